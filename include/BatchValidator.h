@@ -0,0 +1,65 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef BATCHVALIDATOR_H
+#define BATCHVALIDATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+/**
+ * @class BatchValidator
+ * @brief Checks many values of one field at a time against the Customer and Product rules.
+ *
+ * Each kernel packs the values into 16-byte slots and classifies all 16 bytes of a slot with a handful of
+ * SSE2 compares (digit, letter, literal character), then checks the resulting bit masks against the shape
+ * of the field: which positions must be digits, where the hyphens go, how long it may be. The results come
+ * back as a bitmap, bit i set if value i is valid.
+ *
+ * The rules are exactly those of Customer::isUserNameValid, Customer::isNameValid, Customer::isCreditCardValid
+ * and Product::isProductIDValid. Usernames longer than a slot, and builds without SSE2, fall back to those
+ * functions.
+ */
+class BatchValidator {
+public:
+    using Bitmap = std::vector<std::uint64_t>;   ///< Bit i % 64 of word i / 64 is set if value i is valid.
+
+    /**
+     * @brief Validates usernames ('U' followed by up to three digits, then at least six letters or digits).
+     * @param values The usernames.
+     * @return Bitmap The validity bitmap.
+     */
+    static Bitmap userNames(std::span<const std::string_view> values);
+
+    /**
+     * @brief Validates first or last names (1 to 12 letters).
+     * @param values The names.
+     * @return Bitmap The validity bitmap.
+     */
+    static Bitmap names(std::span<const std::string_view> values);
+
+    /**
+     * @brief Validates credit card numbers (NNNN-NNNN-NNNN, not starting with 0).
+     * @param values The credit card numbers.
+     * @return Bitmap The validity bitmap.
+     */
+    static Bitmap creditCards(std::span<const std::string_view> values);
+
+    /**
+     * @brief Validates Product IDs ("Prod" followed by five digits).
+     * @param values The Product IDs.
+     * @return Bitmap The validity bitmap.
+     */
+    static Bitmap productIDs(std::span<const std::string_view> values);
+
+    /**
+     * @brief Reads one bit of a bitmap.
+     * @param bitmap The bitmap.
+     * @param index The value's position.
+     * @return bool True if the value is valid.
+     */
+    static bool isSet(const Bitmap& bitmap, std::size_t index) { return (bitmap[index / 64] >> (index % 64)) & 1; }
+};
+
+#endif // BATCHVALIDATOR_H
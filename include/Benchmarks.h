@@ -0,0 +1,82 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <string>
+#include <vector>
+#include "DataStore.h"
+#include "RewardService.h"
+
+/**
+ * @class Benchmarks
+ * @brief The micro-benchmarks run with --bench-<name> N, kept in one table so a new one needs no new option.
+ *
+ * Each benchmark prints its timings and, where it has one, the result of a self-check that compares the fast
+ * path with a plain one ("0 mismatches", "consistent", "correct"). selfCheck() runs them all at a small size
+ * and reports whether every check held; `make check` runs it.
+ */
+class Benchmarks {
+public:
+    /**
+     * @brief What a benchmark may use from the loaded program.
+     */
+    struct Context {
+        DataStore& store;          ///< The loaded data; the rule benchmark takes its carts from its products.
+        RewardService& service;    ///< The reward service, whose configuration is read and republished.
+    };
+
+    /**
+     * @brief Runs a benchmark.
+     * @param context The loaded program.
+     * @param size How many carts, reads, values, products... the benchmark works on.
+     * @return bool False if the benchmark's self-check failed.
+     */
+    using Function = bool (*)(Context& context, long long size);
+
+    /**
+     * @brief One row of the table.
+     */
+    struct Entry {
+        const char* name;       ///< The benchmark runs with --bench-<name> N.
+        const char* argument;   ///< What N counts, for the usage text.
+        long long checkSize;    ///< N when run by selfCheck(): small, so the whole table runs in seconds.
+        Function run;
+    };
+
+    /**
+     * @brief Retrieves every benchmark, in the order selfCheck() runs them.
+     * @return const std::vector<Entry>& The table.
+     */
+    static const std::vector<Entry>& all();
+
+    /**
+     * @brief Finds a benchmark by name.
+     * @param name The name, without the "--bench-" prefix.
+     * @return const Entry* The benchmark, or nullptr if there is none by that name.
+     */
+    static const Entry* find(const std::string& name);
+
+    /**
+     * @brief Builds the usage text of the benchmark options.
+     * @return std::string " [--bench-rules CARTS] [--bench-config READS] ..."
+     */
+    static std::string usage();
+
+    /**
+     * @brief Runs one benchmark, then restores the std::cout formatting it changed.
+     * @param entry The benchmark.
+     * @param context The loaded program.
+     * @param size How many items the benchmark works on.
+     * @return bool False if the benchmark's self-check failed.
+     */
+    static bool run(const Entry& entry, Context& context, long long size);
+
+    /**
+     * @brief Runs every benchmark at its check size.
+     * @param context The loaded program.
+     * @return bool True if every self-check held.
+     */
+    static bool selfCheck(Context& context);
+};
+
+#endif // BENCHMARKS_H
@@ -0,0 +1,87 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef BLOOMFILTER_H
+#define BLOOMFILTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class BloomFilter
+ * @brief Split-block Bloom filter used as a cheap prefilter in front of exact uniqueness checks.
+ *
+ * Every key maps to a single 32-byte block and sets one bit in each of the block's eight 32-bit words,
+ * so an insert or lookup touches one cache line no matter how large the filter is. A negative answer is
+ * definite; a positive answer only means the key might have been inserted and must be confirmed against
+ * an exact index.
+ */
+class BloomFilter {
+public:
+    /**
+     * @brief Constructor for the BloomFilter class.
+     * @param expectedItems The number of keys the filter is sized for. Inserting more keys still works but
+     *                      raises the false-positive rate.
+     * @param bitsPerItem Filter bits budgeted per expected key. 10 bits gives roughly a 1% false-positive rate.
+     */
+    explicit BloomFilter(std::size_t expectedItems = 1024, double bitsPerItem = 10.0);
+
+    /**
+     * @brief Adds a key to the filter.
+     * @param key The key to add.
+     */
+    void insert(const std::string& key);
+
+    /**
+     * @brief Checks whether a key may have been added to the filter.
+     * @param key The key to look up.
+     * @return bool False if the key was definitely never inserted, true if it might have been.
+     */
+    bool mightContain(const std::string& key) const;
+
+    /**
+     * @brief Removes every key and resizes the filter for a new expected key count.
+     * @param expectedItems The number of keys the filter is sized for.
+     */
+    void reset(std::size_t expectedItems);
+
+    /**
+     * @brief Retrieves the number of keys inserted since construction or the last reset.
+     * @return std::size_t The number of inserted keys.
+     */
+    std::size_t getItemCount() const { return itemCount; }
+
+    /**
+     * @brief Retrieves the number of keys the filter was sized for.
+     * @return std::size_t The expected key count.
+     */
+    std::size_t getCapacity() const { return capacity; }
+
+    /**
+     * @brief Retrieves the memory used by the filter's bit array.
+     * @return std::size_t The size of the bit array in bytes.
+     */
+    std::size_t getSizeInBytes() const { return blocks.size() * sizeof(Block); }
+
+private:
+    static constexpr int WORDS_PER_BLOCK = 8;
+
+    struct alignas(32) Block {
+        std::uint32_t words[WORDS_PER_BLOCK];
+    };
+
+    std::vector<Block> blocks;   ///< The filter bits, one 32-byte block per bucket.
+    std::size_t capacity;        ///< Number of keys the filter was sized for.
+    std::size_t itemCount;       ///< Number of keys inserted.
+    double bitsPerItem;          ///< Bits budgeted per expected key.
+
+    /**
+     * @brief Hashes a key and selects its block.
+     * @param key The key to hash.
+     * @param hash Receives the 64-bit hash; its low 32 bits pick the bits set within the block.
+     * @return std::size_t The index of the key's block.
+     */
+    std::size_t locate(const std::string& key, std::uint64_t& hash) const;
+};
+
+#endif // BLOOMFILTER_H
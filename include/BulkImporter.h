@@ -0,0 +1,70 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef BULKIMPORTER_H
+#define BULKIMPORTER_H
+
+#include <cstddef>
+#include <functional>
+#include <set>
+#include <string>
+#include <vector>
+#include "Customer.h"
+#include "ShardMap.h"
+
+/**
+ * @brief Summary of one bulk customer import.
+ */
+struct ImportReport {
+    std::size_t rowsRead = 0;           ///< Data rows read from the CSV (header excluded).
+    std::size_t imported = 0;           ///< Rows that became new customers.
+    std::size_t rejected = 0;           ///< Rows written to the reject file.
+    std::size_t filterRejects = 0;      ///< Uniqueness checks answered by the Bloom filters alone.
+    std::size_t falsePositives = 0;     ///< Filter hits that the exact index showed to be unique.
+    double seconds = 0.0;               ///< Wall-clock duration of the import.
+
+    /**
+     * @brief Retrieves the import throughput.
+     * @return double Rows processed per second.
+     */
+    double rowsPerSecond() const { return seconds > 0.0 ? rowsRead / seconds : 0.0; }
+
+    /**
+     * @brief Retrieves the measured false-positive rate of the uniqueness prefilters.
+     * @return double Fraction of unique keys that still needed an exact index lookup.
+     */
+    double falsePositiveRate() const {
+        std::size_t negatives = filterRejects + falsePositives;
+        return negatives == 0 ? 0.0 : static_cast<double>(falsePositives) / negatives;
+    }
+};
+
+/**
+ * @class BulkImporter
+ * @brief Imports customers from a CSV file of `username,firstName,lastName,age,creditCard` rows.
+ *
+ * The file is streamed in fixed-size chunks, so memory use does not depend on its size. Each chunk's rows
+ * are parsed in parallel and validated column by column with BatchValidator, then deduplicated in file order against
+ * the existing customers and the rows accepted before them. Customer IDs are assigned from a single counter
+ * and every rejected row is written to the reject file with its line number and reason.
+ */
+class BulkImporter {
+public:
+    /**
+     * @brief Imports customers from a CSV file.
+     * @param csvFilename The CSV file to import. A first line starting with "username" is treated as a header.
+     * @param rejectFilename The file where rejected rows are written as `line,reason,row`.
+     * @param customers The customer list to append imported customers to.
+     * @param usedIDs The set of used Customer IDs; new IDs are added to it.
+     * @param threadCount Number of validation threads, or 0 to use every hardware thread.
+     * @param shardMap The shard the customers are imported into; only IDs it owns are assigned.
+     * @param chunkImported If set, called after each chunk is appended with the position in customers of the
+     *                      chunk's first customer, e.g. to journal the chunk while it is still in cache.
+     * @return ImportReport Counts, timing and prefilter statistics for the import.
+     * @throws std::runtime_error If the CSV file or the reject file cannot be opened.
+     */
+    static ImportReport importCustomers(const std::string& csvFilename, const std::string& rejectFilename,
+                                        std::vector<Customer>& customers, std::set<std::string>& usedIDs,
+                                        unsigned threadCount = 0, const ShardMap& shardMap = ShardMap(),
+                                        const std::function<void(std::size_t)>& chunkImported = nullptr);
+};
+
+#endif // BULKIMPORTER_H
@@ -0,0 +1,149 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef CHECKOUTPIPELINE_H
+#define CHECKOUTPIPELINE_H
+
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DataStore.h"
+#include "FileManager.h"
+#include "LogWriter.h"
+#include "RewardConfig.h"
+#include "Task.h"
+
+/**
+ * @brief Outcome of one checkout.
+ */
+struct Receipt {
+    double totalCost = 0.0;   ///< Price of all cart lines.
+    int rewardPoints = 0;     ///< Points credited to the customer.
+};
+
+using Cart = std::vector<std::pair<std::string, int>>;   ///< Pairs of Product ID and quantity.
+
+/**
+ * @brief Outcome of one cart in a batch: a receipt, or the reason the cart was rejected.
+ */
+struct BatchOutcome {
+    std::optional<Receipt> receipt;   ///< Set if the cart was applied.
+    std::string error;                ///< Why the cart was rejected, if it was.
+};
+
+/**
+ * @class CheckoutPipeline
+ * @brief Runs checkouts as C++20 coroutines through the stages
+ *        validate customer -> resolve products -> reserve stock -> price -> accrue points -> log.
+ *        Each checkout carries the RewardConfig that limits and scores it.
+ *
+ * The first two stages only take the store's shared lock, so bad carts are turned away without ever blocking
+ * writers. Reserve, price and accrue re-check the cart and apply it under one WriteGuard, which also allocates
+ * the sequence number and queues the log record on the LogWriter. The last check of reserve is the customer's
+ * velocity limits (orders and spending within a sliding window), which count the order once it passes. Accrual
+ * adds the bonus of the customer's loyalty tier, found from their lifetime totals before the order, and then
+ * counts the order in those totals. The guard is released before the coroutine suspends to wait for the log
+ * write, so a few pipeline threads can keep many checkouts in flight while the I/O thread writes their records
+ * in groups.
+ *
+ * Batches (a POS sync, a replayed day) skip the per-cart stages: commitBatch() resolves every customer and
+ * product ID in one sorted pass over each list, applies all carts under a single WriteGuard and queues all
+ * of their records as one log write.
+ *
+ * A checkout completes only after its record is in the log. A snapshot taken in between already contains
+ * the checkout; its checkpoint offset is then slightly before the record, which replay handles by
+ * skipping records at or below the checkpoint sequence.
+ */
+class CheckoutPipeline {
+public:
+    /**
+     * @brief Starts the pipeline threads and the log I/O thread.
+     * @param store The store to operate on.
+     * @param threadCount Number of threads that run pipeline stages.
+     */
+    explicit CheckoutPipeline(DataStore& store, unsigned threadCount = 2);
+
+    /**
+     * @brief Detaches the log writer from the store, then stops the threads.
+     */
+    ~CheckoutPipeline();
+
+    /**
+     * @brief The checkout coroutine. Awaiting it runs all stages.
+     * @param customerID The unique identifier of the buying customer.
+     * @param cart Pairs of Product ID and quantity. Applied completely or not at all.
+     * @param config The accrual rules and limits the cart is checked out under.
+     * @return Task<Receipt> Produces the total cost and points earned.
+     * @throws std::invalid_argument If the cart is empty, the customer or a product is unknown, or a quantity
+     *         is not in stock.
+     */
+    Task<Receipt> checkout(std::string customerID, Cart cart, std::shared_ptr<const RewardConfig> config);
+
+    /**
+     * @brief Starts a checkout without waiting for it.
+     * @param done Called on a pipeline thread with the receipt, or with the exception that rejected the cart.
+     */
+    void submit(std::string customerID, Cart cart, std::shared_ptr<const RewardConfig> config,
+                std::function<void(std::optional<Receipt>, std::exception_ptr)> done);
+
+    /**
+     * @brief Runs a checkout and blocks the calling thread until it completes.
+     * @return Receipt The total cost and points earned.
+     * @throws std::invalid_argument If the cart is empty, the customer or a product is unknown, or a quantity
+     *         is not in stock.
+     */
+    Receipt run(std::string customerID, Cart cart, std::shared_ptr<const RewardConfig> config);
+
+    /**
+     * @brief The batch checkout coroutine: applies many carts under one WriteGuard and logs them with one write.
+     * @param orders The carts, applied in order. Each cart is applied completely or not at all; a rejected cart
+     *               does not affect the others.
+     * @param config The accrual rules and limits the cart is checked out under.
+     * @return Task<std::vector<BatchOutcome>> Produces one outcome per order, in order.
+     */
+    Task<std::vector<BatchOutcome>> checkoutBatch(std::vector<CartOrder> orders,
+                                                  std::shared_ptr<const RewardConfig> config);
+
+    /**
+     * @brief Runs a batch checkout and blocks the calling thread until its records are in the log.
+     * @return std::vector<BatchOutcome> One outcome per order, in order.
+     */
+    std::vector<BatchOutcome> runBatch(std::vector<CartOrder> orders, std::shared_ptr<const RewardConfig> config);
+
+    /**
+     * @brief Retrieves the log group-commit counters.
+     * @return LogWriter::Stats The counters so far.
+     */
+    LogWriter::Stats getLogStats() const { return log.getStats(); }
+
+private:
+    struct ResolvedLine {
+        std::size_t position;   ///< Index in the product list when resolved; re-checked at reserve time.
+        double price;
+    };
+
+    struct Committed {
+        Receipt receipt;
+        LogWriter::Ticket ticket;
+    };
+
+    struct CommittedBatch {
+        std::vector<BatchOutcome> outcomes;
+        LogWriter::Ticket ticket = 0;   ///< 0 if no cart was applied and nothing was logged.
+    };
+
+    DataStore& store;
+    Executor executor;   // declared before log: the log writer resumes waiters on it until it is destroyed
+    LogWriter log;
+
+    Task<void> validateCustomer(const std::string& customerID, const Cart& cart, const RewardConfig& config);
+    Task<std::vector<ResolvedLine>> resolveProducts(const Cart& cart);
+    Committed commit(const std::string& customerID, const Cart& cart, std::vector<ResolvedLine>& lines,
+                     const RewardConfig& config);
+    CommittedBatch commitBatch(const std::vector<CartOrder>& orders, const RewardConfig& config);
+};
+
+#endif // CHECKOUTPIPELINE_H
@@ -0,0 +1,46 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef CONFIGWATCHER_H
+#define CONFIGWATCHER_H
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+
+/**
+ * @class ConfigWatcher
+ * @brief Calls back whenever a file is written or replaced, from a background thread.
+ *
+ * The thread blocks in poll() on an inotify descriptor watching the file's directory, so it costs nothing
+ * while the file is unchanged. Watching the directory rather than the file itself also catches editors and
+ * RewardConfig::savePointsPerDollar, which write a new file and rename it over the old one.
+ */
+class ConfigWatcher {
+public:
+    /**
+     * @brief Starts watching.
+     * @param filename The file to watch. It does not have to exist yet.
+     * @param changed Called on the watcher thread with the time the change was noticed.
+     * @throws std::runtime_error If inotify is not available.
+     */
+    ConfigWatcher(const std::string& filename, std::function<void(std::chrono::steady_clock::time_point)> changed);
+
+    /**
+     * @brief Stops the watcher thread.
+     */
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+private:
+    std::string name;   ///< File name without its directory, as inotify reports it.
+    std::function<void(std::chrono::steady_clock::time_point)> changed;
+    int inotifyFd = -1;
+    int stopFd = -1;    ///< eventfd that wakes the thread to exit.
+    std::thread thread;
+
+    void runLoop();
+};
+
+#endif // CONFIGWATCHER_H
@@ -2,52 +2,77 @@
 #ifndef CUSTOMER_H
 #define CUSTOMER_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <stdexcept>
 
 /**
  * @class Customer
  * @brief Represents a customer with relevant attributes and validation.
+ *
+ * A customer is stored in 80 bytes (on 64-bit platforms) with no heap blocks of its own: the Customer ID as
+ * the number after "CustID" and its digit count, the card number as its 12 digits, the age in a byte, and
+ * the names and username in fixed-width buffers sized by the validation rules. A field that does not fit that form (a
+ * Customer ID not made of "CustID" and digits, or a username longer than USER_NAME_CAPACITY) is kept in an
+ * out-of-line Overflow instead, so every value the accessors accepted before is still returned unchanged.
  */
 class Customer {
 private:
-    std::string customerID;          ///< Unique identifier for the customer.
-    std::string userName;            ///< Username chosen by the customer.
-    std::string firstName;           ///< First name of the customer.
-    std::string lastName;            ///< Last name of the customer.
-    int age;                         ///< Age of the customer.
-    std::string creditCardNumber;    ///< Credit card number of the customer.
-    int rewardPoints;                ///< Reward points accumulated by the customer.
+    static constexpr std::size_t NAME_CAPACITY = 12;        ///< isNameValid allows at most 12 letters.
+    static constexpr std::size_t USER_NAME_CAPACITY = 24;
 
     /**
-     * @brief Validates the customer's username.
-     * @param userName The username to validate.
-     * @return bool True if the username is valid, false otherwise.
-     */
-    bool isUserNameValid(const std::string& userName);
-
-    /**
-     * @brief Validates a name (first or last).
-     * @param name The name to validate.
-     * @return bool True if the name is valid, false otherwise.
+     * @brief The fields that did not fit the compact form, as given.
      */
-    bool isNameValid(const std::string& name);
+    struct Overflow {
+        std::string customerID;
+        std::string userName;
+        std::string firstName;
+        std::string lastName;
+        std::string creditCardNumber;
+    };
+
+    enum : std::uint8_t {
+        OVERFLOW_ID = 1, OVERFLOW_USER_NAME = 2, OVERFLOW_FIRST_NAME = 4, OVERFLOW_LAST_NAME = 8, OVERFLOW_CARD = 16
+    };
+
+    std::uint64_t idNumber = 0;                ///< Unique identifier for the customer: the digits after "CustID".
+    std::uint64_t cardNumber = 0;              ///< Credit card number of the customer, without the hyphens.
+    std::unique_ptr<Overflow> overflow;        ///< Null unless a field is in overflowFields.
+    std::int32_t rewardPoints = 0;             ///< Reward points accumulated by the customer.
+    std::uint8_t age = 0;                      ///< Age of the customer.
+    std::uint8_t idDigits = 0;                 ///< Digits after "CustID", leading zeros included.
+    std::uint8_t userNameLength = 0;
+    std::uint8_t overflowFields = 0;           ///< OVERFLOW_* flags of the fields kept in overflow.
+    char firstName[NAME_CAPACITY] = {};        ///< First name of the customer, zero-padded.
+    char lastName[NAME_CAPACITY] = {};         ///< Last name of the customer, zero-padded.
+    char userName[USER_NAME_CAPACITY] = {};    ///< Username chosen by the customer.
+
+    Customer() = default;            ///< For prevalidated(); the fields are assigned there.
 
     /**
-     * @brief Validates the customer's age.
-     * @param age The age to validate.
-     * @return bool True if the age is within the valid range, false otherwise.
+     * @brief Packs the fields into the compact form.
      */
-    bool isAgeValid(int age);
+    void assign(const std::string& customerID, const std::string& userName, const std::string& firstName,
+                const std::string& lastName, int age, const std::string& creditCardNumber);
 
+public:
     /**
-     * @brief Validates the customer's credit card number.
-     * @param creditCard The credit card number to validate.
-     * @return bool True if the credit card number is valid, false otherwise.
+     * @brief A Customer ID parsed once into the compact form, for matching it against many customers.
      */
-    bool isCreditCardValid(const std::string& creditCard);
+    struct IDKey {
+        /**
+         * @brief Parses a Customer ID.
+         * @param customerID The unique identifier of the customer.
+         */
+        explicit IDKey(const std::string& customerID);
+
+        std::string customerID;      ///< The ID as given, for IDs that do not fit the compact form.
+        std::uint64_t number = 0;
+        std::uint8_t digits = 0;     ///< 0 if the ID does not fit the compact form.
+    };
 
-public:
     /**
      * @brief Constructor for the Customer class with validation checks.
      * @param customerID The unique identifier for the customer.
@@ -62,12 +87,40 @@ public:
     Customer(const std::string& customerID, const std::string& userName, const std::string& firstName,
              const std::string& lastName, int age, const std::string& creditCardNumber, int rewardPoints);
 
+    /**
+     * @brief Creates a customer whose fields were already checked, e.g. by BatchValidator.
+     * @param customerID The unique identifier for the customer.
+     * @param userName The username chosen by the customer.
+     * @param firstName The first name of the customer.
+     * @param lastName The last name of the customer.
+     * @param age The age of the customer.
+     * @param creditCardNumber The credit card number of the customer.
+     * @param rewardPoints The number of reward points the customer has.
+     * @return Customer The customer, built without validating again.
+     */
+    static Customer prevalidated(const std::string& customerID, const std::string& userName,
+                                 const std::string& firstName, const std::string& lastName, int age,
+                                 const std::string& creditCardNumber, int rewardPoints);
+
+    Customer(const Customer& other);
+    Customer& operator=(const Customer& other);
+    Customer(Customer&&) noexcept = default;
+    Customer& operator=(Customer&&) noexcept = default;
+    ~Customer() = default;
+
     /**
      * @brief Retrieves the unique identifier for the customer.
      * @return std::string The unique identifier.
      */
     std::string getCustomerID() const;
 
+    /**
+     * @brief Checks the customer's ID without building it as a string.
+     * @param key The Customer ID to compare with.
+     * @return bool True if this customer has that ID.
+     */
+    bool hasCustomerID(const IDKey& key) const;
+
     /**
      * @brief Retrieves the username of the customer.
      * @return std::string The username.
@@ -109,6 +162,34 @@ public:
      * @param points The number of points to add (or subtract if negative).
      */
     void addRewardPoints(int points);
+
+    /**
+     * @brief Validates the customer's username.
+     * @param userName The username to validate.
+     * @return bool True if the username is valid, false otherwise.
+     */
+    static bool isUserNameValid(const std::string& userName);
+
+    /**
+     * @brief Validates a name (first or last).
+     * @param name The name to validate.
+     * @return bool True if the name is valid, false otherwise.
+     */
+    static bool isNameValid(const std::string& name);
+
+    /**
+     * @brief Validates the customer's age.
+     * @param age The age to validate.
+     * @return bool True if the age is within the valid range, false otherwise.
+     */
+    static bool isAgeValid(int age);
+
+    /**
+     * @brief Validates the customer's credit card number.
+     * @param creditCard The credit card number to validate.
+     * @return bool True if the credit card number is valid, false otherwise.
+     */
+    static bool isCreditCardValid(const std::string& creditCard);
 };
 
 #endif // CUSTOMER_H
@@ -0,0 +1,125 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef CUSTOMERINDEX_H
+#define CUSTOMERINDEX_H
+
+#include <cstddef>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Customer.h"
+
+/**
+ * @class CustomerIndex
+ * @brief Sorted secondary indexes on customer name, age and reward points, for staff lookups that would
+ *        otherwise scan the whole customer list.
+ *
+ * Each index is an ordered set of byte-comparable keys ending in the Customer ID, so equal names or ages
+ * still give distinct keys in a stable order:
+ *  - name:   lowercased last name, '\0', lowercased first name, '\0', Customer ID;
+ *  - age:    the age as four big-endian bytes with the sign bit flipped, then the Customer ID;
+ *  - points: the reward points encoded the same way, then the Customer ID.
+ *
+ * Queries seek to the start of the range and walk forward, so a page costs O(log n + page size) however
+ * deep into the results it is. Pages continue from an opaque cursor, the key of the last row returned,
+ * which stays valid while customers are added and removed.
+ */
+class CustomerIndex {
+public:
+    /**
+     * @brief What a query shows of a customer.
+     */
+    struct Row {
+        std::string customerID;
+        std::string firstName;
+        std::string lastName;
+        int age = 0;
+        int rewardPoints = 0;
+    };
+
+    /**
+     * @brief One page of query results.
+     */
+    struct Page {
+        std::vector<Row> rows;
+        std::string next;   ///< Cursor for the following page; empty if this is the last one.
+    };
+
+    /**
+     * @brief Builds the indexes for the given customers.
+     * @param customers The customers to index.
+     */
+    explicit CustomerIndex(const std::vector<Customer>& customers = {});
+
+    /**
+     * @brief Adds a customer to every index.
+     * @param customer The customer to add.
+     */
+    void add(const Customer& customer);
+
+    /**
+     * @brief Removes a customer from every index.
+     * @param customerID The unique identifier of the customer to remove.
+     * @return bool True if the customer was indexed.
+     */
+    bool remove(const std::string& customerID);
+
+    /**
+     * @brief Moves a customer to its new place in the points index.
+     * @param customerID The unique identifier of the customer.
+     * @param rewardPoints The customer's new reward point balance.
+     */
+    void updatePoints(const std::string& customerID, int rewardPoints);
+
+    /**
+     * @brief Finds customers by name, ordered by last name, then first name, ignoring case.
+     * @param lastName The start of the last name, or the whole last name if firstName is given.
+     * @param firstName The start of the first name; empty to match any.
+     * @param limit The most rows to return.
+     * @param after The cursor of the previous page, or empty for the first page.
+     * @return Page The matching customers.
+     */
+    Page byName(std::string_view lastName, std::string_view firstName, std::size_t limit,
+                const std::string& after = "") const;
+
+    /**
+     * @brief Finds customers with an age in a range, youngest first.
+     * @param minAge The lowest age to include.
+     * @param maxAge The highest age to include.
+     * @param limit The most rows to return.
+     * @param after The cursor of the previous page, or empty for the first page.
+     * @return Page The matching customers.
+     */
+    Page byAge(int minAge, int maxAge, std::size_t limit, const std::string& after = "") const;
+
+    /**
+     * @brief Finds customers with a reward point balance in a range, lowest first.
+     * @param minPoints The lowest balance to include.
+     * @param maxPoints The highest balance to include.
+     * @param limit The most rows to return.
+     * @param after The cursor of the previous page, or empty for the first page.
+     * @return Page The matching customers.
+     */
+    Page byPoints(int minPoints, int maxPoints, std::size_t limit, const std::string& after = "") const;
+
+    /**
+     * @brief Retrieves the number of indexed customers.
+     * @return std::size_t The number of customers.
+     */
+    std::size_t size() const { return rows.size(); }
+
+private:
+    std::unordered_map<std::string, Row> rows;   ///< Customer ID to the indexed fields.
+    std::set<std::string> names;
+    std::set<std::string> ages;
+    std::set<std::string> points;
+
+    static std::string nameKey(const Row& row);
+    static std::string numberKey(int value, const std::string& customerID);
+
+    Page scan(const std::set<std::string>& index, const std::string& from, const std::string& to,
+              std::size_t limit, const std::string& after, std::size_t idOffset) const;
+};
+
+#endif // CUSTOMERINDEX_H
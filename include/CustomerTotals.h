@@ -0,0 +1,89 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef CUSTOMERTOTALS_H
+#define CUSTOMERTOTALS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/**
+ * @class CustomerTotals
+ * @brief One customer's lifetime aggregates: what they have spent, how many orders they placed and when they
+ *        last bought something.
+ *
+ * The totals are kept up to date with every checkout, so a customer's loyalty tier is a lookup rather than a
+ * scan of the transaction log. Spending is kept in whole cents so the running totals match totals rebuilt
+ * from the log exactly.
+ */
+class CustomerTotals {
+public:
+    /**
+     * @brief Constructor for the CustomerTotals class.
+     * @param customerID The unique identifier of the customer the totals belong to.
+     * @param spendCents Lifetime spending, in cents.
+     * @param orderCount Number of orders placed.
+     * @param lastPurchase When the last order was placed, in seconds since the epoch; 0 if not known.
+     */
+    explicit CustomerTotals(std::string customerID, std::int64_t spendCents = 0, std::int64_t orderCount = 0,
+                            std::int64_t lastPurchase = 0)
+        : customerID(std::move(customerID)), spendCents(spendCents), orderCount(orderCount),
+          lastPurchase(lastPurchase) {}
+
+    /**
+     * @brief Retrieves the unique identifier of the customer the totals belong to.
+     * @return const std::string& The Customer ID.
+     */
+    const std::string& getCustomerID() const { return customerID; }
+
+    /**
+     * @brief Retrieves the customer's lifetime spending.
+     * @return std::int64_t The amount spent, in cents.
+     */
+    std::int64_t getSpendCents() const { return spendCents; }
+
+    /**
+     * @brief Retrieves the number of orders the customer placed.
+     * @return std::int64_t The order count.
+     */
+    std::int64_t getOrderCount() const { return orderCount; }
+
+    /**
+     * @brief Retrieves when the customer last placed an order.
+     * @return std::int64_t Seconds since the epoch, or 0 if not known.
+     */
+    std::int64_t getLastPurchase() const { return lastPurchase; }
+
+    /**
+     * @brief Converts an amount of money to the cents the totals are kept in.
+     * @param amount The amount, in dollars.
+     * @return std::int64_t The amount rounded to the nearest cent.
+     */
+    static std::int64_t toCents(double amount);
+
+    /**
+     * @brief Adds one order.
+     * @param cents The order's total cost, in cents.
+     * @param purchasedAt When it was placed, in seconds since the epoch; 0 if not known.
+     */
+    void addPurchase(std::int64_t cents, std::int64_t purchasedAt);
+
+    /**
+     * @brief Adds the totals of orders placed after the ones already counted, as when totals built from
+     *        separate stretches of the log are combined.
+     * @param later The totals of the later orders, for the same customer.
+     */
+    void merge(const CustomerTotals& later);
+
+    /**
+     * @brief Resets the totals, as when the customer is removed.
+     */
+    void clear();
+
+private:
+    std::string customerID;
+    std::int64_t spendCents;
+    std::int64_t orderCount;
+    std::int64_t lastPurchase;
+};
+
+#endif // CUSTOMERTOTALS_H
@@ -0,0 +1,454 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef DATASTORE_H
+#define DATASTORE_H
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+#include "Customer.h"
+#include "CustomerIndex.h"
+#include "CustomerTotals.h"
+#include "FileManager.h"
+#include "Gift.h"
+#include "LazyCustomerFile.h"
+#include "PointLots.h"
+#include "Product.h"
+#include "ShardMap.h"
+#include "StockMonitor.h"
+#include "TimingWheel.h"
+#include "VelocityLimiter.h"
+
+class LogWriter;
+
+/**
+ * @class DataStore
+ * @brief Holds the customer, product and gift lists with copy-on-write sharing so a consistent snapshot
+ *        can be taken in O(1) and written out while the menu keeps working.
+ *
+ * Each list lives behind a shared_ptr. Taking a snapshot just copies the three pointers under a shared lock.
+ * A writer asks a WriteGuard for a mutable list; if a snapshot still references that list, the guard copies
+ * it first (the copy-on-write step), so the snapshot never sees a half-finished change.
+ *
+ * The store also hands out the transaction log sequence numbers, so every snapshot knows exactly which
+ * log records it already contains (see Checkpoint). Records are appended through the guard that numbered
+ * them; once a LogWriter is attached every record goes through its queue, so the log stays in sequence order.
+ *
+ * In lazy mode the customer list only holds the customers decoded so far. The rest stay in a read-only
+ * LazyCustomerFile (the base) and are decoded on first lookup; customers removed from the base are kept
+ * as a sorted list of tombstoned IDs so snapshots leave them out and lookups skip them in O(log n).
+ *
+ * The secondary customer indexes (CustomerIndex) are built on first use and kept up to date from then on,
+ * so registering, removing and crediting customers must go through the WriteGuard methods that say so.
+ * Likewise the StockMonitor follows product stock levels, so products are added, removed and restocked or
+ * sold through the WriteGuard.
+ *
+ * In a sharded deployment the store holds one shard's customers; its ShardMap says which Customer IDs it
+ * may hand out to new customers.
+ *
+ * Points that expire are also kept as dated lots (PointLots), a fourth copy-on-write list. Every lot is
+ * scheduled on a TimingWheel by its position in that list, so finding the lots that came due costs O(1) per
+ * lot rather than a scan of every customer. Lots are only ever cleared, never erased, so positions hold.
+ *
+ * Each customer's lifetime totals (CustomerTotals) are a fifth copy-on-write list, updated by every checkout
+ * and found through a hash of Customer IDs, so a customer's loyalty tier is an O(1) lookup.
+ */
+class DataStore {
+public:
+    /**
+     * @brief An immutable, consistent view of the three lists at one point in time.
+     */
+    struct Snapshot {
+        std::shared_ptr<const std::vector<Customer>> customers;
+        std::shared_ptr<const std::vector<Product>> products;
+        std::shared_ptr<const std::vector<Gift>> gifts;
+        std::shared_ptr<const std::vector<PointLots>> pointLots;
+        std::shared_ptr<const std::vector<CustomerTotals>> customerTotals;
+        std::shared_ptr<const LazyCustomerFile> baseCustomers;   ///< Customers not yet decoded, or null.
+        std::shared_ptr<const std::vector<std::string>> removedBaseCustomers;   ///< Base IDs removed since.
+        std::uint64_t version = 0;   ///< Number of write operations the snapshot includes.
+        Checkpoint checkpoint;       ///< Last log record included and the log size at that point.
+    };
+
+    /**
+     * @brief Foreground latency added by copy-on-write, for judging the cost of background snapshots.
+     */
+    struct Stats {
+        std::uint64_t writeOperations = 0;   ///< WriteGuards that modified at least one list.
+        std::uint64_t copies = 0;            ///< Lists copied because a snapshot still referenced them.
+        double copySeconds = 0.0;            ///< Total time spent copying lists.
+        double maxCopySeconds = 0.0;         ///< Longest single copy.
+        double lockWaitSeconds = 0.0;        ///< Total time writers waited for the store lock.
+    };
+
+    /**
+     * @class WriteGuard
+     * @brief Exclusive access to the store for one operation. Mutable accessors detach shared lists first.
+     */
+    class WriteGuard {
+    public:
+        /**
+         * @brief Retrieves the customer list for modification.
+         * @return std::vector<Customer>& The customer list, copied first if a snapshot still shares it.
+         */
+        std::vector<Customer>& customers();
+
+        /**
+         * @brief Retrieves the product list for modification.
+         * @return std::vector<Product>& The product list, copied first if a snapshot still shares it.
+         */
+        std::vector<Product>& products();
+
+        /**
+         * @brief Retrieves the gift list for modification.
+         * @return std::vector<Gift>& The gift list, copied first if a snapshot still shares it.
+         */
+        std::vector<Gift>& gifts();
+
+        /**
+         * @brief Finds a customer for modification, decoding it from the lazy base file on first access.
+         * @param customerID The unique identifier to look up.
+         * @return Customer* The customer, or nullptr if there is no such customer.
+         * @throws std::runtime_error If the base record cannot be read or parsed.
+         * @throws std::invalid_argument If the base record fails the Customer validation rules.
+         */
+        Customer* findCustomer(const std::string& customerID);
+
+        /**
+         * @brief Adds a newly registered customer to the customer list and the secondary indexes.
+         * @param customer The new customer.
+         */
+        void addCustomer(const Customer& customer);
+
+        /**
+         * @brief Adds customers appended directly to customers() to the secondary indexes.
+         * @param firstNew Position in the customer list of the first customer not yet indexed.
+         */
+        void indexNewCustomers(std::size_t firstNew);
+
+        /**
+         * @brief Credits (or debits, if negative) a customer's reward points and updates the points index.
+         *        A debit spends the customer's lots closest to expiring first.
+         * @param customer A customer obtained from this guard.
+         * @param points The number of points to add.
+         * @param expiresAt When credited points expire, in seconds since the epoch; they are kept as a dated lot.
+         *                  PointLots::NEVER credits points that do not expire.
+         */
+        void addRewardPoints(Customer& customer, int points, std::int64_t expiresAt = PointLots::NEVER);
+
+        /**
+         * @brief Expires one customer's lots that are due, deducting their points.
+         * @param customer A customer obtained from this guard.
+         * @param now The time, in seconds since the epoch.
+         * @return int The points expired.
+         */
+        int expirePoints(Customer& customer, std::int64_t now);
+
+        /**
+         * @brief Advances the expiry wheel and expires every lot that came due, deducting the points from the
+         *        customers they belong to. Logging the expiries is left to the caller.
+         * @param now The time, in seconds since the epoch.
+         * @return std::vector<std::pair<std::string, int>> The Customer ID and points expired of each customer
+         *         who lost points, in Customer ID order.
+         */
+        std::vector<std::pair<std::string, int>> expireDuePoints(std::int64_t now);
+
+        /**
+         * @brief Retrieves a customer's dated lots.
+         * @param customerID The unique identifier of the customer.
+         * @return const PointLots* The lots, or nullptr if the customer never earned points that expire.
+         */
+        const PointLots* pointLots(const std::string& customerID) const { return store.findLots(customerID); }
+
+        /**
+         * @brief Counts an order in a customer's lifetime totals.
+         * @param customer A customer obtained from this guard.
+         * @param totalCost The order's total cost.
+         * @param purchasedAt When it was placed, in seconds since the epoch; 0 if not known.
+         */
+        void recordPurchase(const Customer& customer, double totalCost, std::int64_t purchasedAt);
+
+        /**
+         * @brief Retrieves a customer's lifetime totals.
+         * @param customerID The unique identifier of the customer.
+         * @return const CustomerTotals* The totals, or nullptr if the customer never placed an order.
+         */
+        const CustomerTotals* customerTotals(const std::string& customerID) const {
+            return store.findTotals(customerID);
+        }
+
+        /**
+         * @brief Redeems a gift for a customer: checks the points and stock, then deducts both in one step.
+         *
+         * The checks and both deductions happen under this guard's exclusive lock, so concurrent redemptions
+         * of a limited gift can neither sell more units than it has nor spend points a customer lacks.
+         * Nothing changes if a check fails. A redemption that passes every other check is counted against the
+         * customer's redemption limit. Logging the redemption is left to the caller.
+         *
+         * @param customer A customer obtained from this guard.
+         * @param giftNumber Position of the gift in the store's gifts followed by the configured ones, starting at 1.
+         * @param configuredGifts The gifts of the reward configuration, which are never limited.
+         * @param limits The velocity limits of the reward configuration; only the redemption limit applies.
+         * @return Gift The redeemed gift, with the stock left after the redemption.
+         * @throws std::invalid_argument If the gift number is out of range, the gift is out of stock, the
+         *         customer lacks the points, or the customer has redeemed too many gifts lately.
+         */
+        Gift redeemGift(Customer& customer, int giftNumber, const std::vector<Gift>& configuredGifts,
+                        const VelocityLimiter::Limits& limits = {});
+
+        /**
+         * @brief Adds a new product to the product list and the stock monitor.
+         * @param product The new product.
+         */
+        void addProduct(const Product& product);
+
+        /**
+         * @brief Removes a product from the product list and the stock monitor.
+         * @param productID The unique identifier of the product to remove.
+         * @return bool True if the product existed.
+         */
+        bool removeProduct(const std::string& productID);
+
+        /**
+         * @brief Changes a product's inventory and records the new level with the stock monitor.
+         * @param product A product in products().
+         * @param change The number of units to add (positive) or remove (negative).
+         */
+        void updateInventory(Product& product, int change);
+
+        /**
+         * @brief Retrieves the stock monitor, for alerts and the threshold.
+         * @return StockMonitor& The stock monitor.
+         */
+        StockMonitor& stockMonitor() { return store.stockLevels; }
+
+        /**
+         * @brief Retrieves the customers' velocity counters, to check and count a checkout before applying it.
+         * @return VelocityLimiter& The velocity counters.
+         */
+        VelocityLimiter& velocity() { return store.velocityCounters; }
+
+        /**
+         * @brief Retrieves the shard this store holds, so new Customer IDs can be chosen from it.
+         * @return ShardMap& The shard map; a single shard unless set at startup.
+         */
+        ShardMap& shardMap() { return store.shards; }
+
+        /**
+         * @brief Retrieves the secondary customer indexes, building them on first use. In lazy mode the first
+         *        use decodes every remaining base customer.
+         * @return const CustomerIndex& The indexes.
+         * @throws std::runtime_error If a base record cannot be read or parsed.
+         */
+        const CustomerIndex& customerIndex();
+
+        /**
+         * @brief Removes a customer, tombstoning it if it came from the lazy base file.
+         * @param customerID The unique identifier of the customer to remove.
+         * @return bool True if the customer existed.
+         */
+        bool removeCustomer(const std::string& customerID);
+
+        /**
+         * @brief Checks whether the lazy base file holds a customer ID, removed or not, without decoding it.
+         * @param customerID The unique identifier to look up.
+         * @return bool True if the ID is taken by a base record.
+         */
+        bool hasBaseCustomer(const std::string& customerID) const;
+
+        /**
+         * @brief Decodes every remaining base customer into the customer list and drops the base.
+         *        Needed before operations that work on the whole list.
+         * @throws std::runtime_error If a base record cannot be read or parsed.
+         */
+        void materializeAllCustomers();
+
+        /**
+         * @brief Read-only access that never triggers a copy.
+         */
+        const std::vector<Customer>& readCustomers() const { return *store.customerList; }
+        const std::vector<Product>& readProducts() const { return *store.productList; }
+        const std::vector<Gift>& readGifts() const { return *store.giftList; }
+        const std::vector<PointLots>& readPointLots() const { return *store.pointLotList; }
+        const std::vector<CustomerTotals>& readCustomerTotals() const { return *store.customerTotalList; }
+
+        /**
+         * @brief Allocates the sequence number for a transaction log record written by this operation.
+         *        Write the record before releasing the guard so snapshots stay consistent with the log.
+         * @return std::uint64_t The new sequence number.
+         */
+        std::uint64_t nextSequence();
+
+        /**
+         * @brief Appends records numbered by this guard to the transaction log and waits until they are written.
+         *        With a LogWriter attached they are queued behind the records already enqueued on it, so records
+         *        reach the log in the order their sequence numbers were handed out.
+         * @param records One or more formatted records.
+         * @param count How many records the string holds.
+         */
+        void appendLog(std::string records, std::uint64_t count = 1);
+
+        /**
+         * @brief Releases the lock and counts the operation if anything was modified.
+         */
+        ~WriteGuard();
+
+        WriteGuard(const WriteGuard&) = delete;
+        WriteGuard& operator=(const WriteGuard&) = delete;
+
+    private:
+        friend class DataStore;
+        explicit WriteGuard(DataStore& store);
+
+        template <typename T>
+        std::vector<T>& detach(std::shared_ptr<std::vector<T>>& list, bool markModified = true);
+        void updatePoints(Customer& customer, int points);
+
+        DataStore& store;
+        std::unique_lock<std::shared_mutex> lock;
+        bool modified = false;
+    };
+
+    /**
+     * @class ReadGuard
+     * @brief Shared access to the store for one short read. Readers run in parallel with each other and never
+     *        make a writer copy a list, unlike a Snapshot, which is meant to be held for a long time.
+     */
+    class ReadGuard {
+    public:
+        const std::vector<Customer>& readCustomers() const { return *store.customerList; }
+        const std::vector<Product>& readProducts() const { return *store.productList; }
+        const std::vector<Gift>& readGifts() const { return *store.giftList; }
+        const std::vector<PointLots>& readPointLots() const { return *store.pointLotList; }
+        const std::vector<CustomerTotals>& readCustomerTotals() const { return *store.customerTotalList; }
+        const StockMonitor& stockMonitor() const { return store.stockLevels; }
+        const ShardMap& shardMap() const { return store.shards; }
+
+        /**
+         * @brief Looks up a customer, decoding it from the lazy base file if needed without keeping it.
+         * @param customerID The unique identifier to look up.
+         * @return std::optional<Customer> The customer, or nothing if there is no such customer.
+         * @throws std::runtime_error If the base record cannot be read or parsed.
+         */
+        std::optional<Customer> findCustomer(const std::string& customerID) const;
+
+        /**
+         * @brief Retrieves a customer's lifetime totals.
+         * @param customerID The unique identifier of the customer.
+         * @return const CustomerTotals* The totals, or nullptr if the customer never placed an order.
+         */
+        const CustomerTotals* customerTotals(const std::string& customerID) const {
+            return store.findTotals(customerID);
+        }
+
+        /**
+         * @brief Retrieves a customer's dated lots.
+         * @param customerID The unique identifier of the customer.
+         * @return const PointLots* The lots, or nullptr if the customer never earned points that expire.
+         */
+        const PointLots* pointLots(const std::string& customerID) const { return store.findLots(customerID); }
+
+        /**
+         * @brief Retrieves the secondary customer indexes. Readers cannot build them, so build them first with
+         *        WriteGuard::customerIndex(); once built they are kept for the life of the store.
+         * @return const CustomerIndex* The indexes, or nullptr if they were never built.
+         */
+        const CustomerIndex* customerIndex() const { return store.customerIndex.get(); }
+
+    private:
+        friend class DataStore;
+        explicit ReadGuard(const DataStore& store) : store(store), lock(store.mutex) {}
+
+        const DataStore& store;
+        std::shared_lock<std::shared_mutex> lock;
+    };
+
+    /**
+     * @brief Constructor for the DataStore class.
+     * @param customers The initial customer list.
+     * @param products The initial product list.
+     * @param gifts The initial gift list.
+     * @param lastSequence The sequence number of the last transaction log record already applied to the lists.
+     * @param baseCustomers Lazy customer file holding the customers not in the customer list, or null.
+     * @param removedBaseCustomerIDs IDs in baseCustomers that have been removed.
+     * @param pointLots The customers' dated lots; each is scheduled to expire.
+     * @param customerTotals The customers' lifetime totals.
+     */
+    DataStore(std::vector<Customer> customers, std::vector<Product> products, std::vector<Gift> gifts,
+              std::uint64_t lastSequence = 0, std::shared_ptr<const LazyCustomerFile> baseCustomers = nullptr,
+              std::vector<std::string> removedBaseCustomerIDs = {}, std::vector<PointLots> pointLots = {},
+              std::vector<CustomerTotals> customerTotals = {});
+
+    /**
+     * @brief Starts an exclusive write operation. Hold the guard for the whole operation.
+     * @return WriteGuard The guard giving access to the lists.
+     */
+    WriteGuard write();
+
+    /**
+     * @brief Starts a shared read operation. Keep it short: writers wait until the guard is released.
+     * @return ReadGuard The guard giving read access to the lists.
+     */
+    ReadGuard read() const;
+
+    /**
+     * @brief Takes a consistent snapshot, waiting for any write operation in progress to finish.
+     * @return Snapshot The snapshot.
+     */
+    Snapshot snapshot() const;
+
+    /**
+     * @brief Takes a consistent snapshot only if no write operation is in progress.
+     * @param out Receives the snapshot on success.
+     * @return bool True if the snapshot was taken, false if a writer holds the store.
+     */
+    bool trySnapshot(Snapshot& out) const;
+
+    /**
+     * @brief Sends every log write made through WriteGuard::appendLog to a LogWriter's queue from now on.
+     * @param writer The writer, or null to append directly to the log file again. A writer must be detached
+     *               before it is destroyed.
+     */
+    void attachLog(LogWriter* writer);
+
+    /**
+     * @brief Retrieves the copy-on-write latency counters.
+     * @return Stats The counters accumulated since the store was created.
+     */
+    Stats getStats() const;
+
+private:
+    mutable std::shared_mutex mutex;                  ///< Exclusive for writers, shared for snapshots.
+    std::shared_ptr<std::vector<Customer>> customerList;
+    std::unordered_map<std::string, std::uint32_t> customerPositions;   ///< Position in customerList by Customer ID.
+    bool customerPositionsStale = true;               ///< customerPositions must be rebuilt before its next use.
+    std::shared_ptr<std::vector<Product>> productList;
+    std::shared_ptr<std::vector<Gift>> giftList;
+    std::shared_ptr<std::vector<PointLots>> pointLotList;
+    std::unordered_map<std::string, std::uint32_t> pointLotPositions;   ///< Position in pointLotList by Customer ID.
+    TimingWheel expiryWheel;                          ///< Positions in pointLotList, due when a lot expires.
+    std::shared_ptr<std::vector<CustomerTotals>> customerTotalList;
+    std::unordered_map<std::string, std::uint32_t> customerTotalPositions;   ///< Position in customerTotalList.
+    std::shared_ptr<const LazyCustomerFile> baseCustomers;
+    std::shared_ptr<std::vector<std::string>> removedBaseCustomers;   ///< Sorted, for a binary search per lookup.
+    std::unique_ptr<CustomerIndex> customerIndex;     ///< Secondary indexes, or null until first used.
+    StockMonitor stockLevels;                         ///< Inventory levels of the product list.
+    VelocityLimiter velocityCounters;                 ///< Recent orders, spending and redemptions per customer.
+    ShardMap shards;                                  ///< The shard these lists belong to.
+    std::uint64_t version = 0;
+    std::uint64_t lastSequence;                       ///< Last transaction log sequence number handed out.
+    LogWriter* logWriter = nullptr;                   ///< Where appendLog queues records, or null.
+    Stats stats;                                      ///< Guarded by mutex.
+
+    Snapshot makeSnapshot() const;
+    const CustomerTotals* findTotals(const std::string& customerID) const;
+    const PointLots* findLots(const std::string& customerID) const;
+    std::size_t findCustomerPosition(const std::string& customerID);
+    void addCustomerPosition(std::size_t position);
+    bool isRemovedBaseCustomer(const std::string& customerID) const;
+};
+
+#endif // DATASTORE_H
@@ -2,10 +2,15 @@
 #ifndef FILEMANAGER_H
 #define FILEMANAGER_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include "Customer.h"
 #include "Product.h"
+#include "Gift.h"
+#include "CustomerTotals.h"
+#include "PointLots.h"
 
 struct Transaction {
     std::string transactionID;
@@ -34,61 +39,234 @@ struct Transaction {
     void setRewardPoints(int points) { rewardPoints = points; }
 };
 
+/**
+ * @brief Position in the transaction log that a saved data file is consistent with.
+ *
+ * Every data file starts with a "#checkpoint <sequence> <offset>" line: the file reflects every log record
+ * with a sequence number up to `sequence`, and all later records start at or after byte `offset` of the log.
+ */
+struct Checkpoint {
+    std::uint64_t sequence = 0;    ///< Sequence number of the last log record included in the file.
+    std::uint64_t logOffset = 0;   ///< Size of the log, over all its segments, when the file's contents were captured.
+};
+
+/**
+ * @brief A non-purchase change recorded in the transaction log (registrations, removals, new products and gifts).
+ */
+struct ChangeRecord {
+    std::uint64_t sequence;   ///< Sequence number of the change.
+    std::string kind;         ///< Record kind, e.g. "Registered Customer".
+    std::string details;      ///< Comma-separated fields of the change.
+};
+
+/**
+ * @brief A cart to check out as part of a batch.
+ */
+struct CartOrder {
+    std::string customerID;                          ///< The buying customer.
+    std::vector<std::pair<std::string, int>> cart;   ///< Pairs of Product ID and quantity.
+};
+
 /**
  * @class FileManager
  * @brief Provides file management functionalities for logging transactions and saving/loading customer and product data.
  */
 class FileManager {
 public:
+    static void saveTransactions(const std::vector<Transaction>& transactions, const std::string& filename = "transactions.txt");
+    static std::vector<Transaction> loadTransactions(const std::string& filename = "transactions.txt");
+
     /**
      * @brief Logs a customer's transaction to a file.
      * 
+     * @param sequence The sequence number of the transaction in the log.
      * @param customerID The unique identifier for the customer making the transaction.
      * @param cart A vector of pairs, where each pair contains a product ID and the quantity of that product purchased.
      * @param totalCost The total cost of the transaction.
      * @param rewardPoints The number of reward points earned from the transaction.
      */
-    static void saveTransactions(const std::vector<Transaction>& transactions, const std::string& filename = "transactions.txt");
-    static std::vector<Transaction> loadTransactions(const std::string& filename = "transactions.txt");
+    static void logTransaction(std::uint64_t sequence, const std::string& customerID,
+                               const std::vector<std::pair<std::string, int>>& cart, double totalCost, int rewardPoints);
+
+    /**
+     * @brief Formats a purchase as a transaction log record, in the format logTransaction writes.
+     * 
+     * @param sequence The sequence number of the transaction in the log.
+     * @param customerID The unique identifier for the customer making the transaction.
+     * @param cart A vector of pairs, where each pair contains a product ID and the quantity of that product purchased.
+     * @param totalCost The total cost of the transaction.
+     * @param rewardPoints The number of reward points earned from the transaction.
+     * @param pointsExpireAt When the points earned expire, or PointLots::NEVER.
+     * @param purchasedAt When the purchase was made, in seconds since the epoch; 0 leaves it out.
+     * @return std::string The record, including its trailing blank line.
+     */
+    static std::string formatTransaction(std::uint64_t sequence, const std::string& customerID,
+                                         const std::vector<std::pair<std::string, int>>& cart, double totalCost,
+                                         int rewardPoints, std::int64_t pointsExpireAt = PointLots::NEVER,
+                                         std::int64_t purchasedAt = 0);
+
+    /**
+     * @brief Appends already formatted records to the transaction log with a single file open and write.
+     * 
+     * @param records The records to append.
+     * @param filename The name of the transaction log.
+     */
+    static void appendToLog(const std::string& records, const std::string& filename = "transactions.txt");
+
+    /**
+     * @brief Formats a gift redemption as a transaction log record.
+     * 
+     * @param sequence The sequence number of the redemption in the log.
+     * @param customerID The unique identifier for the customer redeeming the gift.
+     * @param gift The redeemed gift, with the stock left after the redemption.
+     * @return std::string The record, including its trailing blank line.
+     */
+    static std::string formatRedemption(std::uint64_t sequence, const std::string& customerID, const Gift& gift);
+
+    /**
+     * @brief Formats a batch of changes as transaction log records, to append with a single write.
+     * 
+     * @param changes The changes, in sequence order.
+     * @return std::string The records, each with its trailing blank line.
+     */
+    static std::string formatChanges(const std::vector<ChangeRecord>& changes);
 
+    /**
+     * @brief Loads a batch of carts, one per line as "<customerID> <productID>:<qty> ...".
+     * 
+     * Blank lines and lines starting with '#' are ignored.
+     * 
+     * @param filename The name of the file to load.
+     * @return std::vector<CartOrder> The carts, in file order.
+     * @throws std::runtime_error If the file cannot be opened or a line is malformed.
+     */
+    static std::vector<CartOrder> loadCartOrders(const std::string& filename);
 
-    static void logTransaction(const std::string& customerID, const std::vector<std::pair<std::string, int>>& cart, double totalCost, int rewardPoints);
+    /**
+     * @brief Retrieves the current size of the transaction log, over all its segments (see TransactionLog).
+     * 
+     * @param filename The name of the transaction log's active segment. Defaults to "transactions.txt".
+     * @return std::uint64_t The size in bytes, or 0 if nothing has been logged yet.
+     */
+    static std::uint64_t transactionLogSize(const std::string& filename = "transactions.txt");
 
     /**
      * @brief Saves customer information to a file.
      * 
      * @param customers A vector of Customer objects to be saved.
      * @param filename The name of the file where customer information will be saved. Defaults to "customers.txt".
-     * @throws std::runtime_error If the file cannot be opened for writing.
+     * @param checkpoint The transaction log position the customer list is consistent with.
+     * @throws std::runtime_error If the file cannot be opened or fully written.
      */
-    static void saveCustomers(const std::vector<Customer>& customers, const std::string& filename = "customers.txt");
+    static void saveCustomers(const std::vector<Customer>& customers, const std::string& filename = "customers.txt",
+                              const Checkpoint& checkpoint = Checkpoint());
 
     /**
      * @brief Loads customer information from a file.
      * 
      * @param filename The name of the file from which customer information will be loaded. Defaults to "customers.txt".
+     * @param checkpoint If not null, receives the file's checkpoint (all zero for files written before checkpoints).
      * @return std::vector<Customer> A vector of Customer objects loaded from the file.
      * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing customer data.
      */
-    static std::vector<Customer> loadCustomers(const std::string& filename = "customers.txt");
+    static std::vector<Customer> loadCustomers(const std::string& filename = "customers.txt", Checkpoint* checkpoint = nullptr);
 
     /**
      * @brief Saves product information to a file.
      * 
      * @param products A vector of Product objects to be saved.
      * @param filename The name of the file where product information will be saved. Defaults to "products.txt".
-     * @throws std::runtime_error If the file cannot be opened for writing.
+     * @param checkpoint The transaction log position the product list is consistent with.
+     * @throws std::runtime_error If the file cannot be opened or fully written.
      */
-    static void saveProducts(const std::vector<Product>& products, const std::string& filename = "products.txt");
+    static void saveProducts(const std::vector<Product>& products, const std::string& filename = "products.txt",
+                             const Checkpoint& checkpoint = Checkpoint());
 
     /**
      * @brief Loads product information from a file.
      * 
      * @param filename The name of the file from which product information will be loaded. Defaults to "products.txt".
+     * @param checkpoint If not null, receives the file's checkpoint (all zero for files written before checkpoints).
      * @return std::vector<Product> A vector of Product objects loaded from the file.
      * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing product data.
      */
-    static std::vector<Product> loadProducts(const std::string& filename = "products.txt");
+    static std::vector<Product> loadProducts(const std::string& filename = "products.txt", Checkpoint* checkpoint = nullptr);
+
+    /**
+     * @brief Saves gift information to a file.
+     * 
+     * @param gifts A vector of Gift objects to be saved.
+     * @param filename The name of the file where gift information will be saved. Defaults to "gifts.txt".
+     * @param checkpoint The transaction log position the gift list is consistent with.
+     * @throws std::runtime_error If the file cannot be opened or fully written.
+     */
+    static void saveGifts(const std::vector<Gift>& gifts, const std::string& filename = "gifts.txt",
+                          const Checkpoint& checkpoint = Checkpoint());
+
+    /**
+     * @brief Loads gift information from a file.
+     * 
+     * @param filename The name of the file from which gift information will be loaded. Defaults to "gifts.txt".
+     * @param checkpoint If not null, receives the file's checkpoint (all zero for files written before checkpoints).
+     * @return std::vector<Gift> A vector of Gift objects loaded from the file.
+     * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing gift data.
+     */
+    static std::vector<Gift> loadGifts(const std::string& filename = "gifts.txt", Checkpoint* checkpoint = nullptr);
+
+    /**
+     * @brief Saves the customers' dated lots of expiring points to a file. Customers without lots are left out.
+     * 
+     * @param pointLots The lots of each customer.
+     * @param filename The name of the file where the lots will be saved. Defaults to "point_lots.txt".
+     * @param checkpoint The transaction log position the lots are consistent with.
+     * @throws std::runtime_error If the file cannot be opened or fully written.
+     */
+    static void savePointLots(const std::vector<PointLots>& pointLots, const std::string& filename = "point_lots.txt",
+                              const Checkpoint& checkpoint = Checkpoint());
+
+    /**
+     * @brief Loads the customers' dated lots of expiring points from a file.
+     * 
+     * @param filename The name of the file from which the lots will be loaded. Defaults to "point_lots.txt".
+     * @param checkpoint If not null, receives the file's checkpoint.
+     * @return std::vector<PointLots> The lots of each customer in the file.
+     * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing a lot.
+     */
+    static std::vector<PointLots> loadPointLots(const std::string& filename = "point_lots.txt",
+                                                Checkpoint* checkpoint = nullptr);
+
+    /**
+     * @brief Saves the customers' lifetime totals to a file. Customers without orders are left out.
+     * 
+     * @param totals The totals of each customer.
+     * @param filename The name of the file where the totals will be saved. Defaults to "customer_totals.txt".
+     * @param checkpoint The transaction log position the totals are consistent with.
+     * @throws std::runtime_error If the file cannot be opened or fully written.
+     */
+    static void saveCustomerTotals(const std::vector<CustomerTotals>& totals,
+                                   const std::string& filename = "customer_totals.txt",
+                                   const Checkpoint& checkpoint = Checkpoint());
+
+    /**
+     * @brief Loads the customers' lifetime totals from a file.
+     * 
+     * @param filename The name of the file from which the totals will be loaded. Defaults to "customer_totals.txt".
+     * @param checkpoint If not null, receives the file's checkpoint.
+     * @return std::vector<CustomerTotals> The totals of each customer in the file.
+     * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing a line.
+     */
+    static std::vector<CustomerTotals> loadCustomerTotals(const std::string& filename = "customer_totals.txt",
+                                                          Checkpoint* checkpoint = nullptr);
+
+    /**
+     * @brief Atomically replaces a file with a freshly written temporary file.
+     * 
+     * @param tempFilename The fully written temporary file.
+     * @param filename The file to replace. Readers see either the old or the new contents, never a mix, and
+     *                 so does the next startup after a crash: the temporary file is flushed to disk first.
+     * @throws std::runtime_error If the temporary file cannot be flushed or the rename fails.
+     */
+    static void replaceFile(const std::string& tempFilename, const std::string& filename);
 };
 
 #endif // FILEMANAGER_H
@@ -6,21 +6,25 @@
 
 /**
  * @class Gift
- * @brief Represents a gift that can be redeemed with reward points.
+ * @brief Represents a gift that can be redeemed with reward points, either without limit or from a limited stock.
  */
 class Gift {
 private:
     std::string giftName;   ///< The name of the gift.
     int requiredPoints;     ///< The number of reward points required to redeem the gift.
+    int stock;              ///< Units left to redeem, or UNLIMITED.
 
 public:
+    static constexpr int UNLIMITED = -1;   ///< Stock of a gift that never runs out.
+
     /**
      * @brief Constructor for the Gift class.
      * @param giftName The name of the gift.
      * @param requiredPoints The number of reward points needed to redeem the gift.
+     * @param stock The units available to redeem, or UNLIMITED.
      */
-    Gift(const std::string& giftName, int requiredPoints)
-        : giftName(giftName), requiredPoints(requiredPoints) {}
+    Gift(const std::string& giftName, int requiredPoints, int stock = UNLIMITED)
+        : giftName(giftName), requiredPoints(requiredPoints), stock(stock < 0 ? UNLIMITED : stock) {}
 
     /**
      * @brief Retrieves the name of the gift.
@@ -33,6 +37,37 @@ public:
      * @return int The number of required reward points.
      */
     int getRequiredPoints() const { return requiredPoints; }
+
+    /**
+     * @brief Retrieves the units left to redeem.
+     * @return int The stock, or UNLIMITED.
+     */
+    int getStock() const { return stock; }
+
+    /**
+     * @brief Checks whether the gift has a limited stock.
+     * @return bool True if the stock can run out.
+     */
+    bool isLimited() const { return stock != UNLIMITED; }
+
+    /**
+     * @brief Checks whether the gift can be redeemed at least once more.
+     * @return bool True if the gift is unlimited or has units left.
+     */
+    bool isInStock() const { return stock != 0; }
+
+    /**
+     * @brief Sets the units left of a limited gift. Has no effect on an unlimited one.
+     * @param units The new stock; negative values are treated as 0.
+     */
+    void setStock(int units) {
+        if (isLimited()) {
+            stock = units < 0 ? 0 : units;
+        }
+        else {
+            // do nothing
+        }
+    }
 };
 
 #endif // GIFT_H
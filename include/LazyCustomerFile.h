@@ -0,0 +1,130 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef LAZYCUSTOMERFILE_H
+#define LAZYCUSTOMERFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+#include "Customer.h"
+#include "FileManager.h"
+
+/**
+ * @class LazyCustomerFile
+ * @brief Read-only view of customers.txt that decodes individual customers on demand.
+ *
+ * Opening the file only maps its sorted offset index (customers.txt.idx, Customer ID -> byte offset), so
+ * startup cost does not depend on the number of customers. A customer record is read, parsed and validated
+ * by the Customer constructor the first time it is looked up. The index is rebuilt with one scan of the
+ * data file whenever it is missing or does not match the data file's size and modification time.
+ *
+ * The data file stays open for the lifetime of the object, so it keeps reading the original contents even
+ * after a snapshot renames a new customers.txt over it.
+ */
+class LazyCustomerFile {
+public:
+    /**
+     * @brief Opens a customer file for lazy access, building its index first if needed.
+     * @param filename The customer file. Its index is filename + ".idx".
+     * @param checkpoint If not null, receives the checkpoint header of the customer file.
+     * @return std::shared_ptr<LazyCustomerFile> The opened file.
+     * @throws std::runtime_error If the file cannot be opened or indexed.
+     */
+    static std::shared_ptr<LazyCustomerFile> open(const std::string& filename, Checkpoint* checkpoint = nullptr);
+
+    /**
+     * @brief Writes the offset index for a customer data file.
+     * @param dataFilename The customer file to scan.
+     * @param indexFilename The index file to write.
+     * @throws std::runtime_error If either file cannot be opened, the index cannot be written, or a Customer ID is
+     *         too long to index.
+     */
+    static void buildIndex(const std::string& dataFilename, const std::string& indexFilename);
+
+    /**
+     * @brief Releases the index mapping and closes the data file.
+     */
+    ~LazyCustomerFile();
+
+    LazyCustomerFile(const LazyCustomerFile&) = delete;
+    LazyCustomerFile& operator=(const LazyCustomerFile&) = delete;
+
+    /**
+     * @brief Retrieves the number of customers in the file.
+     * @return std::size_t The number of indexed customers.
+     */
+    std::size_t size() const { return entryCount; }
+
+    /**
+     * @brief Checks whether the file holds a customer, without decoding it.
+     * @param customerID The unique identifier to look up.
+     * @return bool True if the customer is in the file.
+     */
+    bool contains(const std::string& customerID) const;
+
+    /**
+     * @brief Decodes and validates one customer.
+     * @param customerID The unique identifier to look up.
+     * @return std::optional<Customer> The customer, or nothing if the file does not hold it.
+     * @throws std::runtime_error If the record cannot be read or parsed.
+     * @throws std::invalid_argument If the record fails the Customer validation rules.
+     */
+    std::optional<Customer> load(const std::string& customerID) const;
+
+    /**
+     * @brief Decodes the customer at an index position, in Customer ID order.
+     * @param position Index position, from 0 to size() - 1.
+     * @return Customer The decoded customer.
+     * @throws std::runtime_error If the record cannot be read or parsed.
+     */
+    Customer loadAt(std::size_t position) const;
+
+    /**
+     * @brief Retrieves the Customer ID at an index position without decoding the record.
+     * @param position Index position, from 0 to size() - 1.
+     * @return std::string The Customer ID.
+     */
+    std::string customerIDAt(std::size_t position) const;
+
+    /**
+     * @brief Copies every record whose Customer ID is not in skipIDs to out, unchanged and without decoding.
+     * @param out The stream to write to, in the customers.txt record format.
+     * @param skipIDs IDs to leave out (customers decoded and kept in memory, or removed).
+     * @throws std::runtime_error If the data file cannot be read.
+     */
+    void copyRecords(std::ostream& out, const std::unordered_set<std::string>& skipIDs) const;
+
+private:
+    static constexpr std::size_t ID_LENGTH = 24;   ///< Bytes reserved per Customer ID in the index.
+
+    struct IndexHeader {
+        char magic[8];
+        std::uint64_t dataSize;
+        std::int64_t dataModifiedSeconds;
+        std::int64_t dataModifiedNanoseconds;
+        std::uint64_t entryCount;
+    };
+
+    struct IndexEntry {
+        char customerID[ID_LENGTH];   ///< Zero-padded Customer ID.
+        std::uint64_t offset;         ///< Byte offset of the record in the data file.
+    };
+
+    int dataFile = -1;
+    std::uint64_t dataSize = 0;
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    const IndexEntry* entries = nullptr;
+    std::size_t entryCount = 0;
+
+    LazyCustomerFile() = default;
+
+    const IndexEntry* find(const std::string& customerID) const;
+    std::string readRecord(std::uint64_t offset) const;
+    static Customer parseRecord(const std::string& record);
+};
+
+#endif // LAZYCUSTOMERFILE_H
@@ -0,0 +1,177 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "RewardService.h"
+
+/**
+ * @brief The kinds of request a simulated client sends.
+ */
+enum class LoadOperation { Lookup, Checkout, Redemption, Registration };
+
+constexpr std::size_t LOAD_OPERATION_COUNT = 4;
+
+/**
+ * @brief What to run: how many clients, for how long, at what rate and with which request mix.
+ */
+struct LoadConfig {
+    unsigned clients = 8;      ///< Concurrent simulated clients, each with its own connection.
+    double seconds = 10.0;     ///< Duration of the run.
+    double targetRate = 0.0;   ///< Requests per second across all clients; 0 sends each request as soon as the last returns.
+    std::array<double, LOAD_OPERATION_COUNT> mix = {70.0, 20.0, 5.0, 5.0};   ///< Relative weights, in LoadOperation order.
+};
+
+/**
+ * @brief IDs the simulated clients pick from.
+ */
+struct LoadCatalog {
+    std::vector<std::string> customerIDs;
+    std::vector<std::string> productIDs;
+    int giftCount = 0;
+};
+
+/**
+ * @brief Latency distribution of one kind of request, in microseconds.
+ */
+struct LatencySummary {
+    std::uint64_t count = 0;    ///< Requests completed.
+    std::uint64_t errors = 0;   ///< Requests answered with ERR (e.g. out of stock) or that failed outright.
+    double p50 = 0.0;
+    double p99 = 0.0;
+    double p999 = 0.0;
+    double max = 0.0;
+};
+
+/**
+ * @brief Result of one load run.
+ */
+struct LoadReport {
+    std::array<LatencySummary, LOAD_OPERATION_COUNT> operations;   ///< Per LoadOperation.
+    LatencySummary overall;
+    double seconds = 0.0;       ///< Measured duration of the run.
+
+    /**
+     * @brief Retrieves the achieved throughput.
+     * @return double Completed requests per second.
+     */
+    double throughput() const { return seconds > 0.0 ? overall.count / seconds : 0.0; }
+};
+
+/**
+ * @class LoadTarget
+ * @brief One client's connection to the system under test. Requests and responses use the SocketServer protocol.
+ */
+class LoadTarget {
+public:
+    virtual ~LoadTarget() = default;
+
+    /**
+     * @brief Sends one request and waits for its response.
+     * @param request The request line, without its newline.
+     * @return bool True if the response was OK.
+     * @throws std::runtime_error If the connection fails.
+     */
+    virtual bool execute(const std::string& request) = 0;
+};
+
+/**
+ * @class InProcessTarget
+ * @brief Calls a RewardService directly in this process.
+ */
+class InProcessTarget : public LoadTarget {
+public:
+    explicit InProcessTarget(RewardService& service) : service(service) {}
+    bool execute(const std::string& request) override;
+
+private:
+    RewardService& service;
+};
+
+/**
+ * @class SocketTarget
+ * @brief Talks to a SocketServer over one blocking connection.
+ */
+class SocketTarget : public LoadTarget {
+public:
+    /**
+     * @brief Connects to a server.
+     * @param address "unix:<path>" or "tcp:<port>" (on 127.0.0.1), as given to --serve.
+     * @throws std::runtime_error If the connection cannot be made.
+     */
+    explicit SocketTarget(const std::string& address);
+    ~SocketTarget() override;
+
+    SocketTarget(const SocketTarget&) = delete;
+    SocketTarget& operator=(const SocketTarget&) = delete;
+
+    bool execute(const std::string& request) override;
+
+    /**
+     * @brief Sends one request and waits for its response.
+     * @param request The request line, without its newline.
+     * @return std::string The response line, without its newline.
+     * @throws std::runtime_error If the connection fails.
+     */
+    std::string request(const std::string& request);
+
+    /**
+     * @brief Sends one line without waiting for a response.
+     * @param line The line, without its newline.
+     * @throws std::runtime_error If the connection fails.
+     */
+    void sendLine(const std::string& line);
+
+    /**
+     * @brief Waits for the next line from the server, for streams such as log shipping.
+     * @return std::string The line, without its newline.
+     * @throws std::runtime_error If the connection fails or is closed.
+     */
+    std::string readLine();
+
+    /**
+     * @brief Shuts the connection down, so a thread blocked in readLine() returns. Safe from any thread.
+     */
+    void shutdown();
+
+private:
+    int fd = -1;
+    std::string input;   ///< Bytes received after the last complete response.
+};
+
+/**
+ * @class LoadGenerator
+ * @brief Closed-loop load generator: each client sends a request, waits for the response, then sends the next.
+ *
+ * With a target rate, each client sends on a fixed schedule instead, and latency is measured from the
+ * scheduled send time rather than the actual one. A system that falls behind therefore shows its queueing
+ * delay in the percentiles instead of quietly lowering the offered load.
+ */
+class LoadGenerator {
+public:
+    /**
+     * @brief Runs the load and collects latencies.
+     * @param config Clients, duration, rate and mix.
+     * @param catalog IDs to use in requests. Must hold at least one customer and one product.
+     * @param connect Creates one client's target; called once per client.
+     * @return LoadReport Throughput and latency percentiles.
+     * @throws std::runtime_error If a target cannot be created.
+     */
+    static LoadReport run(const LoadConfig& config, const LoadCatalog& catalog,
+                          const std::function<std::unique_ptr<LoadTarget>()>& connect);
+
+    /**
+     * @brief Retrieves the display name of a request kind.
+     * @param operation The request kind.
+     * @return const char* Its name.
+     */
+    static const char* operationName(LoadOperation operation);
+};
+
+#endif // LOADGENERATOR_H
@@ -0,0 +1,95 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef LOGFOLLOWER_H
+#define LOGFOLLOWER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "DataStore.h"
+#include "LoadGenerator.h"
+#include "SequenceSet.h"
+
+/**
+ * @class LogFollower
+ * @brief Keeps a read-only copy of the primary's data current by applying the records its LogShipper streams.
+ *
+ * The follower starts from the same data files as the primary, loaded and replayed as usual, then asks the
+ * shipper for everything after the last sequence number up to which it has every record. Each record is
+ * applied through Recovery::apply, so lookups and reports served by this process see it as soon as it
+ * arrives. Records may come out of sequence order, so every applied sequence number is remembered and a
+ * record is skipped only if it was itself applied. A lost connection is retried every second, resuming
+ * after the applied records.
+ *
+ * The follower never writes the data files or the log; they belong to the primary.
+ */
+class LogFollower {
+public:
+    /**
+     * @brief How far behind the primary the follower is.
+     */
+    struct Status {
+        bool connected = false;
+        std::uint64_t appliedSequence = 0;   ///< Every record up to this one is applied here.
+        std::uint64_t primarySequence = 0;   ///< Newest record in the primary's log, from its last heartbeat.
+        std::uint64_t recordsApplied = 0;
+        std::uint64_t recordsSkipped = 0;    ///< Records that could not be applied, e.g. for an unknown customer.
+        double lastDelayMs = 0.0;            ///< From the primary noticing the last batch to it being applied here.
+        double heartbeatAgeMs = 0.0;         ///< Time since the primary was last heard from.
+
+        /**
+         * @brief Retrieves the replication lag in records.
+         * @return std::uint64_t Records in the primary's log not yet applied here.
+         */
+        std::uint64_t recordsBehind() const {
+            return primarySequence > appliedSequence ? primarySequence - appliedSequence : 0;
+        }
+    };
+
+    /**
+     * @brief Starts following a primary.
+     * @param store The store to apply the records to, already loaded from the data files.
+     * @param primaryAddress The primary's --replicate address.
+     * @param lastSequence The last sequence number already applied to the store.
+     * @param logOffset An offset in the log at or before the first record not yet applied.
+     */
+    LogFollower(DataStore& store, std::string primaryAddress, std::uint64_t lastSequence, std::uint64_t logOffset);
+
+    /**
+     * @brief Disconnects and stops the follower thread.
+     */
+    ~LogFollower();
+
+    LogFollower(const LogFollower&) = delete;
+    LogFollower& operator=(const LogFollower&) = delete;
+
+    /**
+     * @brief Retrieves the replication status.
+     * @return Status The status now.
+     */
+    Status getStatus() const;
+
+private:
+    DataStore& store;
+    std::string primaryAddress;
+    std::uint64_t logOffset;
+    SequenceSet applied;        ///< Records applied here; used by the follower thread only.
+
+    mutable std::mutex mutex;   ///< Guards the fields below.
+    std::condition_variable stopped;
+    bool stopping = false;
+    std::unique_ptr<SocketTarget> connection;
+    Status status;
+    std::chrono::steady_clock::time_point lastHeard;
+
+    std::thread thread;
+
+    void runLoop();
+    void follow();
+};
+
+#endif // LOGFOLLOWER_H
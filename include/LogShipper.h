@@ -0,0 +1,77 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef LOGSHIPPER_H
+#define LOGSHIPPER_H
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @class LogShipper
+ * @brief Streams the primary's transaction log to read-only follower processes (see LogFollower).
+ *
+ * A follower connects and sends "FOLLOW <lastSequence> <logOffset>": a sequence number up to which it has
+ * applied every record, and a position in the log (see TransactionLog) at or before the next one. The shipper
+ * answers "OK", then sends every complete record after that sequence number that it has not sent already, in
+ * the log's own format (lines ending with a blank line), followed by
+ * "#head <sequence> <milliseconds>": the newest sequence number in the log and the wall-clock time the
+ * records were noticed. The same line is repeated as a heartbeat while the log is idle, so the follower
+ * can tell how far behind it is and whether the link is alive.
+ *
+ * The shipper reads the log files rather than hooking the writers, so only records that were actually
+ * written are shipped, whatever path wrote them, and a follower far behind is caught up across segments.
+ * Records are tracked by sequence number, not by the highest one sent, so a record written to the log after
+ * one with a higher number is still shipped. Each follower has its own thread, woken by inotify when the log
+ * changes.
+ */
+class LogShipper {
+public:
+    /**
+     * @brief Counters for the lifetime of the shipper.
+     */
+    struct Stats {
+        std::uint64_t followersConnected = 0;   ///< Followers accepted so far.
+        std::uint64_t recordsShipped = 0;       ///< Records sent, summed over followers.
+    };
+
+    /**
+     * @brief Starts listening for followers.
+     * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+     * @param logFilename The transaction log to ship.
+     * @throws std::runtime_error If the address cannot be bound or inotify is not available.
+     */
+    LogShipper(const std::string& address, std::string logFilename = "transactions.txt");
+
+    /**
+     * @brief Disconnects every follower and stops the threads.
+     */
+    ~LogShipper();
+
+    LogShipper(const LogShipper&) = delete;
+    LogShipper& operator=(const LogShipper&) = delete;
+
+    /**
+     * @brief Retrieves the shipper counters.
+     * @return Stats The counters so far.
+     */
+    Stats getStats() const;
+
+private:
+    std::string logFilename;
+    std::string unixPath;
+    int listenFd = -1;
+    int stopFd = -1;                  ///< eventfd that wakes every thread to exit.
+    std::thread acceptThread;
+
+    mutable std::mutex mutex;         ///< Guards the fields below.
+    std::vector<std::thread> senders;
+    std::vector<int> followerFds;     ///< Shut down by the destructor to unblock a sender stuck in send().
+    Stats stats;
+
+    void acceptLoop();
+    void ship(int fd);
+};
+
+#endif // LOGSHIPPER_H
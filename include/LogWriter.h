@@ -0,0 +1,115 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Task.h"
+
+/**
+ * @class LogWriter
+ * @brief Appends transaction log records on a dedicated I/O thread, with group commit.
+ *
+ * Producers enqueue formatted records (cheap, never blocks on the file) and later co_await the ticket they
+ * got back. The I/O thread writes everything queued so far with one FileManager::appendToLog call, then
+ * resumes every coroutine whose record is now in the file on the Executor. Under load many checkouts share
+ * one file open and write, and no pipeline thread ever waits on the file itself.
+ *
+ * Records are written in the order they were enqueued, so enqueue them while still holding the store's
+ * WriteGuard to keep the log in sequence order. While a pipeline is running, the store sends every other log
+ * write through the same queue as well (see DataStore::WriteGuard::appendLog), blocking in waitFlushed().
+ */
+class LogWriter {
+public:
+    using Ticket = std::uint64_t;
+
+    /**
+     * @brief Counters for judging how well writes are being grouped.
+     */
+    struct Stats {
+        std::uint64_t batches = 0;   ///< File writes.
+        std::uint64_t records = 0;   ///< Records written.
+    };
+
+    /**
+     * @brief Starts the I/O thread.
+     * @param executor Where waiting coroutines are resumed once their records are written.
+     * @param filename The transaction log.
+     */
+    LogWriter(Executor& executor, std::string filename = "transactions.txt");
+
+    /**
+     * @brief Writes everything still queued, resumes the waiters and stops the I/O thread.
+     */
+    ~LogWriter();
+
+    LogWriter(const LogWriter&) = delete;
+    LogWriter& operator=(const LogWriter&) = delete;
+
+    /**
+     * @brief Queues records for the next write.
+     * @param records One or more formatted records.
+     * @param count How many records the string holds, for the statistics.
+     * @return Ticket The ticket to await with flushed().
+     */
+    Ticket enqueue(std::string records, std::uint64_t count = 1);
+
+    /**
+     * @brief Awaitable that completes once the records of a ticket are in the log file.
+     * @param ticket A ticket returned by enqueue().
+     */
+    auto flushed(Ticket ticket) {
+        struct Awaiter {
+            LogWriter& writer;
+            Ticket ticket;
+            bool await_ready() { return writer.isFlushed(ticket); }
+            bool await_suspend(std::coroutine_handle<> handle) { return writer.addWaiter(ticket, handle); }
+            void await_resume() noexcept {}
+        };
+        return Awaiter{*this, ticket};
+    }
+
+    /**
+     * @brief Blocks the calling thread until the records of a ticket are in the log file.
+     * @param ticket A ticket returned by enqueue().
+     */
+    void waitFlushed(Ticket ticket);
+
+    /**
+     * @brief Retrieves the write counters.
+     * @return Stats The counters so far.
+     */
+    Stats getStats() const;
+
+private:
+    struct Waiter {
+        Ticket ticket;
+        std::coroutine_handle<> handle;
+    };
+
+    Executor& executor;
+    std::string filename;
+
+    mutable std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable written;   ///< Signalled after every file write, for waitFlushed().
+    std::string pending;          ///< Records not yet handed to the I/O thread.
+    std::uint64_t pendingRecords = 0;
+    Ticket lastTicket = 0;        ///< Ticket of the newest enqueued records.
+    Ticket flushedThrough = 0;    ///< Every ticket up to this one is in the file.
+    std::vector<Waiter> waiters;
+    bool exiting = false;
+    Stats stats;
+    std::thread thread;
+
+    bool isFlushed(Ticket ticket) const;
+    bool addWaiter(Ticket ticket, std::coroutine_handle<> handle);
+    void runLoop();
+};
+
+#endif // LOGWRITER_H
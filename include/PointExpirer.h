@@ -0,0 +1,65 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef POINTEXPIRER_H
+#define POINTEXPIRER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "DataStore.h"
+
+/**
+ * @class PointExpirer
+ * @brief Background thread that expires reward points once their lots come due.
+ *
+ * Every interval the thread advances the store's expiry wheel to the current time (see
+ * DataStore::WriteGuard::expireDuePoints) and logs an "Expired Points" record for each customer who lost
+ * points, so replay and followers see the same balances. A follower never runs one: it applies the records
+ * its leader logged.
+ */
+class PointExpirer {
+public:
+    /**
+     * @brief Constructor for the PointExpirer class. The thread starts immediately.
+     * @param store The store whose points expire.
+     * @param interval Time between expiry passes. Zero disables the background thread.
+     */
+    PointExpirer(DataStore& store, std::chrono::milliseconds interval);
+
+    /**
+     * @brief Stops the background thread.
+     */
+    ~PointExpirer();
+
+    PointExpirer(const PointExpirer&) = delete;
+    PointExpirer& operator=(const PointExpirer&) = delete;
+
+    /**
+     * @brief Stops the background thread and waits for an expiry pass in progress to finish.
+     */
+    void stop();
+
+    /**
+     * @brief Expires every lot due by a time and logs the expiries, in one step under the store's write lock.
+     * @param store The store whose points expire.
+     * @param now The time, in seconds since the epoch.
+     * @return std::size_t The number of points expired.
+     * @throws std::runtime_error If the expiries cannot be logged.
+     */
+    static std::size_t expireDue(DataStore& store, std::int64_t now);
+
+private:
+    DataStore& store;
+    std::chrono::milliseconds interval;
+
+    std::mutex mutex;   ///< Guards stopping.
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+};
+
+#endif // POINTEXPIRER_H
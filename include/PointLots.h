@@ -0,0 +1,86 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef POINTLOTS_H
+#define POINTLOTS_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @class PointLots
+ * @brief One customer's expiring reward points, as dated lots: one per checkout, each expiring at its own time.
+ *
+ * The lots are kept in order of expiry, so spending takes the points closest to expiring first and expiry
+ * only ever removes lots from the front. Points a customer holds beyond the total of the lots (earned before
+ * points expired, or imported) never expire; they are spent only once the lots are used up.
+ */
+class PointLots {
+public:
+    /**
+     * @brief Points earned together that expire together.
+     */
+    struct Lot {
+        std::int64_t expiresAt;   ///< Seconds since the epoch.
+        int points;
+    };
+
+    static constexpr std::int64_t NEVER = 0;   ///< Expiry time of points that do not expire.
+
+    /**
+     * @brief Constructor for the PointLots class.
+     * @param customerID The unique identifier of the customer the lots belong to.
+     */
+    explicit PointLots(std::string customerID) : customerID(std::move(customerID)) {}
+
+    /**
+     * @brief Retrieves the unique identifier of the customer the lots belong to.
+     * @return const std::string& The Customer ID.
+     */
+    const std::string& getCustomerID() const { return customerID; }
+
+    /**
+     * @brief Retrieves the lots, earliest expiry first.
+     * @return const std::vector<Lot>& The lots.
+     */
+    const std::vector<Lot>& getLots() const { return lots; }
+
+    /**
+     * @brief Retrieves the points in all the lots.
+     * @return int The total.
+     */
+    int getTotal() const { return total; }
+
+    /**
+     * @brief Adds a lot, merging it with a lot that expires at the same time.
+     * @param expiresAt When the points expire, in seconds since the epoch.
+     * @param points The number of points; nothing is added unless positive.
+     */
+    void add(std::int64_t expiresAt, int points);
+
+    /**
+     * @brief Spends points from the lots closest to expiring.
+     * @param points The number of points spent.
+     * @return int The points taken from the lots; the rest of the amount comes out of points that never expire.
+     */
+    int spend(int points);
+
+    /**
+     * @brief Removes the lots that expire at or before a time.
+     * @param now The time, in seconds since the epoch.
+     * @return int The points in the removed lots.
+     */
+    int expire(std::int64_t now);
+
+    /**
+     * @brief Removes every lot, as when the customer is removed.
+     */
+    void clear();
+
+private:
+    std::string customerID;
+    std::vector<Lot> lots;   ///< Earliest expiry first.
+    int total = 0;
+};
+
+#endif // POINTLOTS_H
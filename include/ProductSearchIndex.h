@@ -0,0 +1,129 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef PRODUCTSEARCHINDEX_H
+#define PRODUCTSEARCHINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Product.h"
+
+/**
+ * @class ProductSearchIndex
+ * @brief Finds products by part of their name, ignoring case, for type-ahead search while shopping.
+ *
+ * Two structures are kept up to date as products are added and removed:
+ *  - a trie over the lowercased name starting at every word, so "pho" finds "Smart Phone". Each node counts
+ *    the keys below it, so a search skips branches whose products were all removed and stops as soon as it
+ *    has enough results, which come out in alphabetical order. Once removed keys have left more than half
+ *    the nodes counting zero, the trie is rebuilt from the products still indexed;
+ *  - an inverted index from every three-character sequence (trigram) of the lowercased name to the sorted
+ *    list of products containing it. A substring query intersects the lists of its trigrams, shortest first,
+ *    and checks the few survivors against the name. Queries of one or two characters match so many products
+ *    that scanning the names until enough are found is as fast.
+ *
+ * Products are numbered by slot; a removed product's slot is reused by the next one added.
+ */
+class ProductSearchIndex {
+public:
+    /**
+     * @brief Builds an index of the given products.
+     * @param products The products to index.
+     */
+    explicit ProductSearchIndex(const std::vector<Product>& products = {});
+
+    /**
+     * @brief Adds a product, or renames it if its Product ID is already indexed.
+     * @param productID The product's unique identifier.
+     * @param productName The product's name.
+     */
+    void add(const std::string& productID, const std::string& productName);
+
+    /**
+     * @brief Removes a product.
+     * @param productID The product's unique identifier.
+     * @return bool True if the product was indexed.
+     */
+    bool remove(const std::string& productID);
+
+    /**
+     * @brief Finds products with a word of their name starting with the query, in alphabetical order.
+     * @param query The start of a word, in any case.
+     * @param limit The most Product IDs to return.
+     * @return std::vector<std::string> The matching Product IDs.
+     */
+    std::vector<std::string> prefix(std::string_view query, std::size_t limit) const;
+
+    /**
+     * @brief Finds products whose name contains the query anywhere.
+     * @param query The text to look for, in any case.
+     * @param limit The most Product IDs to return.
+     * @return std::vector<std::string> The matching Product IDs.
+     */
+    std::vector<std::string> substring(std::string_view query, std::size_t limit) const;
+
+    /**
+     * @brief Finds products for a type-ahead box: prefix matches first, then other substring matches.
+     * @param query The text typed so far, in any case.
+     * @param limit The most Product IDs to return.
+     * @return std::vector<std::string> The matching Product IDs.
+     */
+    std::vector<std::string> search(std::string_view query, std::size_t limit) const;
+
+    /**
+     * @brief Retrieves the number of indexed products.
+     * @return std::size_t The number of products.
+     */
+    std::size_t size() const { return slotOf.size(); }
+
+    /**
+     * @brief Estimates the memory used by the index.
+     * @return std::size_t The approximate size in bytes.
+     */
+    std::size_t getSizeInBytes() const;
+
+private:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFF;
+    static constexpr std::uint32_t LIST = 0x80000000;   ///< Set in Node::terminals when it indexes terminalLists.
+
+    /**
+     * @brief A trie node. Children form a singly linked list sorted by character.
+     */
+    struct Node {
+        std::uint32_t child = NONE;       ///< First child.
+        std::uint32_t sibling = NONE;     ///< Next child of the same parent.
+        std::uint32_t count = 0;          ///< Keys ending at or below this node.
+        std::uint32_t terminals = NONE;   ///< The one slot whose key ends here, or LIST | index into terminalLists.
+        char c = 0;
+    };
+
+    struct Entry {
+        std::string productID;
+        std::string name;   ///< Lowercased.
+        bool live = false;
+    };
+
+    std::vector<Entry> entries;                                       ///< Indexed by slot.
+    std::vector<std::uint32_t> freeSlots;
+    std::unordered_map<std::string, std::uint32_t> slotOf;            ///< Product ID to slot.
+    std::vector<Node> nodes;                                          ///< nodes[0] is the root.
+    std::vector<std::vector<std::uint32_t>> terminalLists;
+    std::size_t deadNodes = 0;                                        ///< Nodes below the root counting zero.
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> postings;   ///< Trigram to sorted slots.
+
+    void insertKey(std::string_view key, std::uint32_t slot);
+    void eraseKey(std::string_view key, std::uint32_t slot);
+    void rebuildTrie();
+    void prefixSlots(const std::string& query, std::size_t limit, std::vector<std::uint32_t>& found) const;
+    void substringSlots(const std::string& query, std::size_t limit, std::vector<std::uint32_t>& found) const;
+    std::vector<std::string> productIDs(const std::vector<std::uint32_t>& slots) const;
+
+    template <typename Visit>
+    static void forEachWordStart(std::string_view name, Visit visit);
+    template <typename Visit>
+    static void forEachTrigram(std::string_view text, Visit visit);
+};
+
+#endif // PRODUCTSEARCHINDEX_H
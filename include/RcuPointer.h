@@ -0,0 +1,127 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef RCUPOINTER_H
+#define RCUPOINTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @class RcuPointer
+ * @brief A read-mostly pointer to an immutable T, replaced with read-copy-update.
+ *
+ * Readers never take a lock: they bump a reader count for the current grace period, load the pointer and
+ * use the object in place. A writer publishes a new object with one atomic exchange, then waits out a grace
+ * period (every reader that might still see the old object has finished) before releasing the old one.
+ *
+ * The grace period uses two reader counts and an epoch bit. The writer flips the epoch so new readers count
+ * themselves in the other slot, waits for the old slot to drain, and then does the same once more. The
+ * second flip catches readers that read the epoch just before the first flip but counted themselves late.
+ * Readers are never blocked, and a steady stream of them cannot starve the writer.
+ *
+ * Writers are serialized by a mutex and are expected to be rare (configuration reloads).
+ */
+template <typename T>
+class RcuPointer {
+public:
+    /**
+     * @class ReadGuard
+     * @brief Pins the object that was current when the guard was made. Keep it short-lived: a writer waits
+     *        for it before releasing a replaced object.
+     */
+    class ReadGuard {
+    public:
+        explicit ReadGuard(const RcuPointer& owner)
+            : owner(owner), slot(owner.epoch.load(std::memory_order_seq_cst) & 1) {
+            owner.readers[slot].fetch_add(1, std::memory_order_seq_cst);
+            object = owner.current.load(std::memory_order_seq_cst);
+        }
+
+        ~ReadGuard() { owner.readers[slot].fetch_sub(1, std::memory_order_release); }
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        const T& operator*() const { return **object; }
+        const T* operator->() const { return object->get(); }
+
+        /**
+         * @brief Shares ownership of the pinned object, so it can be used after the guard is gone.
+         * @return std::shared_ptr<const T> The pinned object.
+         */
+        std::shared_ptr<const T> share() const { return *object; }
+
+    private:
+        const RcuPointer& owner;
+        unsigned slot;
+        const std::shared_ptr<const T>* object;
+    };
+
+    /**
+     * @brief Publishes the first object.
+     * @param initial The object readers see until the first update.
+     */
+    explicit RcuPointer(std::shared_ptr<const T> initial)
+        : current(new std::shared_ptr<const T>(std::move(initial))) {}
+
+    /**
+     * @brief Releases the current object. No reader may still be active.
+     */
+    ~RcuPointer() { delete current.load(); }
+
+    RcuPointer(const RcuPointer&) = delete;
+    RcuPointer& operator=(const RcuPointer&) = delete;
+
+    /**
+     * @brief Pins the current object for reading.
+     * @return ReadGuard The guard; dereference it to use the object.
+     */
+    ReadGuard read() const { return ReadGuard(*this); }
+
+    /**
+     * @brief Shares ownership of the current object.
+     * @return std::shared_ptr<const T> The current object.
+     */
+    std::shared_ptr<const T> load() const { return read().share(); }
+
+    /**
+     * @brief Publishes a new object and returns once no reader can still see the old one.
+     * @param next The object to publish.
+     */
+    void store(std::shared_ptr<const T> next) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        publish(std::move(next));
+    }
+
+    /**
+     * @brief Publishes a changed copy of the current object, with no other writer in between.
+     * @param change Makes the new object from the current one.
+     */
+    void update(const std::function<T(const T&)>& change) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        publish(std::make_shared<const T>(change(**current.load())));
+    }
+
+private:
+    std::atomic<const std::shared_ptr<const T>*> current;
+    std::atomic<unsigned> epoch{0};
+    mutable std::atomic<std::uint64_t> readers[2] = {0, 0};
+    std::mutex writerMutex;
+
+    void publish(std::shared_ptr<const T> next) {
+        const std::shared_ptr<const T>* old =
+            current.exchange(new std::shared_ptr<const T>(std::move(next)), std::memory_order_seq_cst);
+        for (int flip = 0; flip < 2; ++flip) {
+            unsigned draining = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+            while (readers[draining].load(std::memory_order_seq_cst) != 0) {
+                std::this_thread::yield();
+            }
+        }
+        delete old;   // readers that still share() the object keep it alive through their own shared_ptr
+    }
+};
+
+#endif // RCUPOINTER_H
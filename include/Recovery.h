@@ -0,0 +1,150 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef RECOVERY_H
+#define RECOVERY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Customer.h"
+#include "CustomerTotals.h"
+#include "DataStore.h"
+#include "FileManager.h"
+#include "Gift.h"
+#include "LazyCustomerFile.h"
+#include "PointLots.h"
+#include "Product.h"
+
+/**
+ * @brief Summary of one transaction log replay.
+ */
+struct RecoveryReport {
+    std::uint64_t bytesScanned = 0;     ///< Bytes of the log read (the tail after the oldest checkpoint).
+    std::uint64_t recordsRead = 0;      ///< Records found in the scanned tail.
+    std::uint64_t recordsApplied = 0;   ///< Records applied to at least one list.
+    std::uint64_t recordsSkipped = 0;   ///< Malformed records or records referring to unknown IDs.
+    std::uint64_t lastSequence = 0;     ///< Highest sequence number seen in the checkpoints or the log.
+    double seconds = 0.0;               ///< Wall-clock duration of the replay.
+    unsigned threads = 1;               ///< Threads that read the log.
+};
+
+/**
+ * @class Recovery
+ * @brief Brings the lists loaded from the last checkpoint up to date by replaying the transaction log tail.
+ *
+ * Each data file records the log sequence number and offset it is consistent with (see Checkpoint). Replay
+ * starts reading at the smallest of those offsets, so startup cost depends on how much was logged since the
+ * last checkpoint, not on the total history, and applies each record only to the lists whose checkpoint
+ * predates it. Records written by older versions carry no sequence number; they are applied only to files
+ * that have no checkpoint header either.
+ *
+ * The customers' lifetime totals can also be rebuilt from the whole log (rebuildTotals), reading its
+ * segments in parallel, for when customer_totals.txt is missing or in doubt.
+ */
+class Recovery {
+public:
+    /**
+     * @brief Replays the transaction log tail onto freshly loaded lists.
+     * @param customers The customers loaded from the customer checkpoint.
+     * @param customerCheckpoint The checkpoint read from the customer file.
+     * @param products The products loaded from the product checkpoint.
+     * @param productCheckpoint The checkpoint read from the product file.
+     * @param gifts The gifts loaded from the gift checkpoint.
+     * @param giftCheckpoint The checkpoint read from the gift file.
+     * @param pointLots The customers' dated lots loaded from the lot checkpoint.
+     * @param lotCheckpoint The checkpoint read from the lot file.
+     * @param customerTotals The customers' lifetime totals loaded from the totals checkpoint.
+     * @param totalsCheckpoint The checkpoint read from the totals file.
+     * @param filename The transaction log. Defaults to "transactions.txt".
+     * @param baseCustomers In lazy mode, the file holding the customers not yet decoded; a record touching
+     *                      one of them decodes it into customers.
+     * @param removedBaseCustomerIDs In lazy mode, receives the base customers removed by the replayed records.
+     * @return RecoveryReport What was replayed, and the sequence number to continue from.
+     */
+    static RecoveryReport replay(std::vector<Customer>& customers, const Checkpoint& customerCheckpoint,
+                                 std::vector<Product>& products, const Checkpoint& productCheckpoint,
+                                 std::vector<Gift>& gifts, const Checkpoint& giftCheckpoint,
+                                 std::vector<PointLots>& pointLots, const Checkpoint& lotCheckpoint,
+                                 std::vector<CustomerTotals>& customerTotals, const Checkpoint& totalsCheckpoint,
+                                 const std::string& filename = "transactions.txt",
+                                 const LazyCustomerFile* baseCustomers = nullptr,
+                                 std::vector<std::string>* removedBaseCustomerIDs = nullptr);
+
+    /**
+     * @brief Rebuilds every customer's lifetime totals from the whole transaction log, one thread per segment.
+     * @param checkpoint Receives the log position the totals are consistent with.
+     * @param filename The transaction log. Defaults to "transactions.txt".
+     * @param report If not null, receives what was read, how long it took and on how many threads.
+     * @return std::vector<CustomerTotals> The totals of each customer with orders, in Customer ID order.
+     */
+    static std::vector<CustomerTotals> rebuildTotals(Checkpoint& checkpoint,
+                                                     const std::string& filename = "transactions.txt",
+                                                     RecoveryReport* report = nullptr);
+
+    /**
+     * @brief Applies one log record to a running store, as a follower does with the records its primary ships.
+     * @param state The write guard for the store.
+     * @param record The record's lines, without the blank line that ends it.
+     * @return bool True if the record was understood and applied.
+     */
+    static bool apply(DataStore::WriteGuard& state, const std::vector<std::string>& record);
+
+    /**
+     * @brief Reads a record's sequence number.
+     * @param record The record's lines.
+     * @return std::uint64_t The sequence number, or 0 for a record written before sequence numbers.
+     */
+    static std::uint64_t sequenceOf(const std::vector<std::string>& record);
+
+    /**
+     * @brief Formats a new customer as a "Registered Customer" change record.
+     * @param sequence The sequence number of the change.
+     * @param customer The registered customer.
+     * @return ChangeRecord The record to log.
+     */
+    static ChangeRecord customerRegistered(std::uint64_t sequence, const Customer& customer);
+
+    /**
+     * @brief Formats a "Removed Customer" change record.
+     * @param sequence The sequence number of the change.
+     * @param customerID The unique identifier of the removed customer.
+     * @return ChangeRecord The record to log.
+     */
+    static ChangeRecord customerRemoved(std::uint64_t sequence, const std::string& customerID);
+
+    /**
+     * @brief Formats an "Added Product" change record.
+     * @param sequence The sequence number of the change.
+     * @param product The added product.
+     * @return ChangeRecord The record to log.
+     */
+    static ChangeRecord productAdded(std::uint64_t sequence, const Product& product);
+
+    /**
+     * @brief Formats a "Removed Product" change record.
+     * @param sequence The sequence number of the change.
+     * @param productID The unique identifier of the removed product.
+     * @return ChangeRecord The record to log.
+     */
+    static ChangeRecord productRemoved(std::uint64_t sequence, const std::string& productID);
+
+    /**
+     * @brief Formats an "Added Gift" change record, or "Added Limited Gift" for a gift with limited stock.
+     * @param sequence The sequence number of the change.
+     * @param gift The added gift.
+     * @return ChangeRecord The record to log.
+     */
+    static ChangeRecord giftAdded(std::uint64_t sequence, const Gift& gift);
+
+    /**
+     * @brief Formats an "Expired Points" change record.
+     * @param sequence The sequence number of the change.
+     * @param customerID The unique identifier of the customer whose points expired.
+     * @param points The number of points expired.
+     * @param expiredAt The time the lots were expired up to, in seconds since the epoch.
+     * @return ChangeRecord The record to log.
+     */
+    static ChangeRecord pointsExpired(std::uint64_t sequence, const std::string& customerID, int points,
+                                      std::int64_t expiredAt);
+};
+
+#endif // RECOVERY_H
@@ -0,0 +1,51 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef RESHARDER_H
+#define RESHARDER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Summary of one offline rebalance.
+ */
+struct ReshardReport {
+    unsigned sourceShards = 0;                  ///< Shards read; 1 for an unsharded data directory.
+    std::vector<std::size_t> customersPerShard; ///< Customers written to each new shard.
+    std::vector<std::uint64_t> recordsPerShard; ///< Customer log records carried into each new shard.
+    std::uint64_t recordsDropped = 0;           ///< Catalog records left behind in the retired logs.
+    std::uint64_t lastSequence = 0;             ///< Sequence number the new shards continue after.
+    std::string retiredDirectory;               ///< Where the old files were moved.
+    double seconds = 0.0;                       ///< Wall-clock duration of the rebalance.
+};
+
+/**
+ * @class Resharder
+ * @brief Offline tool that splits a data directory, or an existing set of shards, into a new number of shards.
+ *
+ * Every source is loaded and brought up to date from its transaction log, exactly as a process starting on
+ * it would. Customers are then placed by ShardMap::shardOf. Each customer's log records (purchases,
+ * redemptions, registrations and removals) are copied into the new shard's transactions.txt, in their
+ * original order, so the history stays with the customer; catalog records are not carried over. The new data
+ * files are checkpointed at the end of the new logs, so the carried history is never replayed.
+ *
+ * The product catalog and the gifts are taken from the first source. Each product's stock is summed over
+ * every source and split evenly between the new shards, shard 0 taking the remainder.
+ *
+ * The shards must not be running. The new shards are written to shard-<k>.new and only renamed into place
+ * once complete; the old files are moved to retired-<time>, so an interrupted run loses nothing.
+ */
+class Resharder {
+public:
+    /**
+     * @brief Rebalances a root directory into a number of shards.
+     * @param root The root directory: either an unsharded data directory or one holding shards.txt.
+     * @param shardCount The number of shards to create.
+     * @return ReshardReport What was moved where.
+     * @throws std::runtime_error If a source cannot be loaded or the new files cannot be written.
+     */
+    static ReshardReport reshard(const std::string& root, unsigned shardCount);
+};
+
+#endif // RESHARDER_H
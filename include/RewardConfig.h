@@ -0,0 +1,163 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef REWARDCONFIG_H
+#define REWARDCONFIG_H
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Gift.h"
+#include "PointLots.h"
+#include "RewardRules.h"
+#include "VelocityLimiter.h"
+
+/**
+ * @class RewardConfig
+ * @brief Everything in reward_rules.txt: the accrual rules, configured gifts, checkout and velocity limits,
+ *        point expiry and loyalty tiers.
+ *
+ * Besides the RewardRules lines, the file may contain:
+ *
+ *     gift 500 Coffee Mug              a gift offered for redemption, after the gifts in gifts.txt
+ *     limit cart-lines 20              most lines one cart may have
+ *     limit line-quantity 50           most units of one product one cart line may buy
+ *     limit orders 5 per 10 minutes    most checkouts one customer may make in a sliding window
+ *     limit spend 2000 per 1 days      most dollars one customer may spend in a sliding window
+ *     limit redemptions 3 per 1 hours  most gifts one customer may redeem in a sliding window
+ *     expire 365 days                  points expire this long after the checkout that earned them
+ *                                      (days, hours, minutes or seconds); without it they never expire
+ *     loyalty-tier Gold 1000 25        customers who have spent $1000 or more in all earn 25% more points
+ *
+ * A RewardConfig is immutable once loaded. RewardService publishes it through an RcuPointer, so a reload
+ * swaps in a whole new object and checkouts and redemptions already running keep using the one they began with.
+ */
+class RewardConfig {
+public:
+    /**
+     * @brief A loyalty tier: customers whose lifetime spending reaches the threshold earn a bonus on every checkout.
+     */
+    struct LoyaltyTier {
+        std::string name;
+        std::int64_t minimumSpendCents;   ///< Lifetime spending that reaches the tier, in cents.
+        int bonusPercent;                 ///< Extra points, as a percentage of the points the rules award.
+    };
+
+    /**
+     * @brief A configuration with flat accrual and no gifts or limits.
+     * @param pointsPerDollar The number of reward points earned per dollar spent.
+     */
+    explicit RewardConfig(int pointsPerDollar = 10);
+
+    /**
+     * @brief A configuration with the given accrual rules and no gifts or limits.
+     * @param rules The compiled accrual rules.
+     */
+    explicit RewardConfig(RewardRules rules);
+
+    /**
+     * @brief Parses a configuration.
+     * @param in The configuration text.
+     * @param source Name used in error messages, usually the file name.
+     * @return RewardConfig The configuration.
+     * @throws std::runtime_error If a line is not valid.
+     */
+    static RewardConfig parse(std::istream& in, const std::string& source = "config");
+
+    /**
+     * @brief Loads a configuration file.
+     * @param filename The name of the file to load.
+     * @return RewardConfig The configuration.
+     * @throws std::runtime_error If the file cannot be opened or a line is not valid.
+     */
+    static RewardConfig load(const std::string& filename);
+
+    /**
+     * @brief Sets the points-per-dollar line of a configuration file, keeping every other line.
+     * @param filename The configuration file; created if it does not exist.
+     * @param points The number of reward points earned per dollar spent.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    static void savePointsPerDollar(const std::string& filename, int points);
+
+    /**
+     * @brief Retrieves the accrual rules.
+     * @return const RewardRules& The rules.
+     */
+    const RewardRules& getRules() const { return rules; }
+
+    /**
+     * @brief Makes a copy of this configuration with another base rate.
+     * @param points The number of reward points earned per dollar spent.
+     * @return RewardConfig The changed copy.
+     */
+    RewardConfig withPointsPerDollar(int points) const;
+
+    /**
+     * @brief Retrieves the gifts the configuration adds to the ones in the store.
+     * @return const std::vector<Gift>& The configured gifts.
+     */
+    const std::vector<Gift>& getGifts() const { return gifts; }
+
+    /**
+     * @brief Finds a gift by its number in the combined list: the store's gifts, then the configured ones.
+     * @param storeGifts The gifts in the data store.
+     * @param giftNumber Position in the combined list, starting at 1 as in the menu.
+     * @return const Gift* The gift, or nullptr if the number is out of range.
+     */
+    const Gift* giftAt(const std::vector<Gift>& storeGifts, int giftNumber) const;
+
+    /**
+     * @brief Checks a cart against the configured limits.
+     * @param cart Pairs of Product ID and quantity.
+     * @throws std::invalid_argument If the cart has too many lines or a line buys too many units.
+     */
+    void checkLimits(const std::vector<std::pair<std::string, int>>& cart) const;
+
+    /**
+     * @brief Retrieves the per-customer velocity limits checked on every checkout and redemption.
+     * @return const VelocityLimiter::Limits& The limits; none are set unless configured.
+     */
+    const VelocityLimiter::Limits& getVelocityLimits() const { return velocityLimits; }
+
+    /**
+     * @brief Works out when points earned at a given time expire.
+     * @param earnedAt When the points were earned, in seconds since the epoch.
+     * @return std::int64_t When they expire, or PointLots::NEVER if points do not expire.
+     */
+    std::int64_t expiryFor(std::int64_t earnedAt) const {
+        return pointLifetime > 0 ? earnedAt + pointLifetime : PointLots::NEVER;
+    }
+
+    /**
+     * @brief Retrieves the loyalty tiers.
+     * @return const std::vector<LoyaltyTier>& The tiers, lowest threshold first.
+     */
+    const std::vector<LoyaltyTier>& getLoyaltyTiers() const { return loyaltyTiers; }
+
+    /**
+     * @brief Finds the tier a lifetime spending reaches.
+     * @param spendCents Lifetime spending, in cents.
+     * @return const LoyaltyTier* The highest tier reached, or nullptr if none is.
+     */
+    const LoyaltyTier* loyaltyTierFor(std::int64_t spendCents) const;
+
+    /**
+     * @brief Adds the tier bonus to the points the rules awarded for a checkout.
+     * @param points The points the rules awarded.
+     * @param spendCents The customer's lifetime spending before the checkout, in cents.
+     * @return int The points with the bonus of the customer's tier, rounded down.
+     */
+    int withLoyaltyBonus(int points, std::int64_t spendCents) const;
+
+private:
+    RewardRules rules;
+    std::vector<Gift> gifts;
+    int maxCartLines = 0;      ///< 0 means no limit.
+    int maxLineQuantity = 0;   ///< 0 means no limit.
+    VelocityLimiter::Limits velocityLimits;
+    std::int64_t pointLifetime = 0;   ///< Seconds points last; 0 means they never expire.
+    std::vector<LoyaltyTier> loyaltyTiers;   ///< Lowest threshold first.
+};
+
+#endif // REWARDCONFIG_H
@@ -0,0 +1,117 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef REWARDRULES_H
+#define REWARDRULES_H
+
+#include <array>
+#include <functional>
+#include <istream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One cart line as the rule engine sees it.
+ */
+struct PricedLine {
+    std::string_view productID;   ///< The product bought; must outlive the call to points().
+    double price;                 ///< Unit price at checkout.
+    int quantity;                 ///< Units bought.
+};
+
+/**
+ * @class RewardRules
+ * @brief Compiled reward accrual rules: how many points a cart earns.
+ *
+ * Rules are read once from text, one per line ('#' starts a comment):
+ *
+ *     points-per-dollar 10                         base rate
+ *     category electronics Prod00001 Prod00002     names a group of products
+ *     multiplier product Prod00003 2               per-product multiplier
+ *     multiplier category electronics 1.5          per-category multiplier
+ *     tier 100 1.25                                carts spending at least $100 earn 1.25x
+ *     age 18 25 multiplier 1.1                     age-band multiplier (ages inclusive)
+ *     age 65 100 bonus 50                          age-band flat bonus per cart that spends anything
+ *     cap 5000                                     most points one cart can earn
+ *
+ * Compiling folds everything that does not depend on the cart: product and category multipliers become one
+ * sorted table of per-product weights, overlapping age bands become one table indexed by age, and tiers are
+ * sorted by threshold. Scoring a cart is then a lookup per line plus three table reads, with no parsing,
+ * allocation or locking.
+ *
+ * A cart earns int(sum(price * quantity * weight) * pointsPerDollar * tier * ageMultiplier) + ageBonus points,
+ * capped. With only a points-per-dollar rule this is int(totalCost * pointsPerDollar), as before.
+ */
+class RewardRules {
+public:
+    /**
+     * @brief Rules that award a flat number of points per dollar and nothing else.
+     * @param pointsPerDollar The number of reward points earned per dollar spent.
+     */
+    explicit RewardRules(int pointsPerDollar = 10);
+
+    /**
+     * @brief Parses and compiles rules.
+     * @param in The rule text.
+     * @param source Name used in error messages, usually the file name.
+     * @param otherRule Called with the keyword and the rest of the line for lines that are not accrual rules;
+     *                  returns false if it does not know the keyword either. Lets one file hold more settings.
+     * @return RewardRules The compiled rules.
+     * @throws std::runtime_error If a line is not a valid rule.
+     */
+    static RewardRules parse(std::istream& in, const std::string& source = "rules",
+                             const std::function<bool(const std::string&, std::istream&)>& otherRule = nullptr);
+
+    /**
+     * @brief Parses and compiles a rule file.
+     * @param filename The name of the file to load.
+     * @return RewardRules The compiled rules.
+     * @throws std::runtime_error If the file cannot be opened or a line is not a valid rule.
+     */
+    static RewardRules load(const std::string& filename);
+
+    /**
+     * @brief Scores a cart.
+     * @param lines The cart lines with their prices.
+     * @param age The age of the buying customer.
+     * @return int The points the cart earns.
+     */
+    int points(std::span<const PricedLine> lines, int age) const;
+
+    /**
+     * @brief Retrieves the base rate.
+     * @return int The number of reward points earned per dollar spent.
+     */
+    int getPointsPerDollar() const { return pointsPerDollar; }
+
+    /**
+     * @brief Makes a copy of these rules with another base rate.
+     * @param points The number of reward points earned per dollar spent.
+     * @return RewardRules The changed copy.
+     */
+    RewardRules withPointsPerDollar(int points) const;
+
+    /**
+     * @brief Retrieves the number of rules the text contained, for reporting.
+     * @return std::size_t The rule count.
+     */
+    std::size_t getRuleCount() const { return ruleCount; }
+
+private:
+    static constexpr int MAX_AGE = 127;   ///< Ages above this use the last age-table entry.
+
+    struct AgeEffect {
+        double multiplier = 1.0;
+        int bonus = 0;
+    };
+
+    int pointsPerDollar;
+    std::vector<std::pair<std::string, double>> weights;   ///< Sorted by Product ID; products not listed weigh 1.
+    std::vector<std::pair<double, double>> tiers;          ///< (minimum spend, multiplier), sorted by spend.
+    std::array<AgeEffect, MAX_AGE + 1> ageEffects;
+    int cap;                                               ///< Points limit per cart; INT_MAX if none.
+    std::size_t ruleCount = 0;
+};
+
+#endif // REWARDRULES_H
@@ -0,0 +1,140 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef REWARDSERVICE_H
+#define REWARDSERVICE_H
+
+#include <exception>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "CheckoutPipeline.h"
+#include "Customer.h"
+#include "DataStore.h"
+#include "RcuPointer.h"
+#include "RewardConfig.h"
+
+/**
+ * @class RewardService
+ * @brief Non-interactive operations on a DataStore: the same rules as the menu, without the prompts.
+ *
+ * Every method is safe to call from several threads at once. Writes take the store's WriteGuard and log
+ * their record before releasing it, exactly like the menu does; lookups take the shared ReadGuard, so they
+ * run in parallel with each other. Checkouts go through the service's CheckoutPipeline. The RewardConfig is
+ * published through an RcuPointer, so it can be reloaded while checkouts and redemptions run.
+ */
+class RewardService {
+public:
+    /**
+     * @brief Constructor for the RewardService class.
+     * @param store The store to operate on.
+     * @param config The accrual rules, gifts and limits.
+     */
+    RewardService(DataStore& store, RewardConfig config);
+
+    /**
+     * @brief Looks up a customer without modifying the store.
+     * @param customerID The unique identifier to look up.
+     * @return std::optional<Customer> The customer, or nothing if there is no such customer.
+     */
+    std::optional<Customer> lookup(const std::string& customerID) const;
+
+    /**
+     * @brief Registers a new customer under a freshly generated Customer ID.
+     * @return Customer The registered customer.
+     * @throws std::invalid_argument If any field fails the Customer validation rules.
+     */
+    Customer registerCustomer(const std::string& userName, const std::string& firstName, const std::string& lastName,
+                              int age, const std::string& creditCardNumber);
+
+    /**
+     * @brief Buys a cart for a customer: deducts stock, credits points and logs the transaction.
+     *        The cart is applied completely or not at all.
+     * @param customerID The unique identifier of the buying customer.
+     * @param cart Pairs of Product ID and quantity.
+     * @return Receipt The total cost and points earned.
+     * @throws std::invalid_argument If the cart is empty, the customer or a product is unknown, or a quantity
+     *         is not in stock.
+     */
+    Receipt checkout(const std::string& customerID, const Cart& cart);
+
+    /**
+     * @brief Starts a checkout and returns at once; the pipeline calls done when it completes.
+     * @param customerID The unique identifier of the buying customer.
+     * @param cart Pairs of Product ID and quantity.
+     * @param done Called on a pipeline thread with the receipt, or with the exception that rejected the cart.
+     */
+    void checkoutAsync(const std::string& customerID, const Cart& cart,
+                       std::function<void(std::optional<Receipt>, std::exception_ptr)> done);
+
+    /**
+     * @brief Checks out a batch of carts with one lock acquisition and one log write.
+     * @param orders The carts, applied in order. Each is applied completely or not at all, independently of
+     *               the others.
+     * @return std::vector<BatchOutcome> One outcome per order, in order.
+     */
+    std::vector<BatchOutcome> checkoutBatch(std::vector<CartOrder> orders);
+
+    /**
+     * @brief Redeems a gift for a customer and logs the redemption. The points and a unit of a limited
+     *        gift's stock are deducted together (see DataStore::WriteGuard::redeemGift); a sold-out gift is
+     *        refused under the shared lock, without waiting for the exclusive one.
+     * @param customerID The unique identifier of the redeeming customer.
+     * @param giftNumber Position of the gift in the store's gifts followed by the configured ones, starting at 1.
+     * @return int The customer's remaining reward points.
+     * @throws std::invalid_argument If the customer or gift is unknown, the gift is out of stock, or the
+     *         customer lacks the points.
+     */
+    int redeem(const std::string& customerID, int giftNumber);
+
+    /**
+     * @brief Lists the products with the least stock, under the store's shared lock.
+     * @param count The most products to list.
+     * @return std::vector<StockMonitor::Level> The products, lowest first.
+     */
+    std::vector<StockMonitor::Level> lowestStock(std::size_t count) const;
+
+    /**
+     * @brief Removes and returns the low-stock alerts raised since the last call.
+     * @return std::vector<StockMonitor::Alert> The alerts, oldest first.
+     */
+    std::vector<StockMonitor::Alert> takeStockAlerts();
+
+    /**
+     * @brief Retrieves the number of reward points earned per dollar spent.
+     * @return int The points per dollar.
+     */
+    int getPointsPerDollar() const { return config.read()->getRules().getPointsPerDollar(); }
+
+    /**
+     * @brief Sets the number of reward points earned per dollar spent by later checkouts, keeping the other settings.
+     * @param points The points per dollar.
+     */
+    void setPointsPerDollar(int points);
+
+    /**
+     * @brief Retrieves the configuration later checkouts and redemptions use. Never blocks.
+     * @return std::shared_ptr<const RewardConfig> The current configuration; it stays valid while held.
+     */
+    std::shared_ptr<const RewardConfig> getConfig() const { return config.load(); }
+
+    /**
+     * @brief Replaces the configuration for later checkouts and redemptions.
+     * @param newConfig The configuration to publish.
+     */
+    void setConfig(RewardConfig newConfig);
+
+    /**
+     * @brief Retrieves the checkout pipeline, for its statistics.
+     * @return const CheckoutPipeline& The pipeline.
+     */
+    const CheckoutPipeline& getPipeline() const { return pipeline; }
+
+private:
+    DataStore& store;
+    RcuPointer<RewardConfig> config;   ///< Replaced whole, never modified, so readers need no lock.
+    CheckoutPipeline pipeline;
+};
+
+#endif // REWARDSERVICE_H
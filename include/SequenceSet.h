@@ -0,0 +1,54 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef SEQUENCESET_H
+#define SEQUENCESET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+
+/**
+ * @class SequenceSet
+ * @brief The transaction log sequence numbers seen so far, kept as a contiguous low-water mark plus the
+ *        numbers seen above it.
+ *
+ * Records do not have to arrive in sequence order: a number below the highest one seen is still new until it
+ * has been seen itself. Numbers join the low-water mark as soon as every number below them has been seen, so
+ * only the numbers past a gap are stored. A gap that stays open while more than MAX_PENDING numbers pile up
+ * above it is taken to be a number that was never logged, and is closed.
+ */
+class SequenceSet {
+public:
+    static constexpr std::size_t MAX_PENDING = 65536;   ///< Most numbers kept above the low-water mark.
+
+    /**
+     * @brief Constructor for the SequenceSet class.
+     * @param through Every sequence number up to this one counts as already seen.
+     */
+    explicit SequenceSet(std::uint64_t through = 0) : low(through) {}
+
+    /**
+     * @brief Adds a sequence number.
+     * @param sequence The sequence number.
+     * @return bool True if the number had not been seen before.
+     */
+    bool insert(std::uint64_t sequence);
+
+    /**
+     * @brief Tells whether a sequence number has been seen.
+     * @param sequence The sequence number.
+     * @return bool True if it has.
+     */
+    bool contains(std::uint64_t sequence) const { return sequence <= low || above.count(sequence) != 0; }
+
+    /**
+     * @brief Retrieves the low-water mark.
+     * @return std::uint64_t The highest sequence number such that it and every number below it have been seen.
+     */
+    std::uint64_t through() const { return low; }
+
+private:
+    std::uint64_t low;
+    std::set<std::uint64_t> above;   ///< Numbers seen past the first gap.
+};
+
+#endif // SEQUENCESET_H
@@ -0,0 +1,98 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef SHARDMAP_H
+#define SHARDMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class ShardMap
+ * @brief Assigns customers to shards by a hash of their Customer ID, and reads and writes the shard layout.
+ *
+ * A sharded deployment keeps its data under one root directory:
+ *
+ *     <root>/shards.txt          "shards <count>", then optional "address <shard> unix:<path>|tcp:<port>" lines
+ *     <root>/shard-<k>/          a complete data directory (customers.txt, products.txt, gifts.txt,
+ *                                transactions.txt) for the customers whose ID hashes to k, plus
+ *     <root>/shard-<k>/shard.txt "shard <k> of <count>"
+ *
+ * Each shard directory is loaded by its own process, started with --data-dir. The product catalog and the
+ * gifts are copied into every shard, and each shard sells from its own share of the stock.
+ *
+ * The hash is 64-bit FNV-1a, which does not depend on the standard library, so every process and every
+ * machine places a customer in the same shard.
+ */
+class ShardMap {
+public:
+    /**
+     * @brief A shard map for one process.
+     * @param shardCount The number of shards; 1 means the data is not sharded.
+     * @param shardIndex The shard this process serves.
+     */
+    explicit ShardMap(unsigned shardCount = 1, unsigned shardIndex = 0);
+
+    /**
+     * @brief Finds the shard that holds a customer.
+     * @param customerID The unique identifier of the customer.
+     * @param shardCount The number of shards.
+     * @return unsigned The shard, from 0 to shardCount - 1.
+     */
+    static unsigned shardOf(const std::string& customerID, unsigned shardCount);
+
+    /**
+     * @brief Checks whether a customer belongs to this process's shard.
+     * @param customerID The unique identifier of the customer.
+     * @return bool True if the customer belongs here.
+     */
+    bool owns(const std::string& customerID) const { return shardOf(customerID, shardCount) == shardIndex; }
+
+    /**
+     * @brief Reads the shard identity of a data directory from its shard.txt.
+     * @param directory The data directory.
+     * @return ShardMap The identity, or a single unsharded shard if the directory has no shard.txt.
+     * @throws std::runtime_error If shard.txt is malformed.
+     */
+    static ShardMap loadIdentity(const std::string& directory);
+
+    /**
+     * @brief Writes the shard identity of a data directory.
+     * @param directory The data directory.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void saveIdentity(const std::string& directory) const;
+
+    /**
+     * @brief Reads the layout of a sharded root directory.
+     * @param root The root directory.
+     * @param addresses Receives the server address of each shard; empty where none is configured.
+     * @return unsigned The number of shards, or 0 if the root has no shards.txt.
+     * @throws std::runtime_error If shards.txt is malformed.
+     */
+    static unsigned loadLayout(const std::string& root, std::vector<std::string>& addresses);
+
+    /**
+     * @brief Writes the layout of a sharded root directory, replacing shards.txt atomically.
+     * @param root The root directory.
+     * @param addresses The server address of each shard; the size is the shard count.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    static void saveLayout(const std::string& root, const std::vector<std::string>& addresses);
+
+    /**
+     * @brief Builds the path of a shard's data directory.
+     * @param root The root directory.
+     * @param shard The shard.
+     * @return std::string The directory path.
+     */
+    static std::string directory(const std::string& root, unsigned shard);
+
+    unsigned getShardCount() const { return shardCount; }
+    unsigned getShardIndex() const { return shardIndex; }
+
+private:
+    unsigned shardCount;
+    unsigned shardIndex;
+};
+
+#endif // SHARDMAP_H
@@ -0,0 +1,71 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef SHARDROUTER_H
+#define SHARDROUTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "LoadGenerator.h"
+
+/**
+ * @class ShardRouter
+ * @brief Forwards SocketServer protocol requests to the shard process that owns the customer.
+ *
+ * The router reads the shard addresses from a root directory's shards.txt (see ShardMap) and keeps a pool
+ * of idle connections to each shard, so a request costs one round trip and no connection setup once the
+ * pool is warm. LOOKUP, CHECKOUT and REDEEM go to the shard of the Customer ID they name. REGISTER goes to
+ * the shards in turn; the shard picks a Customer ID it owns. PING is answered by the router itself, and
+ * LOWSTOCK and ALERTS are refused, since every shard keeps its own stock.
+ *
+ * A connection that fails is dropped and the request is answered with ERR rather than retried, because a
+ * CHECKOUT or REDEEM may already have been applied.
+ */
+class ShardRouter {
+public:
+    /**
+     * @brief Reads the shard layout.
+     * @param root The root directory of the sharded data.
+     * @throws std::runtime_error If shards.txt is missing or malformed, or a shard has no address.
+     */
+    explicit ShardRouter(const std::string& root);
+
+    ShardRouter(const ShardRouter&) = delete;
+    ShardRouter& operator=(const ShardRouter&) = delete;
+
+    /**
+     * @brief Forwards one request and returns the shard's response. Safe to call from many threads.
+     * @param request The request line, without its newline.
+     * @return std::string The response line, without its newline.
+     */
+    std::string route(const std::string& request);
+
+    /**
+     * @brief Retrieves how many requests each shard has been sent.
+     * @return std::vector<std::uint64_t> The counts, by shard.
+     */
+    std::vector<std::uint64_t> getRequestCounts() const;
+
+    /**
+     * @brief Retrieves the number of shards.
+     * @return unsigned The shard count.
+     */
+    unsigned getShardCount() const { return static_cast<unsigned>(shards.size()); }
+
+private:
+    struct Shard {
+        std::string address;
+        std::mutex mutex;
+        std::vector<std::unique_ptr<SocketTarget>> idle;   ///< Connections not in use by a request.
+        std::atomic<std::uint64_t> requests{0};
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<unsigned> nextRegistration{0};
+
+    std::string forward(unsigned shard, const std::string& request);
+};
+
+#endif // SHARDROUTER_H
@@ -0,0 +1,84 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef SNAPSHOTTER_H
+#define SNAPSHOTTER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include "DataStore.h"
+
+/**
+ * @class Snapshotter
+ * @brief Background thread that periodically persists a DataStore snapshot.
+ *
+ * Every interval the thread takes an O(1) copy-on-write snapshot of the store (retrying shortly if a menu
+ * operation is in progress) and, if anything changed since the last write, saves it with
+ * Snapshotter::writeSnapshot. Foreground operations only ever pay for copying a list they modify while
+ * a write is in flight; DataStore::getStats() reports that cost.
+ */
+class Snapshotter {
+public:
+    /**
+     * @brief Counters describing the background writes.
+     */
+    struct Stats {
+        std::uint64_t snapshotsWritten = 0;   ///< Snapshots saved to disk.
+        std::uint64_t unchangedSkips = 0;     ///< Intervals skipped because nothing changed.
+        std::uint64_t busyRetries = 0;        ///< Snapshot attempts deferred because a writer held the store.
+        std::uint64_t failures = 0;           ///< Writes that failed (the previous files stay in place).
+        double lastWriteSeconds = 0.0;        ///< Duration of the most recent write.
+    };
+
+    /**
+     * @brief Constructor for the Snapshotter class. The thread starts immediately.
+     * @param store The store to persist.
+     * @param interval Time between snapshots. Zero disables the background thread.
+     */
+    Snapshotter(DataStore& store, std::chrono::milliseconds interval);
+
+    /**
+     * @brief Stops the background thread. Does not write a final snapshot.
+     */
+    ~Snapshotter();
+
+    Snapshotter(const Snapshotter&) = delete;
+    Snapshotter& operator=(const Snapshotter&) = delete;
+
+    /**
+     * @brief Stops the background thread and waits for a write in progress to finish.
+     */
+    void stop();
+
+    /**
+     * @brief Retrieves the background write counters.
+     * @return Stats The counters accumulated since the thread started.
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Writes customers.txt, products.txt, gifts.txt, point_lots.txt and customer_totals.txt from a
+     *        snapshot. Each file is written to a temporary file and renamed over the old one, so a crash never
+     *        leaves a partial file behind. Then archives the log segments the files no longer need (see
+     *        TransactionLog::archive).
+     * @param snapshot The snapshot to write.
+     * @throws std::runtime_error If a file cannot be written or renamed.
+     */
+    static void writeSnapshot(const DataStore::Snapshot& snapshot);
+
+private:
+    DataStore& store;
+    std::chrono::milliseconds interval;
+    std::uint64_t lastWrittenVersion;
+
+    mutable std::mutex mutex;              ///< Guards stopping and stats.
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    Stats stats;
+    std::thread worker;
+
+    void run();
+};
+
+#endif // SNAPSHOTTER_H
@@ -0,0 +1,166 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef SOCKETSERVER_H
+#define SOCKETSERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "RewardService.h"
+
+/**
+ * @class SocketServer
+ * @brief Serves RewardService requests over a Unix-domain or loopback TCP socket.
+ *
+ * One thread runs an epoll event loop that accepts connections and does all socket reads and writes with
+ * non-blocking I/O. Complete request lines are handed to a pool of worker threads, and the responses come
+ * back through an eventfd that wakes the loop. CHECKOUT requests are passed on to the service's coroutine
+ * CheckoutPipeline, so a worker never sits waiting for a log write. Each connection has at most one request
+ * in flight, so a client that pipelines several requests still gets its responses in order. The loop stops
+ * reading a connection while its request runs or its responses wait to be written, so a client that pipelines
+ * without reading is held back by the socket's own buffers rather than by the server's memory.
+ *
+ * The protocol is one line per request and one line per response:
+ *
+ *     PING                                             -> OK
+ *     LOOKUP <customerID>                              -> OK <id> <user> <first> <last> <age> <card> <points>
+ *     REGISTER <user> <first> <last> <age> <card>      -> OK <customerID>
+ *     CHECKOUT <customerID> <productID>:<qty> ...      -> OK <totalCost> <pointsEarned>
+ *     REDEEM <customerID> <giftNumber>                 -> OK <remainingPoints>
+ *     LOWSTOCK <count>                                 -> OK <productID>:<inventory> ... (lowest first)
+ *     ALERTS                                           -> OK <productID>:<inventory> ... (fell to the threshold)
+ *
+ * Any failure is answered with "ERR <message>".
+ *
+ * A server can also be given a plain request handler instead of a service, as the shard router does; every
+ * request, CHECKOUT included, then runs on a worker.
+ */
+class SocketServer {
+public:
+    /**
+     * @brief Counters for the lifetime of the server.
+     */
+    struct Stats {
+        std::uint64_t connectionsAccepted = 0;
+        std::uint64_t requestsServed = 0;
+        std::uint64_t errorResponses = 0;   ///< Requests answered with ERR.
+    };
+
+    /**
+     * @brief Binds and listens on an address.
+     * @param service The service that executes requests.
+     * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+     * @param workerCount Number of worker threads; 0 means one per hardware thread.
+     * @throws std::runtime_error If the address is malformed or cannot be bound.
+     */
+    SocketServer(RewardService& service, const std::string& address, unsigned workerCount = 0);
+
+    /**
+     * @brief Binds and listens on an address, answering every request with a handler.
+     * @param handler Turns a request line into a response line; called on worker threads.
+     * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+     * @param workerCount Number of worker threads; 0 means one per hardware thread.
+     * @throws std::runtime_error If the address is malformed or cannot be bound.
+     */
+    SocketServer(std::function<std::string(const std::string&)> handler, const std::string& address,
+                 unsigned workerCount = 0);
+
+    /**
+     * @brief Stops the workers and closes every socket. A Unix socket file is removed.
+     */
+    ~SocketServer();
+
+    SocketServer(const SocketServer&) = delete;
+    SocketServer& operator=(const SocketServer&) = delete;
+
+    /**
+     * @brief Runs the event loop on the calling thread until stop() is called.
+     */
+    void run();
+
+    /**
+     * @brief Asks run() to return. Safe to call from any thread and from a signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Retrieves the server counters.
+     * @return Stats The counters so far.
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Executes one request line against a service.
+     * @param service The service to call.
+     * @param request The request line, without its newline.
+     * @return std::string The response line, without its newline.
+     */
+    static std::string respond(RewardService& service, const std::string& request);
+
+    /**
+     * @brief Binds a non-blocking listening socket.
+     * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+     * @param unixPath Receives the socket file's path for a Unix address, to remove once done.
+     * @return int The listening descriptor.
+     * @throws std::runtime_error If the address is malformed or cannot be bound.
+     */
+    static int listenOn(const std::string& address, std::string& unixPath);
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string input;    ///< Bytes received but not yet handed to a worker.
+        std::string output;   ///< Response bytes not yet written.
+        bool busy = false;    ///< A worker is executing one of this connection's requests.
+        bool readClosed = false;    ///< The client shut down its side; answer what it sent, then close.
+        std::uint32_t events = 0;   ///< The epoll events currently watched.
+    };
+
+    struct Job {
+        std::uint64_t connectionID;
+        std::string text;     ///< Request line on the way in, response line on the way out.
+    };
+
+    RewardService* service = nullptr;   ///< Set when checkouts can go through the service's pipeline.
+    std::function<std::string(const std::string&)> handler;
+    std::string unixPath;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;          ///< eventfd: a worker finished a job, or stop() was called.
+    std::atomic<bool> stopping{false};
+
+    std::unordered_map<std::uint64_t, Connection> connections;   ///< Owned by the event loop thread.
+    std::uint64_t nextConnectionID = 1;
+
+    std::mutex jobMutex;
+    std::condition_variable jobReady;
+    std::deque<Job> pending;    ///< Requests waiting for a worker.
+    std::deque<Job> finished;   ///< Responses waiting for the event loop.
+    bool workersExit = false;
+    std::uint64_t checkoutsInFlight = 0;   ///< Checkouts handed to the pipeline and not yet answered.
+    std::condition_variable checkoutsDrained;
+    std::vector<std::thread> workers;
+
+    mutable std::mutex statsMutex;
+    Stats stats;
+
+    void acceptConnections();
+    void readConnection(std::uint64_t connectionID);
+    void dispatch(std::uint64_t connectionID);
+    void deliverResponses();
+    bool flush(std::uint64_t connectionID);
+    void updateWatch(std::uint64_t connectionID);
+    void closeIfDone(std::uint64_t connectionID);
+    void closeConnection(std::uint64_t connectionID);
+    void workerLoop();
+    void startCheckout(Job job);
+    void complete(Job job);
+};
+
+#endif // SOCKETSERVER_H
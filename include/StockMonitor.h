@@ -0,0 +1,115 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef STOCKMONITOR_H
+#define STOCKMONITOR_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "Product.h"
+
+/**
+ * @class StockMonitor
+ * @brief Tracks product inventory levels so the lowest ones and products running low are known at once.
+ *
+ * The products sit in a binary min-heap ordered by inventory (then Product ID), with a map from Product ID
+ * to heap position so a single product's level can be changed in O(log n) by sifting it up or down. The
+ * lowest product is the root; the lowest N are read off the heap in O(N log N) without looking at the rest
+ * of the catalog.
+ *
+ * An update that takes a product from above the threshold to at or below it queues an Alert, once per
+ * crossing; restocking above the threshold re-arms it.
+ */
+class StockMonitor {
+public:
+    /**
+     * @brief One product's stock level.
+     */
+    struct Level {
+        std::string productID;
+        std::string productName;
+        int inventory = 0;
+    };
+
+    /**
+     * @brief A product whose stock fell to the threshold or below.
+     */
+    struct Alert {
+        std::string productID;
+        std::string productName;
+        int inventory = 0;   ///< The level right after the crossing.
+    };
+
+    /**
+     * @brief Builds the heap for the given products in O(n).
+     * @param products The products to monitor.
+     * @param threshold Products with this many units or fewer count as low.
+     */
+    explicit StockMonitor(const std::vector<Product>& products = {}, int threshold = 5);
+
+    /**
+     * @brief Starts monitoring a product, replacing any earlier entry with the same Product ID.
+     * @param productID The product's unique identifier.
+     * @param productName The product's name, for reports.
+     * @param inventory The product's inventory level.
+     */
+    void add(const std::string& productID, const std::string& productName, int inventory);
+
+    /**
+     * @brief Stops monitoring a product.
+     * @param productID The product's unique identifier.
+     * @return bool True if the product was monitored.
+     */
+    bool remove(const std::string& productID);
+
+    /**
+     * @brief Records a product's new inventory level.
+     * @param productID The product's unique identifier.
+     * @param inventory The new level.
+     */
+    void update(const std::string& productID, int inventory);
+
+    /**
+     * @brief Lists the products with the least stock.
+     * @param count The most products to list.
+     * @return std::vector<Level> The products, lowest first.
+     */
+    std::vector<Level> lowest(std::size_t count) const;
+
+    /**
+     * @brief Removes and returns the alerts queued since the last call.
+     * @return std::vector<Alert> The alerts, oldest first.
+     */
+    std::vector<Alert> takeAlerts();
+
+    /**
+     * @brief Retrieves the low-stock threshold.
+     * @return int Products with this many units or fewer count as low.
+     */
+    int getThreshold() const { return threshold; }
+
+    /**
+     * @brief Changes the low-stock threshold. Products already at or below it do not raise alerts.
+     * @param level Products with this many units or fewer count as low.
+     */
+    void setThreshold(int level) { threshold = level; }
+
+    /**
+     * @brief Retrieves the number of monitored products.
+     * @return std::size_t The number of products.
+     */
+    std::size_t size() const { return heap.size(); }
+
+private:
+    std::vector<Level> heap;
+    std::unordered_map<std::string, std::size_t> positions;   ///< Product ID to index in heap.
+    std::vector<Alert> alerts;
+    int threshold;
+
+    bool less(std::size_t a, std::size_t b) const;
+    void swapEntries(std::size_t a, std::size_t b);
+    void siftUp(std::size_t index);
+    void siftDown(std::size_t index);
+};
+
+#endif // STOCKMONITOR_H
@@ -0,0 +1,252 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef TASK_H
+#define TASK_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @class Task
+ * @brief A lazily started coroutine that produces a T (or throws) for the coroutine awaiting it.
+ *
+ * Nothing runs until the Task is co_awaited. When the coroutine finishes it resumes its awaiter directly
+ * (symmetric transfer), so a chain of stages costs no thread hops unless a stage suspends on purpose.
+ * Use startTask() to run a Task from ordinary code.
+ */
+template <typename T>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation = std::noop_coroutine();
+    std::exception_ptr error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            return handle.promise().continuation;
+        }
+        void await_resume() noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() { error = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object();
+    void return_value(T result) { value = std::move(result); }
+    T take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        else {
+            return std::move(*value);
+        }
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object();
+    void return_void() {}
+    void take() {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+        else {
+            // do nothing
+        }
+    }
+};
+
+} // namespace detail
+
+template <typename T>
+class Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task() {
+        if (handle) {
+            handle.destroy();
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    /**
+     * @brief Starts the coroutine and suspends the awaiter until it finishes.
+     */
+    auto operator co_await() && noexcept {
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().take(); }
+        };
+        return Awaiter{handle};
+    }
+
+private:
+    std::coroutine_handle<promise_type> handle;
+};
+
+namespace detail {
+
+template <typename T>
+Task<T> TaskPromise<T>::get_return_object() {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> TaskPromise<void>::get_return_object() {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+/**
+ * @brief Fire-and-forget coroutine used by startTask; its frame frees itself when it finishes.
+ */
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
+
+template <typename T>
+DetachedTask runDetached(Task<T> task, std::function<void(std::optional<T>, std::exception_ptr)> done) {
+    std::optional<T> result;
+    std::exception_ptr error;
+    try {
+        result = co_await std::move(task);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    done(std::move(result), error);
+}
+
+} // namespace detail
+
+/**
+ * @brief Runs a Task without awaiting it. The callback receives the result or the exception.
+ * @param task The task to run, producing a non-void T. It runs on the calling thread until its first suspension.
+ * @param done Called once with either a value or an exception, on whichever thread finishes the task.
+ */
+template <typename T>
+void startTask(Task<T> task, std::function<void(std::optional<T>, std::exception_ptr)> done) {
+    detail::runDetached(std::move(task), std::move(done));
+}
+
+/**
+ * @class Executor
+ * @brief A small thread pool that resumes coroutines: `co_await executor.schedule()` moves the rest of
+ *        the coroutine onto one of its threads.
+ */
+class Executor {
+public:
+    /**
+     * @brief Starts the pool.
+     * @param threadCount Number of threads, at least one.
+     */
+    explicit Executor(unsigned threadCount) {
+        for (unsigned i = 0; i < std::max(1u, threadCount); ++i) {
+            threads.emplace_back([this] { runLoop(); });
+        }
+    }
+
+    /**
+     * @brief Finishes the queued work and joins the threads.
+     */
+    ~Executor() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            exiting = true;
+        }
+        ready.notify_all();
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * @brief Queues a suspended coroutine to be resumed on a pool thread.
+     * @param handle The coroutine to resume.
+     */
+    void post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(handle);
+        }
+        ready.notify_one();
+    }
+
+    /**
+     * @brief Awaitable that continues the awaiting coroutine on a pool thread.
+     */
+    auto schedule() {
+        struct Awaiter {
+            Executor& executor;
+            bool await_ready() noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<std::coroutine_handle<>> queue;
+    bool exiting = false;
+    std::vector<std::thread> threads;
+
+    void runLoop() {
+        while (true) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                ready.wait(lock, [this] { return exiting || !queue.empty(); });
+                if (queue.empty()) {
+                    return;   // exiting, and nothing left to resume
+                }
+                else {
+                    handle = queue.front();
+                    queue.pop_front();
+                }
+            }
+            handle.resume();
+        }
+    }
+};
+
+#endif // TASK_H
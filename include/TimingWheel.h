@@ -0,0 +1,77 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef TIMINGWHEEL_H
+#define TIMINGWHEEL_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class TimingWheel
+ * @brief A hierarchical timing wheel: items scheduled for a time in whole seconds are handed back once the
+ *        clock passes it, at O(1) cost per item however many are waiting.
+ *
+ * There are six levels of 64 slots. Level 0 has a slot per second and holds the items due in the next 64
+ * seconds; each slot of level L spans a whole turn of level L-1, so the wheel reaches 64^6 seconds (over two
+ * thousand years) ahead. An item goes into the lowest level that reaches its due time. Whenever the clock
+ * enters a new slot of a higher level, that slot's items are placed again, one or more levels down, so an
+ * item is moved at most five times before it fires.
+ *
+ * Advancing over a quiet stretch jumps straight to the next slot boundary of the lowest level holding
+ * anything, so a clock that is advanced rarely, or by days at a time, costs no more than one advanced often.
+ */
+class TimingWheel {
+public:
+    /**
+     * @brief Constructor for the TimingWheel class.
+     * @param now The current time, in seconds.
+     */
+    explicit TimingWheel(std::int64_t now = 0);
+
+    /**
+     * @brief Schedules an item.
+     * @param item What to hand back, e.g. a position in a list.
+     * @param due When to hand it back, in seconds. A time not after now() fires on the next advance.
+     */
+    void schedule(std::uint32_t item, std::int64_t due);
+
+    /**
+     * @brief Moves the clock forward, collecting every item that came due.
+     * @param now The new time, in seconds; earlier than now() does nothing.
+     * @param fired Receives the items that came due, earliest first. An item scheduled twice fires twice.
+     */
+    void advance(std::int64_t now, std::vector<std::uint32_t>& fired);
+
+    /**
+     * @brief Retrieves the time the wheel has been advanced to.
+     * @return std::int64_t The time, in seconds.
+     */
+    std::int64_t now() const { return current; }
+
+    /**
+     * @brief Retrieves the number of items waiting.
+     * @return std::size_t The number of scheduled items that have not fired.
+     */
+    std::size_t size() const { return count; }
+
+private:
+    static constexpr int LEVELS = 6;
+    static constexpr int SLOT_BITS = 6;
+    static constexpr std::int64_t SLOTS = std::int64_t{1} << SLOT_BITS;
+
+    struct Entry {
+        std::int64_t due;
+        std::uint32_t item;
+    };
+
+    std::array<std::array<std::vector<Entry>, SLOTS>, LEVELS> slots;
+    std::array<std::size_t, LEVELS> levelSizes{};   ///< Entries in each level, to skip empty levels.
+    std::int64_t current;                            ///< Every entry due at or before this has fired.
+    std::size_t count = 0;
+
+    void place(const Entry& entry);
+    void tick(std::vector<std::uint32_t>& fired);
+};
+
+#endif // TIMINGWHEEL_H
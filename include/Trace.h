@@ -0,0 +1,88 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Scoped trace spans written out as a Chrome trace-event JSON file (open it in chrome://tracing or Perfetto).
+ *
+ * Tracing is compiled in only when ENABLE_TRACING is defined (build with `make TRACE=1`). Without it,
+ * TRACE_SPAN and TRACE_WRITE expand to nothing, so instrumented code pays no cost at all.
+ *
+ * Usage:
+ *     TRACE_SPAN("FileManager::loadCustomers");   // span lasts until the end of the enclosing scope
+ *     TRACE_WRITE("trace.json");                  // dump every recorded span, usually once at exit
+ *
+ * Span names must be string literals (or otherwise outlive the program), since only the pointer is recorded.
+ */
+#ifdef ENABLE_TRACING
+
+/**
+ * @class Tracer
+ * @brief Records completed spans into a lock-free per-thread buffer and writes them as Chrome trace events.
+ */
+class Tracer {
+public:
+    /**
+     * @class Span
+     * @brief RAII span: records its start time on construction and the complete event on destruction.
+     */
+    class Span {
+    public:
+        /**
+         * @brief Starts a new span.
+         * @param name The span name shown in the trace viewer. Must outlive the program (use a string literal).
+         */
+        explicit Span(const char* name) : name(name), startNs(Tracer::now()) {}
+
+        /**
+         * @brief Ends the span and records it in the calling thread's buffer.
+         */
+        ~Span() { Tracer::record(name, startNs, Tracer::now()); }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+    private:
+        const char* name;        ///< Name of the span.
+        std::uint64_t startNs;   ///< Start time in nanoseconds since the trace epoch.
+    };
+
+    /**
+     * @brief Retrieves the current time.
+     * @return std::uint64_t Nanoseconds since the trace epoch (first use of the tracer).
+     */
+    static std::uint64_t now();
+
+    /**
+     * @brief Appends a completed span to the calling thread's buffer. Never blocks or allocates after the
+     *        thread's first span; spans beyond the buffer capacity are dropped and counted.
+     * @param name The span name.
+     * @param startNs Start time in nanoseconds since the trace epoch.
+     * @param endNs End time in nanoseconds since the trace epoch.
+     */
+    static void record(const char* name, std::uint64_t startNs, std::uint64_t endNs);
+
+    /**
+     * @brief Writes every span recorded so far, from all threads, as a Chrome trace-event JSON file.
+     * @param filename The name of the file to write.
+     * @throws std::runtime_error If the file cannot be opened for writing.
+     */
+    static void writeChromeTrace(const std::string& filename);
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SPAN(name) Tracer::Span TRACE_CONCAT(traceSpan_, __LINE__)(name)
+#define TRACE_WRITE(filename) Tracer::writeChromeTrace(filename)
+
+#else
+
+#define TRACE_SPAN(name) ((void)0)
+#define TRACE_WRITE(filename) ((void)0)
+
+#endif // ENABLE_TRACING
+
+#endif // TRACE_H
@@ -0,0 +1,161 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef TRANSACTIONLOG_H
+#define TRANSACTIONLOG_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @class TransactionLog
+ * @brief The transaction log as a chain of size-bounded segments, with a per-customer index of its records.
+ *
+ * New records are always appended to the active segment, transactions.txt. Once it would grow past the
+ * segment size it is closed: renamed to log/segment-<offset>.txt, where <offset> is the position of its first
+ * byte in the log as a whole, and a new transactions.txt is started. Positions in the log (as in
+ * Checkpoint::logOffset) count every byte ever appended, so they stay valid across rotations. Closed
+ * segments that every data file's checkpoint has passed are no longer needed for recovery and can be moved
+ * to log/archive/ (see archive()); they are still read from there while they exist.
+ *
+ * Every append also records, for each record that concerns a customer, the customer ID, the record's
+ * position and its kind in a side index: transactions.idx for the active segment, renamed along with it to
+ * log/segment-<offset>.idx. A customer's recent history is then a few seeks instead of a scan of the log.
+ * The index is read into memory on first use; if the process stopped between writing a record and its
+ * index line, the missing lines are rebuilt from the end of the active segment.
+ *
+ * There is one TransactionLog per log file per process, shared by every thread; see get().
+ */
+class TransactionLog {
+public:
+    /**
+     * @brief One segment file of the log.
+     */
+    struct Segment {
+        std::uint64_t base = 0;   ///< Position of the segment's first byte in the log.
+        std::uint64_t size = 0;   ///< Bytes in the segment.
+        std::string path;
+        bool archived = false;    ///< The segment has been moved to log/archive/.
+    };
+
+    /**
+     * @brief What a customer's log record records.
+     */
+    enum class Kind : char { Purchase = 'P', Redemption = 'R', Registration = 'G', Removal = 'X', Expiry = 'E' };
+
+    /**
+     * @brief Retrieves the shared log object for a log file, opening it on first use.
+     * @param filename The active segment. Defaults to "transactions.txt".
+     * @return TransactionLog& The log.
+     */
+    static TransactionLog& get(const std::string& filename = "transactions.txt");
+
+    /**
+     * @brief Sets the size at which the active segment is closed and a new one started.
+     * @param bytes The segment size; records are never split, so a segment may end slightly larger.
+     */
+    static void setSegmentBytes(std::uint64_t bytes);
+
+    /**
+     * @brief Appends records with a single write, closing the active segment first if they would overflow it,
+     *        and indexes the ones that concern a customer.
+     * @param records One or more complete records, each ending with its blank line.
+     */
+    void append(const std::string& records);
+
+    /**
+     * @brief Retrieves the position just past the last byte appended.
+     * @return std::uint64_t The log's total size, over every segment.
+     */
+    std::uint64_t endOffset();
+
+    /**
+     * @brief Lists the segments, oldest first, the active one last.
+     * @return std::vector<Segment> The segments.
+     */
+    std::vector<Segment> segments();
+
+    /**
+     * @brief Reads every record from a position onwards, across segments.
+     * @param from A position at the start of a record. A position before the oldest segment starts there.
+     * @param visit Called with each record's position and lines, in log order.
+     * @param includeUnterminated Also visit a last record that has no blank line after it yet.
+     * @return std::uint64_t The position just past the last record visited.
+     */
+    std::uint64_t scan(std::uint64_t from,
+                       const std::function<void(std::uint64_t, const std::vector<std::string>&)>& visit,
+                       bool includeUnterminated = false);
+
+    /**
+     * @brief Reads every complete record of one segment, as listed by segments(). Several threads may each
+     *        read a different segment at once; the active segment must not be rotated meanwhile.
+     * @param segment The segment.
+     * @param visit Called with each record's position in the log and its lines, in order.
+     * @return std::uint64_t The position just past the last record visited.
+     */
+    static std::uint64_t scanSegment(const Segment& segment,
+                                     const std::function<void(std::uint64_t, const std::vector<std::string>&)>& visit);
+
+    /**
+     * @brief Retrieves a customer's most recent records of one kind from the index.
+     * @param customerID The unique identifier of the customer.
+     * @param kind The kind of record.
+     * @param limit The most records to return.
+     * @return std::vector<std::vector<std::string>> The records' lines, newest first. Records whose segment has
+     *         been removed from the archive are left out.
+     */
+    std::vector<std::vector<std::string>> history(const std::string& customerID, Kind kind, std::size_t limit);
+
+    /**
+     * @brief Moves the closed segments that end at or before a position to log/archive/.
+     * @param before Typically the checkpoint of the data files just written.
+     * @return std::size_t The number of segments archived.
+     */
+    std::size_t archive(std::uint64_t before);
+
+    /**
+     * @brief Finds the customer a log record concerns.
+     * @param record The record's lines.
+     * @param kind If not null and the record concerns a customer, receives its kind.
+     * @return std::string The Customer ID, or empty for a catalog record.
+     */
+    static std::string customerOf(const std::vector<std::string>& record, Kind* kind = nullptr);
+
+    TransactionLog(const TransactionLog&) = delete;
+    TransactionLog& operator=(const TransactionLog&) = delete;
+
+private:
+    struct Entry {
+        std::uint64_t offset;
+        Kind kind;
+    };
+
+    explicit TransactionLog(std::string filename);
+
+    std::string filename;            ///< The active segment.
+    std::string indexFilename;       ///< The active segment's index.
+    std::string segmentDirectory;    ///< Closed segments.
+    std::string archiveDirectory;    ///< Archived segments.
+
+    std::mutex mutex;                ///< Guards the fields below.
+    bool opened = false;
+    std::vector<Segment> closed;     ///< Closed and archived segments, oldest first.
+    std::uint64_t activeBase = 0;    ///< Position of the active segment's first byte.
+    bool indexLoaded = false;
+    std::unordered_map<std::string, std::vector<Entry>> index;   ///< Positions by customer, oldest first.
+
+    static std::atomic<std::uint64_t> segmentBytes;
+
+    void open();
+    void loadIndex();
+    void rotate(std::uint64_t activeSize);
+    std::vector<std::pair<Segment, std::unique_ptr<std::ifstream>>> openSegments(std::uint64_t from);
+    static std::string indexLines(std::uint64_t base, const std::string& records, std::vector<std::pair<std::string, Entry>>* entries);
+};
+
+#endif // TRANSACTIONLOG_H
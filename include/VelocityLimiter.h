@@ -0,0 +1,117 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#ifndef VELOCITYLIMITER_H
+#define VELOCITYLIMITER_H
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @class VelocityLimiter
+ * @brief Per-customer sliding-window counters of orders, spending and redemptions, checked against limits
+ *        on every checkout and redemption to stop rapid repeated use of an account.
+ *
+ * Each counter is a ring buffer of 16 buckets, each a sixteenth of the window long, with a running total.
+ * Moving to the current time clears the buckets that fell out of the window and subtracts them from the
+ * total, so a check costs at most 16 steps however busy the customer is. The window slides a bucket at a
+ * time: what is counted is everything from the last 15 to 16 sixteenths of the window.
+ *
+ * The counters are kept in memory only and start empty when the process starts.
+ */
+class VelocityLimiter {
+public:
+    /**
+     * @brief The most of something one customer may do in a window. A maximum of 0 means no limit.
+     */
+    struct Limit {
+        std::int64_t maximum = 0;         ///< Orders, cents or redemptions.
+        std::int64_t windowSeconds = 0;
+    };
+
+    /**
+     * @brief The limits a checkout or redemption is checked against.
+     */
+    struct Limits {
+        Limit orders;
+        Limit spend;         ///< In cents.
+        Limit redemptions;
+
+        /**
+         * @brief Tells whether any limit is set, so unlimited configurations skip the counters entirely.
+         * @return bool True if at least one limit is set.
+         */
+        bool any() const { return orders.maximum > 0 || spend.maximum > 0 || redemptions.maximum > 0; }
+    };
+
+    /**
+     * @brief Checks that a checkout keeps the customer within the order and spending limits, then counts it.
+     * @param customerID The unique identifier of the buying customer.
+     * @param cents The checkout's total cost, in cents.
+     * @param limits The limits to check.
+     * @param nowMillis The current time, from nowMillis().
+     * @throws std::invalid_argument If the checkout would go over a limit; nothing is counted then.
+     */
+    void admitCheckout(const std::string& customerID, std::int64_t cents, const Limits& limits,
+                       std::int64_t nowMillis);
+
+    /**
+     * @brief Checks that a redemption keeps the customer within the redemption limit, then counts it.
+     * @param customerID The unique identifier of the redeeming customer.
+     * @param limits The limits to check.
+     * @param nowMillis The current time, from nowMillis().
+     * @throws std::invalid_argument If the redemption would go over the limit; nothing is counted then.
+     */
+    void admitRedemption(const std::string& customerID, const Limits& limits, std::int64_t nowMillis);
+
+    /**
+     * @brief Retrieves the time the counters are kept in.
+     * @return std::int64_t Milliseconds on the steady clock.
+     */
+    static std::int64_t nowMillis();
+
+private:
+    /**
+     * @brief One sliding-window counter.
+     */
+    class Window {
+    public:
+        /**
+         * @brief Drops what fell out of the window by a time, then retrieves what is left.
+         * @param limit The limit the window belongs to; a changed window length starts the counter afresh.
+         * @param nowMillis The current time.
+         * @return std::int64_t The total counted in the window.
+         */
+        std::int64_t slide(const Limit& limit, std::int64_t nowMillis);
+
+        /**
+         * @brief Counts an amount in the current bucket. Call slide() first.
+         * @param amount The amount.
+         */
+        void add(std::int64_t amount) {
+            buckets[current % BUCKETS] += amount;
+            total += amount;
+        }
+
+    private:
+        static constexpr std::int64_t BUCKETS = 16;
+
+        std::int64_t total = 0;
+        std::int64_t current = 0;       ///< Number of the current bucket, counted from the clock's epoch.
+        std::int64_t widthMillis = 0;   ///< Length of a bucket; 0 until first used.
+        std::array<std::int64_t, BUCKETS> buckets{};
+    };
+
+    /**
+     * @brief One customer's counters.
+     */
+    struct Counters {
+        Window orders;
+        Window spend;
+        Window redemptions;
+    };
+
+    std::unordered_map<std::string, Counters> customers;
+};
+
+#endif // VELOCITYLIMITER_H
@@ -0,0 +1,70 @@
+#!/bin/sh
+# Dyar Jankir, Caden Dye, Arthas Lee
+#
+# Runs the representative workload used to train the PGO build and to compare the build profiles:
+# a bulk CSV import, a batch checkout over the imported customers, then a mixed in-process load of
+# lookups, checkouts, redemptions and registrations. Each binary runs in a fresh directory under DIR
+# and its throughput for each phase is printed as one row of a table.
+#
+# Usage: scripts/workload.sh DIR BINARY...
+# Sizes: WORKLOAD_CUSTOMERS (default 50000), WORKLOAD_CARTS (50000), WORKLOAD_SECONDS (3).
+
+set -e
+
+if [ $# -lt 2 ]; then
+    echo "Usage: $0 DIR BINARY..." >&2
+    exit 1
+fi
+
+dir=$1
+shift
+customers=${WORKLOAD_CUSTOMERS:-50000}
+carts=${WORKLOAD_CARTS:-50000}
+seconds=${WORKLOAD_SECONDS:-3}
+
+printf "%-28s %16s %16s %16s\n" "binary" "import rows/s" "checkout carts/s" "mixed requests/s"
+for binary in "$@"; do
+    program=$(cd "$(dirname "$binary")" && pwd)/$(basename "$binary")
+    run=$dir/$(echo "$binary" | tr '/.' '__')
+    rm -rf "$run"
+    mkdir -p "$run"
+    cd "$run"
+
+    # Products with enough stock that no checkout is refused, and gifts worth redeeming
+    : > products.txt
+    for i in 1 2 3 4 5 6 7 8; do
+        printf "Prod0000%d\nItem%d\n%d.5\n100000000\n\n" "$i" "$i" "$i" >> products.txt
+    done
+    printf "Mug\n50\n\nTea Pot\n200\n\nLaptop\n5000\n\n" > gifts.txt
+
+    awk -v n="$customers" 'BEGIN {
+        srand(1)
+        split("James Mary John Linda David Susan Daniel Karen", first, " ")
+        split("Smith Johnson Brown Jones Garcia Miller Davis Walker", last, " ")
+        for (i = 0; i < n; i++) {
+            printf "U%03duser%07d,%s,%s,%d,%d-%04d-%04d\n", i % 1000, i, first[int(rand() * 8) + 1],
+                   last[int(rand() * 8) + 1], 18 + int(rand() * 83), 1000 + int(rand() * 9000),
+                   int(rand() * 10000), int(rand() * 10000)
+        }
+    }' > customers.csv
+    import=$(printf '8\ncustomers.csv\n0\n' | "$program" --snapshot-interval 0 |
+             sed -n 's/.*Imported .*(\([0-9]*\) rows\/s).*/\1/p')
+
+    awk -v n="$carts" '/^CustID/ { ids[count++] = $0 }
+        END {
+            srand(2)
+            for (i = 0; i < n; i++) {
+                printf "%s Prod0000%d:%d", ids[int(rand() * count)], 1 + int(rand() * 8), 1 + int(rand() * 3)
+                if (rand() < 0.5) printf " Prod0000%d:1", 1 + int(rand() * 8)
+                printf "\n"
+            }
+        }' customers.txt > carts.txt
+    checkout=$("$program" --snapshot-interval 0 --checkout-batch carts.txt |
+               sed -n 's/^Batch checkout: .* \([0-9]*\) carts\/s.*/\1/p')
+
+    mixed=$("$program" --snapshot-interval 0 --loadgen inproc --clients 4 --duration "$seconds" --mix 20,40,30,10 |
+            sed -n 's/^Throughput: \([0-9]*\) requests\/s.*/\1/p')
+
+    cd - > /dev/null
+    printf "%-28s %16s %16s %16s\n" "$binary" "${import:-failed}" "${checkout:-failed}" "${mixed:-failed}"
+done
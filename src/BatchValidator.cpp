@@ -0,0 +1,191 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "BatchValidator.h"
+#include "Customer.h"
+#include "Product.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr std::size_t SLOT = 16;    // bytes per packed value: one SSE2 register
+constexpr std::size_t BLOCK = 64;   // values packed at a time: one bitmap word
+
+/**
+ * @brief Packs the values into zero-padded 16-byte slots, 64 at a time, and records check(slot, length) for
+ *        each one in the bitmap.
+ */
+template <typename Check>
+BatchValidator::Bitmap runKernel(std::span<const std::string_view> values, Check check) {
+    BatchValidator::Bitmap bitmap((values.size() + BLOCK - 1) / BLOCK, 0);
+    alignas(16) unsigned char slots[BLOCK][SLOT];
+
+    for (std::size_t blockStart = 0; blockStart < values.size(); blockStart += BLOCK) {
+        std::size_t count = std::min(BLOCK, values.size() - blockStart);
+        std::memset(slots, 0, sizeof(slots));
+        for (std::size_t i = 0; i < count; ++i) {
+            const std::string_view& value = values[blockStart + i];
+            std::memcpy(slots[i], value.data(), std::min(SLOT, value.size()));
+        }
+
+        std::uint64_t word = 0;
+        for (std::size_t i = 0; i < count; ++i) {
+            word |= static_cast<std::uint64_t>(check(slots[i], values[blockStart + i])) << i;
+        }
+        bitmap[blockStart / BLOCK] = word;
+    }
+    return bitmap;
+}
+
+#if defined(__SSE2__)
+
+/**
+ * @brief Per-byte character classes of one slot, as 16-bit masks (bit i describes byte i).
+ */
+struct Classes {
+    unsigned digit;
+    unsigned letter;
+};
+
+inline __m128i inRange(__m128i bytes, char low, char high) {
+    // Signed compares: bytes of 0x80 and above are negative, so they are never in an ASCII range
+    return _mm_and_si128(_mm_cmpgt_epi8(bytes, _mm_set1_epi8(static_cast<char>(low - 1))),
+                         _mm_cmplt_epi8(bytes, _mm_set1_epi8(static_cast<char>(high + 1))));
+}
+
+inline __m128i load(const unsigned char* slot) {
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(slot));
+}
+
+inline Classes classify(__m128i bytes) {
+    __m128i letter = _mm_or_si128(inRange(bytes, 'A', 'Z'), inRange(bytes, 'a', 'z'));
+    return Classes{static_cast<unsigned>(_mm_movemask_epi8(inRange(bytes, '0', '9'))),
+                   static_cast<unsigned>(_mm_movemask_epi8(letter))};
+}
+
+inline unsigned matches(__m128i bytes, char c) {
+    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(c))));
+}
+
+inline unsigned lowBits(std::size_t count) {
+    return (1u << count) - 1;
+}
+
+#endif
+
+} // namespace
+
+/**
+ * @brief Validates usernames ('U' followed by up to three digits, then at least six letters or digits).
+ *
+ * Since digits are also allowed after the optional leading digits, the rule is the same as 'U' followed by
+ * at least six letters or digits.
+ *
+ * @param values The usernames.
+ * @return Bitmap The validity bitmap.
+ */
+BatchValidator::Bitmap BatchValidator::userNames(std::span<const std::string_view> values) {
+    TRACE_SPAN("BatchValidator::userNames");
+    return runKernel(values, [](const unsigned char* slot, std::string_view value) {
+#if defined(__SSE2__)
+        if (value.size() > SLOT) {
+            return Customer::isUserNameValid(std::string(value));
+        }
+        else if (value.size() < 7) {
+            return false;
+        }
+        else {
+            Classes classes = classify(load(slot));
+            unsigned body = lowBits(value.size()) & ~1u;
+            return slot[0] == 'U' && ((classes.digit | classes.letter) & body) == body;
+        }
+#else
+        (void)slot;
+        return Customer::isUserNameValid(std::string(value));
+#endif
+    });
+}
+
+/**
+ * @brief Validates first or last names (1 to 12 letters).
+ *
+ * @param values The names.
+ * @return Bitmap The validity bitmap.
+ */
+BatchValidator::Bitmap BatchValidator::names(std::span<const std::string_view> values) {
+    TRACE_SPAN("BatchValidator::names");
+    return runKernel(values, [](const unsigned char* slot, std::string_view value) {
+#if defined(__SSE2__)
+        if (value.empty() || value.size() > 12) {
+            return false;
+        }
+        else {
+            unsigned all = lowBits(value.size());
+            return (classify(load(slot)).letter & all) == all;
+        }
+#else
+        (void)slot;
+        return Customer::isNameValid(std::string(value));
+#endif
+    });
+}
+
+/**
+ * @brief Validates credit card numbers (NNNN-NNNN-NNNN, not starting with 0).
+ *
+ * @param values The credit card numbers.
+ * @return Bitmap The validity bitmap.
+ */
+BatchValidator::Bitmap BatchValidator::creditCards(std::span<const std::string_view> values) {
+    TRACE_SPAN("BatchValidator::creditCards");
+    return runKernel(values, [](const unsigned char* slot, std::string_view value) {
+#if defined(__SSE2__)
+        constexpr unsigned DIGITS = 0x3DEF;    // positions 0-3, 5-8 and 10-13
+        constexpr unsigned HYPHENS = 0x210;    // positions 4 and 9
+        if (value.size() != 14) {
+            return false;
+        }
+        else {
+            __m128i bytes = load(slot);
+            return (classify(bytes).digit & DIGITS) == DIGITS && (matches(bytes, '-') & HYPHENS) == HYPHENS &&
+                   slot[0] != '0';
+        }
+#else
+        (void)slot;
+        return Customer::isCreditCardValid(std::string(value));
+#endif
+    });
+}
+
+/**
+ * @brief Validates Product IDs ("Prod" followed by five digits).
+ *
+ * @param values The Product IDs.
+ * @return Bitmap The validity bitmap.
+ */
+BatchValidator::Bitmap BatchValidator::productIDs(std::span<const std::string_view> values) {
+    TRACE_SPAN("BatchValidator::productIDs");
+    return runKernel(values, [](const unsigned char* slot, std::string_view value) {
+#if defined(__SSE2__)
+        constexpr unsigned PREFIX = 0xF;     // positions 0-3
+        constexpr unsigned DIGITS = 0x1F0;   // positions 4-8
+        if (value.size() != 9) {
+            return false;
+        }
+        else {
+            __m128i bytes = load(slot);
+            __m128i prefix = _mm_cmpeq_epi8(bytes, _mm_setr_epi8('P', 'r', 'o', 'd', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0));
+            return (static_cast<unsigned>(_mm_movemask_epi8(prefix)) & PREFIX) == PREFIX &&
+                   (classify(bytes).digit & DIGITS) == DIGITS;
+        }
+#else
+        (void)slot;
+        return Product::isProductIDValid(std::string(value));
+#endif
+    });
+}
@@ -0,0 +1,885 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "Benchmarks.h"
+#include "BatchValidator.h"
+#include "CustomerIndex.h"
+#include "CustomerTotals.h"
+#include "ProductSearchIndex.h"
+#include "RewardConfig.h"
+#include "RewardRules.h"
+#include "StockMonitor.h"
+#include "TimingWheel.h"
+#include "VelocityLimiter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <malloc.h>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string_view>
+#include <thread>
+
+namespace {
+
+/**
+ * @brief Measures how fast the reward rules score carts.
+ * 
+ * @param context The loaded program; its products supply the IDs and prices in the carts, and its configuration
+ *                the rules.
+ * @param cartCount The number of carts to score.
+ * @return bool Always true: there is nothing to check.
+ */
+bool benchmarkRules(Benchmarks::Context& context, long long cartCount) {
+    std::shared_ptr<const RewardConfig> config = context.service.getConfig();
+    const RewardRules& rules = config->getRules();
+
+    // A fixed set of random carts, scored round-robin so generating them is not measured
+    std::vector<Product> products = context.store.read().readProducts();
+    if (products.empty()) {
+        products.push_back(Product("Prod00001", "Sample", 9.99, 1));
+    }
+    else {
+        // do nothing
+    }
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> pickProduct(0, products.size() - 1);
+    std::uniform_int_distribution<int> pickLines(1, 5), pickQuantity(1, 4), pickAge(18, 100);
+    std::vector<std::string> productIDs;
+    for (const Product& product : products) {
+        productIDs.push_back(product.getProductID());
+    }
+    constexpr std::size_t CART_COUNT = 4096;
+    std::vector<std::vector<PricedLine>> carts(CART_COUNT);
+    std::vector<int> ages(CART_COUNT);
+    for (std::size_t c = 0; c < CART_COUNT; ++c) {
+        int lineCount = pickLines(gen);
+        for (int l = 0; l < lineCount; ++l) {
+            std::size_t p = pickProduct(gen);
+            carts[c].push_back(PricedLine{productIDs[p], products[p].getProductPrice(), pickQuantity(gen)});
+        }
+        ages[c] = pickAge(gen);
+    }
+
+    long long totalPoints = 0;   // printed, so the scoring cannot be optimized away
+    auto start = std::chrono::steady_clock::now();
+    for (long long i = 0; i < cartCount; ++i) {
+        std::size_t c = static_cast<std::size_t>(i) % CART_COUNT;
+        totalPoints += rules.points(carts[c], ages[c]);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Scored " << cartCount << " carts with " << rules.getRuleCount() << " rules in " << seconds * 1000
+              << " ms: " << static_cast<long long>(cartCount / seconds) << " carts/s, "
+              << seconds * 1e9 / cartCount << " ns per cart (" << totalPoints << " points).\n";
+    return true;
+}
+
+/**
+ * @brief Measures what reading the reward configuration costs, with and without a concurrent reload.
+ * 
+ * @param context The loaded program; its reward service's configuration is read and republished.
+ * @param readCount The number of reads per measurement.
+ * @return bool Always true: there is nothing to check.
+ */
+bool benchmarkConfig(Benchmarks::Context& context, long long readCount) {
+    RewardService& service = context.service;
+    using Clock = std::chrono::steady_clock;
+    auto nsPerRead = [readCount](Clock::time_point start) {
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / readCount;
+    };
+    long long sink = 0;   // printed, so the reads cannot be optimized away
+
+    // Baseline: the same read through a mutex-protected shared_ptr
+    std::mutex mutex;
+    std::shared_ptr<const RewardConfig> locked = service.getConfig();
+    auto start = Clock::now();
+    for (long long i = 0; i < readCount; ++i) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sink += locked->getRules().getPointsPerDollar();
+    }
+    double mutexRead = nsPerRead(start);
+
+    start = Clock::now();
+    for (long long i = 0; i < readCount; ++i) {
+        sink += service.getPointsPerDollar();   // RCU read guard
+    }
+    double rcuRead = nsPerRead(start);
+
+    start = Clock::now();
+    for (long long i = 0; i < readCount; ++i) {
+        sink += service.getConfig()->getRules().getPointsPerDollar();   // RCU read plus a shared_ptr copy
+    }
+    double rcuShare = nsPerRead(start);
+
+    // Reloads while reader threads keep reading
+    constexpr int READERS = 4, RELOADS = 200;
+    std::atomic<bool> done{false};
+    std::atomic<long long> readsDuringReloads{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < READERS; ++r) {
+        readers.emplace_back([&service, &done, &readsDuringReloads]() {
+            long long reads = 0;
+            while (!done.load(std::memory_order_relaxed)) {
+                reads += service.getPointsPerDollar() >= 0 ? 1 : 0;
+            }
+            readsDuringReloads += reads;
+        });
+    }
+    RewardConfig original = *service.getConfig();
+    double totalReload = 0.0, worstReload = 0.0;
+    start = Clock::now();
+    for (int i = 0; i < RELOADS; ++i) {
+        auto reloadStart = Clock::now();
+        service.setConfig(original.withPointsPerDollar(original.getRules().getPointsPerDollar() + i % 2));
+        double seconds = std::chrono::duration<double>(Clock::now() - reloadStart).count();
+        totalReload += seconds;
+        worstReload = std::max(worstReload, seconds);
+    }
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    done = true;
+    for (std::thread& reader : readers) {
+        reader.join();
+    }
+    service.setConfig(original);
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Config read: " << rcuRead << " ns with RCU, " << rcuShare << " ns with RCU and a shared_ptr copy, "
+              << mutexRead << " ns with a mutex (" << sink % 10 << ").\n";
+    std::cout << "Reload with " << READERS << " readers running: " << totalReload / RELOADS * 1e6 << " us average, "
+              << worstReload * 1e6 << " us worst; readers did "
+              << static_cast<long long>(readsDuringReloads / elapsed) << " reads/s meanwhile.\n";
+    std::cout.unsetf(std::ios::fixed);
+    return true;
+}
+
+/**
+ * @brief Checks that BatchValidator agrees with the scalar Customer and Product rules, and compares their speed.
+ * 
+ * Every field is fed valid samples with random damage: changed, inserted and removed bytes, including bytes
+ * outside ASCII, so both sides of each rule are exercised.
+ * 
+ * @param valueCount The number of values per field.
+ * @return bool True if the batch and scalar rules agreed on every value.
+ */
+bool benchmarkValidator(Benchmarks::Context&, long long valueCount) {
+    using Kernel = BatchValidator::Bitmap (*)(std::span<const std::string_view>);
+    struct Field {
+        const char* name;
+        std::vector<std::string> samples;
+        Kernel batch;
+        std::function<bool(const std::string&)> scalar;
+    };
+    std::vector<Field> fields = {
+        {"username", {"U111thomasmuller", "Uabcdef", "U12abcdef", "U1234567890abcdefghij"}, BatchValidator::userNames,
+         Customer::isUserNameValid},
+        {"name", {"John", "Abcdefghijkl", "Z"}, BatchValidator::names, Customer::isNameValid},
+        {"credit card", {"1234-5678-9012", "9999-0000-1111"}, BatchValidator::creditCards, Customer::isCreditCardValid},
+        {"product ID", {"Prod00001", "Prod98765"}, BatchValidator::productIDs, Product::isProductIDValid},
+    };
+
+    std::mt19937 gen(7);
+    const std::string alphabet = "0123456789-UPabcdodrzAZ@ \x80\xff";
+    std::uniform_int_distribution<std::size_t> pickChar(0, alphabet.size() - 1);
+    std::uniform_int_distribution<int> pickDamage(0, 4);
+    std::size_t totalMismatches = 0;
+    for (Field& field : fields) {
+        std::vector<std::string> values;
+        values.reserve(valueCount);
+        for (long long i = 0; i < valueCount; ++i) {
+            std::string value = field.samples[i % field.samples.size()];
+            int damage = pickDamage(gen);   // 0: untouched, 1: changed byte, 2: inserted byte, 3: removed byte, 4: two changes
+            for (int d = 0; d < (damage == 4 ? 2 : std::min(damage, 1)); ++d) {
+                std::size_t at = std::uniform_int_distribution<std::size_t>(0, value.size())(gen);
+                if (damage == 2) {
+                    value.insert(value.begin() + at, alphabet[pickChar(gen)]);
+                }
+                else if (damage == 3 && !value.empty()) {
+                    value.erase(std::min(at, value.size() - 1), 1);
+                }
+                else if (at < value.size()) {
+                    value[at] = alphabet[pickChar(gen)];
+                }
+                else {
+                    // do nothing
+                }
+            }
+            values.push_back(std::move(value));
+        }
+        std::vector<std::string_view> views(values.begin(), values.end());
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<bool> expected(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            expected[i] = field.scalar(values[i]);
+        }
+        double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        start = std::chrono::steady_clock::now();
+        BatchValidator::Bitmap bitmap = field.batch(views);
+        double batchSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t mismatches = 0, valid = 0;
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            mismatches += BatchValidator::isSet(bitmap, i) != expected[i] ? 1 : 0;
+            valid += expected[i] ? 1 : 0;
+        }
+        std::cout << std::left << std::setw(12) << field.name << std::right << " " << values.size() << " values ("
+                  << valid << " valid): scalar " << scalarSeconds * 1e9 / values.size() << " ns, batch "
+                  << batchSeconds * 1e9 / values.size() << " ns per value, " << mismatches << " mismatches.\n";
+        totalMismatches += mismatches;
+    }
+    return totalMismatches == 0;
+}
+
+/**
+ * @brief Measures the product name index on a generated catalog: build time, memory, query latency and the
+ *        cost of keeping it up to date, and checks sampled query results against a scan of every name.
+ * 
+ * @param productCount The number of products to generate.
+ * @return bool True if every sampled query found what the scan found.
+ */
+bool benchmarkSearch(Benchmarks::Context&, long long productCount) {
+    const std::vector<std::string> brands = {"Acme", "Globex", "Initech", "Umbrella", "Stark", "Wayne", "Hooli",
+                                             "Vandelay", "Soylent", "Tyrell", "Cyberdyne", "Wonka"};
+    const std::vector<std::string> adjectives = {"Smart", "Wireless", "Portable", "Compact", "Deluxe", "Classic",
+                                                 "Ultra", "Mini", "Pro", "Eco", "Rugged", "Silent", "Turbo"};
+    const std::vector<std::string> nouns = {"Phone", "Laptop", "Speaker", "Headphones", "Kettle", "Blender",
+                                            "Camera", "Monitor", "Keyboard", "Charger", "Lamp", "Toaster",
+                                            "Backpack", "Watch", "Router", "Drone", "Tablet", "Projector"};
+    std::mt19937 gen(11);
+    auto pick = [&gen](const std::vector<std::string>& words) {
+        return words[std::uniform_int_distribution<std::size_t>(0, words.size() - 1)(gen)];
+    };
+    std::vector<std::pair<std::string, std::string>> catalog;
+    catalog.reserve(productCount);
+    for (long long i = 0; i < productCount; ++i) {
+        catalog.emplace_back("P" + std::to_string(i), pick(brands) + " " + pick(adjectives) + " " + pick(nouns) +
+                                                          " " + std::to_string(gen() % 10000));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    ProductSearchIndex index;
+    for (const auto& [productID, name] : catalog) {
+        index.add(productID, name);
+    }
+    double buildSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Indexed " << index.size() << " products in " << buildSeconds << " s ("
+              << index.getSizeInBytes() / (1024.0 * 1024.0) << " MiB).\n";
+
+    // Queries are pieces of real names: word starts for prefix search, anywhere for substring search
+    std::vector<std::string> prefixQueries, substringQueries;
+    for (int i = 0; i < 2000; ++i) {
+        std::string word = pick(i % 2 == 0 ? nouns : brands);
+        prefixQueries.push_back(word.substr(0, 1 + i % std::min<std::size_t>(5, word.size())));
+        std::string name = catalog[gen() % catalog.size()].second;
+        std::size_t length = 3 + i % 4;
+        substringQueries.push_back(name.substr(gen() % (name.size() - length), length));
+    }
+    using Query = std::vector<std::string> (ProductSearchIndex::*)(std::string_view, std::size_t) const;
+    auto timeQueries = [&index](const char* label, Query query, const std::vector<std::string>& queries) {
+        auto begin = std::chrono::steady_clock::now();
+        std::size_t results = 0;
+        for (const std::string& text : queries) {
+            results += (index.*query)(text, 10).size();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        std::cout << std::left << std::setw(10) << label << std::right << " " << seconds * 1e6 / queries.size()
+                  << " us per query, " << static_cast<double>(results) / queries.size() << " results on average.\n";
+    };
+    timeQueries("prefix", &ProductSearchIndex::prefix, prefixQueries);
+    timeQueries("substring", &ProductSearchIndex::substring, substringQueries);
+    timeQueries("search", &ProductSearchIndex::search, substringQueries);
+
+    // Every result must match, and an unlimited substring search must find exactly what a scan finds
+    std::size_t wrong = 0;
+    for (int i = 0; i < 20; ++i) {
+        std::string query = substringQueries[i];
+        std::string lowered = query;
+        std::transform(lowered.begin(), lowered.end(), lowered.begin(), ::tolower);
+        std::size_t scanned = 0;
+        for (const auto& [productID, name] : catalog) {
+            std::string lowerName = name;
+            std::transform(lowerName.begin(), lowerName.end(), lowerName.begin(), ::tolower);
+            scanned += lowerName.find(lowered) != std::string::npos ? 1 : 0;
+        }
+        wrong += index.substring(query, catalog.size()).size() != scanned ? 1 : 0;
+    }
+    std::cout << "Checked 20 substring queries against a full scan: " << wrong << " differed.\n";
+
+    start = std::chrono::steady_clock::now();
+    const int updates = 10000;
+    for (int i = 0; i < updates; ++i) {
+        const auto& [productID, name] = catalog[gen() % catalog.size()];
+        index.remove(productID);
+        index.add(productID, name);
+    }
+    double updateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Removed and re-added " << updates << " products at " << updateSeconds * 1e6 / updates
+              << " us per pair.\n";
+    return wrong == 0;
+}
+
+/**
+ * @brief Compares the customer indexes with scanning the customer list on generated customers, for selective
+ *        queries and a page up to a hundred pages deep, and times points updates. Then checks that each query's
+ *        page holds the customers a sorted scan puts there.
+ * 
+ * @param customerCount The number of customers to generate.
+ * @return bool True if every index page matched the sorted scan.
+ */
+bool benchmarkCustomerIndex(Benchmarks::Context&, long long customerCount) {
+    const std::vector<std::string> lastNames = {"Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller",
+                                                "Davis", "Lee", "Walker", "Hall", "Young", "King", "Wright", "Scott"};
+    const std::vector<std::string> firstNames = {"James", "Mary", "John", "Linda", "David", "Susan", "Daniel",
+                                                 "Karen", "Paul", "Nancy", "Mark", "Lisa", "Kevin", "Amy"};
+    std::mt19937 gen(5);
+    std::vector<Customer> customers;
+    customers.reserve(customerCount);
+    for (long long i = 0; i < customerCount; ++i) {
+        std::string id = std::to_string(1000000000LL + i);
+        customers.push_back(Customer::prevalidated("CustID" + id, "U000user" + id, firstNames[gen() % firstNames.size()],
+                                                   lastNames[gen() % lastNames.size()], 18 + gen() % 83,
+                                                   "1234-5678-9012", gen() % 5000));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    CustomerIndex index(customers);
+    std::cout << "Indexed " << index.size() << " customers in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s.\n";
+
+    // The same queries answered by scanning the list, as the menu had to before
+    auto scanPage = [&customers](auto matches, std::size_t skip) {
+        std::vector<std::string> page;
+        for (const Customer& customer : customers) {
+            if (matches(customer) && skip-- == 0) {
+                page.push_back(customer.getCustomerID());
+                if (page.size() == 10) break;
+                skip = 0;
+            }
+            else {
+                // do nothing
+            }
+        }
+        return page;
+    };
+    auto time = [](const std::string& label, auto run) {
+        const int repeats = 20;
+        auto begin = std::chrono::steady_clock::now();
+        std::size_t rows = 0;
+        for (int i = 0; i < repeats; ++i) {
+            rows = run();
+        }
+        std::cout << std::left << std::setw(36) << label << std::right << " "
+                  << std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - begin).count() / repeats
+                  << " us (" << rows << " rows).\n";
+    };
+    auto isWalkerAmy = [](const Customer& c) { return c.getLastName() == "Walker" && c.getFirstName() == "Amy"; };
+    auto isHighPoints = [](const Customer& c) { return c.getRewardPoints() >= 4990; };
+    auto isThirties = [](const Customer& c) { return c.getAge() >= 30 && c.getAge() <= 39; };
+
+    // Selective queries, where a scan has to read most of the list to fill a page
+    time("index: \"Walker, Amy\", page 1", [&] { return index.byName("Walker", "Amy", 10).rows.size(); });
+    time("scan:  \"Walker, Amy\", page 1", [&] { return scanPage(isWalkerAmy, 0).size(); });
+    time("index: points 4990-5000, page 1", [&] { return index.byPoints(4990, 5000, 10).rows.size(); });
+    time("scan:  points 4990-5000, page 1", [&] { return scanPage(isHighPoints, 0).size(); });
+
+    // A deep page of a broad query: the index seeks to the cursor, a scan counts its way there. Fewer customers
+    // may not fill a hundred pages, so the deepest page there is is used.
+    std::string cursor;
+    std::size_t pagesSkipped = 0;
+    while (pagesSkipped < 100) {
+        std::string next = index.byAge(30, 39, 10, cursor).next;
+        if (next.empty()) {
+            break;
+        }
+        else {
+            cursor = next;
+            ++pagesSkipped;
+        }
+    }
+    std::string deepPage = "age 30-39, page " + std::to_string(pagesSkipped + 1);
+    time("index: " + deepPage, [&] { return index.byAge(30, 39, 10, cursor).rows.size(); });
+    time("scan:  " + deepPage, [&] { return scanPage(isThirties, pagesSkipped * 10).size(); });
+
+    // Every match of a scan, sorted into index order: by the key the query orders by, then by Customer ID
+    auto sortedScanPage = [&customers](auto matches, auto key, std::size_t skip) {
+        std::vector<std::pair<int, std::string>> keys;
+        for (const Customer& customer : customers) {
+            if (matches(customer)) {
+                keys.emplace_back(key(customer), customer.getCustomerID());
+            }
+            else {
+                // do nothing
+            }
+        }
+        std::sort(keys.begin(), keys.end());
+        std::vector<std::string> page;
+        for (std::size_t i = skip; i < keys.size() && page.size() < 10; ++i) {
+            page.push_back(keys[i].second);
+        }
+        return page;
+    };
+    auto pageIDs = [](const CustomerIndex::Page& page) {
+        std::vector<std::string> ids;
+        for (const CustomerIndex::Row& row : page.rows) {
+            ids.push_back(row.customerID);
+        }
+        return ids;
+    };
+    int differed = 0;
+    differed += pageIDs(index.byName("Walker", "Amy", 10)) !=
+                sortedScanPage(isWalkerAmy, [](const Customer&) { return 0; }, 0) ? 1 : 0;   // one name: ID order
+    differed += pageIDs(index.byPoints(4990, 5000, 10)) !=
+                sortedScanPage(isHighPoints, [](const Customer& c) { return c.getRewardPoints(); }, 0) ? 1 : 0;
+    differed += pageIDs(index.byAge(30, 39, 10, cursor)) !=
+                sortedScanPage(isThirties, [](const Customer& c) { return c.getAge(); }, pagesSkipped * 10) ? 1 : 0;
+    std::cout << "Checked 3 index pages against a sorted scan: " << differed << " differed.\n";
+
+    CustomerIndex& mutableIndex = index;
+    time("index: 1000 point updates", [&] {
+        for (int i = 0; i < 1000; ++i) {
+            const Customer& customer = customers[gen() % customers.size()];
+            mutableIndex.updatePoints(customer.getCustomerID(), static_cast<int>(gen() % 5000));
+        }
+        return std::size_t{0};
+    });
+    return differed == 0;
+}
+
+/**
+ * @brief Times stock monitor updates and "lowest 10" queries on generated products, against sorting the
+ *        catalog for every query, and checks both give the same answer.
+ * 
+ * @param productCount The number of products to generate.
+ * @return bool True if the heap and the scan found the same lowest products.
+ */
+bool benchmarkStock(Benchmarks::Context&, long long productCount) {
+    std::mt19937 gen(3);
+    std::vector<std::string> productIDs;
+    std::vector<int> levels;
+    StockMonitor monitor({}, 5);
+    for (long long i = 0; i < productCount; ++i) {
+        productIDs.push_back("Item" + std::to_string(i));
+        levels.push_back(static_cast<int>(gen() % 1000));
+        monitor.add(productIDs.back(), "Item", levels.back());
+    }
+
+    const int updates = 1000000;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < updates; ++i) {
+        std::size_t p = gen() % productIDs.size();
+        levels[p] = std::max(0, levels[p] + static_cast<int>(gen() % 21) - 12);   // mostly selling
+        monitor.update(productIDs[p], levels[p]);
+    }
+    double updateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const int queries = 1000;
+    start = std::chrono::steady_clock::now();
+    std::vector<StockMonitor::Level> lowest;
+    for (int i = 0; i < queries; ++i) {
+        lowest = monitor.lowest(10);
+    }
+    double heapSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    std::vector<std::pair<int, std::string>> scanned;
+    for (int i = 0; i < queries; ++i) {
+        scanned.clear();
+        for (std::size_t p = 0; p < productIDs.size(); ++p) {
+            scanned.emplace_back(levels[p], productIDs[p]);
+        }
+        std::partial_sort(scanned.begin(), scanned.begin() + std::min<std::size_t>(10, scanned.size()), scanned.end());
+    }
+    double scanSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    bool same = true;
+    for (std::size_t i = 0; i < lowest.size(); ++i) {
+        same = same && lowest[i].inventory == scanned[i].first && lowest[i].productID == scanned[i].second;
+    }
+    std::cout << productIDs.size() << " products: " << updateSeconds * 1e9 / updates << " ns per update, "
+              << monitor.takeAlerts().size() << " low-stock alerts.\n";
+    std::cout << "Lowest 10: " << heapSeconds * 1e6 / queries << " us from the heap, " << scanSeconds * 1e6 / queries
+              << " us by scanning (" << (same ? "same" : "different") << " results).\n";
+    return same;
+}
+
+/**
+ * @brief Measures the memory a customer takes, with its heap blocks, and times ID lookups and random
+ *        accesses to customer fields on generated customers.
+ * 
+ * @param customerCount The number of customers to generate.
+ * @return bool True if every lookup found its customer.
+ */
+bool benchmarkCustomerLayout(Benchmarks::Context&, long long customerCount) {
+    const std::vector<std::string> lastNames = {"Smith", "Johnson", "Williams", "Brown", "Jones", "Garcia", "Miller",
+                                                "Davis", "Lee", "Walker", "Hall", "Young", "King", "Wright", "Scott"};
+    const std::vector<std::string> firstNames = {"James", "Mary", "John", "Linda", "David", "Susan", "Daniel",
+                                                 "Karen", "Paul", "Nancy", "Mark", "Lisa", "Kevin", "Amy"};
+    std::mt19937 gen(9);
+    std::vector<Customer> customers;
+    auto heapInUse = [] {
+        struct mallinfo2 heap = mallinfo2();
+        return heap.uordblks + heap.hblkhd;   // small blocks plus the vector's own mmap'd block
+    };
+    std::size_t heapBefore = heapInUse();
+    customers.reserve(customerCount);
+    for (long long i = 0; i < customerCount; ++i) {
+        char id[32], card[16];   // id has room for any long long
+        std::snprintf(id, sizeof(id), "CustID%010lld", 1000000000LL + i);
+        std::snprintf(card, sizeof(card), "%04u-%04u-%04u", static_cast<unsigned>(1000 + gen() % 9000),
+                      static_cast<unsigned>(gen() % 10000), static_cast<unsigned>(gen() % 10000));
+        std::string firstName = firstNames[gen() % firstNames.size()];
+        std::string lastName = lastNames[gen() % lastNames.size()];
+        std::string userName = "U" + std::to_string(gen() % 1000) + lastName + firstName;
+        customers.push_back(Customer::prevalidated(id, userName, firstName, lastName, 18 + gen() % 83, card,
+                                                   gen() % 5000));
+    }
+    std::size_t heapBytes = heapInUse() - heapBefore;
+    std::cout << "sizeof(Customer): " << sizeof(Customer) << " bytes; with its heap blocks: " << std::fixed
+              << std::setprecision(1) << static_cast<double>(heapBytes) / customerCount << " bytes per customer ("
+              << heapBytes / (1024.0 * 1024.0) << " MiB for " << customerCount << ").\n";
+
+    std::vector<std::size_t> order(customers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), gen);
+    DataStore store(std::move(customers), {}, {});
+    DataStore::ReadGuard state = store.read();
+    const std::vector<Customer>& list = state.readCustomers();
+
+    // findCustomer compares IDs down the list, so a lookup touches every record before the match
+    const int lookups = 200;
+    auto start = std::chrono::steady_clock::now();
+    long long found = 0;
+    for (int i = 0; i < lookups; ++i) {
+        found += state.findCustomer(list[order[i]].getCustomerID()).has_value() ? 1 : 0;
+    }
+    std::cout << "ID lookup by scan: " << std::chrono::duration<double, std::milli>(
+                     std::chrono::steady_clock::now() - start).count() / lookups
+              << " ms per lookup (" << found << " of " << lookups << " found).\n";
+
+    // Points and age in random order, as the checkout and index paths read them: a cache miss or more each
+    start = std::chrono::steady_clock::now();
+    long long total = 0;
+    for (std::size_t position : order) {
+        total += list[position].getRewardPoints() + list[position].getAge();
+    }
+    std::cout << "Random field reads: " << std::chrono::duration<double, std::nano>(
+                     std::chrono::steady_clock::now() - start).count() / static_cast<double>(order.size())
+              << " ns per customer (checksum " << total << ").\n";
+
+    // Every field in random order, as saving or displaying a customer does
+    start = std::chrono::steady_clock::now();
+    std::size_t characters = 0;
+    for (std::size_t position : order) {
+        const Customer& customer = list[position];
+        characters += customer.getCustomerID().size() + customer.getUserName().size() +
+                      customer.getFirstName().size() + customer.getLastName().size() +
+                      customer.getCreditCardNumber().size();
+    }
+    std::cout << "Random full-record reads: " << std::chrono::duration<double, std::nano>(
+                     std::chrono::steady_clock::now() - start).count() / static_cast<double>(order.size())
+              << " ns per customer (" << characters << " characters).\n" << std::defaultfloat;
+    return found == lookups;
+}
+
+/**
+ * @brief Redeems a popular limited gift from several threads at once, as RewardService::redeem does but without
+ *        logging, and reports the throughput while it lasts and once it is sold out. Then checks that no unit
+ *        was sold twice and no points were spent twice.
+ * 
+ * @param attemptCount The number of redemption attempts, shared between the threads.
+ * @return bool True if the stock and points were consistent.
+ */
+bool benchmarkRedemption(Benchmarks::Context&, long long attemptCount) {
+    const int requiredPoints = 100;
+    const int startingPoints = 250;   // enough for two redemptions each
+    const int threadCount = 4;
+    long long customerCount = std::max(1LL, attemptCount / 2);
+    int stock = static_cast<int>(std::min<long long>(attemptCount / 4, std::numeric_limits<int>::max()));
+    std::vector<Customer> customers;
+    customers.reserve(customerCount);
+    for (long long i = 0; i < customerCount; ++i) {
+        char id[32];   // room for any long long
+        std::snprintf(id, sizeof(id), "CustID%010lld", 1000000000LL + i);
+        customers.push_back(Customer::prevalidated(id, "U000bench", "Bench", "Customer", 30, "1000-0000-0000",
+                                                   startingPoints));
+    }
+    DataStore store(std::move(customers), {}, {Gift("Concert Ticket", requiredPoints, stock)});
+
+    std::atomic<long long> attempts{0}, redeemed{0}, soldOut{0}, insufficient{0};
+    std::atomic<long long> attemptsAtSellOut{-1};
+    std::chrono::steady_clock::time_point sellOutTime;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 gen(t + 1);
+            for (long long i = t; i < attemptCount; i += threadCount) {
+                std::size_t position = gen() % customerCount;
+                attempts++;
+                if (!store.read().readGifts()[0].isInStock()) {
+                    soldOut++;   // refused under the shared lock, as RewardService::redeem does
+                    continue;
+                }
+                else {
+                    // do nothing
+                }
+                try {
+                    auto state = store.write();
+                    Gift gift = state.redeemGift(state.customers()[position], 1, {});
+                    redeemed++;
+                    if (gift.getStock() == 0) {
+                        sellOutTime = std::chrono::steady_clock::now();
+                        attemptsAtSellOut = attempts.load();
+                    }
+                    else {
+                        // do nothing
+                    }
+                } catch (const std::invalid_argument& e) {
+                    (std::string(e.what()).find("stock") != std::string::npos ? soldOut : insufficient)++;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << "Redeemed " << redeemed << " of " << stock << " units in " << attemptCount << " attempts on "
+              << threadCount << " threads (" << insufficient << " lacked the points, " << soldOut
+              << " found it sold out).\n";
+    if (attemptsAtSellOut >= 0) {
+        double before = std::chrono::duration<double>(sellOutTime - start).count();
+        double after = std::chrono::duration<double>(end - sellOutTime).count();
+        std::cout << "While in stock: " << static_cast<long long>(attemptsAtSellOut / before)
+                  << " attempts/s; once sold out: "
+                  << static_cast<long long>((attemptCount - attemptsAtSellOut) / std::max(after, 1e-9))
+                  << " attempts/s.\n";
+    }
+    else {
+        std::cout << "Never sold out: " << static_cast<long long>(
+                         attemptCount / std::chrono::duration<double>(end - start).count())
+                  << " attempts/s.\n";
+    }
+
+    DataStore::ReadGuard state = store.read();
+    long long pointsSpent = 0, negative = 0;
+    for (const Customer& customer : state.readCustomers()) {
+        pointsSpent += startingPoints - customer.getRewardPoints();
+        negative += customer.getRewardPoints() < 0 ? 1 : 0;
+    }
+    int stockLeft = state.readGifts()[0].getStock();
+    bool consistent = stockLeft >= 0 && stock - stockLeft == redeemed && pointsSpent == redeemed * requiredPoints &&
+                      negative == 0;
+    std::cout << "Stock left: " << stockLeft << "; points spent: " << pointsSpent << "; negative balances: "
+              << negative << " -- " << (consistent ? "consistent" : "INCONSISTENT") << ".\n";
+    return consistent;
+}
+
+/**
+ * @brief Schedules point lots on a timing wheel with expiries spread over a year, then advances the wheel an
+ *        hour at a time until every lot has expired, and reports the cost per lot of each step.
+ * 
+ * @param lotCount The number of lots.
+ * @return bool True if every lot expired, and none before its time.
+ */
+bool benchmarkExpiry(Benchmarks::Context&, long long lotCount) {
+    const std::int64_t start = 1700000000;
+    const std::int64_t year = 365LL * 24 * 3600;
+    std::mt19937 gen(42);
+    std::vector<std::int64_t> expiries(lotCount);
+    for (std::int64_t& expiresAt : expiries) {
+        expiresAt = start + 1 + static_cast<std::int64_t>(gen() % year);
+    }
+
+    TimingWheel wheel(start);
+    auto scheduleStart = std::chrono::steady_clock::now();
+    for (long long i = 0; i < lotCount; ++i) {
+        wheel.schedule(static_cast<std::uint32_t>(i), expiries[i]);
+    }
+    double scheduleSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - scheduleStart).count();
+
+    std::vector<std::uint32_t> fired;
+    fired.reserve(lotCount);
+    long long early = 0;
+    auto expireStart = std::chrono::steady_clock::now();
+    for (std::int64_t now = start; wheel.size() > 0; ) {
+        now += 3600;
+        std::size_t before = fired.size();
+        wheel.advance(now, fired);
+        for (std::size_t i = before; i < fired.size(); ++i) {
+            early += expiries[fired[i]] > now ? 1 : 0;
+        }
+    }
+    double expireSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - expireStart).count();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "Scheduled " << lotCount << " lots over a year: "
+              << scheduleSeconds * 1e9 / static_cast<double>(lotCount) << " ns per lot.\n"
+              << "Expired them an hour at a time: " << expireSeconds * 1e9 / static_cast<double>(lotCount)
+              << " ns per lot (" << fired.size() << " fired, " << early << " early).\n" << std::defaultfloat;
+    return early == 0 && static_cast<long long>(fired.size()) == lotCount;
+}
+
+/**
+ * @brief Times velocity checks of checkouts spread over 1000, then 100000, customers, with limits high enough that
+ *        none is refused, then checks that a low order limit refuses and later readmits one customer.
+ * 
+ * @param checkCount The number of checkouts to check.
+ * @return bool True if the low limit refused exactly the one order it should have.
+ */
+bool benchmarkVelocity(Benchmarks::Context&, long long checkCount) {
+    VelocityLimiter::Limits limits;
+    limits.orders = VelocityLimiter::Limit{1000000000, 3600};
+    limits.spend = VelocityLimiter::Limit{CustomerTotals::toCents(1e12), 24 * 3600};
+    std::vector<std::string> customerIDs;
+    for (long long i = 0; i < 100000; ++i) {
+        customerIDs.push_back("CustID" + std::to_string(i));
+    }
+
+    // A few regulars whose counters stay in cache, then a crowd whose counters mostly do not
+    for (std::size_t customerCount : {std::size_t{1000}, customerIDs.size()}) {
+        VelocityLimiter limiter;
+        for (std::size_t c = 0; c < customerCount; ++c) {
+            limiter.admitCheckout(customerIDs[c], 100, limits, 0);
+        }
+        std::mt19937 gen(5);
+        std::int64_t nowMillis = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < checkCount; ++i) {
+            nowMillis += 1 + gen() % 20;   // a few hundred checkouts a second, over hours of simulated time
+            limiter.admitCheckout(customerIDs[gen() % customerCount], 100 + gen() % 50000, limits, nowMillis);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::fixed << std::setprecision(1)
+                  << "Checked " << checkCount << " checkouts of " << customerCount << " customers: "
+                  << seconds * 1e9 / static_cast<double>(checkCount) << " ns per check.\n" << std::defaultfloat;
+    }
+
+    VelocityLimiter::Limits low;
+    low.orders = VelocityLimiter::Limit{3, 60};
+    VelocityLimiter single;
+    int admitted = 0;
+    for (std::int64_t at : {0, 1000, 2000, 3000, 62000}) {
+        try {
+            single.admitCheckout(customerIDs[0], 100, low, at);
+            admitted++;
+        } catch (const std::invalid_argument&) {
+            // the fourth order is refused
+        }
+    }
+
+    std::cout << "Limit of 3 orders a minute: " << admitted << " of 5 admitted -- "
+              << (admitted == 4 ? "correct" : "WRONG") << ".\n";
+    return admitted == 4;
+}
+
+} // namespace
+
+/**
+ * @brief Retrieves every benchmark, in the order selfCheck() runs them.
+ *
+ * @return const std::vector<Benchmarks::Entry>& The table.
+ */
+const std::vector<Benchmarks::Entry>& Benchmarks::all() {
+    static const std::vector<Entry> table = {
+        {"rules", "CARTS", 20000, benchmarkRules},
+        {"config", "READS", 20000, benchmarkConfig},
+        {"validate", "VALUES", 5000, benchmarkValidator},
+        {"search", "PRODUCTS", 2000, benchmarkSearch},
+        {"index", "CUSTOMERS", 5000, benchmarkCustomerIndex},
+        {"stock", "PRODUCTS", 2000, benchmarkStock},
+        {"layout", "CUSTOMERS", 2000, benchmarkCustomerLayout},
+        {"redeem", "ATTEMPTS", 20000, benchmarkRedemption},
+        {"expiry", "LOTS", 20000, benchmarkExpiry},
+        {"velocity", "CHECKS", 20000, benchmarkVelocity},
+    };
+    return table;
+}
+
+/**
+ * @brief Finds a benchmark by name.
+ *
+ * @param name The name, without the "--bench-" prefix.
+ * @return const Benchmarks::Entry* The benchmark, or nullptr if there is none by that name.
+ */
+const Benchmarks::Entry* Benchmarks::find(const std::string& name) {
+    for (const Entry& entry : all()) {
+        if (name == entry.name) {
+            return &entry;
+        }
+        else {
+            // do nothing
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Builds the usage text of the benchmark options.
+ *
+ * @return std::string One " [--bench-<name> <ARGUMENT>]" per benchmark.
+ */
+std::string Benchmarks::usage() {
+    std::string text;
+    for (const Entry& entry : all()) {
+        text += std::string(" [--bench-") + entry.name + " " + entry.argument + "]";
+    }
+    return text;
+}
+
+/**
+ * @brief Runs one benchmark, then restores the std::cout formatting it changed, so the next one prints as it
+ *        would on its own.
+ *
+ * @param entry The benchmark.
+ * @param context The loaded program.
+ * @param size How many items the benchmark works on.
+ * @return bool False if the benchmark's self-check failed.
+ */
+bool Benchmarks::run(const Entry& entry, Context& context, long long size) {
+    std::ios::fmtflags flags = std::cout.flags();
+    std::streamsize precision = std::cout.precision();
+    bool passed = entry.run(context, size);
+    std::cout.flags(flags);
+    std::cout.precision(precision);
+    return passed;
+}
+
+/**
+ * @brief Runs every benchmark at its check size, and lists the ones whose self-check failed.
+ *
+ * @param context The loaded program.
+ * @return bool True if every self-check held.
+ */
+bool Benchmarks::selfCheck(Context& context) {
+    std::vector<std::string> failed;
+    for (const Entry& entry : all()) {
+        std::cout << "--- " << entry.name << " (" << entry.checkSize << ")\n";
+        if (!run(entry, context, entry.checkSize)) {
+            failed.push_back(entry.name);
+        }
+        else {
+            // do nothing
+        }
+    }
+    if (failed.empty()) {
+        std::cout << "All " << all().size() << " benchmark self-checks passed.\n";
+    }
+    else {
+        std::cout << "Failed self-checks:";
+        for (const std::string& name : failed) {
+            std::cout << " " << name;
+        }
+        std::cout << "\n";
+    }
+    return failed.empty();
+}
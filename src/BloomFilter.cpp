@@ -0,0 +1,100 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "BloomFilter.h"
+#include <functional>
+
+namespace {
+
+// Odd multipliers that spread the key hash over the eight words of a block (same salts as Parquet's
+// split-block Bloom filter).
+constexpr std::uint32_t SALTS[8] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+// Finalizer from MurmurHash3; std::hash<std::string> is not guaranteed to mix well in every bit.
+std::uint64_t mix(std::uint64_t h) {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+} // namespace
+
+/**
+ * @brief Constructor for the BloomFilter class.
+ *
+ * @param expectedItems The number of keys the filter is sized for.
+ * @param bitsPerItem Filter bits budgeted per expected key.
+ */
+BloomFilter::BloomFilter(std::size_t expectedItems, double bitsPerItem)
+    : capacity(0), itemCount(0), bitsPerItem(bitsPerItem) {
+    reset(expectedItems);
+}
+
+/**
+ * @brief Removes every key and resizes the filter for a new expected key count.
+ *
+ * @param expectedItems The number of keys the filter is sized for.
+ */
+void BloomFilter::reset(std::size_t expectedItems) {
+    capacity = expectedItems > 0 ? expectedItems : 1;
+    std::size_t bits = static_cast<std::size_t>(capacity * bitsPerItem);
+    std::size_t blockCount = bits / (sizeof(Block) * 8) + 1;
+
+    blocks.assign(blockCount, Block{});
+    itemCount = 0;
+}
+
+/**
+ * @brief Hashes a key and selects its block.
+ *
+ * @param key The key to hash.
+ * @param hash Receives the 64-bit hash of the key.
+ * @return std::size_t The index of the key's block.
+ */
+std::size_t BloomFilter::locate(const std::string& key, std::uint64_t& hash) const {
+    hash = mix(std::hash<std::string>{}(key));
+    // Multiply-shift maps the high 32 bits onto [0, blocks.size()) without a division
+    return static_cast<std::size_t>(((hash >> 32) * static_cast<std::uint64_t>(blocks.size())) >> 32);
+}
+
+/**
+ * @brief Adds a key to the filter.
+ *
+ * @param key The key to add.
+ */
+void BloomFilter::insert(const std::string& key) {
+    std::uint64_t hash;
+    Block& block = blocks[locate(key, hash)];
+    std::uint32_t low = static_cast<std::uint32_t>(hash);
+
+    for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+        block.words[i] |= 1U << ((low * SALTS[i]) >> 27);
+    }
+    ++itemCount;
+}
+
+/**
+ * @brief Checks whether a key may have been added to the filter.
+ *
+ * @param key The key to look up.
+ * @return bool False if the key was definitely never inserted, true if it might have been.
+ */
+bool BloomFilter::mightContain(const std::string& key) const {
+    std::uint64_t hash;
+    const Block& block = blocks[locate(key, hash)];
+    std::uint32_t low = static_cast<std::uint32_t>(hash);
+
+    for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+        if ((block.words[i] & (1U << ((low * SALTS[i]) >> 27))) == 0) {
+            return false;
+        }
+        else {
+            // do nothing
+        }
+    }
+    return true;
+}
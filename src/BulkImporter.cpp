@@ -0,0 +1,406 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "BulkImporter.h"
+#include "BatchValidator.h"
+#include "BloomFilter.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+constexpr std::size_t CHUNK_ROWS = 1 << 16;   // rows held in memory at once
+constexpr int FIELD_COUNT = 5;
+constexpr unsigned long long MAX_CUSTOMER_NUMBER = 9999999999ULL;   // Customer IDs have 10 digits
+
+/**
+ * @brief One CSV row on its way through validation.
+ */
+struct ImportRow {
+    std::size_t lineNumber = 0;
+    std::string text;
+    std::string fields[FIELD_COUNT];   // username, first name, last name, age, credit card
+    int age = 0;
+    const char* reason = nullptr;      // null while the row is still valid
+};
+
+/**
+ * @brief Bloom-filter-fronted exact set used to deduplicate usernames and credit cards.
+ */
+class UniqueKeys {
+public:
+    explicit UniqueKeys(std::size_t expectedItems) : filter(expectedItems) {
+        exact.reserve(expectedItems);
+    }
+
+    /**
+     * @brief Checks for a key, asking the exact set only when the filter cannot rule it out.
+     * @return bool True if the key is present.
+     */
+    bool contains(const std::string& key, ImportReport& report) const {
+        if (filter.mightContain(key)) {
+            if (exact.find(key) != exact.end()) {
+                return true;
+            }
+            else {
+                report.falsePositives++;
+            }
+        }
+        else {
+            report.filterRejects++;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Adds a key unless it is already present.
+     * @return bool True if the key was new, false if it is a duplicate.
+     */
+    bool insert(const std::string& key, ImportReport& report) {
+        if (contains(key, report)) {
+            return false;
+        }
+        else {
+            add(key);
+            return true;
+        }
+    }
+
+    /**
+     * @brief Adds a key known not to be present.
+     */
+    void add(const std::string& key) {
+        exact.insert(key);
+        if (exact.size() > filter.getCapacity()) {
+            // The size estimate was too low; regrow so the false-positive rate stays bounded
+            filter.reset(filter.getCapacity() * 2);
+            for (const auto& existing : exact) {
+                filter.insert(existing);
+            }
+        }
+        else {
+            filter.insert(key);
+        }
+    }
+
+private:
+    BloomFilter filter;
+    std::unordered_set<std::string> exact;
+};
+
+/**
+ * @brief Removes leading and trailing whitespace (including the '\r' of CRLF files).
+ */
+std::string trim(const std::string& text, std::size_t begin, std::size_t end) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(text[begin]))) {
+        ++begin;
+    }
+    while (end > begin && std::isspace(static_cast<unsigned char>(text[end - 1]))) {
+        --end;
+    }
+    return text.substr(begin, end - begin);
+}
+
+/**
+ * @brief Splits a row into its fields and parses the age.
+ */
+void splitRow(ImportRow& row) {
+    int fieldCount = 0;
+    std::size_t start = 0;
+    while (fieldCount < FIELD_COUNT) {
+        std::size_t comma = row.text.find(',', start);
+        std::size_t end = comma == std::string::npos ? row.text.size() : comma;
+        row.fields[fieldCount++] = trim(row.text, start, end);
+        if (comma == std::string::npos) {
+            break;
+        }
+        else {
+            start = comma + 1;
+        }
+    }
+    if (fieldCount != FIELD_COUNT || row.text.find(',', start) != std::string::npos) {
+        row.reason = "wrong number of fields";
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    const std::string& ageText = row.fields[3];
+    auto [end, error] = std::from_chars(ageText.data(), ageText.data() + ageText.size(), row.age);
+    if (error != std::errc() || end != ageText.data() + ageText.size() || !Customer::isAgeValid(row.age)) {
+        row.age = -1;   // reported after the text fields, in the same order as the Customer checks
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Splits rows [begin, end) and checks them against the Customer rules, one column at a time.
+ */
+void validateRows(std::vector<ImportRow>& rows, std::size_t begin, std::size_t end) {
+    std::vector<std::string_view> columns[FIELD_COUNT];
+    for (auto& column : columns) {
+        column.reserve(end - begin);
+    }
+    for (std::size_t i = begin; i < end; ++i) {
+        splitRow(rows[i]);
+        for (int f = 0; f < FIELD_COUNT; ++f) {
+            columns[f].push_back(rows[i].fields[f]);
+        }
+    }
+
+    BatchValidator::Bitmap userNames = BatchValidator::userNames(columns[0]);
+    BatchValidator::Bitmap firstNames = BatchValidator::names(columns[1]);
+    BatchValidator::Bitmap lastNames = BatchValidator::names(columns[2]);
+    BatchValidator::Bitmap creditCards = BatchValidator::creditCards(columns[4]);
+    for (std::size_t i = begin; i < end; ++i) {
+        ImportRow& row = rows[i];
+        std::size_t k = i - begin;
+        if (row.reason != nullptr) {
+            // do nothing
+        }
+        else if (!BatchValidator::isSet(userNames, k)) {
+            row.reason = "invalid username";
+        }
+        else if (!BatchValidator::isSet(firstNames, k)) {
+            row.reason = "invalid first name";
+        }
+        else if (!BatchValidator::isSet(lastNames, k)) {
+            row.reason = "invalid last name";
+        }
+        else if (row.age < 0) {
+            row.reason = "invalid age";
+        }
+        else if (!BatchValidator::isSet(creditCards, k)) {
+            row.reason = "invalid credit card";
+        }
+        else {
+            // do nothing
+        }
+    }
+}
+
+/**
+ * @brief Runs work(begin, end) over [0, count) split evenly across threads, using the caller as one of them.
+ */
+template <typename Work>
+void parallelFor(std::size_t count, unsigned threadCount, Work work) {
+    std::size_t slice = (count + threadCount - 1) / threadCount;
+    std::vector<std::thread> workers;
+
+    for (unsigned t = 1; t < threadCount && t * slice < count; ++t) {
+        std::size_t begin = t * slice;
+        std::size_t end = std::min(count, begin + slice);
+        workers.emplace_back([&work, begin, end] { work(begin, end); });
+    }
+    work(0, std::min(count, slice));
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Finds the number after the highest numeric Customer ID suffix, so a whole import can be numbered from
+ *        one counter. It may be past MAX_CUSTOMER_NUMBER; numbering then wraps around.
+ */
+unsigned long long nextCustomerNumber(const std::set<std::string>& usedIDs) {
+    unsigned long long highest = 0;
+    for (const auto& id : usedIDs) {
+        if (id.compare(0, 6, "CustID") == 0) {
+            highest = std::max(highest, std::strtoull(id.c_str() + 6, nullptr, 10));
+        }
+        else {
+            // do nothing
+        }
+    }
+    return highest + 1;
+}
+
+} // namespace
+
+/**
+ * @brief Imports customers from a CSV file.
+ *
+ * @param csvFilename The CSV file to import.
+ * @param rejectFilename The file where rejected rows are written.
+ * @param customers The customer list to append imported customers to.
+ * @param usedIDs The set of used Customer IDs; new IDs are added to it.
+ * @param threadCount Number of validation threads, or 0 to use every hardware thread.
+ * @param shardMap The shard the customers are imported into; only IDs it owns are assigned.
+ * @param chunkImported If set, called after each chunk is appended with the position of its first customer.
+ * @return ImportReport Counts, timing and prefilter statistics for the import.
+ * @throws std::runtime_error If the CSV file or the reject file cannot be opened.
+ */
+ImportReport BulkImporter::importCustomers(const std::string& csvFilename, const std::string& rejectFilename,
+                                           std::vector<Customer>& customers, std::set<std::string>& usedIDs,
+                                           unsigned threadCount, const ShardMap& shardMap,
+                                           const std::function<void(std::size_t)>& chunkImported) {
+    TRACE_SPAN("BulkImporter::importCustomers");
+    auto startTime = std::chrono::steady_clock::now();
+
+    std::ifstream csv(csvFilename, std::ios::ate);
+    if (!csv.is_open()) {
+        throw std::runtime_error("Failed to open file for importing customers.");
+    }
+    else {
+        // do nothing
+    }
+    std::ofstream rejects(rejectFilename);
+    if (!rejects.is_open()) {
+        throw std::runtime_error("Failed to open file for writing rejected rows.");
+    }
+    else {
+        // do nothing
+    }
+
+    if (threadCount == 0) {
+        threadCount = std::max(1U, std::thread::hardware_concurrency());
+    }
+    else {
+        // do nothing
+    }
+
+    // Size the dedup filters from the file size; ~40 bytes per row is typical for this format
+    std::size_t estimatedRows = static_cast<std::size_t>(csv.tellg()) / 40 + 1;
+    csv.seekg(0);
+
+    ImportReport report;
+    UniqueKeys usernames(customers.size() + estimatedRows);
+    UniqueKeys creditCards(customers.size() + estimatedRows);
+    for (const auto& customer : customers) {
+        usernames.insert(customer.getUserName(), report);
+        creditCards.insert(customer.getCreditCardNumber(), report);
+    }
+    report.filterRejects = 0;
+    report.falsePositives = 0;
+
+    unsigned long long nextNumber = nextCustomerNumber(usedIDs);
+    bool wrapped = false;   // numbers below nextNumber may then be taken already
+    std::size_t lineNumber = 0;
+    std::vector<ImportRow> rows(CHUNK_ROWS);
+    std::vector<std::size_t> accepted;
+    std::vector<std::string> acceptedIDs;
+    std::vector<std::vector<Customer>> built(threadCount);
+
+    while (csv) {
+        // Read the next chunk
+        std::size_t rowCount = 0;
+        while (rowCount < CHUNK_ROWS && std::getline(csv, rows[rowCount].text)) {
+            ++lineNumber;
+            if (rows[rowCount].text.empty() || (lineNumber == 1 && rows[rowCount].text.compare(0, 8, "username") == 0)) {
+                continue;
+            }
+            else {
+                rows[rowCount].lineNumber = lineNumber;
+                rows[rowCount].reason = nullptr;
+                ++rowCount;
+            }
+        }
+        if (rowCount == 0) {
+            break;
+        }
+        else {
+            report.rowsRead += rowCount;
+        }
+
+        // Validate the chunk in parallel
+        {
+            TRACE_SPAN("BulkImporter::validate");
+            parallelFor(rowCount, threadCount, [&rows](std::size_t begin, std::size_t end) {
+                validateRows(rows, begin, end);
+            });
+        }
+
+        // Deduplicate in file order and number the surviving rows
+        {
+            TRACE_SPAN("BulkImporter::deduplicate");
+            accepted.clear();
+            acceptedIDs.clear();
+            for (std::size_t i = 0; i < rowCount; ++i) {
+                ImportRow& row = rows[i];
+                // Both keys are checked before either is added, so a rejected row claims neither
+                if (row.reason == nullptr && usernames.contains(row.fields[0], report)) {
+                    row.reason = "duplicate username";
+                }
+                else if (row.reason == nullptr && creditCards.contains(row.fields[4], report)) {
+                    row.reason = "duplicate credit card";
+                }
+                else if (row.reason == nullptr) {
+                    usernames.add(row.fields[0]);
+                    creditCards.add(row.fields[4]);
+                }
+                else {
+                    // do nothing
+                }
+
+                if (row.reason != nullptr) {
+                    rejects << row.lineNumber << ',' << row.reason << ',' << row.text << '\n';
+                    ++report.rejected;
+                }
+                else {
+                    char id[32];
+                    do {
+                        if (nextNumber > MAX_CUSTOMER_NUMBER) {
+                            nextNumber = 1;   // past the last 10-digit number: use the unused numbers from the bottom
+                            wrapped = true;
+                        }
+                        else {
+                            // do nothing
+                        }
+                        std::snprintf(id, sizeof(id), "CustID%010llu", nextNumber++);
+                    } while (!shardMap.owns(id) || (wrapped && usedIDs.count(id) != 0));   // other shards', or taken
+                    accepted.push_back(i);
+                    acceptedIDs.emplace_back(id);
+                }
+            }
+        }
+
+        // Build the Customer objects in parallel, then append them in file order
+        {
+            TRACE_SPAN("BulkImporter::build");
+            std::size_t slice = (accepted.size() + threadCount - 1) / threadCount;
+            parallelFor(accepted.size(), threadCount, [&](std::size_t begin, std::size_t end) {
+                std::vector<Customer>& out = built[slice == 0 ? 0 : begin / slice];
+                out.clear();
+                out.reserve(end - begin);
+                for (std::size_t k = begin; k < end; ++k) {
+                    const ImportRow& row = rows[accepted[k]];
+                    out.push_back(Customer::prevalidated(acceptedIDs[k], row.fields[0], row.fields[1],
+                                                         row.fields[2], row.age, row.fields[4], 0));
+                }
+            });
+
+            std::size_t firstNew = customers.size();
+            customers.reserve(customers.size() + accepted.size());
+            for (std::size_t t = 0; t < built.size() && t * slice < accepted.size(); ++t) {
+                for (auto& customer : built[t]) {
+                    customers.push_back(std::move(customer));
+                }
+                built[t].clear();
+            }
+            for (const auto& id : acceptedIDs) {
+                usedIDs.insert(usedIDs.end(), id);
+            }
+            report.imported += accepted.size();
+            if (chunkImported && !accepted.empty()) {
+                chunkImported(firstNew);
+            }
+            else {
+                // do nothing
+            }
+        }
+    }
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return report;
+}
@@ -0,0 +1,466 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "CheckoutPipeline.h"
+#include "FileManager.h"
+#include "Trace.h"
+#include <algorithm>
+#include <ctime>
+#include <future>
+#include <memory>
+#include <stdexcept>
+
+/**
+ * @brief Starts the pipeline threads and the log I/O thread, and has the store queue every log write on it.
+ *
+ * @param store The store to operate on.
+ * @param threadCount Number of threads that run pipeline stages.
+ */
+CheckoutPipeline::CheckoutPipeline(DataStore& store, unsigned threadCount)
+    : store(store), executor(threadCount), log(executor) {
+    store.attachLog(&log);
+}
+
+/**
+ * @brief Detaches the log writer from the store, then stops the threads.
+ */
+CheckoutPipeline::~CheckoutPipeline() {
+    store.attachLog(nullptr);
+}
+
+/**
+ * @brief The checkout coroutine. Awaiting it runs all stages.
+ *
+ * @param customerID The unique identifier of the buying customer.
+ * @param cart Pairs of Product ID and quantity. Applied completely or not at all.
+ * @param config The accrual rules and limits the cart is checked out under.
+ * @return Task<Receipt> Produces the total cost and points earned.
+ * @throws std::invalid_argument If the cart is empty, the customer or a product is unknown, or a quantity
+ *         is not in stock.
+ */
+Task<Receipt> CheckoutPipeline::checkout(std::string customerID, Cart cart, std::shared_ptr<const RewardConfig> config) {
+    if (cart.empty()) {
+        throw std::invalid_argument("Cart is empty.");   // it would still count against the velocity limits
+    }
+    else {
+        // do nothing
+    }
+    co_await executor.schedule();   // leave the caller's thread; it may be a socket worker with more to do
+
+    co_await validateCustomer(customerID, cart, *config);
+    std::vector<ResolvedLine> lines = co_await resolveProducts(cart);
+    Committed committed = commit(customerID, cart, lines, *config);
+
+    co_await log.flushed(committed.ticket);   // suspends; the thread picks up another checkout meanwhile
+    co_return committed.receipt;
+}
+
+/**
+ * @brief Starts a checkout without waiting for it.
+ *
+ * @param done Called on a pipeline thread with the receipt, or with the exception that rejected the cart.
+ */
+void CheckoutPipeline::submit(std::string customerID, Cart cart, std::shared_ptr<const RewardConfig> config,
+                              std::function<void(std::optional<Receipt>, std::exception_ptr)> done) {
+    startTask(checkout(std::move(customerID), std::move(cart), std::move(config)), std::move(done));
+}
+
+/**
+ * @brief Runs a checkout and blocks the calling thread until it completes.
+ *
+ * @return Receipt The total cost and points earned.
+ * @throws std::invalid_argument If the cart is empty, the customer or a product is unknown, or a quantity
+ *         is not in stock.
+ */
+Receipt CheckoutPipeline::run(std::string customerID, Cart cart, std::shared_ptr<const RewardConfig> config) {
+    auto result = std::make_shared<std::promise<Receipt>>();
+    std::future<Receipt> future = result->get_future();
+    submit(std::move(customerID), std::move(cart), std::move(config),
+           [result](std::optional<Receipt> receipt, std::exception_ptr error) {
+               if (error) {
+                   result->set_exception(error);
+               }
+               else {
+                   result->set_value(*receipt);
+               }
+           });
+    return future.get();
+}
+
+/**
+ * @brief The batch checkout coroutine: applies many carts under one WriteGuard and logs them with one write.
+ *
+ * @param orders The carts, applied in order. A rejected cart does not affect the others.
+ * @param config The accrual rules and limits the cart is checked out under.
+ * @return Task<std::vector<BatchOutcome>> Produces one outcome per order, in order.
+ */
+Task<std::vector<BatchOutcome>> CheckoutPipeline::checkoutBatch(std::vector<CartOrder> orders,
+                                                                std::shared_ptr<const RewardConfig> config) {
+    co_await executor.schedule();
+
+    CommittedBatch committed = commitBatch(orders, *config);
+    if (committed.ticket != 0) {
+        co_await log.flushed(committed.ticket);
+    }
+    else {
+        // do nothing
+    }
+    co_return std::move(committed.outcomes);
+}
+
+/**
+ * @brief Runs a batch checkout and blocks the calling thread until its records are in the log.
+ *
+ * @return std::vector<BatchOutcome> One outcome per order, in order.
+ */
+std::vector<BatchOutcome> CheckoutPipeline::runBatch(std::vector<CartOrder> orders,
+                                                     std::shared_ptr<const RewardConfig> config) {
+    auto result = std::make_shared<std::promise<std::vector<BatchOutcome>>>();
+    std::future<std::vector<BatchOutcome>> future = result->get_future();
+    auto done = [result](std::optional<std::vector<BatchOutcome>> outcomes, std::exception_ptr error) {
+        if (error) {
+            result->set_exception(error);
+        }
+        else {
+            result->set_value(std::move(*outcomes));
+        }
+    };
+    startTask<std::vector<BatchOutcome>>(checkoutBatch(std::move(orders), std::move(config)), done);
+    return future.get();
+}
+
+/**
+ * @brief Stage 1: rejects carts over the configured limits, and unknown customers under the shared lock.
+ *
+ * @param customerID The unique identifier of the buying customer.
+ * @param cart Pairs of Product ID and quantity.
+ * @param config The configuration whose limits apply.
+ * @throws std::invalid_argument If the cart is over a limit or there is no such customer.
+ */
+Task<void> CheckoutPipeline::validateCustomer(const std::string& customerID, const Cart& cart,
+                                              const RewardConfig& config) {
+    TRACE_SPAN("checkout.validateCustomer");
+    config.checkLimits(cart);
+    if (!store.read().findCustomer(customerID)) {
+        throw std::invalid_argument("Customer not found.");
+    }
+    else {
+        co_return;
+    }
+}
+
+/**
+ * @brief Stage 2: finds every product and checks the requested quantities under the shared lock.
+ *
+ * @param cart Pairs of Product ID and quantity.
+ * @return Task<std::vector<ResolvedLine>> Produces the product position and price of each line.
+ * @throws std::invalid_argument If a product is unknown or a quantity is not in stock.
+ */
+Task<std::vector<CheckoutPipeline::ResolvedLine>> CheckoutPipeline::resolveProducts(const Cart& cart) {
+    TRACE_SPAN("checkout.resolveProducts");
+    auto state = store.read();
+    const std::vector<Product>& products = state.readProducts();
+    std::vector<ResolvedLine> lines;
+    std::vector<int> requested(products.size(), 0);
+
+    for (const auto& [productID, quantity] : cart) {
+        auto it = std::find_if(products.begin(), products.end(),
+                               [&productID](const Product& p) { return p.getProductID() == productID; });
+        if (it == products.end()) {
+            throw std::invalid_argument("Invalid Product ID: " + productID);
+        }
+        else {
+            // do nothing
+        }
+
+        std::size_t position = static_cast<std::size_t>(it - products.begin());
+        requested[position] += quantity;
+        if (quantity <= 0 || requested[position] > it->getProductInventory()) {
+            throw std::invalid_argument("Invalid quantity for " + productID + ".");
+        }
+        else {
+            lines.push_back(ResolvedLine{position, it->getProductPrice()});
+        }
+    }
+    co_return lines;
+}
+
+/**
+ * @brief Stages 3 to 5 and the start of 6, under one WriteGuard: reserve stock, price the cart, accrue points
+ *        and queue the log record.
+ *
+ * The earlier stages ran under the shared lock, so another writer may have changed the lists since. Each
+ * line is re-checked against the current product list before anything is applied.
+ *
+ * @return Committed The receipt and the log ticket to await.
+ * @throws std::invalid_argument If the cart is no longer valid.
+ */
+CheckoutPipeline::Committed CheckoutPipeline::commit(const std::string& customerID, const Cart& cart,
+                                                     std::vector<ResolvedLine>& lines, const RewardConfig& config) {
+    TRACE_SPAN("checkout.commit");
+    auto state = store.write();
+    Customer* customer = state.findCustomer(customerID);
+    if (customer == nullptr) {
+        throw std::invalid_argument("Customer not found.");
+    }
+    else {
+        // do nothing
+    }
+
+    // Reserve stock: confirm every line still fits before changing anything
+    const std::vector<Product>& current = state.readProducts();
+    std::vector<int> requested(current.size(), 0);
+    double cost = 0.0;
+    for (std::size_t i = 0; i < cart.size(); ++i) {
+        const std::string& productID = cart[i].first;
+        if (lines[i].position >= current.size() || current[lines[i].position].getProductID() != productID) {
+            // A product was added or removed since resolveProducts; find it again
+            auto it = std::find_if(current.begin(), current.end(),
+                                   [&productID](const Product& p) { return p.getProductID() == productID; });
+            if (it == current.end()) {
+                throw std::invalid_argument("Invalid Product ID: " + productID);
+            }
+            else {
+                lines[i].position = static_cast<std::size_t>(it - current.begin());
+            }
+        }
+        else {
+            // do nothing
+        }
+        requested[lines[i].position] += cart[i].second;
+        if (requested[lines[i].position] > current[lines[i].position].getProductInventory()) {
+            throw std::invalid_argument("Invalid quantity for " + productID + ".");
+        }
+        else {
+            cost += current[lines[i].position].getProductPrice() * cart[i].second;
+        }
+    }
+    // Last check, since it counts the checkout once it passes
+    if (config.getVelocityLimits().any()) {
+        state.velocity().admitCheckout(customerID, CustomerTotals::toCents(cost), config.getVelocityLimits(),
+                                       VelocityLimiter::nowMillis());
+    }
+    else {
+        // do nothing
+    }
+    std::vector<Product>& products = state.products();
+    for (std::size_t i = 0; i < cart.size(); ++i) {
+        state.updateInventory(products[lines[i].position], -cart[i].second);
+    }
+
+    // Price at the current prices, then accrue points
+    Committed committed;
+    std::vector<PricedLine> priced;
+    priced.reserve(cart.size());
+    for (std::size_t i = 0; i < cart.size(); ++i) {
+        double price = products[lines[i].position].getProductPrice();
+        committed.receipt.totalCost += price * cart[i].second;
+        priced.push_back(PricedLine{cart[i].first, price, cart[i].second});
+    }
+    const CustomerTotals* totals = state.customerTotals(customerID);
+    committed.receipt.rewardPoints = config.withLoyaltyBonus(config.getRules().points(priced, customer->getAge()),
+                                                             totals == nullptr ? 0 : totals->getSpendCents());
+    std::int64_t now = std::time(nullptr);
+    std::int64_t expiresAt = config.expiryFor(now);
+    state.addRewardPoints(*customer, committed.receipt.rewardPoints, expiresAt);
+    state.recordPurchase(*customer, committed.receipt.totalCost, now);
+
+    // Queue the record in sequence order; the write itself happens after the guard is gone
+    committed.ticket = log.enqueue(FileManager::formatTransaction(state.nextSequence(), customerID, cart,
+                                                                  committed.receipt.totalCost,
+                                                                  committed.receipt.rewardPoints, expiresAt, now));
+    return committed;
+}
+
+/**
+ * @brief Applies a batch of carts under one WriteGuard and queues all of their records as one log write.
+ *
+ * The distinct customer and product IDs of the whole batch are sorted once, and each list is then scanned a
+ * single time, looking every element up in the sorted IDs, instead of one linear search per cart line. Carts
+ * are then checked and applied in order against the running inventory, so two carts competing for the last
+ * units behave exactly as if they had been checked out one after the other.
+ *
+ * @param orders The carts, applied in order.
+ * @param config The accrual rules and limits the cart is checked out under.
+ * @return CommittedBatch One outcome per order, and the log ticket to await.
+ */
+CheckoutPipeline::CommittedBatch CheckoutPipeline::commitBatch(const std::vector<CartOrder>& orders,
+                                                               const RewardConfig& config) {
+    TRACE_SPAN("checkout.commitBatch");
+    constexpr std::size_t NOT_FOUND = static_cast<std::size_t>(-1);
+
+    // Distinct IDs of the batch, sorted, so each element of a list needs one binary search
+    std::vector<std::string> customerIDs, productIDs;
+    for (const CartOrder& order : orders) {
+        customerIDs.push_back(order.customerID);
+        for (const auto& line : order.cart) {
+            productIDs.push_back(line.first);
+        }
+    }
+    auto sortUnique = [](std::vector<std::string>& ids) {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    };
+    sortUnique(customerIDs);
+    sortUnique(productIDs);
+    auto rank = [](const std::vector<std::string>& ids, const std::string& id) {
+        auto it = std::lower_bound(ids.begin(), ids.end(), id);
+        return it != ids.end() && *it == id ? static_cast<std::size_t>(it - ids.begin()) : NOT_FOUND;
+    };
+
+    auto state = store.write();
+
+    // One pass over each list: position of every batch ID in the store's lists
+    std::vector<std::size_t> customerPositions(customerIDs.size(), NOT_FOUND);
+    const std::vector<Customer>& inMemory = state.readCustomers();
+    for (std::size_t i = 0; i < inMemory.size(); ++i) {
+        std::size_t r = rank(customerIDs, inMemory[i].getCustomerID());
+        if (r != NOT_FOUND) {
+            customerPositions[r] = i;
+        }
+        else {
+            // do nothing
+        }
+    }
+    for (std::size_t r = 0; r < customerIDs.size(); ++r) {
+        if (customerPositions[r] == NOT_FOUND) {
+            // Not in memory: lazy mode may still have it in the base file
+            try {
+                const Customer* loaded = state.findCustomer(customerIDs[r]);
+                if (loaded != nullptr) {
+                    customerPositions[r] = static_cast<std::size_t>(loaded - state.readCustomers().data());
+                }
+                else {
+                    // do nothing
+                }
+            } catch (const std::invalid_argument&) {
+                // a corrupt base record counts as an unknown customer
+            } catch (const std::runtime_error&) {
+                // and so does a truncated one
+            }
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    std::vector<std::size_t> productPositions(productIDs.size(), NOT_FOUND);
+    const std::vector<Product>& currentProducts = state.readProducts();
+    for (std::size_t i = 0; i < currentProducts.size(); ++i) {
+        std::size_t r = rank(productIDs, currentProducts[i].getProductID());
+        if (r != NOT_FOUND) {
+            productPositions[r] = i;
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    // Apply the carts in order; the lists are only detached once something is actually applied
+    CommittedBatch committed;
+    committed.outcomes.resize(orders.size());
+    std::vector<Customer>* customers = nullptr;
+    std::vector<Product>* products = nullptr;
+    std::vector<int> requested(productIDs.size(), 0);   // per cart, indexed by product rank
+    std::vector<std::size_t> lineRanks;
+    std::vector<PricedLine> priced;
+    std::string records;
+    std::uint64_t recordCount = 0;
+    std::int64_t now = std::time(nullptr);
+    std::int64_t expiresAt = config.expiryFor(now);   // one lot time for the whole batch
+    const VelocityLimiter::Limits& limits = config.getVelocityLimits();
+    std::int64_t nowMillis = limits.any() ? VelocityLimiter::nowMillis() : 0;
+
+    for (std::size_t o = 0; o < orders.size(); ++o) {
+        const CartOrder& order = orders[o];
+        BatchOutcome& outcome = committed.outcomes[o];
+        std::size_t customerPosition = customerPositions[rank(customerIDs, order.customerID)];
+        if (order.cart.empty()) {
+            outcome.error = "Cart is empty.";
+            continue;
+        }
+        else if (customerPosition == NOT_FOUND) {
+            outcome.error = "Customer not found.";
+            continue;
+        }
+        else {
+            try {
+                config.checkLimits(order.cart);
+            } catch (const std::invalid_argument& e) {
+                outcome.error = e.what();
+                continue;
+            }
+        }
+
+        const std::vector<Product>& stock = products != nullptr ? *products : state.readProducts();
+        lineRanks.clear();
+        double cost = 0.0;
+        for (const auto& [productID, quantity] : order.cart) {
+            std::size_t r = rank(productIDs, productID);
+            lineRanks.push_back(r);
+            if (productPositions[r] == NOT_FOUND) {
+                outcome.error = "Invalid Product ID: " + productID;
+                break;
+            }
+            else {
+                requested[r] += quantity;
+            }
+            if (quantity <= 0 || requested[r] > stock[productPositions[r]].getProductInventory()) {
+                outcome.error = "Invalid quantity for " + productID + ".";
+                break;
+            }
+            else {
+                cost += stock[productPositions[r]].getProductPrice() * quantity;
+            }
+        }
+        for (std::size_t r : lineRanks) {
+            requested[r] = 0;
+        }
+        if (!outcome.error.empty()) {
+            continue;
+        }
+        else if (limits.any()) {
+            try {
+                state.velocity().admitCheckout(order.customerID, CustomerTotals::toCents(cost), limits, nowMillis);
+            } catch (const std::invalid_argument& e) {
+                outcome.error = e.what();
+                continue;
+            }
+        }
+        else {
+            // do nothing
+        }
+
+        if (products == nullptr) {
+            products = &state.products();
+            customers = &state.customers();
+        }
+        else {
+            // do nothing
+        }
+        Receipt receipt;
+        priced.clear();
+        for (std::size_t i = 0; i < order.cart.size(); ++i) {
+            Product& product = (*products)[productPositions[lineRanks[i]]];
+            state.updateInventory(product, -order.cart[i].second);
+            receipt.totalCost += product.getProductPrice() * order.cart[i].second;
+            priced.push_back(PricedLine{order.cart[i].first, product.getProductPrice(), order.cart[i].second});
+        }
+        Customer& customer = (*customers)[customerPosition];
+        const CustomerTotals* totals = state.customerTotals(order.customerID);
+        receipt.rewardPoints = config.withLoyaltyBonus(config.getRules().points(priced, customer.getAge()),
+                                                       totals == nullptr ? 0 : totals->getSpendCents());
+        state.addRewardPoints(customer, receipt.rewardPoints, expiresAt);
+        state.recordPurchase(customer, receipt.totalCost, now);
+        records += FileManager::formatTransaction(state.nextSequence(), order.customerID, order.cart,
+                                                  receipt.totalCost, receipt.rewardPoints, expiresAt, now);
+        recordCount++;
+        outcome.receipt = receipt;
+    }
+
+    if (!records.empty()) {
+        committed.ticket = log.enqueue(std::move(records), recordCount);
+    }
+    else {
+        // do nothing
+    }
+    return committed;
+}
@@ -0,0 +1,92 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "ConfigWatcher.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+/**
+ * @brief Starts watching.
+ *
+ * @param filename The file to watch. It does not have to exist yet.
+ * @param changed Called on the watcher thread with the time the change was noticed.
+ * @throws std::runtime_error If inotify is not available.
+ */
+ConfigWatcher::ConfigWatcher(const std::string& filename,
+                             std::function<void(std::chrono::steady_clock::time_point)> changed)
+    : changed(std::move(changed)) {
+    std::filesystem::path path(filename);
+    name = path.filename().string();
+    std::string directory = path.has_parent_path() ? path.parent_path().string() : ".";
+
+    inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    stopFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (inotifyFd < 0 || stopFd < 0 ||
+        ::inotify_add_watch(inotifyFd, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+        std::string reason = std::strerror(errno);
+        if (inotifyFd >= 0) ::close(inotifyFd);
+        if (stopFd >= 0) ::close(stopFd);
+        throw std::runtime_error("Cannot watch " + filename + " (" + reason + ")");
+    }
+    else {
+        thread = std::thread(&ConfigWatcher::runLoop, this);
+    }
+}
+
+/**
+ * @brief Stops the watcher thread.
+ */
+ConfigWatcher::~ConfigWatcher() {
+    std::uint64_t one = 1;
+    ssize_t written = ::write(stopFd, &one, sizeof(one));
+    (void)written;
+    thread.join();
+    ::close(inotifyFd);
+    ::close(stopFd);
+}
+
+/**
+ * @brief Watcher thread: waits for directory events and reports the ones that name the watched file.
+ */
+void ConfigWatcher::runLoop() {
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+    alignas(inotify_event) char buffer[4096];
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            continue;   // interrupted by a signal
+        }
+        else if (fds[1].revents != 0) {
+            return;
+        }
+        else {
+            // do nothing
+        }
+
+        auto noticed = std::chrono::steady_clock::now();
+        bool matched = false;
+        ssize_t length;
+        while ((length = ::read(inotifyFd, buffer, sizeof(buffer))) > 0) {
+            for (ssize_t offset = 0; offset < length;) {
+                const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+                if (event->len > 0 && name == event->name) {
+                    matched = true;
+                }
+                else {
+                    // do nothing
+                }
+                offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+            }
+        }
+        if (matched) {
+            changed(noticed);   // several events from one save are reported once
+        }
+        else {
+            // do nothing
+        }
+    }
+}
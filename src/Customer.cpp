@@ -1,7 +1,73 @@
 // Dyar Jankir, Caden Dye, Arthas Lee
 #include "Customer.h"
+#include "Trace.h"
+#include <cstring>
 #include <regex>
 
+namespace {
+
+/**
+ * @brief Splits a Customer ID of the form "CustID" and 1 to 19 digits into its number and digit count.
+ * @return bool False if the ID has another form.
+ */
+bool parseCustomerID(const std::string& customerID, std::uint64_t& number, std::uint8_t& digits) {
+    if (customerID.size() < 7 || customerID.size() > 25 || customerID.compare(0, 6, "CustID") != 0) {
+        return false;
+    }
+    else {
+        // do nothing
+    }
+    number = 0;
+    for (std::size_t i = 6; i < customerID.size(); ++i) {
+        if (customerID[i] < '0' || customerID[i] > '9') {
+            return false;
+        }
+        else {
+            number = number * 10 + static_cast<std::uint64_t>(customerID[i] - '0');
+        }
+    }
+    digits = static_cast<std::uint8_t>(customerID.size() - 6);
+    return true;
+}
+
+/**
+ * @brief Packs a card number of the form "dddd-dddd-dddd" into its 12 digits.
+ * @return bool False if the card number has another form.
+ */
+bool packCardNumber(const std::string& creditCard, std::uint64_t& number) {
+    if (creditCard.size() != 14 || creditCard[4] != '-' || creditCard[9] != '-') {
+        return false;
+    }
+    else {
+        // do nothing
+    }
+    number = 0;
+    for (std::size_t i = 0; i < creditCard.size(); ++i) {
+        if (i == 4 || i == 9) {
+            continue;
+        }
+        else if (creditCard[i] < '0' || creditCard[i] > '9') {
+            return false;
+        }
+        else {
+            number = number * 10 + static_cast<std::uint64_t>(creditCard[i] - '0');
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a number as a fixed count of digits, right to left, keeping its leading zeros.
+ */
+void writeDigits(char* end, std::uint64_t number, std::size_t digits) {
+    for (std::size_t i = 0; i < digits; ++i) {
+        *--end = static_cast<char>('0' + number % 10);
+        number /= 10;
+    }
+}
+
+} // namespace
+
 /**
  * @brief Constructor for the Customer class with validation checks.
  * 
@@ -17,20 +83,144 @@
  */
 Customer::Customer(const std::string& customerID, const std::string& userName, const std::string& firstName,
                    const std::string& lastName, int age, const std::string& creditCardNumber, int rewardPoints)
-                   : customerID(customerID), rewardPoints(rewardPoints) {
-    if (!isUserNameValid(userName) || !isNameValid(firstName) || !isNameValid(lastName) ||
-        !isAgeValid(age) || !isCreditCardValid(creditCardNumber)) {
+                   : rewardPoints(rewardPoints) {
+    TRACE_SPAN("Customer::Customer");
+    bool valid;
+    {
+        TRACE_SPAN("Customer::validate");
+        valid = isUserNameValid(userName) && isNameValid(firstName) && isNameValid(lastName) &&
+                isAgeValid(age) && isCreditCardValid(creditCardNumber);
+    }
+    if (!valid) {
         throw std::invalid_argument("Invalid customer data provided.");
     }
     else {
         // do nothing
     }
-    
-    this->userName = userName;
-    this->firstName = firstName;
-    this->lastName = lastName;
-    this->age = age;
-    this->creditCardNumber = creditCardNumber;
+
+    assign(customerID, userName, firstName, lastName, age, creditCardNumber);
+}
+
+
+/**
+ * @brief Creates a customer whose fields were already checked, e.g. by BatchValidator.
+ * 
+ * Bulk loads validate whole columns at once and use this to skip the per-record checks of the constructor.
+ * 
+ * @return Customer The customer, built without validating again.
+ */
+Customer Customer::prevalidated(const std::string& customerID, const std::string& userName,
+                                const std::string& firstName, const std::string& lastName, int age,
+                                const std::string& creditCardNumber, int rewardPoints) {
+    Customer customer;
+    customer.assign(customerID, userName, firstName, lastName, age, creditCardNumber);
+    customer.rewardPoints = rewardPoints;
+    return customer;
+}
+
+
+/**
+ * @brief Packs the fields into the compact form, moving any that do not fit into the overflow.
+ * 
+ * The age is stored in a byte; every age isAgeValid accepts fits.
+ */
+void Customer::assign(const std::string& customerID, const std::string& userName, const std::string& firstName,
+                      const std::string& lastName, int age, const std::string& creditCardNumber) {
+    this->age = static_cast<std::uint8_t>(age);
+    overflowFields = 0;
+    overflow.reset();
+    auto spill = [this](std::uint8_t field) -> Overflow& {
+        overflowFields |= field;
+        if (overflow == nullptr) {
+            overflow = std::make_unique<Overflow>();
+        }
+        else {
+            // do nothing
+        }
+        return *overflow;
+    };
+
+    if (!parseCustomerID(customerID, idNumber, idDigits)) {
+        spill(OVERFLOW_ID).customerID = customerID;
+    }
+    else {
+        // do nothing
+    }
+    if (!packCardNumber(creditCardNumber, cardNumber)) {
+        spill(OVERFLOW_CARD).creditCardNumber = creditCardNumber;
+    }
+    else {
+        // do nothing
+    }
+    if (userName.size() <= USER_NAME_CAPACITY) {
+        std::memcpy(this->userName, userName.data(), userName.size());
+        userNameLength = static_cast<std::uint8_t>(userName.size());
+    }
+    else {
+        spill(OVERFLOW_USER_NAME).userName = userName;
+    }
+    // Names are letters only, so the zero padding marks where a shorter name ends
+    if (firstName.size() <= NAME_CAPACITY && firstName.find('\0') == std::string::npos) {
+        std::memcpy(this->firstName, firstName.data(), firstName.size());
+    }
+    else {
+        spill(OVERFLOW_FIRST_NAME).firstName = firstName;
+    }
+    if (lastName.size() <= NAME_CAPACITY && lastName.find('\0') == std::string::npos) {
+        std::memcpy(this->lastName, lastName.data(), lastName.size());
+    }
+    else {
+        spill(OVERFLOW_LAST_NAME).lastName = lastName;
+    }
+}
+
+
+/**
+ * @brief Copies a customer, including any fields kept out of line.
+ * 
+ * @param other The customer to copy.
+ */
+Customer::Customer(const Customer& other)
+    : idNumber(other.idNumber), cardNumber(other.cardNumber),
+      overflow(other.overflow != nullptr ? std::make_unique<Overflow>(*other.overflow) : nullptr),
+      rewardPoints(other.rewardPoints), age(other.age), idDigits(other.idDigits),
+      userNameLength(other.userNameLength), overflowFields(other.overflowFields) {
+    std::memcpy(firstName, other.firstName, NAME_CAPACITY);
+    std::memcpy(lastName, other.lastName, NAME_CAPACITY);
+    std::memcpy(userName, other.userName, USER_NAME_CAPACITY);
+}
+
+
+/**
+ * @brief Copies a customer over this one, including any fields kept out of line.
+ * 
+ * @param other The customer to copy.
+ * @return Customer& This customer.
+ */
+Customer& Customer::operator=(const Customer& other) {
+    if (this != &other) {
+        Customer copy(other);
+        *this = std::move(copy);
+    }
+    else {
+        // do nothing
+    }
+    return *this;
+}
+
+
+/**
+ * @brief Parses a Customer ID once, so it can be matched against many customers.
+ * 
+ * @param customerID The unique identifier of the customer.
+ */
+Customer::IDKey::IDKey(const std::string& customerID) : customerID(customerID) {
+    if (!parseCustomerID(customerID, number, digits)) {
+        digits = 0;
+    }
+    else {
+        // do nothing
+    }
 }
 
 
@@ -42,7 +232,8 @@ Customer::Customer(const std::string& customerID, const std::string& userName, c
  * @return bool Returns true if the username is valid, otherwise false.
  */
 bool Customer::isUserNameValid(const std::string& userName) {
-    return std::regex_match(userName, std::regex("^U\\d{0,3}[A-Za-z0-9]{6,}$"));
+    static const std::regex pattern("^U\\d{0,3}[A-Za-z0-9]{6,}$");
+    return std::regex_match(userName, pattern);
 }
 
 
@@ -53,7 +244,8 @@ bool Customer::isUserNameValid(const std::string& userName) {
  * @return bool Returns true if the name is valid, otherwise false.
  */
 bool Customer::isNameValid(const std::string& name) {
-    return std::regex_match(name, std::regex("^[A-Za-z]{1,12}$"));
+    static const std::regex pattern("^[A-Za-z]{1,12}$");
+    return std::regex_match(name, pattern);
 }
 
 
@@ -77,7 +269,8 @@ bool Customer::isAgeValid(int age) {
  * @return bool Returns true if the credit card number is valid, otherwise false.
  */
 bool Customer::isCreditCardValid(const std::string& creditCard) {
-    return std::regex_match(creditCard, std::regex("^[1-9]\\d{3}-\\d{4}-\\d{4}$"));
+    static const std::regex pattern("^[1-9]\\d{3}-\\d{4}-\\d{4}$");
+    return std::regex_match(creditCard, pattern);
 }
 
 
@@ -86,28 +279,60 @@ bool Customer::isCreditCardValid(const std::string& creditCard) {
  * 
  * @return std::string The unique identifier of the customer.
  */
-std::string Customer::getCustomerID() const { return customerID; }
+std::string Customer::getCustomerID() const {
+    if (overflowFields & OVERFLOW_ID) {
+        return overflow->customerID;
+    }
+    else {
+        char id[25] = {'C', 'u', 's', 't', 'I', 'D'};
+        writeDigits(id + 6 + idDigits, idNumber, idDigits);
+        return std::string(id, 6 + idDigits);
+    }
+}
+
+/**
+ * @brief Checks the customer's ID without building it as a string.
+ * 
+ * @param key The Customer ID to compare with.
+ * @return bool True if this customer has that ID.
+ */
+bool Customer::hasCustomerID(const IDKey& key) const {
+    if (overflowFields & OVERFLOW_ID) {
+        return key.digits == 0 && overflow->customerID == key.customerID;
+    }
+    else {
+        return key.number == idNumber && key.digits == idDigits;
+    }
+}
 
 /**
  * @brief Retrieves the username of the customer.
  * 
  * @return std::string The username of the customer.
  */
-std::string Customer::getUserName() const { return userName; }
+std::string Customer::getUserName() const {
+    return (overflowFields & OVERFLOW_USER_NAME) ? overflow->userName : std::string(userName, userNameLength);
+}
 
 /**
  * @brief Retrieves the first name of the customer.
  * 
  * @return std::string The first name of the customer.
  */
-std::string Customer::getFirstName() const { return firstName; }
+std::string Customer::getFirstName() const {
+    return (overflowFields & OVERFLOW_FIRST_NAME) ? overflow->firstName
+                                                  : std::string(firstName, strnlen(firstName, NAME_CAPACITY));
+}
 
 /**
  * @brief Retrieves the last name of the customer.
  * 
  * @return std::string The last name of the customer.
  */
-std::string Customer::getLastName() const { return lastName; }
+std::string Customer::getLastName() const {
+    return (overflowFields & OVERFLOW_LAST_NAME) ? overflow->lastName
+                                                 : std::string(lastName, strnlen(lastName, NAME_CAPACITY));
+}
 
 /**
  * @brief Retrieves the age of the customer.
@@ -121,7 +346,20 @@ int Customer::getAge() const { return age; }
  * 
  * @return std::string The credit card number of the customer.
  */
-std::string Customer::getCreditCardNumber() const { return creditCardNumber; }
+std::string Customer::getCreditCardNumber() const {
+    if (overflowFields & OVERFLOW_CARD) {
+        return overflow->creditCardNumber;
+    }
+    else {
+        char card[14];
+        writeDigits(card + 14, cardNumber, 4);
+        card[9] = '-';
+        writeDigits(card + 9, cardNumber / 10000, 4);
+        card[4] = '-';
+        writeDigits(card + 4, cardNumber / 100000000, 4);
+        return std::string(card, 14);
+    }
+}
 
 /**
  * @brief Retrieves the reward points of the customer.
@@ -0,0 +1,201 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "CustomerIndex.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+
+namespace {
+
+constexpr std::size_t NAME_ID = std::string::npos;   // scan(): the ID follows the last '\0' of the key
+constexpr std::size_t NUMBER_ID = 4;                 // scan(): the ID follows the four value bytes
+
+std::string lowercase(std::string_view text) {
+    std::string lowered(text);
+    for (char& c : lowered) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lowered;
+}
+
+} // namespace
+
+/**
+ * @brief Builds the name key of a row.
+ *
+ * @param row The indexed fields.
+ * @return std::string The key.
+ */
+std::string CustomerIndex::nameKey(const Row& row) {
+    return lowercase(row.lastName) + '\0' + lowercase(row.firstName) + '\0' + row.customerID;
+}
+
+/**
+ * @brief Builds an age or points key. Flipping the sign bit makes negative values sort first bytewise.
+ *
+ * @param value The age or points.
+ * @param customerID The Customer ID to append; empty for a range bound.
+ * @return std::string The key.
+ */
+std::string CustomerIndex::numberKey(int value, const std::string& customerID) {
+    std::uint32_t bits = static_cast<std::uint32_t>(value) ^ 0x80000000u;
+    std::string key(4, '\0');
+    for (int i = 3; i >= 0; --i) {
+        key[i] = static_cast<char>(bits & 0xFF);
+        bits >>= 8;
+    }
+    return key + customerID;
+}
+
+/**
+ * @brief Builds the indexes for the given customers.
+ *
+ * @param customers The customers to index.
+ */
+CustomerIndex::CustomerIndex(const std::vector<Customer>& customers) {
+    TRACE_SPAN("CustomerIndex::build");
+    rows.reserve(customers.size());
+    for (const Customer& customer : customers) {
+        add(customer);
+    }
+}
+
+/**
+ * @brief Adds a customer to every index.
+ *
+ * @param customer The customer to add.
+ */
+void CustomerIndex::add(const Customer& customer) {
+    remove(customer.getCustomerID());
+    Row row{customer.getCustomerID(), customer.getFirstName(), customer.getLastName(), customer.getAge(),
+            customer.getRewardPoints()};
+    names.insert(nameKey(row));
+    ages.insert(numberKey(row.age, row.customerID));
+    points.insert(numberKey(row.rewardPoints, row.customerID));
+    rows.emplace(row.customerID, std::move(row));
+}
+
+/**
+ * @brief Removes a customer from every index.
+ *
+ * @param customerID The unique identifier of the customer to remove.
+ * @return bool True if the customer was indexed.
+ */
+bool CustomerIndex::remove(const std::string& customerID) {
+    auto found = rows.find(customerID);
+    if (found == rows.end()) {
+        return false;
+    }
+    else {
+        const Row& row = found->second;
+        names.erase(nameKey(row));
+        ages.erase(numberKey(row.age, customerID));
+        points.erase(numberKey(row.rewardPoints, customerID));
+        rows.erase(found);
+        return true;
+    }
+}
+
+/**
+ * @brief Moves a customer to its new place in the points index.
+ *
+ * @param customerID The unique identifier of the customer.
+ * @param rewardPoints The customer's new reward point balance.
+ */
+void CustomerIndex::updatePoints(const std::string& customerID, int rewardPoints) {
+    auto found = rows.find(customerID);
+    if (found == rows.end() || found->second.rewardPoints == rewardPoints) {
+        return;
+    }
+    else {
+        // Reuse the erased node so a balance change does not allocate
+        auto node = points.extract(numberKey(found->second.rewardPoints, customerID));
+        node.value() = numberKey(rewardPoints, customerID);
+        points.insert(std::move(node));
+        found->second.rewardPoints = rewardPoints;
+    }
+}
+
+/**
+ * @brief Walks one index from the start of a range, or from a cursor, collecting up to limit rows.
+ *
+ * @param index The index to walk.
+ * @param from The first key of the range.
+ * @param to The key just past the range.
+ * @param limit The most rows to return.
+ * @param after The cursor of the previous page, or empty.
+ * @param idOffset Where the Customer ID starts in a key (NAME_ID or NUMBER_ID).
+ * @return Page The rows found.
+ */
+CustomerIndex::Page CustomerIndex::scan(const std::set<std::string>& index, const std::string& from,
+                                        const std::string& to, std::size_t limit, const std::string& after,
+                                        std::size_t idOffset) const {
+    Page page;
+    auto it = after.empty() || after < from ? index.lower_bound(from) : index.upper_bound(after);
+    for (; it != index.end() && *it < to; ++it) {
+        if (page.rows.size() == limit) {
+            page.next = page.rows.empty() ? std::string() : *std::prev(it);
+            break;
+        }
+        else {
+            std::size_t start = idOffset == NAME_ID ? it->rfind('\0') + 1 : idOffset;
+            page.rows.push_back(rows.at(it->substr(start)));
+        }
+    }
+    return page;
+}
+
+/**
+ * @brief Finds customers by name, ordered by last name, then first name, ignoring case.
+ *
+ * @param lastName The start of the last name, or the whole last name if firstName is given.
+ * @param firstName The start of the first name; empty to match any.
+ * @param limit The most rows to return.
+ * @param after The cursor of the previous page, or empty for the first page.
+ * @return Page The matching customers.
+ */
+CustomerIndex::Page CustomerIndex::byName(std::string_view lastName, std::string_view firstName, std::size_t limit,
+                                          const std::string& after) const {
+    TRACE_SPAN("CustomerIndex::byName");
+    std::string from = lowercase(lastName);
+    if (!firstName.empty()) {
+        from += '\0' + lowercase(firstName);
+    }
+    else {
+        // do nothing
+    }
+    // Names are letters only, so every key with this prefix sorts before prefix + 0xFF
+    return scan(names, from, from + '\xff', limit, after, NAME_ID);
+}
+
+/**
+ * @brief Finds customers with an age in a range, youngest first.
+ *
+ * @param minAge The lowest age to include.
+ * @param maxAge The highest age to include.
+ * @param limit The most rows to return.
+ * @param after The cursor of the previous page, or empty for the first page.
+ * @return Page The matching customers.
+ */
+CustomerIndex::Page CustomerIndex::byAge(int minAge, int maxAge, std::size_t limit, const std::string& after) const {
+    TRACE_SPAN("CustomerIndex::byAge");
+    std::string to = maxAge == INT_MAX ? std::string(5, '\xff') : numberKey(maxAge + 1, "");
+    return scan(ages, numberKey(minAge, ""), to, limit, after, NUMBER_ID);
+}
+
+/**
+ * @brief Finds customers with a reward point balance in a range, lowest first.
+ *
+ * @param minPoints The lowest balance to include.
+ * @param maxPoints The highest balance to include.
+ * @param limit The most rows to return.
+ * @param after The cursor of the previous page, or empty for the first page.
+ * @return Page The matching customers.
+ */
+CustomerIndex::Page CustomerIndex::byPoints(int minPoints, int maxPoints, std::size_t limit,
+                                            const std::string& after) const {
+    TRACE_SPAN("CustomerIndex::byPoints");
+    std::string to = maxPoints == INT_MAX ? std::string(5, '\xff') : numberKey(maxPoints + 1, "");
+    return scan(points, numberKey(minPoints, ""), to, limit, after, NUMBER_ID);
+}
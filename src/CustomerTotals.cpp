@@ -0,0 +1,46 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "CustomerTotals.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Converts an amount of money to the cents the totals are kept in.
+ *
+ * @param amount The amount, in dollars.
+ * @return std::int64_t The amount rounded to the nearest cent.
+ */
+std::int64_t CustomerTotals::toCents(double amount) {
+    return std::llround(amount * 100.0);
+}
+
+/**
+ * @brief Adds one order.
+ *
+ * @param cents The order's total cost, in cents.
+ * @param purchasedAt When it was placed, in seconds since the epoch; 0 if not known.
+ */
+void CustomerTotals::addPurchase(std::int64_t cents, std::int64_t purchasedAt) {
+    spendCents += cents;
+    orderCount++;
+    lastPurchase = std::max(lastPurchase, purchasedAt);
+}
+
+/**
+ * @brief Adds the totals of orders placed after the ones already counted.
+ *
+ * @param later The totals of the later orders, for the same customer.
+ */
+void CustomerTotals::merge(const CustomerTotals& later) {
+    spendCents += later.spendCents;
+    orderCount += later.orderCount;
+    lastPurchase = std::max(lastPurchase, later.lastPurchase);
+}
+
+/**
+ * @brief Resets the totals.
+ */
+void CustomerTotals::clear() {
+    spendCents = 0;
+    orderCount = 0;
+    lastPurchase = 0;
+}
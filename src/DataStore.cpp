@@ -0,0 +1,751 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "DataStore.h"
+#include "LogWriter.h"
+#include "Trace.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <unordered_set>
+#include <stdexcept>
+
+/**
+ * @brief Constructor for the DataStore class.
+ *
+ * @param customers The initial customer list.
+ * @param products The initial product list.
+ * @param gifts The initial gift list.
+ * @param lastSequence The sequence number of the last transaction log record already applied to the lists.
+ * @param baseCustomers Lazy customer file holding the customers not in the customer list, or null.
+ * @param removedBaseCustomerIDs IDs in baseCustomers that have been removed.
+ * @param pointLots The customers' dated lots; each is scheduled to expire.
+ * @param customerTotals The customers' lifetime totals.
+ */
+DataStore::DataStore(std::vector<Customer> customers, std::vector<Product> products, std::vector<Gift> gifts,
+                     std::uint64_t lastSequence, std::shared_ptr<const LazyCustomerFile> baseCustomers,
+                     std::vector<std::string> removedBaseCustomerIDs, std::vector<PointLots> pointLots,
+                     std::vector<CustomerTotals> customerTotals)
+    : customerList(std::make_shared<std::vector<Customer>>(std::move(customers))),
+      productList(std::make_shared<std::vector<Product>>(std::move(products))),
+      giftList(std::make_shared<std::vector<Gift>>(std::move(gifts))),
+      pointLotList(std::make_shared<std::vector<PointLots>>(std::move(pointLots))),
+      expiryWheel(std::time(nullptr)),
+      customerTotalList(std::make_shared<std::vector<CustomerTotals>>(std::move(customerTotals))),
+      baseCustomers(std::move(baseCustomers)),
+      removedBaseCustomers(std::make_shared<std::vector<std::string>>(std::move(removedBaseCustomerIDs))),
+      stockLevels(*productList),
+      lastSequence(lastSequence) {
+    std::sort(removedBaseCustomers->begin(), removedBaseCustomers->end());
+    const std::vector<PointLots>& lots = *pointLotList;
+    pointLotPositions.reserve(lots.size());
+    for (std::size_t i = 0; i < lots.size(); ++i) {
+        pointLotPositions.emplace(lots[i].getCustomerID(), static_cast<std::uint32_t>(i));
+        for (const PointLots::Lot& lot : lots[i].getLots()) {
+            expiryWheel.schedule(static_cast<std::uint32_t>(i), lot.expiresAt);
+        }
+    }
+    const std::vector<CustomerTotals>& totals = *customerTotalList;
+    customerTotalPositions.reserve(totals.size());
+    for (std::size_t i = 0; i < totals.size(); ++i) {
+        customerTotalPositions.emplace(totals[i].getCustomerID(), static_cast<std::uint32_t>(i));
+    }
+}
+
+/**
+ * @brief Starts an exclusive write operation.
+ *
+ * @return WriteGuard The guard giving access to the lists.
+ */
+DataStore::WriteGuard DataStore::write() {
+    return WriteGuard(*this);
+}
+
+/**
+ * @brief Starts a shared read operation.
+ *
+ * @return ReadGuard The guard giving read access to the lists.
+ */
+DataStore::ReadGuard DataStore::read() const {
+    return ReadGuard(*this);
+}
+
+/**
+ * @brief Looks up a customer, decoding it from the lazy base file if needed without keeping it.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return std::optional<Customer> The customer, or nothing if there is no such customer.
+ * @throws std::runtime_error If the base record cannot be read or parsed.
+ */
+std::optional<Customer> DataStore::ReadGuard::findCustomer(const std::string& customerID) const {
+    const std::vector<Customer>& customers = *store.customerList;
+    Customer::IDKey key(customerID);
+    auto it = std::find_if(customers.begin(), customers.end(),
+                           [&key](const Customer& c) { return c.hasCustomerID(key); });
+    if (it != customers.end()) {
+        return *it;
+    }
+    else if (store.baseCustomers == nullptr || store.isRemovedBaseCustomer(customerID)) {
+        return std::nullopt;
+    }
+    else {
+        return store.baseCustomers->load(customerID);
+    }
+}
+
+/**
+ * @brief Acquires the store lock, recording how long the writer had to wait for it.
+ *
+ * @param store The store to lock.
+ */
+DataStore::WriteGuard::WriteGuard(DataStore& store) : store(store), lock(store.mutex, std::defer_lock) {
+    auto start = std::chrono::steady_clock::now();
+    lock.lock();
+    store.stats.lockWaitSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Releases the lock and counts the operation if anything was modified.
+ */
+DataStore::WriteGuard::~WriteGuard() {
+    if (modified) {
+        store.version++;
+        store.stats.writeOperations++;
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Makes a list safe to modify, copying it if a snapshot still shares it.
+ *
+ * Snapshots are only taken under the shared lock, which this guard excludes, so use_count() cannot grow
+ * while we look at it. It can only shrink as the snapshot writer lets go, which at worst costs a copy.
+ *
+ * @param list The list to detach.
+ * @param markModified False when the caller only adds data that snapshots can already reach another way.
+ * @return std::vector<T>& The list, now owned only by the store.
+ */
+template <typename T>
+std::vector<T>& DataStore::WriteGuard::detach(std::shared_ptr<std::vector<T>>& list, bool markModified) {
+    modified = modified || markModified;
+    if (list.use_count() > 1) {
+        TRACE_SPAN("DataStore::copyOnWrite");
+        auto start = std::chrono::steady_clock::now();
+        list = std::make_shared<std::vector<T>>(*list);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        store.stats.copies++;
+        store.stats.copySeconds += seconds;
+        store.stats.maxCopySeconds = std::max(store.stats.maxCopySeconds, seconds);
+    }
+    else {
+        // do nothing
+    }
+    return *list;
+}
+
+/**
+ * @brief Retrieves the customer list for modification.
+ *
+ * @return std::vector<Customer>& The customer list.
+ */
+std::vector<Customer>& DataStore::WriteGuard::customers() { return detach(store.customerList); }
+
+/**
+ * @brief Retrieves the product list for modification.
+ *
+ * @return std::vector<Product>& The product list.
+ */
+std::vector<Product>& DataStore::WriteGuard::products() { return detach(store.productList); }
+
+/**
+ * @brief Retrieves the gift list for modification.
+ *
+ * @return std::vector<Gift>& The gift list.
+ */
+std::vector<Gift>& DataStore::WriteGuard::gifts() { return detach(store.giftList); }
+
+/**
+ * @brief Finds a customer for modification, decoding it from the lazy base file on first access.
+ *
+ * Decoding a base customer does not count as a modification: snapshots taken before or after it write
+ * the same record either from the list or from the base file.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return Customer* The customer, or nullptr if there is no such customer.
+ * @throws std::runtime_error If the base record cannot be read or parsed.
+ */
+Customer* DataStore::WriteGuard::findCustomer(const std::string& customerID) {
+    std::size_t position = store.findCustomerPosition(customerID);
+    if (position < store.customerList->size()) {
+        return &detach(store.customerList, false)[position];
+    }
+    else if (store.baseCustomers == nullptr || store.isRemovedBaseCustomer(customerID)) {
+        return nullptr;
+    }
+    else {
+        std::optional<Customer> loaded = store.baseCustomers->load(customerID);
+        if (!loaded) {
+            return nullptr;
+        }
+        else {
+            std::vector<Customer>& customers = detach(store.customerList, false);
+            customers.push_back(std::move(*loaded));
+            store.addCustomerPosition(customers.size() - 1);
+            return &customers.back();
+        }
+    }
+}
+
+/**
+ * @brief Removes a customer, tombstoning it if it came from the lazy base file.
+ *
+ * @param customerID The unique identifier of the customer to remove.
+ * @return bool True if the customer existed.
+ */
+bool DataStore::WriteGuard::removeCustomer(const std::string& customerID) {
+    Customer* customer = findCustomer(customerID);
+    if (customer == nullptr) {
+        return false;
+    }
+    else {
+        std::vector<Customer>& customers = detach(store.customerList);
+        customers.erase(customers.begin() + (customer - customers.data()));
+        store.customerPositionsStale = true;   // every customer after it moved up
+        if (store.customerIndex != nullptr) {
+            store.customerIndex->remove(customerID);
+        }
+        else {
+            // do nothing
+        }
+        auto lots = store.pointLotPositions.find(customerID);
+        if (lots != store.pointLotPositions.end()) {
+            detach(store.pointLotList)[lots->second].clear();   // cleared, not erased, so positions hold
+        }
+        else {
+            // do nothing
+        }
+        auto totals = store.customerTotalPositions.find(customerID);
+        if (totals != store.customerTotalPositions.end()) {
+            detach(store.customerTotalList)[totals->second].clear();
+        }
+        else {
+            // do nothing
+        }
+        if (hasBaseCustomer(customerID) && !store.isRemovedBaseCustomer(customerID)) {
+            std::vector<std::string>& removed = detach(store.removedBaseCustomers);
+            removed.insert(std::lower_bound(removed.begin(), removed.end(), customerID), customerID);
+        }
+        else {
+            // do nothing
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Adds a newly registered customer to the customer list and the secondary indexes.
+ *
+ * @param customer The new customer.
+ */
+void DataStore::WriteGuard::addCustomer(const Customer& customer) {
+    customers().push_back(customer);
+    store.addCustomerPosition(store.customerList->size() - 1);
+    if (store.customerIndex != nullptr) {
+        store.customerIndex->add(customer);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Adds customers appended directly to customers() to the secondary indexes.
+ *
+ * @param firstNew Position in the customer list of the first customer not yet indexed.
+ */
+void DataStore::WriteGuard::indexNewCustomers(std::size_t firstNew) {
+    if (store.customerIndex != nullptr) {
+        const std::vector<Customer>& customers = *store.customerList;
+        for (std::size_t i = firstNew; i < customers.size(); ++i) {
+            store.customerIndex->add(customers[i]);
+        }
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Credits (or debits, if negative) a customer's reward points, keeping the dated lots and the points
+ *        index in step.
+ *
+ * @param customer A customer obtained from this guard.
+ * @param points The number of points to add.
+ * @param expiresAt When credited points expire, or PointLots::NEVER.
+ */
+void DataStore::WriteGuard::addRewardPoints(Customer& customer, int points, std::int64_t expiresAt) {
+    if (points > 0 && expiresAt != PointLots::NEVER) {
+        std::string customerID = customer.getCustomerID();
+        auto [it, added] = store.pointLotPositions.emplace(customerID,
+                                                           static_cast<std::uint32_t>(store.pointLotList->size()));
+        std::vector<PointLots>& lots = detach(store.pointLotList);
+        if (added) {
+            lots.emplace_back(customerID);
+        }
+        else {
+            // do nothing
+        }
+        lots[it->second].add(expiresAt, points);
+        store.expiryWheel.schedule(it->second, expiresAt);
+    }
+    else if (points < 0 && !store.pointLotPositions.empty()) {
+        auto it = store.pointLotPositions.find(customer.getCustomerID());
+        if (it != store.pointLotPositions.end() && (*store.pointLotList)[it->second].getTotal() > 0) {
+            detach(store.pointLotList)[it->second].spend(-points);
+        }
+        else {
+            // do nothing
+        }
+    }
+    else {
+        // do nothing
+    }
+    updatePoints(customer, points);
+}
+
+/**
+ * @brief Changes a customer's points and its place in the points index, without touching the lots.
+ */
+void DataStore::WriteGuard::updatePoints(Customer& customer, int points) {
+    customer.addRewardPoints(points);
+    if (store.customerIndex != nullptr) {
+        store.customerIndex->updatePoints(customer.getCustomerID(), customer.getRewardPoints());
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Expires one customer's lots that are due, deducting their points.
+ *
+ * @param customer A customer obtained from this guard.
+ * @param now The time, in seconds since the epoch.
+ * @return int The points expired.
+ */
+int DataStore::WriteGuard::expirePoints(Customer& customer, std::int64_t now) {
+    auto it = store.pointLotPositions.find(customer.getCustomerID());
+    const std::vector<PointLots>& lots = *store.pointLotList;
+    if (it == store.pointLotPositions.end() || lots[it->second].getLots().empty() ||
+        lots[it->second].getLots().front().expiresAt > now) {
+        return 0;
+    }
+    else {
+        int expired = detach(store.pointLotList)[it->second].expire(now);
+        updatePoints(customer, -std::min(expired, customer.getRewardPoints()));
+        return expired;
+    }
+}
+
+/**
+ * @brief Advances the expiry wheel and expires every lot that came due.
+ *
+ * Only the customers whose lots fired are looked up, each through the customer position hash, so a tick costs
+ * what it expires rather than a pass over every customer.
+ *
+ * @param now The time, in seconds since the epoch.
+ * @return std::vector<std::pair<std::string, int>> The Customer ID and points expired of each customer who
+ *         lost points, in Customer ID order.
+ */
+std::vector<std::pair<std::string, int>> DataStore::WriteGuard::expireDuePoints(std::int64_t now) {
+    std::vector<std::uint32_t> fired;
+    store.expiryWheel.advance(now, fired);
+    std::vector<std::pair<std::string, int>> expired;
+    for (std::uint32_t position : fired) {
+        const PointLots& lots = (*store.pointLotList)[position];
+        if (!lots.getLots().empty() && lots.getLots().front().expiresAt <= now) {
+            // Lots that expire together fire together; the first expires them all
+            expired.emplace_back(lots.getCustomerID(), detach(store.pointLotList)[position].expire(now));
+        }
+        else {
+            // do nothing: spent before it expired
+        }
+    }
+    std::sort(expired.begin(), expired.end());
+
+    for (const auto& [customerID, points] : expired) {
+        // Not in memory: lazy mode may still have it in the base file
+        Customer* customer = nullptr;
+        try {
+            customer = findCustomer(customerID);
+        } catch (const std::invalid_argument&) {
+            // a corrupt base record counts as an unknown customer
+        } catch (const std::runtime_error&) {
+            // and so does a truncated one
+        }
+        if (customer != nullptr) {
+            updatePoints(*customer, -std::min(points, customer->getRewardPoints()));
+        }
+        else {
+            // do nothing
+        }
+    }
+    return expired;
+}
+
+/**
+ * @brief Finds a customer's dated lots. The caller must hold the store lock.
+ *
+ * @param customerID The unique identifier of the customer.
+ * @return const PointLots* The lots, or nullptr if the customer never earned points that expire.
+ */
+const PointLots* DataStore::findLots(const std::string& customerID) const {
+    auto it = pointLotPositions.find(customerID);
+    return it == pointLotPositions.end() ? nullptr : &(*pointLotList)[it->second];
+}
+
+/**
+ * @brief Finds a customer's position in the customer list. The caller must hold the exclusive lock.
+ *
+ * The position hash is rebuilt first if it is stale: a customer was removed, or customers were appended to
+ * or moved in WriteGuard::customers() directly. A position that names another customer also means the list
+ * was changed behind the hash.
+ *
+ * @param customerID The unique identifier of the customer.
+ * @return std::size_t The position, or the size of the list if the customer is not in memory.
+ */
+std::size_t DataStore::findCustomerPosition(const std::string& customerID) {
+    const std::vector<Customer>& customers = *customerList;
+    Customer::IDKey key(customerID);
+    for (int attempt = 0; attempt < 2; ++attempt) {
+        if (customerPositionsStale || customerPositions.size() != customers.size()) {
+            customerPositions.clear();
+            customerPositions.reserve(customers.size());
+            for (std::size_t i = 0; i < customers.size(); ++i) {
+                customerPositions.emplace(customers[i].getCustomerID(), static_cast<std::uint32_t>(i));
+            }
+            customerPositionsStale = false;
+        }
+        else {
+            // do nothing
+        }
+        auto it = customerPositions.find(customerID);
+        if (it == customerPositions.end()) {
+            return customers.size();
+        }
+        else if (it->second < customers.size() && customers[it->second].hasCustomerID(key)) {
+            return it->second;
+        }
+        else {
+            customerPositionsStale = true;
+        }
+    }
+    return customers.size();
+}
+
+/**
+ * @brief Adds a customer just appended to the customer list to the position hash, unless it is stale anyway.
+ *
+ * @param position The customer's position in the list.
+ */
+void DataStore::addCustomerPosition(std::size_t position) {
+    if (!customerPositionsStale && customerPositions.size() == position) {
+        customerPositions.emplace((*customerList)[position].getCustomerID(), static_cast<std::uint32_t>(position));
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Counts an order in a customer's lifetime totals.
+ *
+ * @param customer A customer obtained from this guard.
+ * @param totalCost The order's total cost.
+ * @param purchasedAt When it was placed, in seconds since the epoch; 0 if not known.
+ */
+void DataStore::WriteGuard::recordPurchase(const Customer& customer, double totalCost, std::int64_t purchasedAt) {
+    const std::string& customerID = customer.getCustomerID();
+    std::uint32_t next = static_cast<std::uint32_t>(store.customerTotalList->size());
+    auto [it, added] = store.customerTotalPositions.emplace(customerID, next);
+    std::vector<CustomerTotals>& totals = detach(store.customerTotalList);
+    if (added) {
+        totals.emplace_back(customerID);
+    }
+    else {
+        // do nothing
+    }
+    totals[it->second].addPurchase(CustomerTotals::toCents(totalCost), purchasedAt);
+}
+
+/**
+ * @brief Looks up a customer's lifetime totals. The caller must hold the store lock.
+ *
+ * @param customerID The unique identifier of the customer.
+ * @return const CustomerTotals* The totals, or nullptr if the customer never placed an order.
+ */
+const CustomerTotals* DataStore::findTotals(const std::string& customerID) const {
+    auto it = customerTotalPositions.find(customerID);
+    return it == customerTotalPositions.end() ? nullptr : &(*customerTotalList)[it->second];
+}
+
+/**
+ * @brief Redeems a gift for a customer, deducting its points and a unit of its stock in one step.
+ *
+ * @param customer A customer obtained from this guard.
+ * @param giftNumber Position of the gift in the store's gifts followed by the configured ones, starting at 1.
+ * @param configuredGifts The gifts of the reward configuration.
+ * @param limits The velocity limits of the reward configuration; only the redemption limit applies.
+ * @return Gift The redeemed gift, with the stock left after the redemption.
+ * @throws std::invalid_argument If the gift number is out of range, the gift is out of stock, the customer
+ *         lacks the points, or the customer has redeemed too many gifts lately.
+ */
+Gift DataStore::WriteGuard::redeemGift(Customer& customer, int giftNumber, const std::vector<Gift>& configuredGifts,
+                                       const VelocityLimiter::Limits& limits) {
+    const std::vector<Gift>& storeGifts = *store.giftList;
+    if (giftNumber < 1 || static_cast<std::size_t>(giftNumber) > storeGifts.size() + configuredGifts.size()) {
+        throw std::invalid_argument("Invalid choice.");
+    }
+    else {
+        // do nothing
+    }
+
+    std::size_t position = static_cast<std::size_t>(giftNumber - 1);
+    bool inStore = position < storeGifts.size();
+    // A copy: detaching the gift list below would leave a reference into the old one
+    Gift gift = inStore ? storeGifts[position] : configuredGifts[position - storeGifts.size()];
+    if (!gift.isInStock()) {
+        throw std::invalid_argument("This gift is out of stock.");
+    }
+    else if (customer.getRewardPoints() < gift.getRequiredPoints()) {
+        throw std::invalid_argument("Insufficient reward points to redeem this gift.");
+    }
+    else if (limits.redemptions.maximum > 0) {
+        store.velocityCounters.admitRedemption(customer.getCustomerID(), limits, VelocityLimiter::nowMillis());
+    }
+    else {
+        // do nothing
+    }
+
+    if (inStore && gift.isLimited()) {
+        gift.setStock(gift.getStock() - 1);
+        gifts()[position].setStock(gift.getStock());
+    }
+    else {
+        // do nothing
+    }
+    addRewardPoints(customer, -gift.getRequiredPoints());
+    return gift;
+}
+
+/**
+ * @brief Adds a new product to the product list and the stock monitor.
+ *
+ * @param product The new product.
+ */
+void DataStore::WriteGuard::addProduct(const Product& product) {
+    products().push_back(product);
+    store.stockLevels.add(product.getProductID(), product.getProductName(), product.getProductInventory());
+}
+
+/**
+ * @brief Removes a product from the product list and the stock monitor.
+ *
+ * @param productID The unique identifier of the product to remove.
+ * @return bool True if the product existed.
+ */
+bool DataStore::WriteGuard::removeProduct(const std::string& productID) {
+    const std::vector<Product>& current = *store.productList;
+    auto it = std::find_if(current.begin(), current.end(),
+                           [&productID](const Product& p) { return p.getProductID() == productID; });
+    if (it == current.end()) {
+        return false;
+    }
+    else {
+        std::size_t position = static_cast<std::size_t>(it - current.begin());
+        std::vector<Product>& products = detach(store.productList);
+        products.erase(products.begin() + position);
+        store.stockLevels.remove(productID);
+        return true;
+    }
+}
+
+/**
+ * @brief Changes a product's inventory and records the new level with the stock monitor.
+ *
+ * @param product A product in products().
+ * @param change The number of units to add (positive) or remove (negative).
+ */
+void DataStore::WriteGuard::updateInventory(Product& product, int change) {
+    product.updateInventory(change);
+    store.stockLevels.update(product.getProductID(), product.getProductInventory());
+}
+
+/**
+ * @brief Retrieves the secondary customer indexes, building them on first use.
+ *
+ * Building needs every customer in memory, so lazy mode decodes the rest of the base file first.
+ *
+ * @return const CustomerIndex& The indexes.
+ * @throws std::runtime_error If a base record cannot be read or parsed.
+ */
+const CustomerIndex& DataStore::WriteGuard::customerIndex() {
+    if (store.customerIndex == nullptr) {
+        materializeAllCustomers();
+        store.customerIndex = std::make_unique<CustomerIndex>(*store.customerList);
+    }
+    else {
+        // do nothing
+    }
+    return *store.customerIndex;
+}
+
+/**
+ * @brief Checks whether the lazy base file holds a customer ID, removed or not, without decoding it.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return bool True if the ID is taken by a base record.
+ */
+bool DataStore::WriteGuard::hasBaseCustomer(const std::string& customerID) const {
+    return store.baseCustomers != nullptr && store.baseCustomers->contains(customerID);
+}
+
+/**
+ * @brief Decodes every remaining base customer into the customer list and drops the base.
+ *
+ * @throws std::runtime_error If a base record cannot be read or parsed.
+ */
+void DataStore::WriteGuard::materializeAllCustomers() {
+    if (store.baseCustomers == nullptr) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    TRACE_SPAN("DataStore::materializeAllCustomers");
+    std::vector<Customer>& customers = detach(store.customerList);
+    std::unordered_set<std::string> skip(store.removedBaseCustomers->begin(), store.removedBaseCustomers->end());
+    for (const Customer& customer : customers) {
+        skip.insert(customer.getCustomerID());
+    }
+    customers.reserve(customers.size() + store.baseCustomers->size());
+    for (std::size_t i = 0; i < store.baseCustomers->size(); ++i) {
+        Customer customer = store.baseCustomers->loadAt(i);
+        if (skip.find(customer.getCustomerID()) == skip.end()) {
+            customers.push_back(std::move(customer));
+        }
+        else {
+            // do nothing
+        }
+    }
+    store.baseCustomers = nullptr;
+    detach(store.removedBaseCustomers).clear();
+}
+
+/**
+ * @brief Allocates the sequence number for a transaction log record written by this operation.
+ *
+ * @return std::uint64_t The new sequence number.
+ */
+std::uint64_t DataStore::WriteGuard::nextSequence() {
+    modified = true;
+    return ++store.lastSequence;
+}
+
+/**
+ * @brief Appends records numbered by this guard to the transaction log and waits until they are written.
+ *
+ * @param records One or more formatted records.
+ * @param count How many records the string holds.
+ */
+void DataStore::WriteGuard::appendLog(std::string records, std::uint64_t count) {
+    if (store.logWriter != nullptr) {
+        store.logWriter->waitFlushed(store.logWriter->enqueue(std::move(records), count));
+    }
+    else {
+        FileManager::appendToLog(records);
+    }
+}
+
+/**
+ * @brief Copies the list pointers. The caller must hold the store lock.
+ *
+ * No writer can be between allocating a sequence number and logging its record while we hold the lock,
+ * so every record after lastSequence starts at or after the log size read here. Records the CheckoutPipeline
+ * has queued but not yet written may still land after it; replay skips those by sequence number.
+ *
+ * @return Snapshot The snapshot.
+ */
+DataStore::Snapshot DataStore::makeSnapshot() const {
+    Snapshot snapshot;
+    snapshot.customers = customerList;
+    snapshot.products = productList;
+    snapshot.gifts = giftList;
+    snapshot.pointLots = pointLotList;
+    snapshot.customerTotals = customerTotalList;
+    snapshot.baseCustomers = baseCustomers;
+    snapshot.removedBaseCustomers = removedBaseCustomers;
+    snapshot.version = version;
+    snapshot.checkpoint.sequence = lastSequence;
+    snapshot.checkpoint.logOffset = FileManager::transactionLogSize();
+    return snapshot;
+}
+
+/**
+ * @brief Takes a consistent snapshot, waiting for any write operation in progress to finish.
+ *
+ * @return Snapshot The snapshot.
+ */
+DataStore::Snapshot DataStore::snapshot() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return makeSnapshot();
+}
+
+/**
+ * @brief Takes a consistent snapshot only if no write operation is in progress.
+ *
+ * @param out Receives the snapshot on success.
+ * @return bool True if the snapshot was taken, false if a writer holds the store.
+ */
+bool DataStore::trySnapshot(Snapshot& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return false;
+    }
+    else {
+        out = makeSnapshot();
+        return true;
+    }
+}
+
+/**
+ * @brief Tells whether a base customer has been removed. The caller must hold the store lock.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return bool True if the customer was removed.
+ */
+bool DataStore::isRemovedBaseCustomer(const std::string& customerID) const {
+    return std::binary_search(removedBaseCustomers->begin(), removedBaseCustomers->end(), customerID);
+}
+
+/**
+ * @brief Sends every log write made through WriteGuard::appendLog to a LogWriter's queue from now on.
+ *
+ * @param writer The writer, or null to append directly to the log file again.
+ */
+void DataStore::attachLog(LogWriter* writer) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    logWriter = writer;
+}
+
+/**
+ * @brief Retrieves the copy-on-write latency counters.
+ *
+ * @return Stats The counters accumulated since the store was created.
+ */
+DataStore::Stats DataStore::getStats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return stats;
+}
@@ -1,38 +1,228 @@
 // Dyar Jankir, Caden Dye, Arthas Lee
 #include "FileManager.h"
+#include "BatchValidator.h"
+#include "TransactionLog.h"
+#include "Trace.h"
 #include <fstream>
+#include <iomanip>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
+#include <cstdio>
+#include <filesystem>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Writes the "#checkpoint <sequence> <offset>" header line of a data file.
+ */
+void writeCheckpoint(std::ostream& file, const Checkpoint& checkpoint) {
+    file << "#checkpoint " << checkpoint.sequence << " " << checkpoint.logOffset << "\n\n";
+}
+
+/**
+ * @brief Reads the checkpoint header line of a data file into checkpoint.
+ * @return bool True if the line was the header and should be skipped.
+ */
+bool readCheckpoint(const std::string& line, Checkpoint* checkpoint) {
+    if (line.compare(0, 12, "#checkpoint ") != 0) {
+        return false;
+    }
+    else if (checkpoint != nullptr) {
+        std::istringstream fields(line.substr(12));
+        fields >> checkpoint->sequence >> checkpoint->logOffset;
+    }
+    else {
+        // do nothing
+    }
+    return true;
+}
+
+/**
+ * @brief Closes a saved data file, so that a short write (a full disk, an I/O error) is reported before the file
+ *        can replace a good one.
+ * @throws std::runtime_error If a write or the close failed.
+ */
+void closeSaved(std::ofstream& file, const std::string& filename) {
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Failed to write " + filename + ".");
+    }
+    else {
+        // do nothing
+    }
+}
+
+} // namespace
 
 /**
  * @brief Logs a customer's transaction to a file.
  * 
+ * @param sequence The sequence number of the transaction in the log.
  * @param customerID The unique identifier for the customer making the transaction.
  * @param cart A vector of pairs, where each pair contains a product ID and the quantity of that product purchased.
  * @param totalCost The total cost of the transaction.
  * @param rewardPoints The number of reward points earned from the transaction.
  */
-void FileManager::logTransaction(const std::string& customerID,
+void FileManager::logTransaction(std::uint64_t sequence,
+                                 const std::string& customerID,
                                  const std::vector<std::pair<std::string, int>>& cart,
                                  double totalCost,
                                  int rewardPoints) {
-    std::ofstream logFile("transactions.txt", std::ios::app); // Open file in append mode
-    if (logFile.is_open()) {
-        logFile << "Customer ID: " << customerID << "\n";
-        logFile << "Items Purchased:\n";
-        for (const auto& [productID, quantity] : cart) {
-            logFile << "  - Product ID: " << productID << ", Quantity: " << quantity << "\n";
+    TRACE_SPAN("FileManager::logTransaction");
+    appendToLog(formatTransaction(sequence, customerID, cart, totalCost, rewardPoints));
+}
+
+/**
+ * @brief Formats a purchase as a transaction log record, in the format logTransaction writes.
+ * 
+ * @param sequence The sequence number of the transaction in the log.
+ * @param customerID The unique identifier for the customer making the transaction.
+ * @param cart A vector of pairs, where each pair contains a product ID and the quantity of that product purchased.
+ * @param totalCost The total cost of the transaction.
+ * @param rewardPoints The number of reward points earned from the transaction.
+ * @param pointsExpireAt When the points earned expire, or PointLots::NEVER. Replay needs it to rebuild the lot.
+ * @param purchasedAt When the purchase was made, or 0. Rebuilding the customer's totals needs it.
+ * @return std::string The record, including its trailing blank line.
+ */
+std::string FileManager::formatTransaction(std::uint64_t sequence,
+                                           const std::string& customerID,
+                                           const std::vector<std::pair<std::string, int>>& cart,
+                                           double totalCost,
+                                           int rewardPoints,
+                                           std::int64_t pointsExpireAt,
+                                           std::int64_t purchasedAt) {
+    std::ostringstream record;
+    record << "Sequence: " << sequence << "\n";
+    record << "Customer ID: " << customerID << "\n";
+    record << "Items Purchased:\n";
+    for (const auto& [productID, quantity] : cart) {
+        record << "  - Product ID: " << productID << ", Quantity: " << quantity << "\n";
+    }
+    if (purchasedAt != 0) {
+        record << "Purchased At: " << purchasedAt << "\n";
+    }
+    else {
+        // do nothing
+    }
+    // Enough digits that the cents survive; the default six would round a large order's total
+    record << "Total Cost: $" << std::setprecision(15) << totalCost << "\n";
+    if (pointsExpireAt != PointLots::NEVER) {
+        record << "Points Expire: " << pointsExpireAt << "\n";
+    }
+    else {
+        // do nothing
+    }
+    record << "Reward Points Earned: " << rewardPoints << "\n\n";
+    return record.str();
+}
+
+/**
+ * @brief Appends already formatted records to the transaction log with a single file open and write.
+ * 
+ * @param records The records to append.
+ * @param filename The name of the transaction log.
+ */
+void FileManager::appendToLog(const std::string& records, const std::string& filename) {
+    TransactionLog::get(filename).append(records);
+}
+
+/**
+ * @brief Formats a gift redemption as a transaction log record.
+ * 
+ * @param sequence The sequence number of the redemption in the log.
+ * @param customerID The unique identifier for the customer redeeming the gift.
+ * @param gift The redeemed gift, with the stock left after the redemption; a limited gift's stock is logged
+ *             so replay can restore it.
+ * @return std::string The record.
+ */
+std::string FileManager::formatRedemption(std::uint64_t sequence, const std::string& customerID, const Gift& gift) {
+    return "Sequence: " + std::to_string(sequence) + "\n" +
+           "Redemption Customer ID: " + customerID + "\n" +
+           "Gift: " + gift.getGiftName() + "\n" +
+           (gift.isLimited() ? "Stock Left: " + std::to_string(gift.getStock()) + "\n" : std::string()) +
+           "Points Redeemed: " + std::to_string(gift.getRequiredPoints()) + "\n\n";
+}
+
+/**
+ * @brief Formats a batch of changes as transaction log records.
+ * 
+ * @param changes The changes, in sequence order.
+ * @return std::string The records.
+ */
+std::string FileManager::formatChanges(const std::vector<ChangeRecord>& changes) {
+    std::string text;
+    for (const auto& change : changes) {
+        text += "Sequence: " + std::to_string(change.sequence) + "\n" + change.kind + ": " + change.details + "\n\n";
+    }
+    return text;
+}
+
+/**
+ * @brief Retrieves the current size of the transaction log, over all its segments.
+ * 
+ * @param filename The name of the transaction log's active segment.
+ * @return std::uint64_t The size in bytes, or 0 if nothing has been logged yet.
+ */
+std::uint64_t FileManager::transactionLogSize(const std::string& filename) {
+    return TransactionLog::get(filename).endOffset();
+}
+
+/**
+ * @brief Loads a batch of carts, one per line as "<customerID> <productID>:<qty> ...".
+ *
+ * @param filename The name of the file to load.
+ * @return std::vector<CartOrder> The carts, in file order.
+ * @throws std::runtime_error If the file cannot be opened or a line is malformed.
+ */
+std::vector<CartOrder> FileManager::loadCartOrders(const std::string& filename) {
+    TRACE_SPAN("FileManager::loadCartOrders");
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename + " for loading.");
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<CartOrder> orders;
+    std::string line;
+    std::size_t lineNumber = 0;
+    while (std::getline(file, line)) {
+        lineNumber++;
+        std::istringstream in(line);
+        CartOrder order;
+        if (!(in >> order.customerID) || order.customerID[0] == '#') {
+            continue;
+        }
+        else {
+            // do nothing
         }
-        logFile << "Total Cost: $" << totalCost << "\n";
-        logFile << "Reward Points Earned: " << rewardPoints << "\n\n";
-        logFile.close();
-    } else {
-        std::cerr << "Error: Unable to open transactions.txt for writing." << std::endl;
+
+        std::string item;
+        while (in >> item) {
+            std::size_t colon = item.find(':');
+            try {
+                if (colon == std::string::npos) {
+                    throw std::invalid_argument(item);
+                }
+                else {
+                    order.cart.emplace_back(item.substr(0, colon), std::stoi(item.substr(colon + 1)));
+                }
+            } catch (const std::exception&) {
+                throw std::runtime_error(filename + " line " + std::to_string(lineNumber) +
+                                         ": cart items must be <productID>:<quantity>.");
+            }
+        }
+        orders.push_back(std::move(order));
     }
+    return orders;
 }
 
 void FileManager::saveTransactions(const std::vector<Transaction>& transactions, const std::string& filename) {
+    TRACE_SPAN("FileManager::saveTransactions");
     std::ofstream file(filename);
     if (!file.is_open()) throw std::runtime_error("Cannot open file for saving transactions.");
     else {
@@ -51,6 +241,7 @@ void FileManager::saveTransactions(const std::vector<Transaction>& transactions,
 }
 
 std::vector<Transaction> FileManager::loadTransactions(const std::string& filename) {
+    TRACE_SPAN("FileManager::loadTransactions");
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Error: Unable to open transactions.txt for loading.");
@@ -97,9 +288,11 @@ std::vector<Transaction> FileManager::loadTransactions(const std::string& filena
  * 
  * @param customers A vector of Customer objects to be saved.
  * @param filename The name of the file where customer information will be saved.
- * @throws std::runtime_error If the file cannot be opened for writing.
+ * @param checkpoint The transaction log position the customer list is consistent with.
+ * @throws std::runtime_error If the file cannot be opened or fully written.
  */
-void FileManager::saveCustomers(const std::vector<Customer>& customers, const std::string& filename) {
+void FileManager::saveCustomers(const std::vector<Customer>& customers, const std::string& filename, const Checkpoint& checkpoint) {
+    TRACE_SPAN("FileManager::saveCustomers");
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for saving customers.");
@@ -107,6 +300,7 @@ void FileManager::saveCustomers(const std::vector<Customer>& customers, const st
     else {
         // do nothing
     }
+    writeCheckpoint(file, checkpoint);
     for (const auto& customer : customers) {
         file << customer.getCustomerID() << "\n"
              << customer.getUserName() << "\n"
@@ -116,6 +310,7 @@ void FileManager::saveCustomers(const std::vector<Customer>& customers, const st
              << customer.getCreditCardNumber() << "\n"
              << customer.getRewardPoints() << "\n\n";
     }
+    closeSaved(file, filename);
 }
 
 
@@ -123,10 +318,12 @@ void FileManager::saveCustomers(const std::vector<Customer>& customers, const st
  * @brief Loads customer information from a file.
  * 
  * @param filename The name of the file from which customer information will be loaded.
+ * @param checkpoint If not null, receives the file's checkpoint (all zero for files written before checkpoints).
  * @return std::vector<Customer> A vector of Customer objects loaded from the file.
  * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing customer data.
  */
-std::vector<Customer> FileManager::loadCustomers(const std::string& filename) {
+std::vector<Customer> FileManager::loadCustomers(const std::string& filename, Checkpoint* checkpoint) {
+    TRACE_SPAN("FileManager::loadCustomers");
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for loading customers.");
@@ -135,11 +332,17 @@ std::vector<Customer> FileManager::loadCustomers(const std::string& filename) {
         // do nothing
     }
 
-    std::vector<Customer> customers;
+    // Read every record first, so each field can be validated as one column
+    struct Record {
+        std::string customerID, userName, firstName, lastName, creditCardNumber;
+        int age = 0;
+        int rewardPoints = 0;
+    };
+    std::vector<Record> records;
     std::string customerID, userName, firstName, lastName, ageStr, creditCardNumber, rewardPointsStr;
 
     while (std::getline(file, customerID)) {
-        if (customerID.empty()) continue;
+        if (customerID.empty() || readCheckpoint(customerID, checkpoint)) continue;
         else {
             // do nothing
         }
@@ -151,15 +354,40 @@ std::vector<Customer> FileManager::loadCustomers(const std::string& filename) {
         std::getline(file, rewardPointsStr);
 
         try {
-            int age = std::stoi(ageStr);
-            int rewardPoints = std::stoi(rewardPointsStr);
-
-            // Construct the Customer object and add it to the vector
-            customers.emplace_back(customerID, userName, firstName, lastName, age, creditCardNumber, rewardPoints);
+            records.push_back(Record{customerID, userName, firstName, lastName, creditCardNumber,
+                                     std::stoi(ageStr), std::stoi(rewardPointsStr)});
         } catch (const std::invalid_argument& e) {
             throw std::runtime_error("Error parsing customer data: " + std::string(e.what()));
         }
     }
+
+    std::vector<std::string_view> userNames, firstNames, lastNames, creditCards;
+    for (const Record& record : records) {
+        userNames.push_back(record.userName);
+        firstNames.push_back(record.firstName);
+        lastNames.push_back(record.lastName);
+        creditCards.push_back(record.creditCardNumber);
+    }
+    BatchValidator::Bitmap validUserNames = BatchValidator::userNames(userNames);
+    BatchValidator::Bitmap validFirstNames = BatchValidator::names(firstNames);
+    BatchValidator::Bitmap validLastNames = BatchValidator::names(lastNames);
+    BatchValidator::Bitmap validCreditCards = BatchValidator::creditCards(creditCards);
+
+    std::vector<Customer> customers;
+    customers.reserve(records.size());
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        const Record& record = records[i];
+        if (!BatchValidator::isSet(validUserNames, i) || !BatchValidator::isSet(validFirstNames, i) ||
+            !BatchValidator::isSet(validLastNames, i) || !Customer::isAgeValid(record.age) ||
+            !BatchValidator::isSet(validCreditCards, i)) {
+            throw std::runtime_error("Error parsing customer data: Invalid customer data provided.");
+        }
+        else {
+            customers.push_back(Customer::prevalidated(record.customerID, record.userName, record.firstName,
+                                                       record.lastName, record.age, record.creditCardNumber,
+                                                       record.rewardPoints));
+        }
+    }
     return customers;
 }
 
@@ -169,9 +397,11 @@ std::vector<Customer> FileManager::loadCustomers(const std::string& filename) {
  * 
  * @param products A vector of Product objects to be saved.
  * @param filename The name of the file where product information will be saved.
- * @throws std::runtime_error If the file cannot be opened for writing.
+ * @param checkpoint The transaction log position the product list is consistent with.
+ * @throws std::runtime_error If the file cannot be opened or fully written.
  */
-void FileManager::saveProducts(const std::vector<Product>& products, const std::string& filename) {
+void FileManager::saveProducts(const std::vector<Product>& products, const std::string& filename, const Checkpoint& checkpoint) {
+    TRACE_SPAN("FileManager::saveProducts");
     std::ofstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for saving products.");
@@ -179,12 +409,14 @@ void FileManager::saveProducts(const std::vector<Product>& products, const std::
     else {
         // do nothing
     }
+    writeCheckpoint(file, checkpoint);
     for (const auto& product : products) {
         file << product.getProductID() << "\n"
              << product.getProductName() << "\n"
              << product.getProductPrice() << "\n"
              << product.getProductInventory() << "\n\n";
     }
+    closeSaved(file, filename);
 }
 
 
@@ -192,10 +424,12 @@ void FileManager::saveProducts(const std::vector<Product>& products, const std::
  * @brief Loads product information from a file.
  * 
  * @param filename The name of the file from which product information will be loaded.
+ * @param checkpoint If not null, receives the file's checkpoint (all zero for files written before checkpoints).
  * @return std::vector<Product> A vector of Product objects loaded from the file.
  * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing product data.
  */
-std::vector<Product> FileManager::loadProducts(const std::string& filename) {
+std::vector<Product> FileManager::loadProducts(const std::string& filename, Checkpoint* checkpoint) {
+    TRACE_SPAN("FileManager::loadProducts");
     std::ifstream file(filename);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for loading products.");
@@ -208,7 +442,7 @@ std::vector<Product> FileManager::loadProducts(const std::string& filename) {
     std::string productID, productName, productPriceStr, productInventoryStr;
 
     while (std::getline(file, productID)) {
-        if (productID.empty()) continue;
+        if (productID.empty() || readCheckpoint(productID, checkpoint)) continue;
         else {
             // do nothing
         }
@@ -228,3 +462,268 @@ std::vector<Product> FileManager::loadProducts(const std::string& filename) {
     }
     return products;
 }
+
+
+/**
+ * @brief Saves gift information to a file.
+ * 
+ * @param gifts A vector of Gift objects to be saved.
+ * @param filename The name of the file where gift information will be saved.
+ * @param checkpoint The transaction log position the gift list is consistent with.
+ * @throws std::runtime_error If the file cannot be opened or fully written.
+ */
+void FileManager::saveGifts(const std::vector<Gift>& gifts, const std::string& filename, const Checkpoint& checkpoint) {
+    TRACE_SPAN("FileManager::saveGifts");
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for saving gifts.");
+    }
+    else {
+        // do nothing
+    }
+    writeCheckpoint(file, checkpoint);
+    for (const auto& gift : gifts) {
+        file << gift.getGiftName() << "\n"
+             << gift.getRequiredPoints() << "\n";
+        if (gift.isLimited()) {
+            file << gift.getStock() << "\n";
+        }
+        else {
+            // do nothing
+        }
+        file << "\n";
+    }
+    closeSaved(file, filename);
+}
+
+
+/**
+ * @brief Loads gift information from a file.
+ * 
+ * @param filename The name of the file from which gift information will be loaded.
+ * @param checkpoint If not null, receives the file's checkpoint (all zero for files written before checkpoints).
+ * @return std::vector<Gift> A vector of Gift objects loaded from the file.
+ * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing gift data.
+ */
+std::vector<Gift> FileManager::loadGifts(const std::string& filename, Checkpoint* checkpoint) {
+    TRACE_SPAN("FileManager::loadGifts");
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for loading gifts.");
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<Gift> gifts;
+    std::string giftName, requiredPointsStr, stockStr;
+
+    while (std::getline(file, giftName)) {
+        if (giftName.empty() || readCheckpoint(giftName, checkpoint)) continue;
+        else {
+            // do nothing
+        }
+        std::getline(file, requiredPointsStr);
+        // A limited gift has its stock on a third line; an unlimited one goes straight to the blank line
+        if (!std::getline(file, stockStr)) {
+            stockStr.clear();
+        }
+        else {
+            // do nothing
+        }
+
+        try {
+            gifts.emplace_back(giftName, std::stoi(requiredPointsStr),
+                               stockStr.empty() ? Gift::UNLIMITED : std::stoi(stockStr));
+        } catch (const std::invalid_argument& e) {
+            throw std::runtime_error("Error parsing gift data: " + std::string(e.what()));
+        }
+    }
+    return gifts;
+}
+
+
+/**
+ * @brief Saves the customers' dated lots of expiring points to a file.
+ * 
+ * Each customer with lots takes a line with the Customer ID, then a line per lot with its expiry time and
+ * points, then a blank line.
+ * 
+ * @param pointLots The lots of each customer.
+ * @param filename The name of the file where the lots will be saved.
+ * @param checkpoint The transaction log position the lots are consistent with.
+ * @throws std::runtime_error If the file cannot be opened or fully written.
+ */
+void FileManager::savePointLots(const std::vector<PointLots>& pointLots, const std::string& filename,
+                                const Checkpoint& checkpoint) {
+    TRACE_SPAN("FileManager::savePointLots");
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for saving point lots.");
+    }
+    else {
+        // do nothing
+    }
+    writeCheckpoint(file, checkpoint);
+    for (const PointLots& lots : pointLots) {
+        if (lots.getLots().empty()) {
+            continue;
+        }
+        else {
+            // do nothing
+        }
+        file << lots.getCustomerID() << "\n";
+        for (const PointLots::Lot& lot : lots.getLots()) {
+            file << lot.expiresAt << " " << lot.points << "\n";
+        }
+        file << "\n";
+    }
+    closeSaved(file, filename);
+}
+
+
+/**
+ * @brief Loads the customers' dated lots of expiring points from a file.
+ * 
+ * @param filename The name of the file from which the lots will be loaded.
+ * @param checkpoint If not null, receives the file's checkpoint.
+ * @return std::vector<PointLots> The lots of each customer in the file.
+ * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing a lot.
+ */
+std::vector<PointLots> FileManager::loadPointLots(const std::string& filename, Checkpoint* checkpoint) {
+    TRACE_SPAN("FileManager::loadPointLots");
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for loading point lots.");
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<PointLots> pointLots;
+    std::string customerID, line;
+    while (std::getline(file, customerID)) {
+        if (customerID.empty() || readCheckpoint(customerID, checkpoint)) continue;
+        else {
+            // do nothing
+        }
+        pointLots.emplace_back(customerID);
+        while (std::getline(file, line) && !line.empty()) {
+            std::istringstream fields(line);
+            std::int64_t expiresAt;
+            int points;
+            if (!(fields >> expiresAt >> points)) {
+                throw std::runtime_error("Error parsing point lot for " + customerID + ": " + line);
+            }
+            else {
+                pointLots.back().add(expiresAt, points);
+            }
+        }
+    }
+    return pointLots;
+}
+
+
+/**
+ * @brief Saves the customers' lifetime totals to a file.
+ * 
+ * Each customer with orders takes one line: the Customer ID, the spending in cents, the order count and the
+ * time of the last order.
+ * 
+ * @param totals The totals of each customer.
+ * @param filename The name of the file where the totals will be saved.
+ * @param checkpoint The transaction log position the totals are consistent with.
+ * @throws std::runtime_error If the file cannot be opened or fully written.
+ */
+void FileManager::saveCustomerTotals(const std::vector<CustomerTotals>& totals, const std::string& filename,
+                                     const Checkpoint& checkpoint) {
+    TRACE_SPAN("FileManager::saveCustomerTotals");
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for saving customer totals.");
+    }
+    else {
+        // do nothing
+    }
+    writeCheckpoint(file, checkpoint);
+    for (const CustomerTotals& customer : totals) {
+        if (customer.getOrderCount() > 0) {
+            file << customer.getCustomerID() << " " << customer.getSpendCents() << " " << customer.getOrderCount()
+                 << " " << customer.getLastPurchase() << "\n";
+        }
+        else {
+            // do nothing
+        }
+    }
+    closeSaved(file, filename);
+}
+
+
+/**
+ * @brief Loads the customers' lifetime totals from a file.
+ * 
+ * @param filename The name of the file from which the totals will be loaded.
+ * @param checkpoint If not null, receives the file's checkpoint.
+ * @return std::vector<CustomerTotals> The totals of each customer in the file.
+ * @throws std::runtime_error If the file cannot be opened for reading or if there is an error parsing a line.
+ */
+std::vector<CustomerTotals> FileManager::loadCustomerTotals(const std::string& filename, Checkpoint* checkpoint) {
+    TRACE_SPAN("FileManager::loadCustomerTotals");
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for loading customer totals.");
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<CustomerTotals> totals;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || readCheckpoint(line, checkpoint)) continue;
+        else {
+            // do nothing
+        }
+        std::istringstream fields(line);
+        std::string customerID;
+        std::int64_t spendCents, orderCount, lastPurchase;
+        if (!(fields >> customerID >> spendCents >> orderCount >> lastPurchase)) {
+            throw std::runtime_error("Error parsing customer totals: " + line);
+        }
+        else {
+            totals.emplace_back(customerID, spendCents, orderCount, lastPurchase);
+        }
+    }
+    return totals;
+}
+
+
+/**
+ * @brief Atomically replaces a file with a freshly written temporary file.
+ * 
+ * The temporary file is flushed to disk first, so a crash soon after the rename cannot leave the new name
+ * pointing at contents that were never written.
+ * 
+ * @param tempFilename The fully written temporary file.
+ * @param filename The file to replace.
+ * @throws std::runtime_error If the temporary file cannot be flushed or the rename fails.
+ */
+void FileManager::replaceFile(const std::string& tempFilename, const std::string& filename) {
+    int fd = ::open(tempFilename.c_str(), O_RDONLY | O_CLOEXEC);
+    bool synced = fd >= 0 && ::fsync(fd) == 0;
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    else {
+        // do nothing
+    }
+    if (!synced) {
+        throw std::runtime_error("Failed to flush " + tempFilename + " to disk.");
+    }
+    else if (std::rename(tempFilename.c_str(), filename.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace " + filename + " with " + tempFilename + ".");
+    }
+    else {
+        // do nothing
+    }
+}
@@ -0,0 +1,434 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "LazyCustomerFile.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char INDEX_MAGIC[8] = {'C', 'U', 'S', 'T', 'I', 'D', 'X', '1'};
+constexpr int LINES_PER_RECORD = 7;   // ID, username, first, last, age, card, points
+
+/**
+ * @brief Buffered line reader over a file descriptor using pread, so it never moves a shared file position.
+ */
+class LineReader {
+public:
+    explicit LineReader(int fd) : fd(fd) {}
+
+    bool next(std::string& line) {
+        line.clear();
+        while (true) {
+            std::size_t newline = buffer.find('\n', position);
+            if (newline != std::string::npos) {
+                line.append(buffer, position, newline - position);
+                position = newline + 1;
+                return true;
+            }
+            else {
+                line.append(buffer, position, std::string::npos);
+            }
+
+            buffer.resize(1 << 20);
+            ssize_t count = ::pread(fd, &buffer[0], buffer.size(), static_cast<off_t>(offset));
+            if (count <= 0) {
+                buffer.clear();
+                position = 0;
+                return !line.empty();
+            }
+            else {
+                buffer.resize(static_cast<std::size_t>(count));
+                offset += static_cast<std::uint64_t>(count);
+                position = 0;
+            }
+        }
+    }
+
+private:
+    int fd;
+    std::uint64_t offset = 0;
+    std::string buffer;
+    std::size_t position = 0;
+};
+
+bool isCheckpointLine(const std::string& line) {
+    return line.compare(0, 12, "#checkpoint ") == 0;
+}
+
+} // namespace
+
+/**
+ * @brief Opens a customer file for lazy access, building its index first if needed.
+ *
+ * @param filename The customer file. Its index is filename + ".idx".
+ * @param checkpoint If not null, receives the checkpoint header of the customer file.
+ * @return std::shared_ptr<LazyCustomerFile> The opened file.
+ * @throws std::runtime_error If the file cannot be opened or indexed.
+ */
+std::shared_ptr<LazyCustomerFile> LazyCustomerFile::open(const std::string& filename, Checkpoint* checkpoint) {
+    TRACE_SPAN("LazyCustomerFile::open");
+    std::shared_ptr<LazyCustomerFile> file(new LazyCustomerFile());
+
+    file->dataFile = ::open(filename.c_str(), O_RDONLY);
+    struct stat dataStat;
+    if (file->dataFile < 0 || ::fstat(file->dataFile, &dataStat) != 0) {
+        throw std::runtime_error("Failed to open file for loading customers.");
+    }
+    else {
+        file->dataSize = static_cast<std::uint64_t>(dataStat.st_size);
+    }
+
+    std::string indexFilename = filename + ".idx";
+    for (int attempt = 0; attempt < 2 && file->entries == nullptr; ++attempt) {
+        int indexFile = ::open(indexFilename.c_str(), O_RDONLY);
+        struct stat indexStat;
+        if (indexFile >= 0 && ::fstat(indexFile, &indexStat) == 0 &&
+            static_cast<std::size_t>(indexStat.st_size) >= sizeof(IndexHeader)) {
+            void* mapping = ::mmap(nullptr, static_cast<std::size_t>(indexStat.st_size), PROT_READ, MAP_SHARED, indexFile, 0);
+            const IndexHeader* header = static_cast<const IndexHeader*>(mapping);
+
+            if (mapping != MAP_FAILED &&
+                std::memcmp(header->magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) == 0 &&
+                header->dataSize == file->dataSize &&
+                header->dataModifiedSeconds == dataStat.st_mtim.tv_sec &&
+                header->dataModifiedNanoseconds == dataStat.st_mtim.tv_nsec &&
+                static_cast<std::size_t>(indexStat.st_size) == sizeof(IndexHeader) + header->entryCount * sizeof(IndexEntry)) {
+                file->mapping = mapping;
+                file->mappingSize = static_cast<std::size_t>(indexStat.st_size);
+                file->entries = reinterpret_cast<const IndexEntry*>(header + 1);
+                file->entryCount = static_cast<std::size_t>(header->entryCount);
+            }
+            else if (mapping != MAP_FAILED) {
+                ::munmap(mapping, static_cast<std::size_t>(indexStat.st_size));
+            }
+            else {
+                // do nothing
+            }
+        }
+        else {
+            // do nothing
+        }
+        if (indexFile >= 0) {
+            ::close(indexFile);
+        }
+        else {
+            // do nothing
+        }
+
+        if (file->entries == nullptr && attempt == 0) {
+            // Missing or stale: one full scan now makes the following startups instant
+            buildIndex(filename, indexFilename + ".tmp");
+            FileManager::replaceFile(indexFilename + ".tmp", indexFilename);
+        }
+        else {
+            // do nothing
+        }
+    }
+    if (file->entries == nullptr) {
+        throw std::runtime_error("Failed to index " + filename + ".");
+    }
+    else {
+        // do nothing
+    }
+
+    if (checkpoint != nullptr) {
+        char head[128] = {};
+        ssize_t count = ::pread(file->dataFile, head, sizeof(head) - 1, 0);
+        std::string line(head, count > 0 ? static_cast<std::size_t>(count) : 0);
+        line = line.substr(0, line.find('\n'));
+        if (isCheckpointLine(line)) {
+            std::istringstream fields(line.substr(12));
+            fields >> checkpoint->sequence >> checkpoint->logOffset;
+        }
+        else {
+            // do nothing
+        }
+    }
+    else {
+        // do nothing
+    }
+    return file;
+}
+
+/**
+ * @brief Writes the offset index for a customer data file.
+ *
+ * @param dataFilename The customer file to scan.
+ * @param indexFilename The index file to write.
+ * @throws std::runtime_error If either file cannot be opened, the index cannot be written, or a Customer ID is too
+ *         long to index.
+ */
+void LazyCustomerFile::buildIndex(const std::string& dataFilename, const std::string& indexFilename) {
+    TRACE_SPAN("LazyCustomerFile::buildIndex");
+    int data = ::open(dataFilename.c_str(), O_RDONLY);
+    struct stat dataStat;
+    if (data < 0 || ::fstat(data, &dataStat) != 0) {
+        if (data >= 0) {
+            ::close(data);
+        }
+        else {
+            // do nothing
+        }
+        throw std::runtime_error("Failed to open file for indexing customers.");
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<IndexEntry> index;
+    LineReader reader(data);
+    std::string line;
+    std::uint64_t offset = 0;
+    bool tooLong = false;
+
+    while (reader.next(line)) {
+        std::uint64_t lineStart = offset;
+        offset += line.size() + 1;
+        if (line.empty() || isCheckpointLine(line)) {
+            continue;
+        }
+        else if (line.size() >= ID_LENGTH) {
+            tooLong = true;
+            break;
+        }
+        else {
+            IndexEntry entry = {};
+            std::memcpy(entry.customerID, line.data(), line.size());
+            entry.offset = lineStart;
+            index.push_back(entry);
+        }
+
+        for (int i = 1; i < LINES_PER_RECORD && reader.next(line); ++i) {
+            offset += line.size() + 1;
+        }
+    }
+    ::close(data);
+    if (tooLong) {
+        throw std::runtime_error("Customer ID too long to index in " + dataFilename + ".");
+    }
+    else {
+        // do nothing
+    }
+
+    std::sort(index.begin(), index.end(), [](const IndexEntry& a, const IndexEntry& b) {
+        return std::memcmp(a.customerID, b.customerID, ID_LENGTH) < 0;
+    });
+
+    IndexHeader header = {};
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.dataSize = static_cast<std::uint64_t>(dataStat.st_size);
+    header.dataModifiedSeconds = dataStat.st_mtim.tv_sec;
+    header.dataModifiedNanoseconds = dataStat.st_mtim.tv_nsec;
+    header.entryCount = index.size();
+
+    std::ofstream out(indexFilename, std::ios::binary);
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open file for saving customer index.");
+    }
+    else {
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(index.data()),
+                  static_cast<std::streamsize>(index.size() * sizeof(IndexEntry)));
+        out.close();
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write " + indexFilename + ".");
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Releases the index mapping and closes the data file.
+ */
+LazyCustomerFile::~LazyCustomerFile() {
+    if (mapping != nullptr) {
+        ::munmap(mapping, mappingSize);
+    }
+    else {
+        // do nothing
+    }
+    if (dataFile >= 0) {
+        ::close(dataFile);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Binary-searches the index for a Customer ID.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return const IndexEntry* The entry, or nullptr if the file does not hold the customer.
+ */
+const LazyCustomerFile::IndexEntry* LazyCustomerFile::find(const std::string& customerID) const {
+    if (customerID.size() >= ID_LENGTH) {
+        return nullptr;
+    }
+    else {
+        // do nothing
+    }
+
+    char key[ID_LENGTH] = {};
+    std::memcpy(key, customerID.data(), customerID.size());
+    const IndexEntry* end = entries + entryCount;
+    const IndexEntry* it = std::lower_bound(entries, end, key, [](const IndexEntry& entry, const char* k) {
+        return std::memcmp(entry.customerID, k, ID_LENGTH) < 0;
+    });
+    return it != end && std::memcmp(it->customerID, key, ID_LENGTH) == 0 ? it : nullptr;
+}
+
+/**
+ * @brief Checks whether the file holds a customer, without decoding it.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return bool True if the customer is in the file.
+ */
+bool LazyCustomerFile::contains(const std::string& customerID) const {
+    return find(customerID) != nullptr;
+}
+
+/**
+ * @brief Reads the seven lines of the record starting at offset.
+ *
+ * @param offset Byte offset of the record's Customer ID line.
+ * @return std::string The record text, one field per line.
+ * @throws std::runtime_error If the record is truncated.
+ */
+std::string LazyCustomerFile::readRecord(std::uint64_t offset) const {
+    std::string record(256, '\0');
+    while (true) {
+        ssize_t count = ::pread(dataFile, &record[0], record.size(), static_cast<off_t>(offset));
+        std::size_t length = count > 0 ? static_cast<std::size_t>(count) : 0;
+
+        int lines = 0;
+        for (std::size_t i = 0; i < length; ++i) {
+            if (record[i] == '\n' && ++lines == LINES_PER_RECORD) {
+                record.resize(i + 1);
+                return record;
+            }
+            else {
+                // do nothing
+            }
+        }
+        if (length < record.size() || record.size() >= (1 << 16)) {
+            throw std::runtime_error("Error parsing customer data: truncated record.");
+        }
+        else {
+            record.resize(record.size() * 2);
+        }
+    }
+}
+
+/**
+ * @brief Builds a Customer from the text of one record.
+ *
+ * @param record The record text.
+ * @return Customer The validated customer.
+ * @throws std::runtime_error If a numeric field cannot be parsed.
+ */
+Customer LazyCustomerFile::parseRecord(const std::string& record) {
+    TRACE_SPAN("LazyCustomerFile::decode");
+    std::istringstream lines(record);
+    std::string customerID, userName, firstName, lastName, ageStr, creditCardNumber, rewardPointsStr;
+    std::getline(lines, customerID);
+    std::getline(lines, userName);
+    std::getline(lines, firstName);
+    std::getline(lines, lastName);
+    std::getline(lines, ageStr);
+    std::getline(lines, creditCardNumber);
+    std::getline(lines, rewardPointsStr);
+
+    try {
+        return Customer(customerID, userName, firstName, lastName, std::stoi(ageStr), creditCardNumber,
+                        std::stoi(rewardPointsStr));
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("Error parsing customer data: " + std::string(e.what()));
+    }
+}
+
+/**
+ * @brief Decodes and validates one customer.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return std::optional<Customer> The customer, or nothing if the file does not hold it.
+ * @throws std::runtime_error If the record cannot be read, parsed or validated.
+ */
+std::optional<Customer> LazyCustomerFile::load(const std::string& customerID) const {
+    const IndexEntry* entry = find(customerID);
+    if (entry == nullptr) {
+        return std::nullopt;
+    }
+    else {
+        return parseRecord(readRecord(entry->offset));
+    }
+}
+
+/**
+ * @brief Decodes the customer at an index position, in Customer ID order.
+ *
+ * @param position Index position, from 0 to size() - 1.
+ * @return Customer The decoded customer.
+ * @throws std::runtime_error If the record cannot be read, parsed or validated.
+ */
+Customer LazyCustomerFile::loadAt(std::size_t position) const {
+    return parseRecord(readRecord(entries[position].offset));
+}
+
+/**
+ * @brief Retrieves the Customer ID at an index position without decoding the record.
+ *
+ * @param position Index position, from 0 to size() - 1.
+ * @return std::string The Customer ID.
+ */
+std::string LazyCustomerFile::customerIDAt(std::size_t position) const {
+    const char* id = entries[position].customerID;
+    return std::string(id, strnlen(id, ID_LENGTH));
+}
+
+/**
+ * @brief Copies every record whose Customer ID is not in skipIDs to out, unchanged and without decoding.
+ *
+ * @param out The stream to write to.
+ * @param skipIDs IDs to leave out.
+ * @throws std::runtime_error If the data file cannot be read.
+ */
+void LazyCustomerFile::copyRecords(std::ostream& out, const std::unordered_set<std::string>& skipIDs) const {
+    TRACE_SPAN("LazyCustomerFile::copyRecords");
+    LineReader reader(dataFile);
+    std::string line;
+    std::string record;
+
+    while (reader.next(line)) {
+        if (line.empty() || isCheckpointLine(line)) {
+            continue;
+        }
+        else {
+            // do nothing
+        }
+
+        bool keep = skipIDs.find(line) == skipIDs.end();
+        record = line;
+        record += '\n';
+        for (int i = 1; i < LINES_PER_RECORD && reader.next(line); ++i) {
+            record += line;
+            record += '\n';
+        }
+        if (keep) {
+            out << record << '\n';
+        }
+        else {
+            // do nothing
+        }
+    }
+}
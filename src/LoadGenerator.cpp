@@ -0,0 +1,340 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "LoadGenerator.h"
+#include "SocketServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Latencies recorded by one client, in nanoseconds, per LoadOperation.
+ */
+struct ClientSamples {
+    std::array<std::vector<std::uint64_t>, LOAD_OPERATION_COUNT> latencies;
+    std::array<std::uint64_t, LOAD_OPERATION_COUNT> errors = {};
+};
+
+/**
+ * @brief Builds a random request of the given kind.
+ */
+std::string makeRequest(LoadOperation operation, const LoadCatalog& catalog, std::mt19937_64& gen,
+                        unsigned client, std::uint64_t& registrations) {
+    auto pick = [&gen](const std::vector<std::string>& ids) -> const std::string& {
+        return ids[std::uniform_int_distribution<std::size_t>(0, ids.size() - 1)(gen)];
+    };
+
+    switch (operation) {
+        case LoadOperation::Lookup:
+            return "LOOKUP " + pick(catalog.customerIDs);
+        case LoadOperation::Checkout: {
+            std::string request = "CHECKOUT " + pick(catalog.customerIDs);
+            int lines = std::uniform_int_distribution<int>(1, 3)(gen);
+            for (int i = 0; i < lines; ++i) {
+                request += " " + pick(catalog.productIDs) + ":1";
+            }
+            return request;
+        }
+        case LoadOperation::Redemption: {
+            int gift = std::uniform_int_distribution<int>(1, std::max(1, catalog.giftCount))(gen);
+            return "REDEEM " + pick(catalog.customerIDs) + " " + std::to_string(gift);
+        }
+        default:
+            // "U" + 3 digits + 6 or more letters and digits, unique per client and request
+            return "REGISTER U" + std::to_string(100 + client % 900) + "load" + std::to_string(client) + "x" +
+                   std::to_string(registrations++) + " Load Client 30 1234-5678-9012";
+    }
+}
+
+/**
+ * @brief Summarizes a set of latencies given in nanoseconds.
+ */
+LatencySummary summarize(std::vector<std::uint64_t>& latencies, std::uint64_t errors) {
+    LatencySummary summary;
+    summary.count = latencies.size();
+    summary.errors = errors;
+    if (latencies.empty()) {
+        return summary;
+    }
+    else {
+        // do nothing
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&latencies](double q) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(q * latencies.size()));
+        return latencies[std::min(latencies.size() - 1, rank == 0 ? 0 : rank - 1)] / 1000.0;
+    };
+    summary.p50 = percentile(0.50);
+    summary.p99 = percentile(0.99);
+    summary.p999 = percentile(0.999);
+    summary.max = latencies.back() / 1000.0;
+    return summary;
+}
+
+} // namespace
+
+/**
+ * @brief Executes a request through the same parser the socket service uses.
+ *
+ * @param request The request line.
+ * @return bool True if the response was OK.
+ */
+bool InProcessTarget::execute(const std::string& request) {
+    return SocketServer::respond(service, request).compare(0, 2, "OK") == 0;
+}
+
+/**
+ * @brief Connects to a server.
+ *
+ * @param address "unix:<path>" or "tcp:<port>" (on 127.0.0.1), as given to --serve.
+ * @throws std::runtime_error If the connection cannot be made.
+ */
+SocketTarget::SocketTarget(const std::string& address) {
+    int result = -1;
+    if (address.compare(0, 5, "unix:") == 0) {
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        std::string path = address.substr(5);
+        std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        result = fd < 0 ? -1 : ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+    else if (address.compare(0, 4, "tcp:") == 0) {
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(std::atoi(address.c_str() + 4)));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        result = fd < 0 ? -1 : ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+    }
+    else {
+        throw std::runtime_error("Address must be unix:<path> or tcp:<port>, got " + address);
+    }
+
+    if (result != 0) {
+        std::string reason = std::strerror(errno);
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        else {
+            // do nothing
+        }
+        throw std::runtime_error("Failed to connect to " + address + " (" + reason + ")");
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Closes the connection.
+ */
+SocketTarget::~SocketTarget() {
+    ::close(fd);
+}
+
+/**
+ * @brief Sends one request and waits for its response line.
+ *
+ * @param request The request line.
+ * @return bool True if the response was OK.
+ * @throws std::runtime_error If the connection fails.
+ */
+bool SocketTarget::execute(const std::string& request) {
+    return this->request(request).compare(0, 2, "OK") == 0;
+}
+
+/**
+ * @brief Sends one request and waits for its response line.
+ *
+ * @param request The request line.
+ * @return std::string The response line.
+ * @throws std::runtime_error If the connection fails.
+ */
+std::string SocketTarget::request(const std::string& request) {
+    sendLine(request);
+    return readLine();
+}
+
+/**
+ * @brief Sends one line without waiting for a response.
+ *
+ * @param line The line.
+ * @throws std::runtime_error If the connection fails.
+ */
+void SocketTarget::sendLine(const std::string& line) {
+    std::string text = line + "\n";
+    std::size_t written = 0;
+    while (written < text.size()) {
+        ssize_t count = ::send(fd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+        if (count <= 0 && errno != EINTR) {
+            throw std::runtime_error("Connection lost while sending.");
+        }
+        else {
+            written += count > 0 ? static_cast<std::size_t>(count) : 0;
+        }
+    }
+}
+
+/**
+ * @brief Waits for the next line from the server.
+ *
+ * @return std::string The line.
+ * @throws std::runtime_error If the connection fails or is closed.
+ */
+std::string SocketTarget::readLine() {
+    std::size_t newline;
+    while ((newline = input.find('\n')) == std::string::npos) {
+        char buffer[4096];
+        ssize_t count = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (count == 0 || (count < 0 && errno != EINTR)) {
+            throw std::runtime_error("Connection lost while receiving.");
+        }
+        else {
+            input.append(buffer, count > 0 ? static_cast<std::size_t>(count) : 0);
+        }
+    }
+    std::string line = input.substr(0, newline);
+    input.erase(0, newline + 1);
+    return line;
+}
+
+/**
+ * @brief Shuts the connection down, so a thread blocked in readLine() returns.
+ */
+void SocketTarget::shutdown() {
+    ::shutdown(fd, SHUT_RDWR);
+}
+
+/**
+ * @brief Runs the load and collects latencies.
+ *
+ * @param config Clients, duration, rate and mix.
+ * @param catalog IDs to use in requests. Must hold at least one customer and one product.
+ * @param connect Creates one client's target; called once per client.
+ * @return LoadReport Throughput and latency percentiles.
+ * @throws std::runtime_error If a target cannot be created.
+ */
+LoadReport LoadGenerator::run(const LoadConfig& config, const LoadCatalog& catalog,
+                              const std::function<std::unique_ptr<LoadTarget>()>& connect) {
+    if (catalog.customerIDs.empty() || catalog.productIDs.empty()) {
+        throw std::runtime_error("Load generation needs at least one customer and one product.");
+    }
+    else {
+        // do nothing
+    }
+
+    unsigned clients = std::max(1u, config.clients);
+    std::vector<std::unique_ptr<LoadTarget>> targets;
+    for (unsigned i = 0; i < clients; ++i) {
+        targets.push_back(connect());   // connect everyone first so setup is not measured
+    }
+
+    std::vector<ClientSamples> samples(clients);
+    Clock::time_point start = Clock::now();
+    Clock::time_point deadline = start + std::chrono::duration_cast<Clock::duration>(
+                                             std::chrono::duration<double>(config.seconds));
+    Clock::duration interval = config.targetRate > 0.0
+        ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(clients / config.targetRate))
+        : Clock::duration::zero();
+
+    auto client = [&](unsigned id) {
+        std::mt19937_64 gen(0x9E3779B97F4A7C15ULL * (id + 1));
+        std::discrete_distribution<int> chooseOperation(config.mix.begin(), config.mix.end());
+        std::uint64_t registrations = 0;
+        ClientSamples& mine = samples[id];
+        // Stagger paced clients so they do not all fire at the same instant
+        Clock::time_point scheduled = start + interval * id / clients;
+
+        while (true) {
+            Clock::time_point sendTime = interval > Clock::duration::zero() ? scheduled : Clock::now();
+            if (sendTime >= deadline) {
+                break;
+            }
+            else if (interval > Clock::duration::zero()) {
+                std::this_thread::sleep_until(scheduled);
+                scheduled += interval;
+            }
+            else {
+                // do nothing
+            }
+
+            auto operation = static_cast<std::size_t>(chooseOperation(gen));
+            std::string request = makeRequest(static_cast<LoadOperation>(operation), catalog, gen, id, registrations);
+            bool ok = false;
+            bool connected = true;
+            try {
+                ok = targets[id]->execute(request);
+            } catch (const std::runtime_error&) {
+                connected = false;
+            }
+            mine.latencies[operation].push_back(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - sendTime).count()));
+            mine.errors[operation] += ok ? 0 : 1;
+            if (!connected) {
+                break;
+            }
+            else {
+                // do nothing
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < clients; ++i) {
+        threads.emplace_back(client, i);
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::vector<std::uint64_t> all;
+    std::uint64_t allErrors = 0;
+    for (std::size_t op = 0; op < LOAD_OPERATION_COUNT; ++op) {
+        std::vector<std::uint64_t> merged;
+        std::uint64_t errors = 0;
+        for (ClientSamples& s : samples) {
+            merged.insert(merged.end(), s.latencies[op].begin(), s.latencies[op].end());
+            errors += s.errors[op];
+        }
+        all.insert(all.end(), merged.begin(), merged.end());
+        allErrors += errors;
+        report.operations[op] = summarize(merged, errors);
+    }
+    report.overall = summarize(all, allErrors);
+    return report;
+}
+
+/**
+ * @brief Retrieves the display name of a request kind.
+ *
+ * @param operation The request kind.
+ * @return const char* Its name.
+ */
+const char* LoadGenerator::operationName(LoadOperation operation) {
+    switch (operation) {
+        case LoadOperation::Lookup:
+            return "lookup";
+        case LoadOperation::Checkout:
+            return "checkout";
+        case LoadOperation::Redemption:
+            return "redeem";
+        default:
+            return "register";
+    }
+}
@@ -0,0 +1,144 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "LogFollower.h"
+#include "Recovery.h"
+#include "Trace.h"
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Starts following a primary.
+ *
+ * @param store The store to apply the records to, already loaded from the data files.
+ * @param primaryAddress The primary's --replicate address.
+ * @param lastSequence The last sequence number already applied to the store.
+ * @param logOffset An offset in the log at or before the first record not yet applied.
+ */
+LogFollower::LogFollower(DataStore& store, std::string primaryAddress, std::uint64_t lastSequence,
+                         std::uint64_t logOffset)
+    : store(store), primaryAddress(std::move(primaryAddress)), logOffset(logOffset), applied(lastSequence),
+      lastHeard(std::chrono::steady_clock::now()) {
+    status.appliedSequence = lastSequence;
+    status.primarySequence = lastSequence;
+    thread = std::thread(&LogFollower::runLoop, this);
+}
+
+/**
+ * @brief Disconnects and stops the follower thread.
+ */
+LogFollower::~LogFollower() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        if (connection != nullptr) {
+            connection->shutdown();   // unblocks the thread's readLine()
+        }
+        else {
+            // do nothing
+        }
+    }
+    stopped.notify_all();
+    thread.join();
+}
+
+/**
+ * @brief Retrieves the replication status.
+ *
+ * @return Status The status now.
+ */
+LogFollower::Status LogFollower::getStatus() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Status now = status;
+    now.heartbeatAgeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - lastHeard).count();
+    return now;
+}
+
+/**
+ * @brief Follower thread: follows the primary, reconnecting every second while it cannot be reached.
+ */
+void LogFollower::runLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        lock.unlock();
+        try {
+            follow();
+        } catch (const std::runtime_error&) {
+            // do nothing: the primary is down or restarting; try again shortly
+        }
+        lock.lock();
+        connection.reset();
+        status.connected = false;
+        stopped.wait_for(lock, std::chrono::seconds(1), [this] { return stopping; });
+    }
+}
+
+/**
+ * @brief Connects to the primary and applies what it ships until the connection ends.
+ *
+ * @throws std::runtime_error If the connection fails or the primary refuses it.
+ */
+void LogFollower::follow() {
+    SocketTarget* target = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        else {
+            connection = std::make_unique<SocketTarget>(primaryAddress);
+            target = connection.get();
+        }
+    }
+
+    std::string reply = target->request("FOLLOW " + std::to_string(applied.through()) + " " + std::to_string(logOffset));
+    if (reply != "OK") {
+        throw std::runtime_error("The primary refused to ship its log: " + reply);
+    }
+    else {
+        std::lock_guard<std::mutex> lock(mutex);
+        status.connected = true;
+        lastHeard = std::chrono::steady_clock::now();
+    }
+
+    std::vector<std::string> record;
+    while (true) {
+        std::string line = target->readLine();
+        if (line.compare(0, 6, "#head ") == 0) {
+            std::istringstream fields(line.substr(6));
+            std::uint64_t head = 0;
+            long long noticedMs = 0;
+            fields >> head >> noticedMs;
+            long long nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            std::lock_guard<std::mutex> lock(mutex);
+            status.primarySequence = head;
+            status.lastDelayMs = static_cast<double>(nowMs - noticedMs);
+            lastHeard = std::chrono::steady_clock::now();
+        }
+        else if (!line.empty()) {
+            record.push_back(line);
+        }
+        else if (!record.empty()) {
+            TRACE_SPAN("LogFollower::apply");
+            std::uint64_t sequence = Recovery::sequenceOf(record);
+            if (applied.insert(sequence)) {
+                bool ok;
+                {
+                    auto state = store.write();
+                    ok = Recovery::apply(state, record);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                status.appliedSequence = applied.through();
+                status.recordsApplied += ok ? 1 : 0;
+                status.recordsSkipped += ok ? 0 : 1;
+            }
+            else {
+                // do nothing: already applied before a reconnect
+            }
+            record.clear();
+        }
+        else {
+            // do nothing
+        }
+    }
+}
@@ -0,0 +1,228 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "LogShipper.h"
+#include "Recovery.h"
+#include "SequenceSet.h"
+#include "SocketServer.h"
+#include "TransactionLog.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int HEARTBEAT_MS = 250;   // heartbeat interval while the log is idle
+
+/**
+ * @brief Sends the whole string, returning false once the follower has gone.
+ */
+bool sendAll(int fd, const std::string& text) {
+    std::size_t written = 0;
+    while (written < text.size()) {
+        ssize_t count = ::send(fd, text.data() + written, text.size() - written, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (count <= 0) {
+            return false;
+        }
+        else {
+            written += static_cast<std::size_t>(count);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Milliseconds since the epoch, comparable between processes on one machine.
+ */
+long long wallClockMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+/**
+ * @brief Starts listening for followers.
+ *
+ * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+ * @param logFilename The transaction log to ship.
+ * @throws std::runtime_error If the address cannot be bound.
+ */
+LogShipper::LogShipper(const std::string& address, std::string logFilename) : logFilename(std::move(logFilename)) {
+    listenFd = SocketServer::listenOn(address, unixPath);
+    stopFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (stopFd < 0) {
+        ::close(listenFd);
+        throw std::runtime_error(std::string("Failed to create the shipper's eventfd (") + std::strerror(errno) + ")");
+    }
+    else {
+        acceptThread = std::thread(&LogShipper::acceptLoop, this);
+    }
+}
+
+/**
+ * @brief Disconnects every follower and stops the threads.
+ */
+LogShipper::~LogShipper() {
+    std::uint64_t one = 1;
+    ssize_t written = ::write(stopFd, &one, sizeof(one));
+    (void)written;
+    acceptThread.join();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int fd : followerFds) {
+            ::shutdown(fd, SHUT_RDWR);   // a sender blocked on a slow follower returns at once
+        }
+    }
+    for (std::thread& sender : senders) {
+        sender.join();
+    }
+    ::close(listenFd);
+    ::close(stopFd);
+    if (!unixPath.empty()) {
+        ::unlink(unixPath.c_str());
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Retrieves the shipper counters.
+ *
+ * @return Stats The counters so far.
+ */
+LogShipper::Stats LogShipper::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Accept thread: starts a sender thread for every follower that connects.
+ */
+void LogShipper::acceptLoop() {
+    pollfd fds[2] = {{listenFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+    while (true) {
+        if (::poll(fds, 2, -1) < 0) {
+            continue;   // interrupted by a signal
+        }
+        else if (fds[1].revents != 0) {
+            return;
+        }
+        else {
+            // do nothing
+        }
+
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd >= 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            followerFds.push_back(fd);
+            stats.followersConnected++;
+            senders.emplace_back(&LogShipper::ship, this, fd);
+        }
+        else {
+            // do nothing: the follower gave up before it was accepted
+        }
+    }
+}
+
+/**
+ * @brief Sender thread: ships one follower the records it is missing, then each new record as it is written.
+ *
+ * @param fd The follower's connection.
+ */
+void LogShipper::ship(int fd) {
+    // Handshake: "FOLLOW <lastSequence> <logOffset>"
+    std::string request;
+    char c;
+    while (request.size() < 256 && ::recv(fd, &c, 1, 0) == 1 && c != '\n') {
+        request += c;
+    }
+    std::istringstream words(request);
+    std::string command;
+    std::uint64_t lastSent = 0;
+    std::uint64_t offset = 0;
+    bool ok = words >> command >> lastSent >> offset && command == "FOLLOW" &&
+              sendAll(fd, "OK\n");
+
+    // Wake on every write to the log; watching the directory also sees the log being replaced
+    std::filesystem::path path(logFilename);
+    std::string name = path.filename().string();
+    std::string directory = path.has_parent_path() ? path.parent_path().string() : ".";
+    int inotifyFd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    ok = ok && inotifyFd >= 0 &&
+         ::inotify_add_watch(inotifyFd, directory.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) >= 0;
+
+    // Records can reach the log out of sequence order, so remember each one sent rather than only the highest
+    SequenceSet sent(lastSent);
+    std::uint64_t head = lastSent;
+    pollfd fds[2] = {{inotifyFd, POLLIN, 0}, {stopFd, POLLIN, 0}};
+    while (ok) {
+        long long noticed = wallClockMs();
+        TransactionLog& log = TransactionLog::get(logFilename);
+        if (log.endOffset() < offset) {
+            offset = 0;   // the log was replaced; sequence numbers still say what the follower has
+        }
+        else {
+            // do nothing
+        }
+
+        // Ship each complete record, i.e. each one already followed by its blank line
+        std::string batch;
+        std::uint64_t shipped = 0;
+        offset = log.scan(offset, [&](std::uint64_t, const std::vector<std::string>& record) {
+            std::uint64_t sequence = Recovery::sequenceOf(record);
+            head = std::max(head, sequence);
+            if (sent.insert(sequence)) {
+                for (const std::string& recordLine : record) {
+                    batch += recordLine + "\n";
+                }
+                batch += "\n";
+                ++shipped;
+            }
+            else {
+                // do nothing: the follower has it, or it predates sequence numbers
+            }
+        });
+        ok = sendAll(fd, batch + "#head " + std::to_string(head) + " " + std::to_string(noticed) + "\n");
+        if (shipped > 0) {
+            std::lock_guard<std::mutex> lock(mutex);
+            stats.recordsShipped += shipped;
+        }
+        else {
+            // do nothing
+        }
+
+        // Sleep until the log changes, the heartbeat is due, or the shipper stops
+        if (ok && ::poll(fds, 2, HEARTBEAT_MS) > 0) {
+            ok = fds[1].revents == 0;
+            alignas(inotify_event) char buffer[4096];
+            while (::read(inotifyFd, buffer, sizeof(buffer)) > 0) {
+                // do nothing: any event is a reason to look at the log again
+            }
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    if (inotifyFd >= 0) {
+        ::close(inotifyFd);
+    }
+    else {
+        // do nothing
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    followerFds.erase(std::remove(followerFds.begin(), followerFds.end(), fd), followerFds.end());
+    ::close(fd);
+}
@@ -0,0 +1,139 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "LogWriter.h"
+#include "FileManager.h"
+#include "Trace.h"
+#include <algorithm>
+
+/**
+ * @brief Starts the I/O thread.
+ *
+ * @param executor Where waiting coroutines are resumed once their records are written.
+ * @param filename The transaction log.
+ */
+LogWriter::LogWriter(Executor& executor, std::string filename)
+    : executor(executor), filename(std::move(filename)), thread(&LogWriter::runLoop, this) {}
+
+/**
+ * @brief Writes everything still queued, resumes the waiters and stops the I/O thread.
+ */
+LogWriter::~LogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        exiting = true;
+    }
+    queued.notify_one();
+    thread.join();
+}
+
+/**
+ * @brief Queues records for the next write.
+ *
+ * @param records One or more formatted records.
+ * @param count How many records the string holds, for the statistics.
+ * @return Ticket The ticket to await with flushed().
+ */
+LogWriter::Ticket LogWriter::enqueue(std::string records, std::uint64_t count) {
+    Ticket ticket;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (pending.empty()) {
+            pending.swap(records);   // a large batch is not copied
+        }
+        else {
+            pending += records;
+        }
+        pendingRecords += count;
+        ticket = ++lastTicket;
+    }
+    queued.notify_one();
+    return ticket;
+}
+
+/**
+ * @brief Blocks the calling thread until the records of a ticket are in the log file.
+ *
+ * @param ticket A ticket returned by enqueue().
+ */
+void LogWriter::waitFlushed(Ticket ticket) {
+    std::unique_lock<std::mutex> lock(mutex);
+    written.wait(lock, [this, ticket] { return ticket <= flushedThrough; });
+}
+
+/**
+ * @brief Retrieves the write counters.
+ *
+ * @return Stats The counters so far.
+ */
+LogWriter::Stats LogWriter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Checks whether a ticket's records are already in the file.
+ */
+bool LogWriter::isFlushed(Ticket ticket) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return ticket <= flushedThrough;
+}
+
+/**
+ * @brief Parks a coroutine until its ticket is flushed.
+ *
+ * @return bool False if the ticket was flushed meanwhile, so the coroutine should just continue.
+ */
+bool LogWriter::addWaiter(Ticket ticket, std::coroutine_handle<> handle) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (ticket <= flushedThrough) {
+        return false;
+    }
+    else {
+        waiters.push_back(Waiter{ticket, handle});
+        return true;
+    }
+}
+
+/**
+ * @brief I/O thread: writes whatever has queued up since the last write, then wakes its waiters.
+ */
+void LogWriter::runLoop() {
+    while (true) {
+        std::string batch;
+        std::uint64_t batchRecords;
+        Ticket batchTicket;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            queued.wait(lock, [this] { return exiting || !pending.empty(); });
+            if (pending.empty()) {
+                return;   // exiting, and every record is written
+            }
+            else {
+                batch.swap(pending);
+                batchRecords = pendingRecords;
+                pendingRecords = 0;
+                batchTicket = lastTicket;
+            }
+        }
+
+        {
+            TRACE_SPAN("LogWriter::write");
+            FileManager::appendToLog(batch, filename);
+        }
+
+        std::vector<Waiter> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            flushedThrough = batchTicket;
+            stats.batches++;
+            stats.records += batchRecords;
+            auto split = std::partition(waiters.begin(), waiters.end(),
+                                        [batchTicket](const Waiter& w) { return w.ticket > batchTicket; });
+            ready.assign(split, waiters.end());
+            waiters.erase(split, waiters.end());
+        }
+        written.notify_all();
+        for (const Waiter& waiter : ready) {
+            executor.post(waiter.handle);
+        }
+    }
+}
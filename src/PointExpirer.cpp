@@ -0,0 +1,96 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "PointExpirer.h"
+#include "FileManager.h"
+#include "Recovery.h"
+#include "Trace.h"
+#include <ctime>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+/**
+ * @brief Constructor for the PointExpirer class. The thread starts immediately.
+ *
+ * @param store The store whose points expire.
+ * @param interval Time between expiry passes. Zero disables the background thread.
+ */
+PointExpirer::PointExpirer(DataStore& store, std::chrono::milliseconds interval)
+    : store(store), interval(interval) {
+    if (interval.count() > 0) {
+        worker = std::thread(&PointExpirer::run, this);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Stops the background thread.
+ */
+PointExpirer::~PointExpirer() {
+    stop();
+}
+
+/**
+ * @brief Stops the background thread and waits for an expiry pass in progress to finish.
+ */
+void PointExpirer::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Expires every lot due by a time and logs the expiries, in one step under the store's write lock.
+ *
+ * Logging under the lock keeps the records in sequence order with the checkouts around them.
+ *
+ * @param store The store whose points expire.
+ * @param now The time, in seconds since the epoch.
+ * @return std::size_t The number of points expired.
+ */
+std::size_t PointExpirer::expireDue(DataStore& store, std::int64_t now) {
+    TRACE_SPAN("PointExpirer::expireDue");
+    DataStore::WriteGuard state = store.write();
+    std::vector<std::pair<std::string, int>> expired = state.expireDuePoints(now);
+
+    std::vector<ChangeRecord> changes;
+    changes.reserve(expired.size());
+    std::size_t total = 0;
+    for (const auto& [customerID, points] : expired) {
+        changes.push_back(Recovery::pointsExpired(state.nextSequence(), customerID, points, now));
+        total += points;
+    }
+    if (!changes.empty()) {
+        state.appendLog(FileManager::formatChanges(changes), changes.size());
+    }
+    else {
+        // do nothing
+    }
+    return total;
+}
+
+/**
+ * @brief Background loop: wait an interval, then expire what came due.
+ */
+void PointExpirer::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wakeUp.wait_for(lock, interval, [this] { return stopping; })) {
+        // Expire without holding our mutex so stop() never waits behind the store's lock
+        lock.unlock();
+        try {
+            expireDue(store, std::time(nullptr));
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Point expiry failed: " << e.what() << "\n";
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,76 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "PointLots.h"
+#include <algorithm>
+#include <iterator>
+
+/**
+ * @brief Adds a lot, merging it with a lot that expires at the same time.
+ *
+ * Lots almost always arrive in order of expiry, so this is normally an append.
+ *
+ * @param expiresAt When the points expire, in seconds since the epoch.
+ * @param points The number of points.
+ */
+void PointLots::add(std::int64_t expiresAt, int points) {
+    if (points <= 0) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+    auto it = std::upper_bound(lots.begin(), lots.end(), expiresAt,
+                               [](std::int64_t time, const Lot& lot) { return time < lot.expiresAt; });
+    if (it != lots.begin() && std::prev(it)->expiresAt == expiresAt) {
+        std::prev(it)->points += points;
+    }
+    else {
+        lots.insert(it, Lot{expiresAt, points});
+    }
+    total += points;
+}
+
+/**
+ * @brief Spends points from the lots closest to expiring.
+ *
+ * @param points The number of points spent.
+ * @return int The points taken from the lots.
+ */
+int PointLots::spend(int points) {
+    int taken = 0;
+    std::size_t used = 0;
+    while (used < lots.size() && taken < points) {
+        int part = std::min(points - taken, lots[used].points);
+        lots[used].points -= part;
+        taken += part;
+        used += lots[used].points == 0 ? 1 : 0;
+    }
+    lots.erase(lots.begin(), lots.begin() + used);
+    total -= taken;
+    return taken;
+}
+
+/**
+ * @brief Removes the lots that expire at or before a time.
+ *
+ * @param now The time, in seconds since the epoch.
+ * @return int The points in the removed lots.
+ */
+int PointLots::expire(std::int64_t now) {
+    int expired = 0;
+    std::size_t used = 0;
+    while (used < lots.size() && lots[used].expiresAt <= now) {
+        expired += lots[used].points;
+        used++;
+    }
+    lots.erase(lots.begin(), lots.begin() + used);
+    total -= expired;
+    return expired;
+}
+
+/**
+ * @brief Removes every lot.
+ */
+void PointLots::clear() {
+    lots.clear();
+    total = 0;
+}
@@ -95,7 +95,8 @@ void Product::updateInventory(int change) {
  * @return bool Returns true if the product ID is valid, otherwise false.
  */
 bool Product::isProductIDValid(const std::string& productID) {
-    return std::regex_match(productID, std::regex("^Prod\\d{5}$"));
+    static const std::regex pattern("^Prod\\d{5}$");
+    return std::regex_match(productID, pattern);
 }
 
 
@@ -0,0 +1,498 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "ProductSearchIndex.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cctype>
+#include <span>
+
+namespace {
+
+std::string lowercase(std::string_view text) {
+    std::string lowered(text);
+    for (char& c : lowered) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    return lowered;
+}
+
+bool isWordCharacter(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) != 0;
+}
+
+} // namespace
+
+/**
+ * @brief Calls visit(key) with the rest of the name from the start of every word.
+ */
+template <typename Visit>
+void ProductSearchIndex::forEachWordStart(std::string_view name, Visit visit) {
+    for (std::size_t i = 0; i < name.size(); ++i) {
+        if (isWordCharacter(name[i]) && (i == 0 || !isWordCharacter(name[i - 1]))) {
+            visit(name.substr(i));
+        }
+        else {
+            // do nothing
+        }
+    }
+}
+
+/**
+ * @brief Calls visit(trigram) for every three characters of the text, packed into the low 24 bits.
+ */
+template <typename Visit>
+void ProductSearchIndex::forEachTrigram(std::string_view text, Visit visit) {
+    for (std::size_t i = 0; i + 3 <= text.size(); ++i) {
+        visit(static_cast<std::uint32_t>(static_cast<unsigned char>(text[i])) << 16 |
+              static_cast<std::uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8 |
+              static_cast<std::uint32_t>(static_cast<unsigned char>(text[i + 2])));
+    }
+}
+
+/**
+ * @brief Builds an index of the given products.
+ *
+ * @param products The products to index.
+ */
+ProductSearchIndex::ProductSearchIndex(const std::vector<Product>& products) : nodes(1) {
+    TRACE_SPAN("ProductSearchIndex::build");
+    entries.reserve(products.size());
+    slotOf.reserve(products.size());
+    for (const Product& product : products) {
+        add(product.getProductID(), product.getProductName());
+    }
+}
+
+/**
+ * @brief Adds a product, or renames it if its Product ID is already indexed.
+ *
+ * @param productID The product's unique identifier.
+ * @param productName The product's name.
+ */
+void ProductSearchIndex::add(const std::string& productID, const std::string& productName) {
+    remove(productID);
+
+    std::uint32_t slot;
+    if (freeSlots.empty()) {
+        slot = static_cast<std::uint32_t>(entries.size());
+        entries.emplace_back();
+    }
+    else {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }
+    Entry& entry = entries[slot];
+    entry.productID = productID;
+    entry.name = lowercase(productName);
+    entry.live = true;
+    slotOf.emplace(productID, slot);
+
+    forEachWordStart(entry.name, [this, slot](std::string_view key) { insertKey(key, slot); });
+    forEachTrigram(entry.name, [this, slot](std::uint32_t trigram) {
+        std::vector<std::uint32_t>& slots = postings[trigram];
+        if (slots.empty() || slots.back() < slot) {
+            slots.push_back(slot);   // the usual case: new slots are numbered upwards
+        }
+        else {
+            auto at = std::lower_bound(slots.begin(), slots.end(), slot);
+            if (at == slots.end() || *at != slot) {
+                slots.insert(at, slot);
+            }
+            else {
+                // do nothing: the trigram occurs more than once in the name
+            }
+        }
+    });
+}
+
+/**
+ * @brief Removes a product.
+ *
+ * @param productID The product's unique identifier.
+ * @return bool True if the product was indexed.
+ */
+bool ProductSearchIndex::remove(const std::string& productID) {
+    auto found = slotOf.find(productID);
+    if (found == slotOf.end()) {
+        return false;
+    }
+    else {
+        // do nothing
+    }
+
+    std::uint32_t slot = found->second;
+    slotOf.erase(found);
+    Entry& entry = entries[slot];
+    forEachWordStart(entry.name, [this, slot](std::string_view key) { eraseKey(key, slot); });
+    forEachTrigram(entry.name, [this, slot](std::uint32_t trigram) {
+        auto list = postings.find(trigram);
+        if (list != postings.end()) {
+            std::vector<std::uint32_t>& slots = list->second;
+            auto at = std::lower_bound(slots.begin(), slots.end(), slot);
+            if (at != slots.end() && *at == slot) {
+                slots.erase(at);
+            }
+            else {
+                // do nothing: already erased for an earlier occurrence of the trigram
+            }
+            if (slots.empty()) {
+                postings.erase(list);
+            }
+            else {
+                // do nothing
+            }
+        }
+        else {
+            // do nothing
+        }
+    });
+
+    entry.productID.clear();
+    entry.name.clear();
+    entry.live = false;
+    freeSlots.push_back(slot);
+    if (deadNodes * 2 > nodes.size()) {
+        rebuildTrie();
+    }
+    else {
+        // do nothing
+    }
+    return true;
+}
+
+/**
+ * @brief Adds one key to the trie, creating the missing nodes in character order.
+ *
+ * @param key The lowercased key.
+ * @param slot The product's slot.
+ */
+void ProductSearchIndex::insertKey(std::string_view key, std::uint32_t slot) {
+    std::uint32_t node = 0;
+    ++nodes[0].count;
+    for (char c : key) {
+        // Find the child for c, or the place to link a new one so the children stay sorted
+        std::uint32_t previous = NONE;
+        std::uint32_t child = nodes[node].child;
+        while (child != NONE && nodes[child].c < c) {
+            previous = child;
+            child = nodes[child].sibling;
+        }
+        if (child == NONE || nodes[child].c != c) {
+            std::uint32_t created = static_cast<std::uint32_t>(nodes.size());
+            nodes.emplace_back();
+            nodes[created].c = c;
+            nodes[created].sibling = child;
+            if (previous == NONE) {
+                nodes[node].child = created;
+            }
+            else {
+                nodes[previous].sibling = created;
+            }
+            child = created;
+        }
+        else if (nodes[child].count == 0) {
+            --deadNodes;   // a node left by a removed key is reused
+        }
+        else {
+            // do nothing
+        }
+        node = child;
+        ++nodes[node].count;
+    }
+
+    // Most keys end at a node of their own, so a single slot is kept in the node without a list
+    std::uint32_t& terminals = nodes[node].terminals;
+    if (terminals == NONE) {
+        terminals = slot;
+    }
+    else if ((terminals & LIST) == 0) {
+        terminalLists.push_back({terminals, slot});
+        terminals = LIST | static_cast<std::uint32_t>(terminalLists.size() - 1);
+    }
+    else {
+        terminalLists[terminals & ~LIST].push_back(slot);
+    }
+}
+
+/**
+ * @brief Removes one key from the trie. Nodes are kept with a count of zero so a later key can reuse them,
+ *        until remove() finds too many of them and rebuilds the trie.
+ *
+ * @param key The lowercased key.
+ * @param slot The product's slot.
+ */
+void ProductSearchIndex::eraseKey(std::string_view key, std::uint32_t slot) {
+    std::uint32_t node = 0;
+    --nodes[0].count;
+    for (char c : key) {
+        std::uint32_t child = nodes[node].child;
+        while (nodes[child].c != c) {
+            child = nodes[child].sibling;
+        }
+        node = child;
+        if (--nodes[node].count == 0) {
+            ++deadNodes;
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    std::uint32_t& terminals = nodes[node].terminals;
+    if (terminals == slot) {
+        terminals = NONE;
+    }
+    else {
+        std::vector<std::uint32_t>& slots = terminalLists[terminals & ~LIST];
+        slots.erase(std::find(slots.begin(), slots.end(), slot));
+    }
+}
+
+/**
+ * @brief Rebuilds the trie from the live products, dropping the nodes and terminal lists of removed keys.
+ *
+ * Runs once the dead nodes outnumber the live ones, so its cost is paid for by the removals that left them.
+ */
+void ProductSearchIndex::rebuildTrie() {
+    TRACE_SPAN("ProductSearchIndex::rebuildTrie");
+    nodes.assign(1, Node{});
+    terminalLists.clear();
+    deadNodes = 0;
+    for (std::uint32_t slot = 0; slot < entries.size(); ++slot) {
+        if (entries[slot].live) {
+            forEachWordStart(entries[slot].name, [this, slot](std::string_view key) { insertKey(key, slot); });
+        }
+        else {
+            // do nothing
+        }
+    }
+}
+
+/**
+ * @brief Walks the trie below the query in alphabetical order, collecting distinct slots.
+ *
+ * @param query The lowercased query.
+ * @param limit The most slots to collect.
+ * @param found Receives the slots.
+ */
+void ProductSearchIndex::prefixSlots(const std::string& query, std::size_t limit,
+                                     std::vector<std::uint32_t>& found) const {
+    std::uint32_t node = 0;
+    for (char c : query) {
+        std::uint32_t child = nodes[node].child;
+        while (child != NONE && nodes[child].c != c) {
+            child = nodes[child].sibling;
+        }
+        if (child == NONE) {
+            return;
+        }
+        else {
+            node = child;
+        }
+    }
+
+    std::vector<std::uint32_t> stack = {node};
+    std::vector<std::uint32_t> children;
+    while (!stack.empty() && found.size() < limit) {
+        node = stack.back();
+        stack.pop_back();
+        if (nodes[node].count == 0) {
+            continue;   // every key below was removed
+        }
+        else {
+            // do nothing
+        }
+
+        std::uint32_t terminals = nodes[node].terminals;
+        std::span<const std::uint32_t> slots;
+        if (terminals == NONE) {
+            // do nothing
+        }
+        else if ((terminals & LIST) == 0) {
+            slots = std::span<const std::uint32_t>(&nodes[node].terminals, 1);
+        }
+        else {
+            slots = terminalLists[terminals & ~LIST];
+        }
+        for (std::uint32_t slot : slots) {
+            // A product is reached once per word matching the query, e.g. "pho" in "Phone Photo"
+            if (found.size() < limit && std::find(found.begin(), found.end(), slot) == found.end()) {
+                found.push_back(slot);
+            }
+            else {
+                // do nothing
+            }
+        }
+
+        children.clear();
+        for (std::uint32_t child = nodes[node].child; child != NONE; child = nodes[child].sibling) {
+            children.push_back(child);
+        }
+        stack.insert(stack.end(), children.rbegin(), children.rend());   // smallest character on top
+    }
+}
+
+/**
+ * @brief Collects the slots of products containing the query, skipping those already found.
+ *
+ * @param query The lowercased query.
+ * @param limit The most slots to collect, counting those already found.
+ * @param found Receives the slots.
+ */
+void ProductSearchIndex::substringSlots(const std::string& query, std::size_t limit,
+                                        std::vector<std::uint32_t>& found) const {
+    auto accept = [&](std::uint32_t slot) {
+        if (entries[slot].name.find(query) != std::string::npos &&
+            std::find(found.begin(), found.end(), slot) == found.end()) {
+            found.push_back(slot);
+        }
+        else {
+            // do nothing
+        }
+    };
+
+    if (query.size() < 3) {
+        for (std::uint32_t slot = 0; slot < entries.size() && found.size() < limit; ++slot) {
+            if (entries[slot].live) {
+                accept(slot);
+            }
+            else {
+                // do nothing
+            }
+        }
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<const std::vector<std::uint32_t>*> lists;
+    bool missing = false;
+    forEachTrigram(query, [&](std::uint32_t trigram) {
+        auto list = postings.find(trigram);
+        if (list == postings.end()) {
+            missing = true;
+        }
+        else if (std::find(lists.begin(), lists.end(), &list->second) == lists.end()) {
+            lists.push_back(&list->second);
+        }
+        else {
+            // do nothing
+        }
+    });
+    if (missing) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    for (std::uint32_t slot : *lists.front()) {
+        if (found.size() >= limit) {
+            break;
+        }
+        else {
+            // do nothing
+        }
+        bool inAll = std::all_of(lists.begin() + 1, lists.end(), [slot](const auto* list) {
+            return std::binary_search(list->begin(), list->end(), slot);
+        });
+        if (inAll) {
+            accept(slot);   // the trigrams may occur apart, so confirm the whole query
+        }
+        else {
+            // do nothing
+        }
+    }
+}
+
+/**
+ * @brief Converts slots to Product IDs.
+ *
+ * @param slots The slots.
+ * @return std::vector<std::string> The Product IDs, in the same order.
+ */
+std::vector<std::string> ProductSearchIndex::productIDs(const std::vector<std::uint32_t>& slots) const {
+    std::vector<std::string> ids;
+    ids.reserve(slots.size());
+    for (std::uint32_t slot : slots) {
+        ids.push_back(entries[slot].productID);
+    }
+    return ids;
+}
+
+/**
+ * @brief Finds products with a word of their name starting with the query, in alphabetical order.
+ *
+ * @param query The start of a word, in any case.
+ * @param limit The most Product IDs to return.
+ * @return std::vector<std::string> The matching Product IDs.
+ */
+std::vector<std::string> ProductSearchIndex::prefix(std::string_view query, std::size_t limit) const {
+    TRACE_SPAN("ProductSearchIndex::prefix");
+    std::vector<std::uint32_t> found;
+    prefixSlots(lowercase(query), limit, found);
+    return productIDs(found);
+}
+
+/**
+ * @brief Finds products whose name contains the query anywhere.
+ *
+ * @param query The text to look for, in any case.
+ * @param limit The most Product IDs to return.
+ * @return std::vector<std::string> The matching Product IDs.
+ */
+std::vector<std::string> ProductSearchIndex::substring(std::string_view query, std::size_t limit) const {
+    TRACE_SPAN("ProductSearchIndex::substring");
+    std::vector<std::uint32_t> found;
+    substringSlots(lowercase(query), limit, found);
+    return productIDs(found);
+}
+
+/**
+ * @brief Finds products for a type-ahead box: prefix matches first, then other substring matches.
+ *
+ * @param query The text typed so far, in any case.
+ * @param limit The most Product IDs to return.
+ * @return std::vector<std::string> The matching Product IDs.
+ */
+std::vector<std::string> ProductSearchIndex::search(std::string_view query, std::size_t limit) const {
+    TRACE_SPAN("ProductSearchIndex::search");
+    std::string lowered = lowercase(query);
+    std::vector<std::uint32_t> found;
+    prefixSlots(lowered, limit, found);
+    if (found.size() < limit) {
+        substringSlots(lowered, limit, found);
+    }
+    else {
+        // do nothing
+    }
+    return productIDs(found);
+}
+
+/**
+ * @brief Estimates the memory used by the index.
+ *
+ * @return std::size_t The approximate size in bytes.
+ */
+std::size_t ProductSearchIndex::getSizeInBytes() const {
+    std::size_t bytes = entries.capacity() * sizeof(Entry) + nodes.capacity() * sizeof(Node) +
+                        terminalLists.capacity() * sizeof(std::vector<std::uint32_t>) +
+                        freeSlots.capacity() * sizeof(std::uint32_t);
+    for (const Entry& entry : entries) {
+        // Short strings live inside the Entry; only longer ones allocate
+        bytes += entry.productID.capacity() > 15 ? entry.productID.capacity() + 1 : 0;
+        bytes += entry.name.capacity() > 15 ? entry.name.capacity() + 1 : 0;
+    }
+    for (const auto& slots : terminalLists) {
+        bytes += slots.capacity() * sizeof(std::uint32_t);
+    }
+    // Each hash map node holds the key, the value and a next pointer (plus the cached hash for strings)
+    bytes += slotOf.size() * (sizeof(void*) * 2 + sizeof(std::string) + sizeof(std::uint32_t)) +
+             slotOf.bucket_count() * sizeof(void*);
+    for (const auto& [trigram, slots] : postings) {
+        bytes += sizeof(void*) + sizeof(trigram) + sizeof(slots) + slots.capacity() * sizeof(std::uint32_t);
+    }
+    bytes += postings.bucket_count() * sizeof(void*);
+    return bytes;
+}
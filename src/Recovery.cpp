@@ -0,0 +1,913 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "Recovery.h"
+#include "TransactionLog.h"
+#include "Trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <optional>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace {
+
+/**
+ * @brief Position lookup for customers or products, built only once the tail actually touches that list.
+ */
+template <typename T, typename GetID>
+class IDIndex {
+public:
+    IDIndex(std::vector<T>& items, GetID getID) : items(items), getID(getID) {}
+
+    T* find(const std::string& id) {
+        if (stale) {
+            positions.clear();
+            positions.reserve(items.size());
+            for (std::size_t i = 0; i < items.size(); ++i) {
+                positions.emplace(getID(items[i]), i);
+            }
+            stale = false;
+        }
+        else {
+            // do nothing
+        }
+        auto it = positions.find(id);
+        return it == positions.end() ? nullptr : &items[it->second];
+    }
+
+    void add(T item) {
+        if (!stale) {
+            positions.emplace(getID(item), items.size());
+        }
+        else {
+            // do nothing
+        }
+        items.push_back(std::move(item));
+    }
+
+    bool remove(const std::string& id) {
+        T* item = find(id);
+        if (item == nullptr) {
+            return false;
+        }
+        else {
+            items.erase(items.begin() + (item - items.data()));
+            stale = true;   // positions after the erased item moved
+            return true;
+        }
+    }
+
+private:
+    std::vector<T>& items;
+    GetID getID;
+    std::unordered_map<std::string, std::size_t> positions;
+    bool stale = true;
+};
+
+/**
+ * @brief Decides whether a record belongs after a list's checkpoint.
+ */
+bool isAfter(std::uint64_t sequence, const Checkpoint& checkpoint) {
+    // Unsequenced records predate checkpoints; they only apply to files that predate them too
+    return sequence == 0 ? checkpoint.sequence == 0 && checkpoint.logOffset == 0 : sequence > checkpoint.sequence;
+}
+
+/**
+ * @brief Returns the text after "prefix" if line starts with it.
+ */
+bool field(const std::string& line, const char* prefix, std::string& value) {
+    std::size_t length = std::char_traits<char>::length(prefix);
+    if (line.compare(0, length, prefix) != 0) {
+        return false;
+    }
+    else {
+        value = line.substr(length);
+        return true;
+    }
+}
+
+/**
+ * @brief Splits "a,b,c" into at most maxFields fields; the last field keeps any further commas.
+ */
+std::vector<std::string> splitDetails(const std::string& details, std::size_t maxFields) {
+    std::vector<std::string> fields;
+    std::size_t start = 0;
+    while (fields.size() + 1 < maxFields) {
+        std::size_t comma = details.find(',', start);
+        if (comma == std::string::npos) {
+            break;
+        }
+        else {
+            fields.push_back(details.substr(start, comma - start));
+            start = comma + 1;
+        }
+    }
+    fields.push_back(details.substr(start));
+    return fields;
+}
+
+/**
+ * @brief Finds the limited gift a redemption record drew from and the stock it left.
+ * @return The gift's position in gifts, or gifts.size() if the record names no limited gift there.
+ */
+std::size_t giftStockLeft(const std::vector<Gift>& gifts, const std::vector<std::string>& record, int& stockLeft) {
+    std::string giftName, stock;
+    for (const std::string& line : record) {
+        if (!field(line, "Gift: ", giftName)) {
+            field(line, "Stock Left: ", stock);
+        }
+        else {
+            // do nothing
+        }
+    }
+    if (stock.empty()) {
+        return gifts.size();
+    }
+    else {
+        stockLeft = std::stoi(stock);
+        auto it = std::find_if(gifts.begin(), gifts.end(), [&](const Gift& gift) {
+            return gift.isLimited() && gift.getGiftName() == giftName;
+        });
+        return static_cast<std::size_t>(it - gifts.begin());
+    }
+}
+
+/**
+ * @brief Reads when the points of a purchase record expire.
+ * @return The time from its "Points Expire" line, or PointLots::NEVER if it has none.
+ */
+std::int64_t pointsExpireAt(const std::vector<std::string>& record) {
+    std::string value;
+    for (const std::string& line : record) {
+        if (field(line, "Points Expire: ", value)) {
+            return std::stoll(value);
+        }
+        else {
+            // do nothing
+        }
+    }
+    return PointLots::NEVER;
+}
+
+/**
+ * @brief Reads the total cost and time of a purchase record.
+ * @return False if the record has no "Total Cost" line. A record without a "Purchased At" line gives a time of 0.
+ */
+bool purchaseOf(const std::vector<std::string>& record, double& totalCost, std::int64_t& purchasedAt) {
+    std::string value;
+    bool found = false;
+    purchasedAt = 0;
+    for (const std::string& line : record) {
+        if (field(line, "Total Cost: $", value)) {
+            totalCost = std::stod(value);
+            found = true;
+        }
+        else if (field(line, "Purchased At: ", value)) {
+            purchasedAt = std::stoll(value);
+        }
+        else {
+            // do nothing
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Builds a gift from the details of an "Added Gift" (points,name) or "Added Limited Gift"
+ *        (points,stock,name) record.
+ */
+Gift giftFromDetails(const std::string& details, bool limited) {
+    std::vector<std::string> f = splitDetails(details, limited ? 3 : 2);
+    if (f.size() < (limited ? 3u : 2u)) {
+        throw std::invalid_argument("Incomplete gift record");
+    }
+    else {
+        return Gift(f.back(), std::stoi(f[0]), limited ? std::stoi(f[1]) : Gift::UNLIMITED);
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Replays the transaction log tail onto freshly loaded lists.
+ *
+ * @param customers The customers loaded from the customer checkpoint.
+ * @param customerCheckpoint The checkpoint read from the customer file.
+ * @param products The products loaded from the product checkpoint.
+ * @param productCheckpoint The checkpoint read from the product file.
+ * @param gifts The gifts loaded from the gift checkpoint.
+ * @param giftCheckpoint The checkpoint read from the gift file.
+ * @param pointLots The customers' dated lots loaded from the lot checkpoint.
+ * @param lotCheckpoint The checkpoint read from the lot file.
+ * @param customerTotals The customers' lifetime totals loaded from the totals checkpoint.
+ * @param totalsCheckpoint The checkpoint read from the totals file.
+ * @param filename The transaction log.
+ * @param baseCustomers In lazy mode, the file holding the customers not in customers; they are decoded only
+ *                      when a replayed record touches them.
+ * @param removedBaseCustomerIDs In lazy mode, receives the base customers removed by the replayed records.
+ * @return RecoveryReport What was replayed, and the sequence number to continue from.
+ */
+RecoveryReport Recovery::replay(std::vector<Customer>& customers, const Checkpoint& customerCheckpoint,
+                                std::vector<Product>& products, const Checkpoint& productCheckpoint,
+                                std::vector<Gift>& gifts, const Checkpoint& giftCheckpoint,
+                                std::vector<PointLots>& pointLots, const Checkpoint& lotCheckpoint,
+                                std::vector<CustomerTotals>& customerTotals, const Checkpoint& totalsCheckpoint,
+                                const std::string& filename, const LazyCustomerFile* baseCustomers,
+                                std::vector<std::string>* removedBaseCustomerIDs) {
+    TRACE_SPAN("Recovery::replay");
+    auto startTime = std::chrono::steady_clock::now();
+
+    RecoveryReport report;
+    report.lastSequence = std::max({customerCheckpoint.sequence, productCheckpoint.sequence, giftCheckpoint.sequence,
+                                    lotCheckpoint.sequence, totalsCheckpoint.sequence});
+
+    TransactionLog& log = TransactionLog::get(filename);
+    std::uint64_t logSize = log.endOffset();
+    if (logSize == 0) {
+        return report;   // nothing logged yet
+    }
+    else {
+        // do nothing
+    }
+
+    std::uint64_t start = std::min({customerCheckpoint.logOffset, productCheckpoint.logOffset, giftCheckpoint.logOffset,
+                                    lotCheckpoint.logOffset, totalsCheckpoint.logOffset});
+    if (start > logSize) {
+        start = 0;   // the log was replaced since the checkpoint; sequence numbers still filter correctly
+    }
+    else {
+        // do nothing
+    }
+    report.bytesScanned = logSize - start;
+
+    auto customerID = [](const Customer& c) { return c.getCustomerID(); };
+    auto productID = [](const Product& p) { return p.getProductID(); };
+    IDIndex<Customer, decltype(customerID)> customerIndex(customers, customerID);
+    IDIndex<Product, decltype(productID)> productIndex(products, productID);
+    auto lotsCustomerID = [](const PointLots& lots) { return lots.getCustomerID(); };
+    IDIndex<PointLots, decltype(lotsCustomerID)> lotIndex(pointLots, lotsCustomerID);
+    auto lotsOf = [&lotIndex, &pointLots](const std::string& id) -> PointLots& {
+        PointLots* lots = lotIndex.find(id);
+        if (lots == nullptr) {
+            lotIndex.add(PointLots(id));
+            return pointLots.back();
+        }
+        else {
+            return *lots;
+        }
+    };
+    auto totalsCustomerID = [](const CustomerTotals& totals) { return totals.getCustomerID(); };
+    IDIndex<CustomerTotals, decltype(totalsCustomerID)> totalsIndex(customerTotals, totalsCustomerID);
+    auto totalsOf = [&totalsIndex, &customerTotals](const std::string& id) -> CustomerTotals& {
+        CustomerTotals* totals = totalsIndex.find(id);
+        if (totals == nullptr) {
+            totalsIndex.add(CustomerTotals(id));
+            return customerTotals.back();
+        }
+        else {
+            return *totals;
+        }
+    };
+
+    // Lazy mode: a customer missing from the list may still be waiting, undecoded, in the base file
+    std::unordered_set<std::string> removedBase;
+    auto findCustomer = [&](const std::string& id) -> Customer* {
+        Customer* customer = customerIndex.find(id);
+        if (customer != nullptr || baseCustomers == nullptr || removedBase.count(id) > 0) {
+            return customer;
+        }
+        else {
+            std::optional<Customer> loaded = baseCustomers->load(id);
+            if (!loaded) {
+                return nullptr;
+            }
+            else {
+                customerIndex.add(std::move(*loaded));
+                return &customers.back();
+            }
+        }
+    };
+
+    // A last record with no blank line after it was cut short by a crash; replay what it has
+    log.scan(start, [&](std::uint64_t, const std::vector<std::string>& record) {
+        report.recordsRead++;
+        std::uint64_t sequence = 0;
+        std::size_t first = 0;
+        std::string value;
+        if (field(record[0], "Sequence: ", value)) {
+            sequence = std::stoull(value);
+            report.lastSequence = std::max(report.lastSequence, sequence);
+            first = 1;
+        }
+        else {
+            // do nothing
+        }
+
+        bool forCustomers = isAfter(sequence, customerCheckpoint);
+        bool forProducts = isAfter(sequence, productCheckpoint);
+        bool forLots = isAfter(sequence, lotCheckpoint);
+        bool forTotals = isAfter(sequence, totalsCheckpoint);
+        bool applied = false;
+        bool skipped = first >= record.size();
+
+        try {
+            const std::string& head = skipped ? record[0] : record[first];
+
+            if (!skipped && field(head, "Customer ID: ", value)) {
+                // Purchase: deduct stock, credit the points earned
+                if (forProducts) {
+                    for (std::size_t i = first + 1; i < record.size(); ++i) {
+                        std::string item;
+                        if (field(record[i], "  - Product ID: ", item)) {
+                            std::size_t comma = item.find(", Quantity: ");
+                            Product* product = productIndex.find(item.substr(0, comma));
+                            if (product != nullptr && comma != std::string::npos) {
+                                product->updateInventory(-std::stoi(item.substr(comma + 12)));
+                            }
+                            else {
+                                skipped = true;
+                            }
+                        }
+                        else {
+                            // do nothing
+                        }
+                    }
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+                if (forCustomers) {
+                    Customer* customer = findCustomer(value);
+                    std::string points;
+                    if (customer != nullptr && field(record.back(), "Reward Points Earned: ", points)) {
+                        customer->addRewardPoints(std::stoi(points));
+                        applied = true;
+                    }
+                    else {
+                        skipped = true;
+                    }
+                }
+                else {
+                    // do nothing
+                }
+                std::string points;
+                std::int64_t expiresAt = pointsExpireAt(record);
+                if (!skipped && forLots && expiresAt != PointLots::NEVER &&
+                    field(record.back(), "Reward Points Earned: ", points)) {
+                    lotsOf(value).add(expiresAt, std::stoi(points));
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+                double totalCost = 0.0;
+                std::int64_t purchasedAt = 0;
+                if (!skipped && forTotals && purchaseOf(record, totalCost, purchasedAt)) {
+                    totalsOf(value).addPurchase(CustomerTotals::toCents(totalCost), purchasedAt);
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && field(head, "Redemption Customer ID: ", value)) {
+                if (forCustomers) {
+                    Customer* customer = findCustomer(value);
+                    std::string points;
+                    if (customer != nullptr && field(record.back(), "Points Redeemed: ", points)) {
+                        customer->addRewardPoints(-std::stoi(points));
+                        applied = true;
+                    }
+                    else {
+                        skipped = true;
+                    }
+                }
+                else {
+                    // do nothing
+                }
+                std::string points;
+                PointLots* lots = forLots ? lotIndex.find(value) : nullptr;
+                if (!skipped && lots != nullptr && field(record.back(), "Points Redeemed: ", points)) {
+                    lots->spend(std::stoi(points));
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+                int stockLeft = 0;
+                std::size_t position = giftStockLeft(gifts, record, stockLeft);
+                if (!skipped && isAfter(sequence, giftCheckpoint) && position < gifts.size()) {
+                    gifts[position].setStock(stockLeft);
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && field(head, "Registered Customer: ", value)) {
+                if (forCustomers) {
+                    std::vector<std::string> f = splitDetails(value, 7);
+                    if (f.size() == 7 && findCustomer(f[0]) == nullptr) {
+                        customerIndex.add(Customer(f[0], f[1], f[2], f[3], std::stoi(f[4]), f[5], std::stoi(f[6])));
+                        applied = true;
+                    }
+                    else {
+                        skipped = true;
+                    }
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && field(head, "Removed Customer: ", value)) {
+                if (forCustomers) {
+                    applied = findCustomer(value) != nullptr && customerIndex.remove(value);
+                    skipped = !applied;
+                    if (applied && baseCustomers != nullptr && baseCustomers->contains(value)) {
+                        removedBase.insert(value);
+                    }
+                    else {
+                        // do nothing
+                    }
+                }
+                else {
+                    // do nothing
+                }
+                PointLots* lots = forLots ? lotIndex.find(value) : nullptr;
+                if (!skipped && lots != nullptr) {
+                    lots->clear();
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+                CustomerTotals* totals = forTotals ? totalsIndex.find(value) : nullptr;
+                if (!skipped && totals != nullptr) {
+                    totals->clear();
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && field(head, "Expired Points: ", value)) {
+                std::vector<std::string> f = splitDetails(value, 3);
+                if (f.size() == 3 && forCustomers) {
+                    Customer* customer = findCustomer(f[0]);
+                    if (customer != nullptr) {
+                        customer->addRewardPoints(-std::min(std::stoi(f[1]), customer->getRewardPoints()));
+                        applied = true;
+                    }
+                    else {
+                        skipped = true;
+                    }
+                }
+                else {
+                    skipped = f.size() != 3;
+                }
+                PointLots* lots = forLots && !skipped ? lotIndex.find(f[0]) : nullptr;
+                if (lots != nullptr) {
+                    lots->expire(std::stoll(f[2]));
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && field(head, "Added Product: ", value)) {
+                if (forProducts) {
+                    std::vector<std::string> f = splitDetails(value, 4);
+                    if (f.size() == 4 && productIndex.find(f[0]) == nullptr) {
+                        productIndex.add(Product(f[0], f[3], std::stod(f[1]), std::stoi(f[2])));
+                        applied = true;
+                    }
+                    else {
+                        skipped = true;
+                    }
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && field(head, "Removed Product: ", value)) {
+                if (forProducts) {
+                    applied = productIndex.remove(value);
+                    skipped = !applied;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else if (!skipped && (field(head, "Added Gift: ", value) || field(head, "Added Limited Gift: ", value))) {
+                if (isAfter(sequence, giftCheckpoint)) {
+                    gifts.push_back(giftFromDetails(value, head.rfind("Added Limited Gift: ", 0) == 0));
+                    applied = true;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else {
+                skipped = true;
+            }
+        } catch (const std::exception&) {
+            // std::invalid_argument from the constructors or std::stoi on a damaged record
+            skipped = true;
+        }
+
+        report.recordsApplied += applied ? 1 : 0;
+        report.recordsSkipped += skipped ? 1 : 0;
+    }, true);
+
+    if (removedBaseCustomerIDs != nullptr) {
+        removedBaseCustomerIDs->assign(removedBase.begin(), removedBase.end());
+    }
+    else {
+        // do nothing
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return report;
+}
+
+/**
+ * @brief Rebuilds every customer's lifetime totals from the whole transaction log, one thread per segment.
+ *
+ * Each thread takes the next unread segment and sums its purchases per customer into a partial result of
+ * its own, noting customers removed in that segment. The partial results are then combined in log order: a
+ * removal discards what came before it, otherwise the later segment's totals are added. Sums and counts do
+ * not depend on the order they are added in, so the result matches reading the log from start to end.
+ *
+ * @param checkpoint Receives the log position the totals are consistent with.
+ * @param filename The transaction log.
+ * @param report If not null, receives what was read, how long it took and on how many threads.
+ * @return std::vector<CustomerTotals> The totals of each customer with orders, in Customer ID order.
+ */
+std::vector<CustomerTotals> Recovery::rebuildTotals(Checkpoint& checkpoint, const std::string& filename,
+                                                    RecoveryReport* report) {
+    TRACE_SPAN("Recovery::rebuildTotals");
+    auto startTime = std::chrono::steady_clock::now();
+
+    struct Partial {
+        CustomerTotals totals;
+        bool removed = false;   ///< Removed in this segment; totals only counts orders after that.
+    };
+    struct SegmentResult {
+        std::unordered_map<std::string, Partial> customers;
+        std::uint64_t lastSequence = 0;
+        std::uint64_t recordsRead = 0;
+        std::uint64_t recordsApplied = 0;
+        std::uint64_t recordsSkipped = 0;
+        std::uint64_t end = 0;
+    };
+
+    std::vector<TransactionLog::Segment> segments = TransactionLog::get(filename).segments();
+    std::vector<SegmentResult> results(segments.size());
+    std::atomic<std::size_t> nextSegment{0};
+    auto work = [&]() {
+        for (std::size_t i = nextSegment++; i < segments.size(); i = nextSegment++) {
+            SegmentResult& result = results[i];
+            auto visit = [&result](std::uint64_t, const std::vector<std::string>& record) {
+                result.recordsRead++;
+                result.lastSequence = std::max(result.lastSequence, sequenceOf(record));
+                std::size_t first = !record.empty() && record[0].compare(0, 10, "Sequence: ") == 0 ? 1 : 0;
+                std::string value;
+                try {
+                    if (first < record.size() && field(record[first], "Customer ID: ", value)) {
+                        double totalCost = 0.0;
+                        std::int64_t purchasedAt = 0;
+                        if (purchaseOf(record, totalCost, purchasedAt)) {
+                            Partial& partial = result.customers.try_emplace(value, Partial{CustomerTotals(value)})
+                                                   .first->second;
+                            partial.totals.addPurchase(CustomerTotals::toCents(totalCost), purchasedAt);
+                            result.recordsApplied++;
+                        }
+                        else {
+                            result.recordsSkipped++;
+                        }
+                    }
+                    else if (first < record.size() && field(record[first], "Removed Customer: ", value)) {
+                        Partial& partial = result.customers.try_emplace(value, Partial{CustomerTotals(value)})
+                                               .first->second;
+                        partial.totals.clear();
+                        partial.removed = true;
+                        result.recordsApplied++;
+                    }
+                    else {
+                        // do nothing: no other record changes the totals
+                    }
+                } catch (const std::exception&) {
+                    // std::invalid_argument or std::out_of_range from std::stod on a damaged record
+                    result.recordsSkipped++;
+                }
+            };
+            result.end = TransactionLog::scanSegment(segments[i], visit);
+        }
+    };
+
+    unsigned threadCount = static_cast<unsigned>(std::min<std::size_t>(
+        std::max(1u, std::thread::hardware_concurrency()), std::max<std::size_t>(segments.size(), 1)));
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; ++t) {
+        threads.emplace_back(work);
+    }
+    work();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    // Combine in log order
+    std::unordered_map<std::string, CustomerTotals> combined;
+    checkpoint = Checkpoint();
+    RecoveryReport summary;
+    summary.threads = threadCount;
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        for (auto& [customerID, partial] : results[i].customers) {
+            auto [it, added] = combined.try_emplace(customerID, partial.totals);
+            if (!added && partial.removed) {
+                it->second = partial.totals;
+            }
+            else if (!added) {
+                it->second.merge(partial.totals);
+            }
+            else {
+                // do nothing
+            }
+        }
+        checkpoint.sequence = std::max(checkpoint.sequence, results[i].lastSequence);
+        checkpoint.logOffset = std::max(checkpoint.logOffset, results[i].end);
+        summary.bytesScanned += segments[i].size;
+        summary.recordsRead += results[i].recordsRead;
+        summary.recordsApplied += results[i].recordsApplied;
+        summary.recordsSkipped += results[i].recordsSkipped;
+    }
+    summary.lastSequence = checkpoint.sequence;
+
+    std::vector<CustomerTotals> totals;
+    totals.reserve(combined.size());
+    for (auto& [customerID, customer] : combined) {
+        if (customer.getOrderCount() > 0) {
+            totals.push_back(std::move(customer));
+        }
+        else {
+            // do nothing
+        }
+    }
+    std::sort(totals.begin(), totals.end(), [](const CustomerTotals& a, const CustomerTotals& b) {
+        return a.getCustomerID() < b.getCustomerID();
+    });
+
+    summary.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if (report != nullptr) {
+        *report = summary;
+    }
+    else {
+        // do nothing
+    }
+    return totals;
+}
+
+/**
+ * @brief Applies one log record to a running store.
+ *
+ * Unlike replay, which works on the lists before the store exists, this goes through the WriteGuard so the
+ * secondary indexes and the stock monitor follow the change.
+ *
+ * @param state The write guard for the store.
+ * @param record The record's lines, without the blank line that ends it.
+ * @return bool True if the record was understood and applied.
+ */
+bool Recovery::apply(DataStore::WriteGuard& state, const std::vector<std::string>& record) {
+    std::size_t first = !record.empty() && record[0].compare(0, 10, "Sequence: ") == 0 ? 1 : 0;
+    if (first >= record.size()) {
+        return false;
+    }
+    else {
+        // do nothing
+    }
+
+    auto findProduct = [&state](const std::string& productID) -> Product* {
+        for (Product& product : state.products()) {
+            if (product.getProductID() == productID) {
+                return &product;
+            }
+            else {
+                // do nothing
+            }
+        }
+        return nullptr;
+    };
+
+    const std::string& head = record[first];
+    std::string value;
+    try {
+        if (field(head, "Customer ID: ", value)) {
+            for (std::size_t i = first + 1; i < record.size(); ++i) {
+                std::string item;
+                if (field(record[i], "  - Product ID: ", item)) {
+                    std::size_t comma = item.find(", Quantity: ");
+                    Product* product = comma == std::string::npos ? nullptr : findProduct(item.substr(0, comma));
+                    if (product != nullptr) {
+                        state.updateInventory(*product, -std::stoi(item.substr(comma + 12)));
+                    }
+                    else {
+                        // do nothing
+                    }
+                }
+                else {
+                    // do nothing
+                }
+            }
+            Customer* customer = state.findCustomer(value);
+            std::string points;
+            if (customer != nullptr && field(record.back(), "Reward Points Earned: ", points)) {
+                state.addRewardPoints(*customer, std::stoi(points), pointsExpireAt(record));
+                double totalCost = 0.0;
+                std::int64_t purchasedAt = 0;
+                if (purchaseOf(record, totalCost, purchasedAt)) {
+                    state.recordPurchase(*customer, totalCost, purchasedAt);
+                }
+                else {
+                    // do nothing
+                }
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (field(head, "Redemption Customer ID: ", value)) {
+            Customer* customer = state.findCustomer(value);
+            std::string points;
+            if (customer != nullptr && field(record.back(), "Points Redeemed: ", points)) {
+                state.addRewardPoints(*customer, -std::stoi(points));
+                int stockLeft = 0;
+                std::size_t position = giftStockLeft(state.readGifts(), record, stockLeft);
+                if (position < state.readGifts().size()) {
+                    state.gifts()[position].setStock(stockLeft);
+                }
+                else {
+                    // do nothing
+                }
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (field(head, "Registered Customer: ", value)) {
+            std::vector<std::string> f = splitDetails(value, 7);
+            if (f.size() == 7 && state.findCustomer(f[0]) == nullptr) {
+                state.addCustomer(Customer(f[0], f[1], f[2], f[3], std::stoi(f[4]), f[5], std::stoi(f[6])));
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (field(head, "Removed Customer: ", value)) {
+            return state.removeCustomer(value);
+        }
+        else if (field(head, "Expired Points: ", value)) {
+            std::vector<std::string> f = splitDetails(value, 3);
+            Customer* customer = f.size() == 3 ? state.findCustomer(f[0]) : nullptr;
+            if (customer != nullptr) {
+                state.expirePoints(*customer, std::stoll(f[2]));
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (field(head, "Added Product: ", value)) {
+            std::vector<std::string> f = splitDetails(value, 4);
+            if (f.size() == 4 && findProduct(f[0]) == nullptr) {
+                state.addProduct(Product(f[0], f[3], std::stod(f[1]), std::stoi(f[2])));
+                return true;
+            }
+            else {
+                return false;
+            }
+        }
+        else if (field(head, "Removed Product: ", value)) {
+            return state.removeProduct(value);
+        }
+        else if (field(head, "Added Gift: ", value) || field(head, "Added Limited Gift: ", value)) {
+            state.gifts().push_back(giftFromDetails(value, head.rfind("Added Limited Gift: ", 0) == 0));
+            return true;
+        }
+        else {
+            return false;
+        }
+    } catch (const std::exception&) {
+        // std::invalid_argument from the constructors or std::stoi on a damaged record
+        return false;
+    }
+}
+
+/**
+ * @brief Reads a record's sequence number.
+ *
+ * @param record The record's lines.
+ * @return std::uint64_t The sequence number, or 0 for a record written before sequence numbers.
+ */
+std::uint64_t Recovery::sequenceOf(const std::vector<std::string>& record) {
+    std::string value;
+    if (!record.empty() && field(record[0], "Sequence: ", value)) {
+        try {
+            return std::stoull(value);
+        } catch (const std::exception&) {
+            return 0;
+        }
+    }
+    else {
+        return 0;
+    }
+}
+
+/**
+ * @brief Formats a new customer as a "Registered Customer" change record.
+ *
+ * @param sequence The sequence number of the change.
+ * @param customer The registered customer.
+ * @return ChangeRecord The record to log.
+ */
+ChangeRecord Recovery::customerRegistered(std::uint64_t sequence, const Customer& customer) {
+    return ChangeRecord{sequence, "Registered Customer",
+                        customer.getCustomerID() + "," + customer.getUserName() + "," + customer.getFirstName() + "," +
+                        customer.getLastName() + "," + std::to_string(customer.getAge()) + "," +
+                        customer.getCreditCardNumber() + "," + std::to_string(customer.getRewardPoints())};
+}
+
+/**
+ * @brief Formats a "Removed Customer" change record.
+ *
+ * @param sequence The sequence number of the change.
+ * @param customerID The unique identifier of the removed customer.
+ * @return ChangeRecord The record to log.
+ */
+ChangeRecord Recovery::customerRemoved(std::uint64_t sequence, const std::string& customerID) {
+    return ChangeRecord{sequence, "Removed Customer", customerID};
+}
+
+/**
+ * @brief Formats an "Added Product" change record. The name goes last since it may contain commas.
+ *
+ * @param sequence The sequence number of the change.
+ * @param product The added product.
+ * @return ChangeRecord The record to log.
+ */
+ChangeRecord Recovery::productAdded(std::uint64_t sequence, const Product& product) {
+    std::ostringstream details;
+    details << product.getProductID() << "," << product.getProductPrice() << ","
+            << product.getProductInventory() << "," << product.getProductName();
+    return ChangeRecord{sequence, "Added Product", details.str()};
+}
+
+/**
+ * @brief Formats a "Removed Product" change record.
+ *
+ * @param sequence The sequence number of the change.
+ * @param productID The unique identifier of the removed product.
+ * @return ChangeRecord The record to log.
+ */
+ChangeRecord Recovery::productRemoved(std::uint64_t sequence, const std::string& productID) {
+    return ChangeRecord{sequence, "Removed Product", productID};
+}
+
+/**
+ * @brief Formats an "Added Gift" change record, or an "Added Limited Gift" one with the stock after the points.
+ *        The name goes last since it may contain commas.
+ *
+ * @param sequence The sequence number of the change.
+ * @param gift The added gift.
+ * @return ChangeRecord The record to log.
+ */
+ChangeRecord Recovery::giftAdded(std::uint64_t sequence, const Gift& gift) {
+    if (gift.isLimited()) {
+        return ChangeRecord{sequence, "Added Limited Gift", std::to_string(gift.getRequiredPoints()) + "," +
+                                                            std::to_string(gift.getStock()) + "," + gift.getGiftName()};
+    }
+    else {
+        return ChangeRecord{sequence, "Added Gift", std::to_string(gift.getRequiredPoints()) + "," + gift.getGiftName()};
+    }
+}
+
+/**
+ * @brief Formats an "Expired Points" change record: the Customer ID, the points expired and when.
+ *
+ * @param sequence The sequence number of the change.
+ * @param customerID The unique identifier of the customer whose points expired.
+ * @param points The number of points expired.
+ * @param expiredAt The time the lots were expired up to, in seconds since the epoch.
+ * @return ChangeRecord The record to log.
+ */
+ChangeRecord Recovery::pointsExpired(std::uint64_t sequence, const std::string& customerID, int points,
+                                     std::int64_t expiredAt) {
+    return ChangeRecord{sequence, "Expired Points",
+                        customerID + "," + std::to_string(points) + "," + std::to_string(expiredAt)};
+}
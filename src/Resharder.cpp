@@ -0,0 +1,283 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "Resharder.h"
+#include "FileManager.h"
+#include "Recovery.h"
+#include "ShardMap.h"
+#include "Trace.h"
+#include "TransactionLog.h"
+#include <chrono>
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/**
+ * @brief One source directory after loading and replay.
+ */
+struct Source {
+    std::vector<Customer> customers;
+    std::vector<Product> products;
+    std::vector<Gift> gifts;
+    std::vector<PointLots> pointLots;
+    std::vector<CustomerTotals> customerTotals;
+};
+
+/**
+ * @brief Loads a further shard's stock levels as copies of the catalog products.
+ *
+ * Product IDs may only be constructed once per process, so the products of every source after the first
+ * are copies of the first source's, with the inventory read from this source's file.
+ */
+std::vector<Product> loadStock(const std::vector<Product>& catalog, const std::string& filename,
+                               Checkpoint& checkpoint) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open " + filename + ".");
+    }
+    else {
+        // do nothing
+    }
+
+    std::unordered_map<std::string, const Product*> catalogByID;
+    for (const Product& product : catalog) {
+        catalogByID.emplace(product.getProductID(), &product);
+    }
+
+    std::vector<Product> products;
+    std::string productID, productName, productPrice, productInventory;
+    while (std::getline(file, productID)) {
+        if (productID.empty()) {
+            continue;
+        }
+        else if (productID.compare(0, 12, "#checkpoint ") == 0) {
+            std::istringstream fields(productID.substr(12));
+            fields >> checkpoint.sequence >> checkpoint.logOffset;
+            continue;
+        }
+        else {
+            // do nothing
+        }
+        std::getline(file, productName);
+        std::getline(file, productPrice);
+        std::getline(file, productInventory);
+
+        auto found = catalogByID.find(productID);
+        if (found != catalogByID.end()) {
+            products.push_back(*found->second);
+            products.back().updateInventory(std::stoi(productInventory) - found->second->getProductInventory());
+        }
+        else {
+            // do nothing: not in the catalog being kept
+        }
+    }
+    return products;
+}
+
+/**
+ * @brief Builds a timestamp for the retired directory's name.
+ */
+std::string timestamp() {
+    std::time_t now = std::time(nullptr);
+    char text[32];
+    std::strftime(text, sizeof(text), "%Y%m%d-%H%M%S", std::localtime(&now));
+    return text;
+}
+
+} // namespace
+
+/**
+ * @brief Rebalances a root directory into a number of shards.
+ *
+ * @param root The root directory: either an unsharded data directory or one holding shards.txt.
+ * @param shardCount The number of shards to create.
+ * @return ReshardReport What was moved where.
+ * @throws std::runtime_error If a source cannot be loaded or the new files cannot be written.
+ */
+ReshardReport Resharder::reshard(const std::string& root, unsigned shardCount) {
+    TRACE_SPAN("Resharder::reshard");
+    auto startTime = std::chrono::steady_clock::now();
+    if (shardCount == 0) {
+        throw std::runtime_error("The shard count must be at least 1.");
+    }
+    else {
+        // do nothing
+    }
+
+    ReshardReport report;
+    std::vector<std::string> addresses;
+    unsigned oldCount = ShardMap::loadLayout(root, addresses);
+    std::vector<std::string> directories;
+    if (oldCount == 0) {
+        directories.push_back(root);
+    }
+    else {
+        for (unsigned shard = 0; shard < oldCount; ++shard) {
+            directories.push_back(ShardMap::directory(root, shard));
+        }
+    }
+    report.sourceShards = static_cast<unsigned>(directories.size());
+
+    // Load every source as a process starting on it would: checkpoint files plus the log tail
+    std::vector<Source> sources(directories.size());
+    for (std::size_t i = 0; i < directories.size(); ++i) {
+        const std::string& directory = directories[i];
+        Source& source = sources[i];
+        Checkpoint customerCheckpoint, productCheckpoint, giftCheckpoint;
+        source.customers = FileManager::loadCustomers(directory + "/customers.txt", &customerCheckpoint);
+        source.products = i == 0 ? FileManager::loadProducts(directory + "/products.txt", &productCheckpoint)
+                                 : loadStock(sources[0].products, directory + "/products.txt", productCheckpoint);
+        source.gifts = FileManager::loadGifts(directory + "/gifts.txt", &giftCheckpoint);
+        Checkpoint lotCheckpoint = customerCheckpoint;   // a shard without a lot file has no lots before its customers
+        try {
+            source.pointLots = FileManager::loadPointLots(directory + "/point_lots.txt", &lotCheckpoint);
+        } catch (const std::runtime_error&) {
+            // do nothing
+        }
+        Checkpoint totalsCheckpoint;
+        try {
+            source.customerTotals = FileManager::loadCustomerTotals(directory + "/customer_totals.txt",
+                                                                    &totalsCheckpoint);
+        } catch (const std::runtime_error&) {
+            source.customerTotals = Recovery::rebuildTotals(totalsCheckpoint, directory + "/transactions.txt");
+        }
+        RecoveryReport replayed = Recovery::replay(source.customers, customerCheckpoint, source.products,
+                                                   productCheckpoint, source.gifts, giftCheckpoint,
+                                                   source.pointLots, lotCheckpoint, source.customerTotals,
+                                                   totalsCheckpoint, directory + "/transactions.txt");
+        report.lastSequence = std::max(report.lastSequence, replayed.lastSequence);
+    }
+
+    // Sum the stock over the sources, then give each new shard an equal share. Limited gifts are split the
+    // same way, matched by their position in the gift list, which every shard shares.
+    std::unordered_map<std::string, long long> totalStock;
+    std::vector<long long> totalGiftStock(sources[0].gifts.size(), 0);
+    for (const Source& source : sources) {
+        for (const Product& product : source.products) {
+            totalStock[product.getProductID()] += product.getProductInventory();
+        }
+        for (std::size_t i = 0; i < source.gifts.size() && i < totalGiftStock.size(); ++i) {
+            totalGiftStock[i] += source.gifts[i].isLimited() ? source.gifts[i].getStock() : 0;
+        }
+    }
+
+    std::vector<std::string> newDirectories;
+    std::vector<std::unique_ptr<std::ofstream>> logs;
+    for (unsigned shard = 0; shard < shardCount; ++shard) {
+        newDirectories.push_back(ShardMap::directory(root, shard) + ".new");
+        fs::remove_all(newDirectories.back());   // left over from an interrupted run
+        fs::create_directories(newDirectories.back());
+        logs.push_back(std::make_unique<std::ofstream>(newDirectories.back() + "/transactions.txt"));
+    }
+    report.customersPerShard.assign(shardCount, 0);
+    report.recordsPerShard.assign(shardCount, 0);
+
+    // Carry each customer's log records to its new shard, in their original order
+    for (const std::string& directory : directories) {
+        TransactionLog& log = TransactionLog::get(directory + "/transactions.txt");
+        log.scan(0, [&](std::uint64_t, const std::vector<std::string>& record) {
+            std::string customerID = TransactionLog::customerOf(record);
+            if (customerID.empty()) {
+                report.recordsDropped++;
+            }
+            else {
+                unsigned shard = ShardMap::shardOf(customerID, shardCount);
+                for (const std::string& recordLine : record) {
+                    *logs[shard] << recordLine << "\n";
+                }
+                *logs[shard] << "\n";
+                report.recordsPerShard[shard]++;
+            }
+        }, true);
+    }
+
+    // Partition the customers, and their lots and totals along with them
+    std::vector<std::vector<Customer>> customers(shardCount);
+    std::vector<std::vector<PointLots>> pointLots(shardCount);
+    std::vector<std::vector<CustomerTotals>> customerTotals(shardCount);
+    for (Source& source : sources) {
+        for (Customer& customer : source.customers) {
+            unsigned shard = ShardMap::shardOf(customer.getCustomerID(), shardCount);
+            customers[shard].push_back(std::move(customer));
+        }
+        for (PointLots& lots : source.pointLots) {
+            unsigned shard = ShardMap::shardOf(lots.getCustomerID(), shardCount);
+            pointLots[shard].push_back(std::move(lots));
+        }
+        for (CustomerTotals& totals : source.customerTotals) {
+            unsigned shard = ShardMap::shardOf(totals.getCustomerID(), shardCount);
+            customerTotals[shard].push_back(std::move(totals));
+        }
+    }
+
+    // Write each new shard, checkpointed at the end of its log so the carried history is not replayed
+    for (unsigned shard = 0; shard < shardCount; ++shard) {
+        const std::string& directory = newDirectories[shard];
+        logs[shard]->close();
+        if (!*logs[shard]) {
+            throw std::runtime_error("Failed to write " + directory + "/transactions.txt.");
+        }
+        else {
+            // do nothing
+        }
+        Checkpoint checkpoint{report.lastSequence, FileManager::transactionLogSize(directory + "/transactions.txt")};
+
+        std::vector<Product> products = sources[0].products;
+        for (Product& product : products) {
+            long long total = totalStock[product.getProductID()];
+            long long share = total / shardCount + (shard == 0 ? total % shardCount : 0);
+            product.updateInventory(static_cast<int>(share) - product.getProductInventory());
+        }
+        std::vector<Gift> gifts = sources[0].gifts;
+        for (std::size_t i = 0; i < gifts.size(); ++i) {
+            long long share = totalGiftStock[i] / shardCount + (shard == 0 ? totalGiftStock[i] % shardCount : 0);
+            gifts[i].setStock(static_cast<int>(share));
+        }
+
+        FileManager::saveCustomers(customers[shard], directory + "/customers.txt", checkpoint);
+        FileManager::saveProducts(products, directory + "/products.txt", checkpoint);
+        FileManager::saveGifts(gifts, directory + "/gifts.txt", checkpoint);
+        FileManager::savePointLots(pointLots[shard], directory + "/point_lots.txt", checkpoint);
+        FileManager::saveCustomerTotals(customerTotals[shard], directory + "/customer_totals.txt", checkpoint);
+        ShardMap(shardCount, shard).saveIdentity(directory);
+        report.customersPerShard[shard] = customers[shard].size();
+    }
+
+    // Retire the old files, then move the new shards into place
+    report.retiredDirectory = root + "/retired-" + timestamp();
+    fs::create_directories(report.retiredDirectory);
+    if (oldCount == 0) {
+        for (const char* name : {"customers.txt", "products.txt", "gifts.txt", "point_lots.txt", "customer_totals.txt",
+                                 "transactions.txt", "transactions.idx", "log"}) {
+            if (fs::exists(root + "/" + name)) {
+                fs::rename(root + "/" + name, report.retiredDirectory + "/" + name);
+            }
+            else {
+                // do nothing
+            }
+        }
+    }
+    else {
+        for (unsigned shard = 0; shard < oldCount; ++shard) {
+            fs::rename(directories[shard], ShardMap::directory(report.retiredDirectory, shard));
+        }
+        fs::copy_file(root + "/shards.txt", report.retiredDirectory + "/shards.txt");
+    }
+    for (unsigned shard = 0; shard < shardCount; ++shard) {
+        fs::rename(newDirectories[shard], ShardMap::directory(root, shard));
+    }
+
+    // Keep the addresses of the shards that still exist; new shards need one added before routing
+    addresses.resize(shardCount);
+    ShardMap::saveLayout(root, addresses);
+
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    return report;
+}
@@ -0,0 +1,304 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "RewardConfig.h"
+#include "CustomerTotals.h"
+#include "FileManager.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Reads a length of time written as "<count> days|hours|minutes|seconds".
+ * @return False if the words are not a positive count and one of the units.
+ */
+bool readDuration(std::istream& words, std::int64_t& seconds) {
+    static const std::pair<const char*, std::int64_t> units[] = {
+        {"days", 86400}, {"hours", 3600}, {"minutes", 60}, {"seconds", 1}};
+    std::int64_t count;
+    std::string unit;
+    if (!(words >> count >> unit) || count <= 0) {
+        return false;
+    }
+    else {
+        // do nothing
+    }
+    for (const auto& [name, length] : units) {
+        if (unit == name) {
+            seconds = count * length;
+            return true;
+        }
+        else {
+            // do nothing
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief A configuration with flat accrual and no gifts or limits.
+ *
+ * @param pointsPerDollar The number of reward points earned per dollar spent.
+ */
+RewardConfig::RewardConfig(int pointsPerDollar) : rules(pointsPerDollar) {}
+
+/**
+ * @brief A configuration with the given accrual rules and no gifts or limits.
+ *
+ * @param rules The compiled accrual rules.
+ */
+RewardConfig::RewardConfig(RewardRules rules) : rules(std::move(rules)) {}
+
+/**
+ * @brief Parses a configuration.
+ *
+ * @param in The configuration text.
+ * @param source Name used in error messages, usually the file name.
+ * @return RewardConfig The configuration.
+ * @throws std::runtime_error If a line is not valid.
+ */
+RewardConfig RewardConfig::parse(std::istream& in, const std::string& source) {
+    RewardConfig config;
+    auto otherRule = [&config](const std::string& keyword, std::istream& words) {
+        if (keyword == "gift") {
+            int requiredPoints;
+            std::string name;
+            if (!(words >> requiredPoints) || requiredPoints < 0 || !std::getline(words >> std::ws, name)) {
+                throw std::invalid_argument("expected gift <points> <name>.");
+            }
+            else {
+                config.gifts.emplace_back(name.substr(0, name.find_last_not_of(" \t") + 1), requiredPoints);
+                return true;
+            }
+        }
+        else if (keyword == "limit") {
+            static const char* usage = "expected limit cart-lines|line-quantity <count>, or "
+                                       "limit orders|spend|redemptions <count> per <count> days|hours|minutes|seconds.";
+            std::string kind, per;
+            double value;
+            VelocityLimiter::Limit limit;
+            if (!(words >> kind >> value) || value < 0) {
+                throw std::invalid_argument(usage);
+            }
+            else if (kind == "cart-lines" || kind == "line-quantity") {
+                (kind == "cart-lines" ? config.maxCartLines : config.maxLineQuantity) = static_cast<int>(value);
+                return true;
+            }
+            else if (!(words >> per) || per != "per" || !readDuration(words, limit.windowSeconds)) {
+                throw std::invalid_argument(usage);
+            }
+            else {
+                // do nothing
+            }
+            if (kind == "orders") {
+                limit.maximum = static_cast<std::int64_t>(value);
+                config.velocityLimits.orders = limit;
+            }
+            else if (kind == "spend") {
+                limit.maximum = CustomerTotals::toCents(value);
+                config.velocityLimits.spend = limit;
+            }
+            else if (kind == "redemptions") {
+                limit.maximum = static_cast<std::int64_t>(value);
+                config.velocityLimits.redemptions = limit;
+            }
+            else {
+                throw std::invalid_argument(usage);
+            }
+            return true;
+        }
+        else if (keyword == "expire") {
+            if (!readDuration(words, config.pointLifetime)) {
+                throw std::invalid_argument("expected expire <count> days|hours|minutes|seconds.");
+            }
+            else {
+                return true;
+            }
+        }
+        else if (keyword == "loyalty-tier") {
+            LoyaltyTier tier;
+            double minimumSpend;
+            if (!(words >> tier.name >> minimumSpend >> tier.bonusPercent) || minimumSpend < 0 ||
+                tier.bonusPercent < 0) {
+                throw std::invalid_argument("expected loyalty-tier <name> <lifetime spend> <bonus percent>.");
+            }
+            else {
+                tier.minimumSpendCents = CustomerTotals::toCents(minimumSpend);
+            }
+            auto it = std::upper_bound(config.loyaltyTiers.begin(), config.loyaltyTiers.end(),
+                                       tier.minimumSpendCents, [](std::int64_t cents, const LoyaltyTier& t) {
+                                           return cents < t.minimumSpendCents;
+                                       });
+            config.loyaltyTiers.insert(it, tier);
+            return true;
+        }
+        else {
+            return false;
+        }
+    };
+    config.rules = RewardRules::parse(in, source, otherRule);
+    return config;
+}
+
+/**
+ * @brief Finds the tier a lifetime spending reaches.
+ *
+ * There are only ever a handful of tiers, so a scan from the top is as fast as any index.
+ *
+ * @param spendCents Lifetime spending, in cents.
+ * @return const LoyaltyTier* The highest tier reached, or nullptr if none is.
+ */
+const RewardConfig::LoyaltyTier* RewardConfig::loyaltyTierFor(std::int64_t spendCents) const {
+    for (auto it = loyaltyTiers.rbegin(); it != loyaltyTiers.rend(); ++it) {
+        if (spendCents >= it->minimumSpendCents) {
+            return &*it;
+        }
+        else {
+            // do nothing
+        }
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Adds the tier bonus to the points the rules awarded for a checkout.
+ *
+ * @param points The points the rules awarded.
+ * @param spendCents The customer's lifetime spending before the checkout, in cents.
+ * @return int The points with the bonus of the customer's tier, rounded down.
+ */
+int RewardConfig::withLoyaltyBonus(int points, std::int64_t spendCents) const {
+    const LoyaltyTier* tier = loyaltyTiers.empty() ? nullptr : loyaltyTierFor(spendCents);
+    if (tier == nullptr) {
+        return points;
+    }
+    else {
+        return points + static_cast<int>(static_cast<std::int64_t>(points) * tier->bonusPercent / 100);
+    }
+}
+
+/**
+ * @brief Loads a configuration file.
+ *
+ * @param filename The name of the file to load.
+ * @return RewardConfig The configuration.
+ * @throws std::runtime_error If the file cannot be opened or a line is not valid.
+ */
+RewardConfig RewardConfig::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename + " for loading.");
+    }
+    else {
+        return parse(file, filename);
+    }
+}
+
+/**
+ * @brief Sets the points-per-dollar line of a configuration file, keeping every other line.
+ *
+ * The file is rewritten to a temporary file and renamed over the original, so a watcher never reads it half
+ * written.
+ *
+ * @param filename The configuration file; created if it does not exist.
+ * @param points The number of reward points earned per dollar spent.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void RewardConfig::savePointsPerDollar(const std::string& filename, int points) {
+    std::vector<std::string> lines;
+    std::ifstream existing(filename);
+    std::string line;
+    bool replaced = false;
+    while (std::getline(existing, line)) {
+        std::istringstream words(line);
+        std::string keyword;
+        if (!replaced && words >> keyword && keyword == "points-per-dollar") {
+            line = "points-per-dollar " + std::to_string(points);
+            replaced = true;
+        }
+        else {
+            // do nothing
+        }
+        lines.push_back(line);
+    }
+    if (!replaced) {
+        lines.insert(lines.begin(), "points-per-dollar " + std::to_string(points));
+    }
+    else {
+        // do nothing
+    }
+
+    std::string tempFilename = filename + ".tmp";
+    std::ofstream file(tempFilename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + tempFilename + " for saving.");
+    }
+    else {
+        for (const std::string& kept : lines) {
+            file << kept << "\n";
+        }
+    }
+    file.close();
+    FileManager::replaceFile(tempFilename, filename);
+}
+
+/**
+ * @brief Makes a copy of this configuration with another base rate.
+ *
+ * @param points The number of reward points earned per dollar spent.
+ * @return RewardConfig The changed copy.
+ */
+RewardConfig RewardConfig::withPointsPerDollar(int points) const {
+    RewardConfig changed = *this;
+    changed.rules = rules.withPointsPerDollar(points);
+    return changed;
+}
+
+/**
+ * @brief Finds a gift by its number in the combined list: the store's gifts, then the configured ones.
+ *
+ * @param storeGifts The gifts in the data store.
+ * @param giftNumber Position in the combined list, starting at 1 as in the menu.
+ * @return const Gift* The gift, or nullptr if the number is out of range.
+ */
+const Gift* RewardConfig::giftAt(const std::vector<Gift>& storeGifts, int giftNumber) const {
+    if (giftNumber < 1) {
+        return nullptr;
+    }
+    else if (static_cast<std::size_t>(giftNumber) <= storeGifts.size()) {
+        return &storeGifts[giftNumber - 1];
+    }
+    else if (static_cast<std::size_t>(giftNumber) <= storeGifts.size() + gifts.size()) {
+        return &gifts[giftNumber - 1 - storeGifts.size()];
+    }
+    else {
+        return nullptr;
+    }
+}
+
+/**
+ * @brief Checks a cart against the configured limits.
+ *
+ * @param cart Pairs of Product ID and quantity.
+ * @throws std::invalid_argument If the cart has too many lines or a line buys too many units.
+ */
+void RewardConfig::checkLimits(const std::vector<std::pair<std::string, int>>& cart) const {
+    if (maxCartLines > 0 && cart.size() > static_cast<std::size_t>(maxCartLines)) {
+        throw std::invalid_argument("Carts are limited to " + std::to_string(maxCartLines) + " lines.");
+    }
+    else {
+        // do nothing
+    }
+    for (const auto& [productID, quantity] : cart) {
+        if (maxLineQuantity > 0 && quantity > maxLineQuantity) {
+            throw std::invalid_argument("Quantity for " + productID + " is over the limit of " +
+                                        std::to_string(maxLineQuantity) + ".");
+        }
+        else {
+            // do nothing
+        }
+    }
+}
@@ -0,0 +1,252 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "RewardRules.h"
+#include "Trace.h"
+#include <algorithm>
+#include <climits>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Rules that award a flat number of points per dollar and nothing else.
+ *
+ * @param pointsPerDollar The number of reward points earned per dollar spent.
+ */
+RewardRules::RewardRules(int pointsPerDollar) : pointsPerDollar(pointsPerDollar), cap(INT_MAX) {}
+
+/**
+ * @brief Parses and compiles rules.
+ *
+ * @param in The rule text.
+ * @param source Name used in error messages, usually the file name.
+ * @param otherRule Called for lines that are not accrual rules; returns false if it does not know them either.
+ * @return RewardRules The compiled rules.
+ * @throws std::runtime_error If a line is not a valid rule.
+ */
+RewardRules RewardRules::parse(std::istream& in, const std::string& source,
+                               const std::function<bool(const std::string&, std::istream&)>& otherRule) {
+    TRACE_SPAN("RewardRules::parse");
+    RewardRules rules;
+    std::map<std::string, std::vector<std::string>> categories;
+    std::map<std::string, double> productMultipliers;
+    std::vector<std::pair<std::string, double>> categoryMultipliers;   // resolved once every category is known
+    std::vector<std::pair<std::pair<int, int>, AgeEffect>> ageBands;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        auto fail = [&](const std::string& message) {
+            return std::runtime_error(source + " line " + std::to_string(lineNumber) + ": " + message);
+        };
+        std::istringstream words(line.substr(0, line.find('#')));
+        std::string keyword;
+        if (!(words >> keyword)) {
+            continue;   // blank or comment
+        }
+        else {
+            rules.ruleCount++;
+        }
+
+        if (keyword == "points-per-dollar") {
+            if (!(words >> rules.pointsPerDollar) || rules.pointsPerDollar < 0) {
+                throw fail("expected points-per-dollar <points>.");
+            }
+            else {
+                // do nothing
+            }
+        }
+        else if (keyword == "category") {
+            std::string name, productID;
+            if (!(words >> name)) {
+                throw fail("expected category <name> <productID>...");
+            }
+            else {
+                while (words >> productID) {
+                    categories[name].push_back(productID);
+                }
+            }
+        }
+        else if (keyword == "multiplier") {
+            std::string kind, name;
+            double multiplier;
+            if (!(words >> kind >> name >> multiplier) || multiplier < 0 || (kind != "product" && kind != "category")) {
+                throw fail("expected multiplier product|category <name> <multiplier>.");
+            }
+            else if (kind == "product") {
+                auto [it, inserted] = productMultipliers.emplace(name, multiplier);
+                if (!inserted) {
+                    it->second *= multiplier;
+                }
+                else {
+                    // do nothing
+                }
+            }
+            else {
+                categoryMultipliers.emplace_back(name, multiplier);
+            }
+        }
+        else if (keyword == "tier") {
+            double minimumSpend, multiplier;
+            if (!(words >> minimumSpend >> multiplier) || minimumSpend < 0 || multiplier < 0) {
+                throw fail("expected tier <minimum spend> <multiplier>.");
+            }
+            else {
+                rules.tiers.emplace_back(minimumSpend, multiplier);
+            }
+        }
+        else if (keyword == "age") {
+            int low, high;
+            std::string kind;
+            AgeEffect effect;
+            bool valid = static_cast<bool>(words >> low >> high >> kind) && low >= 0 && low <= high && high <= MAX_AGE;
+            if (valid && kind == "multiplier") {
+                valid = static_cast<bool>(words >> effect.multiplier) && effect.multiplier >= 0;
+            }
+            else if (valid && kind == "bonus") {
+                valid = static_cast<bool>(words >> effect.bonus);
+            }
+            else {
+                valid = false;
+            }
+            if (!valid) {
+                throw fail("expected age <low> <high> multiplier <m> | bonus <points>, ages 0-" +
+                           std::to_string(MAX_AGE) + ".");
+            }
+            else {
+                ageBands.push_back({{low, high}, effect});
+            }
+        }
+        else if (keyword == "cap") {
+            if (!(words >> rules.cap) || rules.cap < 0) {
+                throw fail("expected cap <points>.");
+            }
+            else {
+                // do nothing
+            }
+        }
+        else if (otherRule) {
+            try {
+                if (!otherRule(keyword, words)) {
+                    throw fail("unknown rule '" + keyword + "'.");
+                }
+                else {
+                    rules.ruleCount--;   // counted by whoever handled it
+                }
+            } catch (const std::invalid_argument& e) {
+                throw fail(e.what());
+            }
+        }
+        else {
+            throw fail("unknown rule '" + keyword + "'.");
+        }
+    }
+
+    // Fold category multipliers into the per-product weights
+    for (const auto& [name, multiplier] : categoryMultipliers) {
+        auto category = categories.find(name);
+        if (category == categories.end()) {
+            throw std::runtime_error(source + ": multiplier for undefined category '" + name + "'.");
+        }
+        else {
+            for (const std::string& productID : category->second) {
+                auto [it, inserted] = productMultipliers.emplace(productID, multiplier);
+                if (!inserted) {
+                    it->second *= multiplier;
+                }
+                else {
+                    // do nothing
+                }
+            }
+        }
+    }
+    rules.weights.assign(productMultipliers.begin(), productMultipliers.end());   // std::map is already sorted
+
+    std::sort(rules.tiers.begin(), rules.tiers.end());
+
+    // Overlapping bands combine: multipliers multiply, bonuses add
+    for (const auto& [range, effect] : ageBands) {
+        for (int age = range.first; age <= range.second; ++age) {
+            rules.ageEffects[age].multiplier *= effect.multiplier;
+            rules.ageEffects[age].bonus += effect.bonus;
+        }
+    }
+    return rules;
+}
+
+/**
+ * @brief Parses and compiles a rule file.
+ *
+ * @param filename The name of the file to load.
+ * @return RewardRules The compiled rules.
+ * @throws std::runtime_error If the file cannot be opened or a line is not a valid rule.
+ */
+RewardRules RewardRules::load(const std::string& filename) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Unable to open " + filename + " for loading.");
+    }
+    else {
+        return parse(file, filename);
+    }
+}
+
+/**
+ * @brief Scores a cart.
+ *
+ * @param lines The cart lines with their prices.
+ * @param age The age of the buying customer.
+ * @return int The points the cart earns.
+ */
+int RewardRules::points(std::span<const PricedLine> lines, int age) const {
+    double spend = 0.0;
+    double weighted = 0.0;
+    for (const PricedLine& line : lines) {
+        double cost = line.price * line.quantity;
+        spend += cost;
+        if (weights.empty()) {
+            weighted += cost;
+        }
+        else {
+            auto it = std::lower_bound(weights.begin(), weights.end(), line.productID,
+                                       [](const std::pair<std::string, double>& w, std::string_view id) {
+                                           return std::string_view(w.first) < id;
+                                       });
+            weighted += it != weights.end() && it->first == line.productID ? cost * it->second : cost;
+        }
+    }
+
+    double tierMultiplier = 1.0;
+    for (auto tier = tiers.rbegin(); tier != tiers.rend(); ++tier) {
+        if (spend >= tier->first) {
+            tierMultiplier = tier->second;
+            break;
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    const AgeEffect& ageEffect = ageEffects[std::clamp(age, 0, MAX_AGE)];
+    long long earned = static_cast<long long>(weighted * pointsPerDollar * tierMultiplier * ageEffect.multiplier);
+    if (spend > 0.0) {
+        earned += ageEffect.bonus;   // a flat bonus for an empty cart could be collected over and over
+    }
+    else {
+        // do nothing
+    }
+    return static_cast<int>(std::clamp<long long>(earned, 0, cap));
+}
+
+/**
+ * @brief Makes a copy of these rules with another base rate.
+ *
+ * @param points The number of reward points earned per dollar spent.
+ * @return RewardRules The changed copy.
+ */
+RewardRules RewardRules::withPointsPerDollar(int points) const {
+    RewardRules changed = *this;
+    changed.pointsPerDollar = points;
+    return changed;
+}
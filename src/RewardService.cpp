@@ -0,0 +1,181 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "RewardService.h"
+#include "FileManager.h"
+#include "Recovery.h"
+#include "Trace.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+/**
+ * @brief Constructor for the RewardService class.
+ *
+ * @param store The store to operate on.
+ * @param config The accrual rules, gifts and limits.
+ */
+RewardService::RewardService(DataStore& store, RewardConfig config)
+    : store(store), config(std::make_shared<const RewardConfig>(std::move(config))), pipeline(store) {}
+
+/**
+ * @brief Looks up a customer without modifying the store.
+ *
+ * Runs under the store's shared lock, so lookups proceed in parallel and never force a copy-on-write.
+ *
+ * @param customerID The unique identifier to look up.
+ * @return std::optional<Customer> The customer, or nothing if there is no such customer.
+ */
+std::optional<Customer> RewardService::lookup(const std::string& customerID) const {
+    TRACE_SPAN("RewardService::lookup");
+    try {
+        return store.read().findCustomer(customerID);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;   // a damaged lazy record behaves like a missing customer
+    }
+}
+
+/**
+ * @brief Registers a new customer under a freshly generated Customer ID.
+ *
+ * @param userName The username of the customer.
+ * @param firstName The first name of the customer.
+ * @param lastName The last name of the customer.
+ * @param age The age of the customer.
+ * @param creditCardNumber The credit card number of the customer.
+ * @return Customer The registered customer.
+ * @throws std::invalid_argument If any field fails the Customer validation rules.
+ */
+Customer RewardService::registerCustomer(const std::string& userName, const std::string& firstName,
+                                         const std::string& lastName, int age, const std::string& creditCardNumber) {
+    TRACE_SPAN("RewardService::registerCustomer");
+    thread_local std::mt19937_64 gen(std::random_device{}());
+    std::uniform_int_distribution<long long> dist(1000000000LL, 9999999999LL); // 10-digit numbers
+
+    auto state = store.write();
+    std::string customerID;
+    do {
+        customerID = "CustID" + std::to_string(dist(gen));
+    } while (!state.shardMap().owns(customerID) || state.findCustomer(customerID) != nullptr ||
+             state.hasBaseCustomer(customerID));
+
+    Customer newCustomer(customerID, userName, firstName, lastName, age, creditCardNumber, 0);
+    state.addCustomer(newCustomer);
+    state.appendLog(FileManager::formatChanges({Recovery::customerRegistered(state.nextSequence(), newCustomer)}));
+    return newCustomer;
+}
+
+/**
+ * @brief Buys a cart for a customer: deducts stock, credits points and logs the transaction.
+ *
+ * @param customerID The unique identifier of the buying customer.
+ * @param cart Pairs of Product ID and quantity.
+ * @return Receipt The total cost and points earned.
+ * @throws std::invalid_argument If the cart is empty, the customer or a product is unknown, or a quantity
+ *         is not in stock.
+ */
+Receipt RewardService::checkout(const std::string& customerID, const Cart& cart) {
+    TRACE_SPAN("RewardService::checkout");
+    return pipeline.run(customerID, cart, config.load());
+}
+
+/**
+ * @brief Starts a checkout and returns at once; the pipeline calls done when it completes.
+ *
+ * @param customerID The unique identifier of the buying customer.
+ * @param cart Pairs of Product ID and quantity.
+ * @param done Called on a pipeline thread with the receipt, or with the exception that rejected the cart.
+ */
+void RewardService::checkoutAsync(const std::string& customerID, const Cart& cart,
+                                  std::function<void(std::optional<Receipt>, std::exception_ptr)> done) {
+    pipeline.submit(customerID, cart, config.load(), std::move(done));
+}
+
+/**
+ * @brief Checks out a batch of carts with one lock acquisition and one log write.
+ *
+ * @param orders The carts, applied in order.
+ * @return std::vector<BatchOutcome> One outcome per order, in order.
+ */
+std::vector<BatchOutcome> RewardService::checkoutBatch(std::vector<CartOrder> orders) {
+    return pipeline.runBatch(std::move(orders), config.load());
+}
+
+/**
+ * @brief Replaces the configuration for later checkouts and redemptions.
+ *
+ * Returns once no checkout or redemption can still be reading the old configuration, apart from those that
+ * hold their own reference to it.
+ *
+ * @param newConfig The configuration to publish.
+ */
+void RewardService::setConfig(RewardConfig newConfig) {
+    config.store(std::make_shared<const RewardConfig>(std::move(newConfig)));
+}
+
+/**
+ * @brief Sets the number of reward points earned per dollar spent by later checkouts, keeping the other settings.
+ *
+ * @param points The points per dollar.
+ */
+void RewardService::setPointsPerDollar(int points) {
+    config.update([points](const RewardConfig& current) { return current.withPointsPerDollar(points); });
+}
+
+/**
+ * @brief Redeems a gift for a customer and logs the redemption.
+ *
+ * @param customerID The unique identifier of the redeeming customer.
+ * @param giftNumber Position of the gift in the store's gifts followed by the configured ones, starting at 1.
+ * @return int The customer's remaining reward points.
+ * @throws std::invalid_argument If the customer or gift is unknown, the gift is out of stock, or the
+ *         customer lacks the points.
+ */
+int RewardService::redeem(const std::string& customerID, int giftNumber) {
+    TRACE_SPAN("RewardService::redeem");
+    // A shared_ptr rather than a read guard: it is held while waiting for the write lock and the log write,
+    // and a held guard would keep a config reload spinning
+    std::shared_ptr<const RewardConfig> current = config.load();
+    {
+        // Once a popular gift sells out, refusing it needs no exclusive lock
+        auto snapshot = store.read();
+        const Gift* found = current->giftAt(snapshot.readGifts(), giftNumber);
+        if (found != nullptr && !found->isInStock()) {
+            throw std::invalid_argument("This gift is out of stock.");
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    auto state = store.write();
+    Customer* customer = state.findCustomer(customerID);
+    if (customer == nullptr) {
+        throw std::invalid_argument("Customer ID not found.");
+    }
+    else {
+        // do nothing
+    }
+
+    Gift gift = state.redeemGift(*customer, giftNumber, current->getGifts(), current->getVelocityLimits());
+    state.appendLog(FileManager::formatRedemption(state.nextSequence(), customerID, gift));
+    return customer->getRewardPoints();
+}
+
+/**
+ * @brief Lists the products with the least stock, under the store's shared lock.
+ *
+ * @param count The most products to list.
+ * @return std::vector<StockMonitor::Level> The products, lowest first.
+ */
+std::vector<StockMonitor::Level> RewardService::lowestStock(std::size_t count) const {
+    TRACE_SPAN("RewardService::lowestStock");
+    return store.read().stockMonitor().lowest(count);
+}
+
+/**
+ * @brief Removes and returns the low-stock alerts raised since the last call.
+ *
+ * @return std::vector<StockMonitor::Alert> The alerts, oldest first.
+ */
+std::vector<StockMonitor::Alert> RewardService::takeStockAlerts() {
+    return store.write().stockMonitor().takeAlerts();
+}
@@ -0,0 +1,25 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "SequenceSet.h"
+
+/**
+ * @brief Adds a sequence number, then moves the low-water mark over every number now contiguous with it.
+ *
+ * @param sequence The sequence number.
+ * @return bool True if the number had not been seen before.
+ */
+bool SequenceSet::insert(std::uint64_t sequence) {
+    if (sequence <= low || !above.insert(sequence).second) {
+        return false;
+    }
+    else if (above.size() > MAX_PENDING) {
+        low = *above.begin() - 1;   // the gap below the oldest pending number is never going to be filled
+    }
+    else {
+        // do nothing
+    }
+    while (!above.empty() && *above.begin() == low + 1) {
+        low++;
+        above.erase(above.begin());
+    }
+    return true;
+}
@@ -0,0 +1,171 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "ShardMap.h"
+#include "FileManager.h"
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief A shard map for one process.
+ *
+ * @param shardCount The number of shards; 1 means the data is not sharded.
+ * @param shardIndex The shard this process serves.
+ * @throws std::invalid_argument If the index is not below the count.
+ */
+ShardMap::ShardMap(unsigned shardCount, unsigned shardIndex) : shardCount(shardCount), shardIndex(shardIndex) {
+    if (shardCount == 0 || shardIndex >= shardCount) {
+        throw std::invalid_argument("Shard " + std::to_string(shardIndex) + " of " + std::to_string(shardCount) +
+                                    " does not exist.");
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Finds the shard that holds a customer.
+ *
+ * @param customerID The unique identifier of the customer.
+ * @param shardCount The number of shards.
+ * @return unsigned The shard, from 0 to shardCount - 1.
+ */
+unsigned ShardMap::shardOf(const std::string& customerID, unsigned shardCount) {
+    std::uint64_t hash = 0xcbf29ce484222325ULL;   // FNV-1a offset basis
+    for (unsigned char c : customerID) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;                 // FNV-1a prime
+    }
+    return static_cast<unsigned>(hash % shardCount);
+}
+
+/**
+ * @brief Builds the path of a shard's data directory.
+ *
+ * @param root The root directory.
+ * @param shard The shard.
+ * @return std::string The directory path.
+ */
+std::string ShardMap::directory(const std::string& root, unsigned shard) {
+    return root + "/shard-" + std::to_string(shard);
+}
+
+/**
+ * @brief Reads the shard identity of a data directory from its shard.txt.
+ *
+ * @param directory The data directory.
+ * @return ShardMap The identity, or a single unsharded shard if the directory has no shard.txt.
+ * @throws std::runtime_error If shard.txt is malformed.
+ */
+ShardMap ShardMap::loadIdentity(const std::string& directory) {
+    std::ifstream file(directory + "/shard.txt");
+    std::string shardWord, ofWord;
+    unsigned index = 0, count = 0;
+    if (!file.is_open()) {
+        return ShardMap();
+    }
+    else if (!(file >> shardWord >> index >> ofWord >> count) || shardWord != "shard" || ofWord != "of" ||
+             count == 0 || index >= count) {
+        throw std::runtime_error(directory + "/shard.txt must contain \"shard <index> of <count>\".");
+    }
+    else {
+        return ShardMap(count, index);
+    }
+}
+
+/**
+ * @brief Writes the shard identity of a data directory.
+ *
+ * @param directory The data directory.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void ShardMap::saveIdentity(const std::string& directory) const {
+    std::ofstream file(directory + "/shard.txt");
+    if (!(file << "shard " << shardIndex << " of " << shardCount << "\n")) {
+        throw std::runtime_error("Unable to write " + directory + "/shard.txt.");
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Reads the layout of a sharded root directory.
+ *
+ * @param root The root directory.
+ * @param addresses Receives the server address of each shard; empty where none is configured.
+ * @return unsigned The number of shards, or 0 if the root has no shards.txt.
+ * @throws std::runtime_error If shards.txt is malformed.
+ */
+unsigned ShardMap::loadLayout(const std::string& root, std::vector<std::string>& addresses) {
+    std::string filename = root + "/shards.txt";
+    std::ifstream file(filename);
+    addresses.clear();
+    if (!file.is_open()) {
+        return 0;
+    }
+    else {
+        // do nothing
+    }
+
+    unsigned count = 0;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::istringstream words(line);
+        std::string keyword;
+        unsigned shard = 0;
+        std::string address;
+        if (!(words >> keyword) || keyword[0] == '#') {
+            continue;
+        }
+        else if (keyword == "shards" && words >> count && count > 0) {
+            addresses.resize(count);
+        }
+        else if (keyword == "address" && words >> shard >> address && shard < count) {
+            addresses[shard] = address;
+        }
+        else {
+            throw std::runtime_error(filename + ":" + std::to_string(lineNumber) +
+                                     ": expected \"shards <count>\" then \"address <shard> <address>\".");
+        }
+    }
+    if (count == 0) {
+        throw std::runtime_error(filename + " does not give a shard count.");
+    }
+    else {
+        return count;
+    }
+}
+
+/**
+ * @brief Writes the layout of a sharded root directory, replacing shards.txt atomically.
+ *
+ * @param root The root directory.
+ * @param addresses The server address of each shard; the size is the shard count.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+void ShardMap::saveLayout(const std::string& root, const std::vector<std::string>& addresses) {
+    std::string filename = root + "/shards.txt";
+    std::string tempFilename = filename + ".tmp";
+    {
+        std::ofstream file(tempFilename);
+        file << "# Customers are placed by FNV-1a hash of the Customer ID modulo the shard count\n";
+        file << "shards " << addresses.size() << "\n";
+        for (std::size_t shard = 0; shard < addresses.size(); ++shard) {
+            if (!addresses[shard].empty()) {
+                file << "address " << shard << " " << addresses[shard] << "\n";
+            }
+            else {
+                // do nothing
+            }
+        }
+        if (!file) {
+            throw std::runtime_error("Unable to write " + tempFilename + ".");
+        }
+        else {
+            // do nothing
+        }
+    }
+    FileManager::replaceFile(tempFilename, filename);
+}
@@ -0,0 +1,119 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "ShardRouter.h"
+#include "ShardMap.h"
+#include "Trace.h"
+#include <sstream>
+#include <stdexcept>
+
+/**
+ * @brief Reads the shard layout.
+ *
+ * @param root The root directory of the sharded data.
+ * @throws std::runtime_error If shards.txt is missing or malformed, or a shard has no address.
+ */
+ShardRouter::ShardRouter(const std::string& root) {
+    std::vector<std::string> addresses;
+    if (ShardMap::loadLayout(root, addresses) == 0) {
+        throw std::runtime_error(root + " has no shards.txt; create the shards with --reshard first.");
+    }
+    else {
+        // do nothing
+    }
+    for (std::size_t shard = 0; shard < addresses.size(); ++shard) {
+        if (addresses[shard].empty()) {
+            throw std::runtime_error(root + "/shards.txt gives no address for shard " + std::to_string(shard) +
+                                     "; add \"address " + std::to_string(shard) + " unix:<path>\".");
+        }
+        else {
+            shards.push_back(std::make_unique<Shard>());
+            shards.back()->address = addresses[shard];
+        }
+    }
+}
+
+/**
+ * @brief Forwards one request and returns the shard's response.
+ *
+ * @param request The request line, without its newline.
+ * @return std::string The response line, without its newline.
+ */
+std::string ShardRouter::route(const std::string& request) {
+    TRACE_SPAN("ShardRouter::route");
+    std::istringstream in(request);
+    std::string command, customerID;
+    in >> command >> customerID;
+
+    if (command == "PING") {
+        return "OK";
+    }
+    else if (command == "LOOKUP" || command == "CHECKOUT" || command == "REDEEM") {
+        if (customerID.empty()) {
+            return "ERR Usage: " + command + " <customerID> ...";
+        }
+        else {
+            return forward(ShardMap::shardOf(customerID, getShardCount()), request);
+        }
+    }
+    else if (command == "REGISTER") {
+        return forward(nextRegistration.fetch_add(1, std::memory_order_relaxed) % getShardCount(), request);
+    }
+    else if (command == "LOWSTOCK" || command == "ALERTS") {
+        return "ERR " + command + " is per shard; send it to a shard's own address.";
+    }
+    else {
+        return "ERR Unknown command: " + command;
+    }
+}
+
+/**
+ * @brief Sends a request to one shard over a pooled connection.
+ *
+ * @param shard The shard.
+ * @param request The request line.
+ * @return std::string The shard's response, or ERR if it could not be reached.
+ */
+std::string ShardRouter::forward(unsigned shard, const std::string& request) {
+    Shard& target = *shards[shard];
+    target.requests.fetch_add(1, std::memory_order_relaxed);
+
+    std::unique_ptr<SocketTarget> connection;
+    {
+        std::lock_guard<std::mutex> lock(target.mutex);
+        if (!target.idle.empty()) {
+            connection = std::move(target.idle.back());
+            target.idle.pop_back();
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    try {
+        if (connection == nullptr) {
+            connection = std::make_unique<SocketTarget>(target.address);
+        }
+        else {
+            // do nothing
+        }
+        std::string response = connection->request(request);
+        std::lock_guard<std::mutex> lock(target.mutex);
+        target.idle.push_back(std::move(connection));
+        return response;
+    } catch (const std::runtime_error& e) {
+        // The connection is dropped; the next request to this shard opens a new one
+        return "ERR Shard " + std::to_string(shard) + " unavailable: " + e.what();
+    }
+}
+
+/**
+ * @brief Retrieves how many requests each shard has been sent.
+ *
+ * @return std::vector<std::uint64_t> The counts, by shard.
+ */
+std::vector<std::uint64_t> ShardRouter::getRequestCounts() const {
+    std::vector<std::uint64_t> counts;
+    for (const auto& shard : shards) {
+        counts.push_back(shard->requests.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
@@ -0,0 +1,178 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "Snapshotter.h"
+#include "FileManager.h"
+#include "Trace.h"
+#include "TransactionLog.h"
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace {
+
+// How soon to try again when a menu operation is holding the store
+constexpr std::chrono::milliseconds BUSY_RETRY_DELAY(50);
+
+} // namespace
+
+/**
+ * @brief Constructor for the Snapshotter class. The thread starts immediately.
+ *
+ * @param store The store to persist.
+ * @param interval Time between snapshots. Zero disables the background thread.
+ */
+Snapshotter::Snapshotter(DataStore& store, std::chrono::milliseconds interval)
+    : store(store), interval(interval), lastWrittenVersion(store.snapshot().version) {
+    if (interval.count() > 0) {
+        worker = std::thread(&Snapshotter::run, this);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Stops the background thread.
+ */
+Snapshotter::~Snapshotter() {
+    stop();
+}
+
+/**
+ * @brief Stops the background thread and waits for a write in progress to finish.
+ */
+void Snapshotter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Retrieves the background write counters.
+ *
+ * @return Stats The counters accumulated since the thread started.
+ */
+Snapshotter::Stats Snapshotter::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+/**
+ * @brief Background loop: wait an interval, snapshot, write if changed.
+ */
+void Snapshotter::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    std::chrono::milliseconds delay = interval;
+
+    while (!wakeUp.wait_for(lock, delay, [this] { return stopping; })) {
+        DataStore::Snapshot snapshot;
+        if (!store.trySnapshot(snapshot)) {
+            stats.busyRetries++;
+            delay = BUSY_RETRY_DELAY;
+            continue;
+        }
+        else {
+            delay = interval;
+        }
+
+        if (snapshot.version == lastWrittenVersion) {
+            stats.unchangedSkips++;
+            continue;
+        }
+        else {
+            // do nothing
+        }
+
+        // Write without holding our mutex so stop() and getStats() never wait on disk I/O
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        bool written = true;
+        try {
+            writeSnapshot(snapshot);
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Background snapshot failed: " << e.what() << "\n";
+            written = false;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        lock.lock();
+
+        if (written) {
+            lastWrittenVersion = snapshot.version;
+            stats.snapshotsWritten++;
+            stats.lastWriteSeconds = seconds;
+        }
+        else {
+            stats.failures++;
+        }
+    }
+}
+
+/**
+ * @brief Writes customers.txt, products.txt, gifts.txt, point_lots.txt and customer_totals.txt from a snapshot.
+ *
+ * In lazy mode the customers never decoded are copied verbatim from the base file after the decoded ones,
+ * and customers.txt.idx is rebuilt alongside so the next lazy startup can use it straight away. Closed log
+ * segments that end before the checkpoint are then moved to the archive.
+ *
+ * @param snapshot The snapshot to write.
+ * @throws std::runtime_error If a file cannot be written or renamed.
+ */
+void Snapshotter::writeSnapshot(const DataStore::Snapshot& snapshot) {
+    TRACE_SPAN("Snapshotter::writeSnapshot");
+    FileManager::saveCustomers(*snapshot.customers, "customers.txt.tmp", snapshot.checkpoint);
+    if (snapshot.baseCustomers != nullptr) {
+        std::unordered_set<std::string> skipIDs(snapshot.removedBaseCustomers->begin(),
+                                                snapshot.removedBaseCustomers->end());
+        for (const Customer& customer : *snapshot.customers) {
+            skipIDs.insert(customer.getCustomerID());
+        }
+        std::ofstream out("customers.txt.tmp", std::ios::app);
+        snapshot.baseCustomers->copyRecords(out, skipIDs);
+        out.close();
+        if (!out) {
+            throw std::runtime_error("Failed to write customers.txt.tmp.");
+        }
+        else {
+            // do nothing
+        }
+    }
+    else {
+        // do nothing
+    }
+    FileManager::saveProducts(*snapshot.products, "products.txt.tmp", snapshot.checkpoint);
+    FileManager::saveGifts(*snapshot.gifts, "gifts.txt.tmp", snapshot.checkpoint);
+    FileManager::savePointLots(*snapshot.pointLots, "point_lots.txt.tmp", snapshot.checkpoint);
+    FileManager::saveCustomerTotals(*snapshot.customerTotals, "customer_totals.txt.tmp", snapshot.checkpoint);
+
+    // The rename keeps the modification time, so an index built from the temporary file matches the final one
+    bool indexed = snapshot.baseCustomers != nullptr || std::ifstream("customers.txt.idx").is_open();
+    if (indexed) {
+        LazyCustomerFile::buildIndex("customers.txt.tmp", "customers.txt.idx.tmp");
+    }
+    else {
+        // do nothing
+    }
+
+    FileManager::replaceFile("customers.txt.tmp", "customers.txt");
+    if (indexed) {
+        FileManager::replaceFile("customers.txt.idx.tmp", "customers.txt.idx");
+    }
+    else {
+        // do nothing
+    }
+    FileManager::replaceFile("products.txt.tmp", "products.txt");
+    FileManager::replaceFile("gifts.txt.tmp", "gifts.txt");
+    FileManager::replaceFile("point_lots.txt.tmp", "point_lots.txt");
+    FileManager::replaceFile("customer_totals.txt.tmp", "customer_totals.txt");
+
+    // Recovery now starts at or after the checkpoint, so the log segments before it are history only
+    TransactionLog::get().archive(snapshot.checkpoint.logOffset);
+}
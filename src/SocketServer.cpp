@@ -0,0 +1,676 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "SocketServer.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::uint64_t LISTEN_ID = 0;                 // epoll tag of the listening socket
+constexpr std::uint64_t WAKE_ID = ~std::uint64_t(0);   // epoll tag of the eventfd
+constexpr std::size_t MAX_REQUEST_BYTES = 64 * 1024;   // longer lines are treated as a broken client
+constexpr int MAX_EVENTS = 64;
+
+/**
+ * @brief Parses the "<customerID> <productID>:<qty> ..." part of a CHECKOUT request.
+ */
+void parseCheckout(std::istream& in, std::string& customerID, Cart& cart) {
+    std::string item;
+    in >> customerID;
+    while (in >> item) {
+        std::size_t colon = item.find(':');
+        if (colon == std::string::npos) {
+            throw std::invalid_argument("Cart items must be <productID>:<quantity>.");
+        }
+        else {
+            cart.emplace_back(item.substr(0, colon), std::stoi(item.substr(colon + 1)));
+        }
+    }
+}
+
+std::string formatReceipt(const Receipt& receipt) {
+    std::ostringstream out;
+    out << "OK " << std::fixed << std::setprecision(2) << receipt.totalCost << " " << receipt.rewardPoints;
+    return out.str();
+}
+
+void watch(int epollFd, int op, int fd, std::uint64_t tag, std::uint32_t events) {
+    epoll_event event = {};
+    event.events = events;
+    event.data.u64 = tag;
+    ::epoll_ctl(epollFd, op, fd, &event);
+}
+
+} // namespace
+
+/**
+ * @brief Binds and listens on an address, then starts the worker pool.
+ *
+ * @param service The service that executes requests.
+ * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+ * @param workerCount Number of worker threads; 0 means one per hardware thread.
+ * @throws std::runtime_error If the address is malformed or cannot be bound.
+ */
+SocketServer::SocketServer(RewardService& service, const std::string& address, unsigned workerCount)
+    : SocketServer([&service](const std::string& request) { return respond(service, request); }, address,
+                   workerCount) {
+    this->service = &service;
+}
+
+/**
+ * @brief Binds and listens on an address, then starts the worker pool.
+ *
+ * @param handler Turns a request line into a response line; called on worker threads.
+ * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+ * @param workerCount Number of worker threads; 0 means one per hardware thread.
+ * @throws std::runtime_error If the address is malformed or cannot be bound.
+ */
+SocketServer::SocketServer(std::function<std::string(const std::string&)> handler, const std::string& address,
+                           unsigned workerCount)
+    : handler(std::move(handler)) {
+    listenFd = listenOn(address, unixPath);
+    auto fail = [this](const std::string& message) {
+        ::close(listenFd);
+        if (epollFd >= 0) ::close(epollFd);
+        if (wakeFd >= 0) ::close(wakeFd);
+        throw std::runtime_error(message + " (" + std::strerror(errno) + ")");
+    };
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        fail("Failed to create the event loop");
+    }
+    else {
+        watch(epollFd, EPOLL_CTL_ADD, listenFd, LISTEN_ID, EPOLLIN);
+        watch(epollFd, EPOLL_CTL_ADD, wakeFd, WAKE_ID, EPOLLIN);
+    }
+
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    else {
+        // do nothing
+    }
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&SocketServer::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Binds a non-blocking listening socket.
+ *
+ * @param address "unix:<path>" or "tcp:<port>" (bound to 127.0.0.1).
+ * @param unixPath Receives the socket file's path for a Unix address, to remove once done.
+ * @return int The listening descriptor.
+ * @throws std::runtime_error If the address is malformed or cannot be bound.
+ */
+int SocketServer::listenOn(const std::string& address, std::string& unixPath) {
+    int listenFd = -1;
+    auto fail = [&listenFd](const std::string& message) {
+        std::string reason = std::strerror(errno);
+        if (listenFd >= 0) ::close(listenFd);
+        throw std::runtime_error(message + " (" + reason + ")");
+    };
+
+    if (address.compare(0, 5, "unix:") == 0) {
+        unixPath = address.substr(5);
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        if (unixPath.empty() || unixPath.size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("Invalid socket path: " + unixPath);
+        }
+        else {
+            std::memcpy(addr.sun_path, unixPath.c_str(), unixPath.size() + 1);
+        }
+        ::unlink(unixPath.c_str());   // a stale socket file from an earlier run
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || ::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            fail("Failed to bind " + address);
+        }
+        else {
+            // do nothing
+        }
+    }
+    else if (address.compare(0, 4, "tcp:") == 0) {
+        int port = 0;
+        try {
+            port = std::stoi(address.substr(4));
+        } catch (const std::exception&) {
+            port = -1;
+        }
+        if (port <= 0 || port > 65535) {
+            throw std::runtime_error("Invalid port in " + address);
+        }
+        else {
+            // do nothing
+        }
+
+        sockaddr_in addr = {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<std::uint16_t>(port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        int reuse = 1;
+        listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0 || ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+            ::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            fail("Failed to bind " + address);
+        }
+        else {
+            // do nothing
+        }
+    }
+    else {
+        throw std::runtime_error("Address must be unix:<path> or tcp:<port>, got " + address);
+    }
+
+    if (::listen(listenFd, SOMAXCONN) != 0) {
+        fail("Failed to listen on " + address);
+    }
+    else {
+        // do nothing
+    }
+    return listenFd;
+}
+
+/**
+ * @brief Stops the workers and closes every socket. A Unix socket file is removed.
+ */
+SocketServer::~SocketServer() {
+    {
+        std::unique_lock<std::mutex> lock(jobMutex);
+        workersExit = true;
+        checkoutsDrained.wait(lock, [this] { return checkoutsInFlight == 0; });   // their callbacks use this object
+    }
+    jobReady.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    for (auto& entry : connections) {
+        ::close(entry.second.fd);
+    }
+    ::close(listenFd);
+    ::close(epollFd);
+    ::close(wakeFd);
+    if (!unixPath.empty()) {
+        ::unlink(unixPath.c_str());
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Runs the event loop on the calling thread until stop() is called.
+ */
+void SocketServer::run() {
+    epoll_event events[MAX_EVENTS];
+    while (!stopping.load()) {
+        int count = ::epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (count < 0) {
+            continue;   // EINTR: a signal arrived; stop() will have set the flag if it was ours
+        }
+        else {
+            // do nothing
+        }
+
+        for (int i = 0; i < count; ++i) {
+            std::uint64_t tag = events[i].data.u64;
+            if (tag == LISTEN_ID) {
+                acceptConnections();
+            }
+            else if (tag == WAKE_ID) {
+                deliverResponses();
+            }
+            else if (connections.find(tag) == connections.end()) {
+                continue;   // closed earlier in this batch
+            }
+            else if (events[i].events & (EPOLLHUP | EPOLLERR)) {
+                closeConnection(tag);
+            }
+            else {
+                if (events[i].events & EPOLLIN) {
+                    readConnection(tag);
+                }
+                else {
+                    // do nothing
+                }
+                if ((events[i].events & EPOLLOUT) && connections.find(tag) != connections.end() && !flush(tag)) {
+                    closeConnection(tag);
+                }
+                else if (connections.find(tag) != connections.end()) {
+                    closeIfDone(tag);
+                }
+                else {
+                    // do nothing
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Asks run() to return. Only an atomic store and a write(), so it is async-signal-safe.
+ */
+void SocketServer::stop() {
+    stopping.store(true);
+    std::uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/**
+ * @brief Retrieves the server counters.
+ *
+ * @return Stats The counters so far.
+ */
+SocketServer::Stats SocketServer::getStats() const {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return stats;
+}
+
+/**
+ * @brief Accepts every pending connection on the listening socket.
+ */
+void SocketServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;   // EAGAIN, or the client already gave up
+        }
+        else {
+            std::uint64_t id = nextConnectionID++;
+            connections[id].fd = fd;
+            connections[id].events = EPOLLIN;
+            watch(epollFd, EPOLL_CTL_ADD, fd, id, EPOLLIN);
+            std::lock_guard<std::mutex> lock(statsMutex);
+            stats.connectionsAccepted++;
+        }
+    }
+}
+
+/**
+ * @brief Reads what a connection has sent, up to one request's worth past the buffered input, and dispatches
+ *        its next request.
+ *
+ * @param connectionID The connection to read.
+ */
+void SocketServer::readConnection(std::uint64_t connectionID) {
+    Connection& connection = connections[connectionID];
+    char buffer[4096];
+    while (connection.input.size() <= MAX_REQUEST_BYTES) {   // the rest waits in the socket
+        ssize_t count = ::read(connection.fd, buffer, sizeof(buffer));
+        if (count > 0) {
+            connection.input.append(buffer, static_cast<std::size_t>(count));
+        }
+        else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (count == 0) {
+            connection.readClosed = true;   // the requests already sent still get their answers
+            break;
+        }
+        else {
+            closeConnection(connectionID);   // a hard error
+            return;
+        }
+    }
+
+    if (connection.input.size() > MAX_REQUEST_BYTES && connection.input.find('\n') == std::string::npos) {
+        closeConnection(connectionID);
+    }
+    else {
+        dispatch(connectionID);
+        updateWatch(connectionID);
+        closeIfDone(connectionID);
+    }
+}
+
+/**
+ * @brief Hands the connection's next complete request line to the workers, unless one is already running.
+ *
+ * @param connectionID The connection to dispatch from.
+ */
+void SocketServer::dispatch(std::uint64_t connectionID) {
+    Connection& connection = connections[connectionID];
+    std::size_t newline = connection.input.find('\n');
+    if (connection.busy || newline == std::string::npos) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    Job job{connectionID, connection.input.substr(0, newline)};
+    connection.input.erase(0, newline + 1);
+    if (!job.text.empty() && job.text.back() == '\r') {
+        job.text.pop_back();
+    }
+    else {
+        // do nothing
+    }
+    connection.busy = true;
+    updateWatch(connectionID);
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        pending.push_back(std::move(job));
+    }
+    jobReady.notify_one();
+}
+
+/**
+ * @brief Queues the responses finished by the workers onto their connections.
+ */
+void SocketServer::deliverResponses() {
+    std::uint64_t counter;
+    ssize_t ignored = ::read(wakeFd, &counter, sizeof(counter));
+    (void)ignored;
+
+    std::deque<Job> done;
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        done.swap(finished);
+    }
+    for (Job& job : done) {
+        auto it = connections.find(job.connectionID);
+        if (it == connections.end()) {
+            continue;   // the client hung up while its request was running
+        }
+        else {
+            // do nothing
+        }
+
+        it->second.output += job.text;
+        it->second.output += '\n';
+        it->second.busy = false;
+        if (!flush(job.connectionID)) {
+            closeConnection(job.connectionID);
+        }
+        else {
+            dispatch(job.connectionID);   // the client may have pipelined more requests
+            updateWatch(job.connectionID);
+            closeIfDone(job.connectionID);
+        }
+    }
+}
+
+/**
+ * @brief Writes as much pending output as the socket accepts, watching for writability if some is left.
+ *
+ * @param connectionID The connection to write.
+ * @return bool False if the connection failed and should be closed.
+ */
+bool SocketServer::flush(std::uint64_t connectionID) {
+    Connection& connection = connections[connectionID];
+    std::size_t written = 0;
+    while (written < connection.output.size()) {
+        ssize_t count = ::send(connection.fd, connection.output.data() + written, connection.output.size() - written,
+                               MSG_NOSIGNAL);
+        if (count > 0) {
+            written += static_cast<std::size_t>(count);
+        }
+        else if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        else {
+            return false;
+        }
+    }
+
+    connection.output.erase(0, written);
+    updateWatch(connectionID);
+    return true;
+}
+
+/**
+ * @brief Watches a connection for reads only while it has no request running, no output waiting for the client
+ *        and an open read side, and for writes only while it has output left.
+ *
+ * @param connectionID The connection to watch.
+ */
+void SocketServer::updateWatch(std::uint64_t connectionID) {
+    Connection& connection = connections[connectionID];
+    bool reading = !connection.busy && connection.output.empty() && !connection.readClosed;
+    std::uint32_t events = (reading ? static_cast<std::uint32_t>(EPOLLIN) : 0u) |
+                           (connection.output.empty() ? 0u : static_cast<std::uint32_t>(EPOLLOUT));
+    if (events != connection.events) {
+        watch(epollFd, EPOLL_CTL_MOD, connection.fd, connectionID, events);
+        connection.events = events;
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Closes a connection whose client has shut down its side once every complete request it sent has been
+ *        answered and the answers written. A partial last line is dropped.
+ *
+ * @param connectionID The connection to check.
+ */
+void SocketServer::closeIfDone(std::uint64_t connectionID) {
+    const Connection& connection = connections[connectionID];
+    if (connection.readClosed && !connection.busy && connection.output.empty()) {
+        closeConnection(connectionID);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Closes a connection. A response still being computed for it is discarded when it arrives.
+ *
+ * @param connectionID The connection to close.
+ */
+void SocketServer::closeConnection(std::uint64_t connectionID) {
+    auto it = connections.find(connectionID);
+    if (it != connections.end()) {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, it->second.fd, nullptr);
+        ::close(it->second.fd);
+        connections.erase(it);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Worker thread: executes requests until the server is destroyed.
+ */
+void SocketServer::workerLoop() {
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(jobMutex);
+            jobReady.wait(lock, [this] { return workersExit || !pending.empty(); });
+            if (workersExit) {
+                return;
+            }
+            else {
+                job = std::move(pending.front());
+                pending.pop_front();
+            }
+        }
+
+        if (service != nullptr && job.text.compare(0, 9, "CHECKOUT ") == 0) {
+            startCheckout(std::move(job));   // completes later on a pipeline thread
+        }
+        else {
+            job.text = handler(job.text);
+            complete(std::move(job));
+        }
+    }
+}
+
+/**
+ * @brief Hands a CHECKOUT request to the checkout pipeline, so the worker does not wait for the log write.
+ *
+ * @param job The request; its connection gets the response once the pipeline finishes.
+ */
+void SocketServer::startCheckout(Job job) {
+    std::istringstream in(job.text.substr(9));
+    std::string customerID;
+    Cart cart;
+    try {
+        parseCheckout(in, customerID, cart);
+    } catch (const std::exception& e) {
+        job.text = std::string("ERR ") + e.what();
+        complete(std::move(job));
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        checkoutsInFlight++;
+    }
+    std::uint64_t connectionID = job.connectionID;
+    service->checkoutAsync(customerID, cart, [this, connectionID](std::optional<Receipt> receipt, std::exception_ptr error) {
+        Job done{connectionID, std::string()};
+        if (error) {
+            try {
+                std::rethrow_exception(error);
+            } catch (const std::exception& e) {
+                done.text = std::string("ERR ") + e.what();
+            }
+        }
+        else {
+            done.text = formatReceipt(*receipt);
+        }
+        complete(std::move(done));
+
+        std::lock_guard<std::mutex> lock(jobMutex);
+        if (--checkoutsInFlight == 0) {
+            checkoutsDrained.notify_all();
+        }
+        else {
+            // do nothing
+        }
+    });
+}
+
+/**
+ * @brief Passes a response to the event loop.
+ *
+ * @param job The response and the connection it belongs to.
+ */
+void SocketServer::complete(Job job) {
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        stats.requestsServed++;
+        stats.errorResponses += job.text.compare(0, 3, "ERR") == 0 ? 1 : 0;
+    }
+    {
+        std::lock_guard<std::mutex> lock(jobMutex);
+        finished.push_back(std::move(job));
+    }
+    std::uint64_t one = 1;
+    ssize_t ignored = ::write(wakeFd, &one, sizeof(one));
+    (void)ignored;
+}
+
+/**
+ * @brief Executes one request line against a service.
+ *
+ * @param service The service to call.
+ * @param request The request line, without its newline.
+ * @return std::string The response line, without its newline.
+ */
+std::string SocketServer::respond(RewardService& service, const std::string& request) {
+    TRACE_SPAN("SocketServer::respond");
+    std::istringstream in(request);
+    std::ostringstream out;
+    std::string command;
+    in >> command;
+
+    try {
+        if (command == "PING") {
+            out << "OK";
+        }
+        else if (command == "LOOKUP") {
+            std::string customerID;
+            in >> customerID;
+            std::optional<Customer> customer = service.lookup(customerID);
+            if (!customer) {
+                out << "ERR Customer ID not found.";
+            }
+            else {
+                out << "OK " << customer->getCustomerID() << " " << customer->getUserName() << " "
+                    << customer->getFirstName() << " " << customer->getLastName() << " " << customer->getAge() << " "
+                    << customer->getCreditCardNumber() << " " << customer->getRewardPoints();
+            }
+        }
+        else if (command == "REGISTER") {
+            std::string userName, firstName, lastName, creditCardNumber;
+            int age = 0;
+            if (!(in >> userName >> firstName >> lastName >> age >> creditCardNumber)) {
+                out << "ERR Usage: REGISTER <user> <first> <last> <age> <card>";
+            }
+            else {
+                out << "OK " << service.registerCustomer(userName, firstName, lastName, age, creditCardNumber)
+                                    .getCustomerID();
+            }
+        }
+        else if (command == "CHECKOUT") {
+            std::string customerID;
+            Cart cart;
+            parseCheckout(in, customerID, cart);
+            out << formatReceipt(service.checkout(customerID, cart));
+        }
+        else if (command == "REDEEM") {
+            std::string customerID;
+            int giftNumber = 0;
+            if (!(in >> customerID >> giftNumber)) {
+                out << "ERR Usage: REDEEM <customerID> <giftNumber>";
+            }
+            else {
+                out << "OK " << service.redeem(customerID, giftNumber);
+            }
+        }
+        else if (command == "LOWSTOCK") {
+            std::size_t count = 0;
+            if (!(in >> count)) {
+                out << "ERR Usage: LOWSTOCK <count>";
+            }
+            else {
+                out << "OK";
+                for (const StockMonitor::Level& level : service.lowestStock(count)) {
+                    out << " " << level.productID << ":" << level.inventory;
+                }
+            }
+        }
+        else if (command == "ALERTS") {
+            out << "OK";
+            for (const StockMonitor::Alert& alert : service.takeStockAlerts()) {
+                out << " " << alert.productID << ":" << alert.inventory;
+            }
+        }
+        else {
+            out << "ERR Unknown command: " << command;
+        }
+    } catch (const std::exception& e) {
+        // std::invalid_argument from validation or std::stoi, std::runtime_error from the log or lazy file
+        out.str("");
+        out << "ERR " << e.what();
+    }
+    return out.str();
+}
@@ -0,0 +1,206 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "StockMonitor.h"
+#include <queue>
+#include <utility>
+
+/**
+ * @brief Builds the heap for the given products in O(n).
+ *
+ * @param products The products to monitor.
+ * @param threshold Products with this many units or fewer count as low.
+ */
+StockMonitor::StockMonitor(const std::vector<Product>& products, int threshold) : threshold(threshold) {
+    heap.reserve(products.size());
+    for (const Product& product : products) {
+        if (positions.emplace(product.getProductID(), heap.size()).second) {
+            heap.push_back(Level{product.getProductID(), product.getProductName(), product.getProductInventory()});
+        }
+        else {
+            // do nothing: the first product with an ID wins, as in lookups
+        }
+    }
+    // Bottom-up heap construction: sift every internal node down, last first
+    for (std::size_t i = heap.size() / 2; i-- > 0;) {
+        siftDown(i);
+    }
+}
+
+/**
+ * @brief Orders two heap entries by inventory, then Product ID so ties list in a stable order.
+ */
+bool StockMonitor::less(std::size_t a, std::size_t b) const {
+    return heap[a].inventory != heap[b].inventory ? heap[a].inventory < heap[b].inventory
+                                                  : heap[a].productID < heap[b].productID;
+}
+
+/**
+ * @brief Swaps two heap entries and their recorded positions.
+ */
+void StockMonitor::swapEntries(std::size_t a, std::size_t b) {
+    std::swap(heap[a], heap[b]);
+    positions[heap[a].productID] = a;
+    positions[heap[b].productID] = b;
+}
+
+/**
+ * @brief Moves an entry towards the root while it is lower than its parent.
+ */
+void StockMonitor::siftUp(std::size_t index) {
+    while (index > 0 && less(index, (index - 1) / 2)) {
+        swapEntries(index, (index - 1) / 2);
+        index = (index - 1) / 2;
+    }
+}
+
+/**
+ * @brief Moves an entry towards the leaves while a child is lower.
+ */
+void StockMonitor::siftDown(std::size_t index) {
+    while (true) {
+        std::size_t smallest = index;
+        std::size_t left = 2 * index + 1;
+        std::size_t right = left + 1;
+        if (left < heap.size() && less(left, smallest)) {
+            smallest = left;
+        }
+        else {
+            // do nothing
+        }
+        if (right < heap.size() && less(right, smallest)) {
+            smallest = right;
+        }
+        else {
+            // do nothing
+        }
+        if (smallest == index) {
+            return;
+        }
+        else {
+            swapEntries(index, smallest);
+            index = smallest;
+        }
+    }
+}
+
+/**
+ * @brief Starts monitoring a product, replacing any earlier entry with the same Product ID.
+ *
+ * @param productID The product's unique identifier.
+ * @param productName The product's name, for reports.
+ * @param inventory The product's inventory level.
+ */
+void StockMonitor::add(const std::string& productID, const std::string& productName, int inventory) {
+    remove(productID);
+    positions[productID] = heap.size();
+    heap.push_back(Level{productID, productName, inventory});
+    siftUp(heap.size() - 1);
+}
+
+/**
+ * @brief Stops monitoring a product.
+ *
+ * @param productID The product's unique identifier.
+ * @return bool True if the product was monitored.
+ */
+bool StockMonitor::remove(const std::string& productID) {
+    auto found = positions.find(productID);
+    if (found == positions.end()) {
+        return false;
+    }
+    else {
+        // Move the last entry into the hole, then restore the heap around it
+        std::size_t index = found->second;
+        std::size_t last = heap.size() - 1;
+        if (index != last) {
+            swapEntries(index, last);
+        }
+        else {
+            // do nothing
+        }
+        heap.pop_back();
+        positions.erase(productID);
+        if (index < heap.size()) {
+            siftUp(index);
+            siftDown(index);
+        }
+        else {
+            // do nothing
+        }
+        return true;
+    }
+}
+
+/**
+ * @brief Records a product's new inventory level, queuing an alert if it just fell to the threshold.
+ *
+ * @param productID The product's unique identifier.
+ * @param inventory The new level.
+ */
+void StockMonitor::update(const std::string& productID, int inventory) {
+    auto found = positions.find(productID);
+    if (found == positions.end()) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    std::size_t index = found->second;
+    int previous = heap[index].inventory;
+    heap[index].inventory = inventory;
+    if (inventory < previous) {
+        siftUp(index);
+    }
+    else if (inventory > previous) {
+        siftDown(index);
+    }
+    else {
+        // do nothing
+    }
+
+    if (previous > threshold && inventory <= threshold) {
+        alerts.push_back(Alert{productID, heap[positions[productID]].productName, inventory});
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Lists the products with the least stock.
+ *
+ * A heap's N smallest entries are the root and, recursively, the smallest children of entries already taken,
+ * so a small priority queue of candidate positions finds them without visiting the rest of the heap.
+ *
+ * @param count The most products to list.
+ * @return std::vector<Level> The products, lowest first.
+ */
+std::vector<StockMonitor::Level> StockMonitor::lowest(std::size_t count) const {
+    std::vector<Level> levels;
+    auto greater = [this](std::size_t a, std::size_t b) { return less(b, a); };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(greater)> candidates(greater);
+    if (!heap.empty()) {
+        candidates.push(0);
+    }
+    else {
+        // do nothing
+    }
+    while (!candidates.empty() && levels.size() < count) {
+        std::size_t index = candidates.top();
+        candidates.pop();
+        levels.push_back(heap[index]);
+        for (std::size_t child = 2 * index + 1; child <= 2 * index + 2 && child < heap.size(); ++child) {
+            candidates.push(child);
+        }
+    }
+    return levels;
+}
+
+/**
+ * @brief Removes and returns the alerts queued since the last call.
+ *
+ * @return std::vector<Alert> The alerts, oldest first.
+ */
+std::vector<StockMonitor::Alert> StockMonitor::takeAlerts() {
+    return std::exchange(alerts, {});
+}
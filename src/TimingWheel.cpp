@@ -0,0 +1,117 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "TimingWheel.h"
+#include <algorithm>
+
+/**
+ * @brief Constructor for the TimingWheel class.
+ *
+ * @param now The current time, in seconds.
+ */
+TimingWheel::TimingWheel(std::int64_t now) : current(now) {}
+
+/**
+ * @brief Schedules an item.
+ *
+ * @param item What to hand back.
+ * @param due When to hand it back, in seconds. A time not after now() fires on the next advance.
+ */
+void TimingWheel::schedule(std::uint32_t item, std::int64_t due) {
+    place(Entry{std::max(due, current + 1), item});
+}
+
+/**
+ * @brief Puts an entry in the lowest level whose span reaches its due time, in the slot for that time.
+ *
+ * An entry further ahead than the whole wheel waits in the top level's furthest slot and is placed again
+ * each time that slot comes round.
+ */
+void TimingWheel::place(const Entry& entry) {
+    std::int64_t delta = entry.due - current;
+    int level = 0;
+    while (level < LEVELS - 1 && (delta >> (SLOT_BITS * (level + 1))) != 0) {
+        level++;
+    }
+    std::int64_t at = entry.due;
+    if ((delta >> (SLOT_BITS * LEVELS)) != 0) {
+        at = current + (std::int64_t{1} << (SLOT_BITS * LEVELS)) - 1;
+    }
+    else {
+        // do nothing
+    }
+    slots[level][(at >> (SLOT_BITS * level)) & (SLOTS - 1)].push_back(entry);
+    levelSizes[level]++;
+    count++;
+}
+
+/**
+ * @brief Moves the clock forward, collecting every item that came due.
+ *
+ * @param now The new time, in seconds.
+ * @param fired Receives the items that came due, earliest first.
+ */
+void TimingWheel::advance(std::int64_t now, std::vector<std::uint32_t>& fired) {
+    while (current < now) {
+        if (count == 0) {
+            current = now;
+            break;
+        }
+        else {
+            // do nothing
+        }
+
+        int lowest = 0;
+        while (levelSizes[lowest] == 0) {
+            lowest++;
+        }
+        if (lowest == 0) {
+            tick(fired);
+            continue;
+        }
+        else {
+            // do nothing
+        }
+
+        // Nothing can fire before the lowest occupied level next enters a new slot
+        int shift = SLOT_BITS * lowest;
+        std::int64_t boundary = ((current >> shift) + 1) << shift;
+        if (boundary > now) {
+            current = now;
+        }
+        else {
+            current = boundary - 1;
+            tick(fired);
+        }
+    }
+}
+
+/**
+ * @brief Advances the clock one second: places again the entries of every higher-level slot the clock has
+ *        just entered, lowest level first, then fires the level 0 slot for the new time.
+ */
+void TimingWheel::tick(std::vector<std::uint32_t>& fired) {
+    current++;
+    std::vector<Entry> moving;
+    for (int level = 1; level < LEVELS; ++level) {
+        int shift = SLOT_BITS * level;
+        if ((current & ((std::int64_t{1} << shift) - 1)) != 0) {
+            break;
+        }
+        else {
+            moving.clear();
+            moving.swap(slots[level][(current >> shift) & (SLOTS - 1)]);
+            levelSizes[level] -= moving.size();
+            count -= moving.size();
+            for (const Entry& entry : moving) {
+                place(entry);
+            }
+        }
+    }
+
+    std::vector<Entry>& due = slots[0][current & (SLOTS - 1)];
+    for (const Entry& entry : due) {
+        fired.push_back(entry.item);
+    }
+    levelSizes[0] -= due.size();
+    count -= due.size();
+    due.clear();
+}
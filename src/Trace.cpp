@@ -0,0 +1,135 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "Trace.h"
+
+#ifdef ENABLE_TRACING
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief One completed span ("ph":"X" complete event in the Chrome trace format).
+ */
+struct TraceEvent {
+    const char* name;
+    std::uint64_t startNs;
+    std::uint64_t durationNs;
+};
+
+constexpr std::size_t EVENTS_PER_THREAD = 1 << 16;
+
+/**
+ * @brief Fixed-capacity span buffer owned by a single writer thread.
+ *
+ * The owning thread fills events[count] and then publishes it by storing count + 1 with release ordering,
+ * so writeChromeTrace can read everything below count from another thread without any lock.
+ */
+struct ThreadBuffer {
+    TraceEvent events[EVENTS_PER_THREAD];
+    std::atomic<std::size_t> count{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::uint32_t threadID = 0;
+    ThreadBuffer* next = nullptr;
+};
+
+// Intrusive list of every thread's buffer, pushed with CAS. Buffers are never freed so that spans
+// recorded by threads that have already exited still make it into the trace.
+std::atomic<ThreadBuffer*> bufferList{nullptr};
+std::atomic<std::uint32_t> nextThreadID{1};
+
+const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+ThreadBuffer* registerThreadBuffer() {
+    ThreadBuffer* buffer = new ThreadBuffer();
+    buffer->threadID = nextThreadID.fetch_add(1, std::memory_order_relaxed);
+    buffer->next = bufferList.load(std::memory_order_relaxed);
+    while (!bufferList.compare_exchange_weak(buffer->next, buffer,
+                                             std::memory_order_release, std::memory_order_relaxed)) {
+        // buffer->next was refreshed by the failed CAS; try again
+    }
+    return buffer;
+}
+
+ThreadBuffer& threadBuffer() {
+    thread_local ThreadBuffer* buffer = registerThreadBuffer();
+    return *buffer;
+}
+
+} // namespace
+
+/**
+ * @brief Retrieves the current time.
+ *
+ * @return std::uint64_t Nanoseconds since the trace epoch.
+ */
+std::uint64_t Tracer::now() {
+    return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - traceEpoch).count());
+}
+
+/**
+ * @brief Appends a completed span to the calling thread's buffer.
+ *
+ * @param name The span name.
+ * @param startNs Start time in nanoseconds since the trace epoch.
+ * @param endNs End time in nanoseconds since the trace epoch.
+ */
+void Tracer::record(const char* name, std::uint64_t startNs, std::uint64_t endNs) {
+    ThreadBuffer& buffer = threadBuffer();
+    std::size_t index = buffer.count.load(std::memory_order_relaxed);
+    if (index >= EVENTS_PER_THREAD) {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    buffer.events[index] = TraceEvent{name, startNs, endNs - startNs};
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Writes every span recorded so far as a Chrome trace-event JSON file.
+ *
+ * @param filename The name of the file to write.
+ * @throws std::runtime_error If the file cannot be opened for writing.
+ */
+void Tracer::writeChromeTrace(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for writing trace.");
+    }
+    else {
+        // do nothing
+    }
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::uint64_t dropped = 0;
+    char timing[64];
+
+    for (ThreadBuffer* buffer = bufferList.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->next) {
+        std::size_t count = buffer->count.load(std::memory_order_acquire);
+        dropped += buffer->dropped.load(std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const TraceEvent& event = buffer->events[i];
+            // Chrome expects microseconds; keep nanosecond precision as a fraction
+            std::snprintf(timing, sizeof(timing), "\"ts\":%.3f,\"dur\":%.3f",
+                          event.startNs / 1000.0, event.durationNs / 1000.0);
+            file << (first ? "\n" : ",\n")
+                 << "{\"name\":\"" << event.name << "\",\"cat\":\"app\",\"ph\":\"X\"," << timing
+                 << ",\"pid\":1,\"tid\":" << buffer->threadID << "}";
+            first = false;
+        }
+    }
+
+    file << "\n],\"otherData\":{\"droppedSpans\":" << dropped << "}}\n";
+}
+
+#endif // ENABLE_TRACING
@@ -0,0 +1,580 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "TransactionLog.h"
+#include "Trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+std::atomic<std::uint64_t> TransactionLog::segmentBytes{64ULL << 20};
+
+namespace {
+
+/**
+ * @brief Reads the complete records of some open segments, in order, from a position onwards.
+ * @return std::uint64_t The position just past the last record visited.
+ */
+std::uint64_t readRecords(std::vector<std::pair<TransactionLog::Segment, std::unique_ptr<std::ifstream>>>& segments,
+                          std::uint64_t from,
+                          const std::function<void(std::uint64_t, const std::vector<std::string>&)>& visit,
+                          bool includeUnterminated) {
+    std::uint64_t end = from;
+    for (auto& [segment, stream] : segments) {
+        std::uint64_t position = std::max(from, segment.base);
+        stream->seekg(static_cast<std::streamoff>(position - segment.base));
+        std::vector<std::string> record;
+        std::uint64_t recordStart = position;
+        std::string line;
+        while (std::getline(*stream, line)) {
+            bool terminated = !stream->eof();   // getline stops at end of file without a newline
+            if (!line.empty()) {
+                if (record.empty()) {
+                    recordStart = position;
+                }
+                else {
+                    // do nothing
+                }
+                record.push_back(line);
+                position += line.size() + (terminated ? 1 : 0);
+            }
+            else {
+                position += 1;
+                if (!record.empty()) {
+                    visit(recordStart, record);
+                    record.clear();
+                }
+                else {
+                    // do nothing
+                }
+                end = position;
+            }
+        }
+        if (!record.empty() && includeUnterminated) {
+            visit(recordStart, record);
+            end = position;
+        }
+        else {
+            // do nothing: still being written, or cut short by a crash
+        }
+    }
+    return end;
+}
+
+/**
+ * @brief Builds the name of a closed segment from its position.
+ */
+std::string segmentName(std::uint64_t base) {
+    char name[48];
+    std::snprintf(name, sizeof(name), "segment-%020llu.txt", static_cast<unsigned long long>(base));
+    return name;
+}
+
+/**
+ * @brief Turns a segment's path into its index's path.
+ */
+std::string indexPath(const std::string& segmentPath) {
+    return fs::path(segmentPath).replace_extension(".idx").string();
+}
+
+} // namespace
+
+/**
+ * @brief Retrieves the shared log object for a log file, opening it on first use.
+ *
+ * @param filename The active segment.
+ * @return TransactionLog& The log.
+ */
+TransactionLog& TransactionLog::get(const std::string& filename) {
+    static std::mutex registryMutex;
+    static std::unordered_map<std::string, std::unique_ptr<TransactionLog>> logs;
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::unique_ptr<TransactionLog>& log = logs[filename];
+    if (log == nullptr) {
+        log.reset(new TransactionLog(filename));
+    }
+    else {
+        // do nothing
+    }
+    return *log;
+}
+
+/**
+ * @brief Sets the size at which the active segment is closed and a new one started.
+ *
+ * @param bytes The segment size.
+ */
+void TransactionLog::setSegmentBytes(std::uint64_t bytes) {
+    segmentBytes.store(std::max<std::uint64_t>(bytes, 1), std::memory_order_relaxed);
+}
+
+/**
+ * @brief Works out where the segments and indexes of a log file live. Nothing is read until first use.
+ *
+ * @param filename The active segment.
+ */
+TransactionLog::TransactionLog(std::string filename) : filename(std::move(filename)) {
+    fs::path path(this->filename);
+    fs::path directory = path.has_parent_path() ? path.parent_path() : fs::path(".");
+    indexFilename = (directory / (path.stem().string() + ".idx")).string();
+    segmentDirectory = (directory / "log").string();
+    archiveDirectory = (directory / "log" / "archive").string();
+}
+
+/**
+ * @brief Finds the closed segments and brings the active segment's index up to date. Call with the mutex held.
+ */
+void TransactionLog::open() {
+    if (opened) {
+        return;
+    }
+    else {
+        opened = true;
+    }
+
+    for (const auto& [directory, archived] : {std::pair{segmentDirectory, false}, std::pair{archiveDirectory, true}}) {
+        std::error_code error;
+        for (const auto& file : fs::directory_iterator(directory, error)) {
+            std::string name = file.path().filename().string();
+            if (name.size() == 32 && name.compare(0, 8, "segment-") == 0 && file.path().extension() == ".txt") {
+                closed.push_back(Segment{std::stoull(name.substr(8, 20)), file.file_size(), file.path().string(),
+                                         archived});
+            }
+            else {
+                // do nothing
+            }
+        }
+    }
+    std::sort(closed.begin(), closed.end(), [](const Segment& a, const Segment& b) { return a.base < b.base; });
+    for (const Segment& segment : closed) {
+        activeBase = std::max(activeBase, segment.base + segment.size);
+    }
+
+    // Index whatever the active segment holds past its last index line: everything, for a log written before
+    // the index existed, or the last few records if the process stopped between the two writes
+    std::uint64_t indexed = 0;
+    bool anyIndexed = false;
+    {
+        std::ifstream indexFile(indexFilename);
+        std::string customerID;
+        std::uint64_t offset;
+        char kind;
+        while (indexFile >> customerID >> offset >> kind) {
+            indexed = offset;
+            anyIndexed = true;
+        }
+    }
+    std::vector<std::pair<Segment, std::unique_ptr<std::ifstream>>> active;
+    active.emplace_back(Segment{activeBase, 0, filename, false}, std::make_unique<std::ifstream>(filename, std::ios::binary));
+    if (active.back().second->is_open()) {
+        std::string lines;
+        readRecords(active, anyIndexed ? indexed : activeBase,
+                    [&](std::uint64_t offset, const std::vector<std::string>& record) {
+                        Kind recordKind;
+                        std::string customerID = customerOf(record, &recordKind);
+                        if (!customerID.empty() && (!anyIndexed || offset > indexed)) {
+                            lines += customerID + " " + std::to_string(offset) + " " +
+                                     static_cast<char>(recordKind) + "\n";
+                        }
+                        else {
+                            // do nothing
+                        }
+                    },
+                    true);
+        if (!lines.empty()) {
+            std::ofstream(indexFilename, std::ios::app) << lines;
+        }
+        else {
+            // do nothing
+        }
+    }
+    else {
+        // do nothing: nothing logged yet
+    }
+}
+
+/**
+ * @brief Reads every segment's index into memory. Call with the mutex held, after open().
+ */
+void TransactionLog::loadIndex() {
+    if (indexLoaded) {
+        return;
+    }
+    else {
+        indexLoaded = true;
+    }
+
+    TRACE_SPAN("TransactionLog::loadIndex");
+    std::vector<std::string> files;
+    for (const Segment& segment : closed) {
+        files.push_back(indexPath(segment.path));
+    }
+    files.push_back(indexFilename);
+    for (const std::string& file : files) {
+        std::ifstream indexFile(file);
+        std::string customerID;
+        std::uint64_t offset;
+        char kind;
+        while (indexFile >> customerID >> offset >> kind) {
+            index[customerID].push_back(Entry{offset, static_cast<Kind>(kind)});
+        }
+    }
+}
+
+/**
+ * @brief Closes the active segment and its index. Call with the mutex held.
+ *
+ * @param activeSize The active segment's size.
+ */
+void TransactionLog::rotate(std::uint64_t activeSize) {
+    TRACE_SPAN("TransactionLog::rotate");
+    fs::create_directories(segmentDirectory);
+    std::string path = (fs::path(segmentDirectory) / segmentName(activeBase)).string();
+    fs::rename(filename, path);
+    std::error_code error;
+    fs::rename(indexFilename, indexPath(path), error);   // no index if nothing concerned a customer
+    closed.push_back(Segment{activeBase, activeSize, path, false});
+    activeBase += activeSize;
+}
+
+/**
+ * @brief Builds the index lines for appended records.
+ *
+ * @param base The position of the first record.
+ * @param records The records.
+ * @param entries If not null, receives the customer and entry of each line.
+ * @return std::string The index lines.
+ */
+std::string TransactionLog::indexLines(std::uint64_t base, const std::string& records,
+                                       std::vector<std::pair<std::string, Entry>>* entries) {
+    std::string lines;
+    std::size_t start = 0;
+    while (start < records.size()) {
+        std::size_t end = records.find("\n\n", start);
+        end = end == std::string::npos ? records.size() : end + 2;
+        std::vector<std::string> record;
+        std::istringstream text(records.substr(start, end - start));
+        std::string line;
+        std::size_t skipped = 0;   // blank lines before the record
+        while (std::getline(text, line)) {
+            if (!line.empty()) {
+                record.push_back(line);
+            }
+            else if (record.empty()) {
+                ++skipped;
+            }
+            else {
+                // do nothing
+            }
+        }
+
+        Kind kind;
+        std::string customerID = customerOf(record, &kind);
+        if (!customerID.empty()) {
+            std::uint64_t offset = base + start + skipped;
+            lines += customerID + " " + std::to_string(offset) + " " + static_cast<char>(kind) + "\n";
+            if (entries != nullptr) {
+                entries->emplace_back(customerID, Entry{offset, kind});
+            }
+            else {
+                // do nothing
+            }
+        }
+        else {
+            // do nothing
+        }
+        start = end;
+    }
+    return lines;
+}
+
+/**
+ * @brief Appends records with a single write, closing the active segment first if they would overflow it.
+ *
+ * @param records One or more complete records, each ending with its blank line.
+ */
+void TransactionLog::append(const std::string& records) {
+    TRACE_SPAN("TransactionLog::append");
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+
+    std::error_code error;
+    std::uint64_t size = fs::file_size(filename, error);
+    size = error ? 0 : size;
+    if (size > 0 && size + records.size() > segmentBytes.load(std::memory_order_relaxed)) {
+        try {
+            rotate(size);
+            size = 0;
+        } catch (const fs::filesystem_error& e) {
+            std::cerr << "Error: Unable to close log segment " << filename << ": " << e.what() << std::endl;
+        }
+    }
+    else {
+        // do nothing
+    }
+
+    std::ofstream logFile(filename, std::ios::app | std::ios::binary);
+    if (logFile.is_open()) {
+        logFile.write(records.data(), static_cast<std::streamsize>(records.size()));
+    }
+    else {
+        std::cerr << "Error: Unable to open " << filename << " for writing." << std::endl;
+        return;
+    }
+    logFile.close();
+
+    std::vector<std::pair<std::string, Entry>> entries;
+    std::string lines = indexLines(activeBase + size, records, indexLoaded ? &entries : nullptr);
+    if (!lines.empty()) {
+        std::ofstream(indexFilename, std::ios::app) << lines;
+    }
+    else {
+        // do nothing
+    }
+    for (auto& [customerID, entry] : entries) {
+        index[customerID].push_back(entry);
+    }
+}
+
+/**
+ * @brief Retrieves the position just past the last byte appended.
+ *
+ * @return std::uint64_t The log's total size, over every segment.
+ */
+std::uint64_t TransactionLog::endOffset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+    std::error_code error;
+    std::uint64_t size = fs::file_size(filename, error);
+    return activeBase + (error ? 0 : size);
+}
+
+/**
+ * @brief Lists the segments, oldest first, the active one last.
+ *
+ * @return std::vector<Segment> The segments.
+ */
+std::vector<TransactionLog::Segment> TransactionLog::segments() {
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+    std::vector<Segment> all = closed;
+    std::error_code error;
+    std::uint64_t size = fs::file_size(filename, error);
+    all.push_back(Segment{activeBase, error ? 0 : size, filename, false});
+    return all;
+}
+
+/**
+ * @brief Opens the segments holding positions from a given one onwards. Call with the mutex held.
+ *
+ * Opening them all under the mutex means a rotation while they are read cannot pair a segment with the
+ * wrong file.
+ *
+ * @param from The first position wanted.
+ * @return The segments with their open files, oldest first.
+ */
+std::vector<std::pair<TransactionLog::Segment, std::unique_ptr<std::ifstream>>> TransactionLog::openSegments(std::uint64_t from) {
+    std::vector<std::pair<Segment, std::unique_ptr<std::ifstream>>> open;
+    std::vector<Segment> all = closed;
+    all.push_back(Segment{activeBase, 0, filename, false});
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        bool active = i + 1 == all.size();
+        if (active || all[i].base + all[i].size > from) {
+            auto stream = std::make_unique<std::ifstream>(all[i].path, std::ios::binary);
+            if (stream->is_open()) {
+                open.emplace_back(all[i], std::move(stream));
+            }
+            else {
+                // do nothing: removed from the archive, or nothing logged yet
+            }
+        }
+        else {
+            // do nothing
+        }
+    }
+    return open;
+}
+
+/**
+ * @brief Reads every record from a position onwards, across segments.
+ *
+ * @param from A position at the start of a record.
+ * @param visit Called with each record's position and lines, in log order.
+ * @param includeUnterminated Also visit a last record that has no blank line after it yet.
+ * @return std::uint64_t The position just past the last record visited.
+ */
+std::uint64_t TransactionLog::scan(std::uint64_t from,
+                                   const std::function<void(std::uint64_t, const std::vector<std::string>&)>& visit,
+                                   bool includeUnterminated) {
+    std::vector<std::pair<Segment, std::unique_ptr<std::ifstream>>> open;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->open();
+        open = openSegments(from);
+    }
+    return readRecords(open, from, visit, includeUnterminated);
+}
+
+/**
+ * @brief Reads every complete record of one segment.
+ *
+ * @param segment The segment.
+ * @param visit Called with each record's position in the log and its lines, in order.
+ * @return std::uint64_t The position just past the last record visited.
+ */
+std::uint64_t TransactionLog::scanSegment(const Segment& segment,
+                                          const std::function<void(std::uint64_t, const std::vector<std::string>&)>& visit) {
+    std::vector<std::pair<Segment, std::unique_ptr<std::ifstream>>> open;
+    auto stream = std::make_unique<std::ifstream>(segment.path, std::ios::binary);
+    if (stream->is_open()) {
+        open.emplace_back(segment, std::move(stream));
+    }
+    else {
+        // do nothing: removed from the archive, or nothing logged yet
+    }
+    return readRecords(open, segment.base, visit, false);
+}
+
+/**
+ * @brief Retrieves a customer's most recent records of one kind from the index.
+ *
+ * @param customerID The unique identifier of the customer.
+ * @param kind The kind of record.
+ * @param limit The most records to return.
+ * @return std::vector<std::vector<std::string>> The records' lines, newest first.
+ */
+std::vector<std::vector<std::string>> TransactionLog::history(const std::string& customerID, Kind kind,
+                                                              std::size_t limit) {
+    TRACE_SPAN("TransactionLog::history");
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+    loadIndex();
+
+    std::vector<std::vector<std::string>> records;
+    auto found = index.find(customerID);
+    if (found == index.end()) {
+        return records;
+    }
+    else {
+        // do nothing
+    }
+
+    std::vector<Segment> all = closed;
+    all.push_back(Segment{activeBase, 0, filename, false});
+    std::string openPath;
+    std::ifstream file;
+    for (auto entry = found->second.rbegin(); entry != found->second.rend() && records.size() < limit; ++entry) {
+        if (entry->kind != kind) {
+            continue;
+        }
+        else {
+            // do nothing
+        }
+
+        // The segment holding the record is the last one starting at or before it
+        auto segment = std::upper_bound(all.begin(), all.end(), entry->offset,
+                                        [](std::uint64_t offset, const Segment& s) { return offset < s.base; });
+        if (segment == all.begin()) {
+            continue;
+        }
+        else {
+            --segment;
+        }
+        if (segment->path != openPath) {
+            file.close();
+            file.clear();
+            file.open(segment->path, std::ios::binary);
+            openPath = segment->path;
+        }
+        else {
+            file.clear();
+        }
+        file.seekg(static_cast<std::streamoff>(entry->offset - segment->base));
+
+        std::vector<std::string> record;
+        std::string line;
+        while (std::getline(file, line) && !line.empty()) {
+            record.push_back(line);
+        }
+        if (!record.empty()) {
+            records.push_back(std::move(record));
+        }
+        else {
+            // do nothing: the segment has been removed from the archive
+        }
+    }
+    return records;
+}
+
+/**
+ * @brief Moves the closed segments that end at or before a position to log/archive/.
+ *
+ * @param before Typically the checkpoint of the data files just written.
+ * @return std::size_t The number of segments archived.
+ */
+std::size_t TransactionLog::archive(std::uint64_t before) {
+    std::lock_guard<std::mutex> lock(mutex);
+    open();
+    std::size_t archived = 0;
+    for (Segment& segment : closed) {
+        if (!segment.archived && segment.base + segment.size <= before) {
+            fs::create_directories(archiveDirectory);
+            std::string path = (fs::path(archiveDirectory) / fs::path(segment.path).filename()).string();
+            fs::rename(segment.path, path);
+            std::error_code error;
+            fs::rename(indexPath(segment.path), indexPath(path), error);
+            segment.path = path;
+            segment.archived = true;
+            ++archived;
+        }
+        else {
+            // do nothing
+        }
+    }
+    return archived;
+}
+
+/**
+ * @brief Finds the customer a log record concerns.
+ *
+ * @param record The record's lines.
+ * @param kind If not null and the record concerns a customer, receives its kind.
+ * @return std::string The Customer ID, or empty for a catalog record.
+ */
+std::string TransactionLog::customerOf(const std::vector<std::string>& record, Kind* kind) {
+    std::size_t first = !record.empty() && record[0].compare(0, 10, "Sequence: ") == 0 ? 1 : 0;
+    if (first >= record.size()) {
+        return std::string();
+    }
+    else {
+        // do nothing
+    }
+
+    static const std::pair<const char*, Kind> prefixes[] = {
+        {"Customer ID: ", Kind::Purchase},
+        {"Redemption Customer ID: ", Kind::Redemption},
+        {"Registered Customer: ", Kind::Registration},
+        {"Removed Customer: ", Kind::Removal},
+        {"Expired Points: ", Kind::Expiry},
+    };
+    const std::string& head = record[first];
+    for (const auto& [prefix, prefixKind] : prefixes) {
+        std::size_t length = std::char_traits<char>::length(prefix);
+        if (head.compare(0, length, prefix) == 0) {
+            std::size_t comma = head.find(',', length);
+            if (kind != nullptr) {
+                *kind = prefixKind;
+            }
+            else {
+                // do nothing
+            }
+            return head.substr(length, comma == std::string::npos ? std::string::npos : comma - length);
+        }
+        else {
+            // do nothing
+        }
+    }
+    return std::string();
+}
@@ -0,0 +1,122 @@
+// Dyar Jankir, Caden Dye, Arthas Lee
+#include "VelocityLimiter.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+namespace {
+
+/**
+ * @brief Builds the message for a refused checkout or redemption.
+ */
+std::string overLimit(const char* what, std::int64_t maximum, const VelocityLimiter::Limit& limit) {
+    return std::string("Too many ") + what + " in a short time: the limit is " + std::to_string(maximum) +
+           " every " + std::to_string(limit.windowSeconds) + " seconds.";
+}
+
+} // namespace
+
+/**
+ * @brief Checks that a checkout keeps the customer within the order and spending limits, then counts it.
+ *
+ * @param customerID The unique identifier of the buying customer.
+ * @param cents The checkout's total cost, in cents.
+ * @param limits The limits to check.
+ * @param nowMillis The current time, from nowMillis().
+ * @throws std::invalid_argument If the checkout would go over a limit.
+ */
+void VelocityLimiter::admitCheckout(const std::string& customerID, std::int64_t cents, const Limits& limits,
+                                    std::int64_t nowMillis) {
+    if (limits.orders.maximum <= 0 && limits.spend.maximum <= 0) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+    Counters& counters = customers[customerID];
+    if (limits.orders.maximum > 0 && counters.orders.slide(limits.orders, nowMillis) + 1 > limits.orders.maximum) {
+        throw std::invalid_argument(overLimit("orders", limits.orders.maximum, limits.orders));
+    }
+    else {
+        // do nothing
+    }
+    if (limits.spend.maximum > 0 && counters.spend.slide(limits.spend, nowMillis) + cents > limits.spend.maximum) {
+        throw std::invalid_argument(overLimit("dollars spent", limits.spend.maximum / 100, limits.spend));
+    }
+    else {
+        // do nothing
+    }
+    if (limits.orders.maximum > 0) {
+        counters.orders.add(1);
+    }
+    else {
+        // do nothing
+    }
+    if (limits.spend.maximum > 0) {
+        counters.spend.add(cents);
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Checks that a redemption keeps the customer within the redemption limit, then counts it.
+ *
+ * @param customerID The unique identifier of the redeeming customer.
+ * @param limits The limits to check.
+ * @param nowMillis The current time, from nowMillis().
+ * @throws std::invalid_argument If the redemption would go over the limit.
+ */
+void VelocityLimiter::admitRedemption(const std::string& customerID, const Limits& limits, std::int64_t nowMillis) {
+    if (limits.redemptions.maximum <= 0) {
+        return;
+    }
+    else {
+        // do nothing
+    }
+    Window& redemptions = customers[customerID].redemptions;
+    if (redemptions.slide(limits.redemptions, nowMillis) + 1 > limits.redemptions.maximum) {
+        throw std::invalid_argument(overLimit("redemptions", limits.redemptions.maximum, limits.redemptions));
+    }
+    else {
+        redemptions.add(1);
+    }
+}
+
+/**
+ * @brief Retrieves the time the counters are kept in.
+ *
+ * @return std::int64_t Milliseconds on the steady clock.
+ */
+std::int64_t VelocityLimiter::nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @brief Drops what fell out of the window by a time, then retrieves what is left.
+ *
+ * @param limit The limit the window belongs to.
+ * @param nowMillis The current time.
+ * @return std::int64_t The total counted in the window.
+ */
+std::int64_t VelocityLimiter::Window::slide(const Limit& limit, std::int64_t nowMillis) {
+    std::int64_t width = std::max<std::int64_t>(1, limit.windowSeconds * 1000 / BUCKETS);
+    std::int64_t bucket = nowMillis / width;
+    if (width != widthMillis || bucket - current >= BUCKETS) {
+        buckets.fill(0);
+        total = 0;
+        widthMillis = width;
+        current = bucket;
+    }
+    else {
+        // Clear the buckets the window moved past, now reused for the newest times
+        while (current < bucket) {
+            current++;
+            total -= buckets[current % BUCKETS];
+            buckets[current % BUCKETS] = 0;
+        }
+    }
+    return total;
+}
@@ -3,11 +3,38 @@
 #include "Product.h"
 #include "Gift.h"
 #include "FileManager.h"
+#include "Benchmarks.h"
+#include "BulkImporter.h"
+#include "DataStore.h"
+#include "Snapshotter.h"
+#include "PointExpirer.h"
+#include "LazyCustomerFile.h"
+#include "LoadGenerator.h"
+#include "LogFollower.h"
+#include "LogShipper.h"
+#include "ProductSearchIndex.h"
+#include "Recovery.h"
+#include "Resharder.h"
+#include "ShardMap.h"
+#include "ShardRouter.h"
+#include "ConfigWatcher.h"
+#include "RewardConfig.h"
+#include "RewardService.h"
+#include "SocketServer.h"
+#include "Trace.h"
+#include "TransactionLog.h"
 #include <iostream>
 #include <limits>
 #include <algorithm>
 #include <random>
+#include <chrono>
+#include <csignal>
+#include <ctime>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
 #include <set> // For tracking used IDs
+#include <sstream>
 
 /**
  * @brief Displays the main menu for the Customer Reward System and returns the selected option.
@@ -24,6 +51,9 @@ int displayMenu() {
     std::cout << "5. Shopping\n";
     std::cout << "6. View Customer by Customer ID\n";
     std::cout << "7. Redeem Rewards\n";
+    std::cout << "8. Bulk Customer Import (CSV)\n";
+    std::cout << "9. Search Customers\n";
+    std::cout << "10. Low Stock Report\n";
     std::cout << "0. Exit\n";
     std::cout << "Select an option: ";
     std::cin >> choice;
@@ -44,10 +74,10 @@ int displayMenu() {
 /**
  * @brief Registers a new customer by collecting input and generating a unique Customer ID.
  * 
- * @param customers A reference to the vector of Customer objects where the new customer will be added.
+ * @param store The data store; the new customer is added to its customer list once every field is entered.
  * @param usedIDs A reference to the set of used Customer IDs to ensure uniqueness.
  */
-void registerCustomer(std::vector<Customer>& customers, std::set<std::string>& usedIDs) {
+void registerCustomer(DataStore& store, std::set<std::string>& usedIDs) {
     std::string userName, firstName, lastName, creditCardNumber;
     int age, rewardPoints = 0;
 
@@ -63,13 +93,15 @@ void registerCustomer(std::vector<Customer>& customers, std::set<std::string>& u
     std::cin >> creditCardNumber;
 
     // Generate unique Customer ID
+    auto state = store.write();
     std::string customerID;
     do {
         std::random_device rd; // Seed generator
         std::mt19937 gen(rd()); // Random number generator
         std::uniform_int_distribution<> dist(1000000000, 9999999999); // 10-digit numbers
         customerID = "CustID" + std::to_string(dist(gen)); // Generate ID
-    } while (usedIDs.find(customerID) != usedIDs.end()); // Ensure uniqueness
+    } while (usedIDs.find(customerID) != usedIDs.end() || state.hasBaseCustomer(customerID) ||
+             !state.shardMap().owns(customerID)); // Ensure uniqueness, and that the ID belongs to this shard
 
     usedIDs.insert(customerID); // Mark ID as used
 
@@ -77,18 +109,68 @@ void registerCustomer(std::vector<Customer>& customers, std::set<std::string>& u
         Customer newCustomer(customerID, userName, firstName, lastName, age, creditCardNumber, rewardPoints);
         std::cout << "Customer registered successfully.\n";
         std::cout << "CustomerID: " << customerID << ".\n";
-        customers.push_back(newCustomer);
+        state.addCustomer(newCustomer);
+        state.appendLog(FileManager::formatChanges({Recovery::customerRegistered(state.nextSequence(), newCustomer)}));
     } catch (const std::invalid_argument& e) {
         std::cerr << "Error: " << e.what() << "\n";
     }
 }
 
+/**
+ * @brief Imports customers from a CSV file and reports how many rows were accepted or rejected.
+ * 
+ * @param store The data store; imported customers are added to its customer list.
+ * @param usedIDs A reference to the set of used Customer IDs to ensure uniqueness.
+ */
+void importCustomers(DataStore& store, std::set<std::string>& usedIDs) {
+    std::string csvFilename;
+    std::cout << "Enter CSV file (username,firstName,lastName,age,creditCard per line): ";
+    std::cin >> csvFilename;
+    std::string rejectFilename = csvFilename + ".rejects";
+
+    auto state = store.write();
+    try {
+        // Uniqueness checks need every existing customer, so lazy mode decodes the rest of the file first
+        state.materializeAllCustomers();
+        std::vector<Customer>& customers = state.customers();
+        for (const auto& customer : customers) {
+            usedIDs.insert(customer.getCustomerID());
+        }
+        std::size_t firstImported = customers.size();
+
+        // Journal each chunk with one write as it is accepted, so the records never outgrow a chunk
+        auto journalChunk = [&state, &customers](std::size_t firstNew) {
+            std::vector<ChangeRecord> changes;
+            changes.reserve(customers.size() - firstNew);
+            for (std::size_t i = firstNew; i < customers.size(); ++i) {
+                changes.push_back(Recovery::customerRegistered(state.nextSequence(), customers[i]));
+            }
+            state.appendLog(FileManager::formatChanges(changes), changes.size());
+        };
+        ImportReport report = BulkImporter::importCustomers(csvFilename, rejectFilename, customers, usedIDs, 0,
+                                                            state.shardMap(), journalChunk);
+        state.indexNewCustomers(firstImported);
+
+        std::cout << "Imported " << report.imported << " of " << report.rowsRead << " rows in "
+                  << report.seconds << " s (" << static_cast<long long>(report.rowsPerSecond()) << " rows/s).\n";
+        std::cout << "Duplicate prefilter false-positive rate: " << report.falsePositiveRate() * 100 << "%\n";
+        if (report.rejected > 0) {
+            std::cout << report.rejected << " rejected rows written to " << rejectFilename << ".\n";
+        }
+        else {
+            // do nothing
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
+
 /**
  * @brief Removes a customer by their Customer ID.
  * 
- * @param customers A reference to the vector of Customer objects from which the customer will be removed.
+ * @param store The data store; the customer is removed from its customer list.
  */
-void removeCustomer(std::vector<Customer>& customers) {
+void removeCustomer(DataStore& store) {
     std::string customerID;
     bool found = false;
 
@@ -96,12 +178,16 @@ void removeCustomer(std::vector<Customer>& customers) {
     std::cin >> customerID;
 
     // Search for the customer by customerID
-    for (auto it = customers.begin(); it != customers.end(); ++it) {
-        if (it->getCustomerID() == customerID) {
-            customers.erase(it);  // Remove the customer
+    {
+        auto state = store.write();
+        try {
+            found = state.removeCustomer(customerID);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+        }
+        if (found) {
+            state.appendLog(FileManager::formatChanges({Recovery::customerRemoved(state.nextSequence(), customerID)}));
             std::cout << "Customer removed successfully.\n";
-            found = true;
-            break;
         }
         else {
             // do nothing
@@ -120,22 +206,24 @@ void removeCustomer(std::vector<Customer>& customers) {
 /**
  * @brief Removes a product by its Product ID.
  * 
- * @param products A reference to the vector of Product objects from which the product will be removed.
+ * @param store The data store; the product is removed from its product list and stock monitor.
+ * @param productIndex The product name index, updated to match.
  */
-void removeProduct(std::vector<Product>& products) {
+void removeProduct(DataStore& store, ProductSearchIndex& productIndex) {
     std::string productID;
-    bool found = false;
 
     std::cout << "Enter the Product ID to remove: ";
     std::cin >> productID;
 
-    // Search for the product by productID
-    for (auto it = products.begin(); it != products.end(); ++it) {
-        if (it->getProductID() == productID) {
-            products.erase(it);  // Remove the product
+    // Remove the product from the list and the stock monitor
+    bool found = false;
+    {
+        auto state = store.write();
+        found = state.removeProduct(productID);
+        if (found) {
+            productIndex.remove(productID);
+            state.appendLog(FileManager::formatChanges({Recovery::productRemoved(state.nextSequence(), productID)}));
             std::cout << "Product removed successfully.\n";
-            found = true;
-            break;
         }
         else {
             // do nothing
@@ -154,9 +242,10 @@ void removeProduct(std::vector<Product>& products) {
 /**
  * @brief Adds a new product to the inventory by collecting input and validating through the Product constructor.
  * 
- * @param products A reference to the vector of Product objects where the new product will be added.
+ * @param store The data store; the new product is added to its product list and stock monitor.
+ * @param productIndex The product name index, updated to match.
  */
-void addProduct(std::vector<Product>& products) {  // Pass the vector by reference
+void addProduct(DataStore& store, ProductSearchIndex& productIndex) {
     std::string productID, productName;
     double productPrice;
     int productInventory;
@@ -183,7 +272,10 @@ void addProduct(std::vector<Product>& products) {  // Pass the vector by referen
         Product newProduct(productID, productName, productPrice, productInventory);
 
         // Add the product to the product list
-        products.push_back(newProduct);
+        auto state = store.write();
+        state.addProduct(newProduct);
+        productIndex.add(productID, productName);
+        state.appendLog(FileManager::formatChanges({Recovery::productAdded(state.nextSequence(), newProduct)}));
 
         std::cout << "Product added successfully.\n";
     } catch (const std::invalid_argument& e) {
@@ -194,31 +286,102 @@ void addProduct(std::vector<Product>& products) {  // Pass the vector by referen
 /**
  * @brief Displays the details of a customer based on the provided Customer ID.
  * 
- * @param customers A constant reference to the vector of Customer objects to search.
+ * @param store The data store, read under its shared lock; in lazy mode the customer is decoded without being kept.
+ * @param config The reward configuration, for the customer's loyalty tier.
  */
-void viewCustomerByID(const std::vector<Customer>& customers) {
+void viewCustomerByID(const DataStore& store, const RewardConfig& config) {
     std::string customerID;
     std::cout << "Enter Customer ID: ";
     std::cin >> customerID;
 
-    // Search for the customer in the vector
+    auto state = store.read();
+
+    // Search for the customer, decoding it from the lazy customer file if needed
     bool found = false;
-    for (const auto& customer : customers) {
-        if (customer.getCustomerID() == customerID) {
-            std::cout << "\n--- Customer Details ---\n";
-            std::cout << "Customer ID: " << customer.getCustomerID() << "\n";
-            std::cout << "Username: " << customer.getUserName() << "\n";
-            std::cout << "First Name: " << customer.getFirstName() << "\n";
-            std::cout << "Last Name: " << customer.getLastName() << "\n";
-            std::cout << "Age: " << customer.getAge() << "\n";
-            std::cout << "Credit Card Number: " << customer.getCreditCardNumber() << "\n";
-            std::cout << "Reward Points: " << customer.getRewardPoints() << "\n";
-            found = true;
-            break;
+    std::optional<Customer> match;
+    try {
+        match = state.findCustomer(customerID);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+    if (match.has_value()) {
+        const Customer& customer = *match;
+        std::cout << "\n--- Customer Details ---\n";
+        std::cout << "Customer ID: " << customer.getCustomerID() << "\n";
+        std::cout << "Username: " << customer.getUserName() << "\n";
+        std::cout << "First Name: " << customer.getFirstName() << "\n";
+        std::cout << "Last Name: " << customer.getLastName() << "\n";
+        std::cout << "Age: " << customer.getAge() << "\n";
+        std::cout << "Credit Card Number: " << customer.getCreditCardNumber() << "\n";
+        std::cout << "Reward Points: " << customer.getRewardPoints() << "\n";
+        const PointLots* lots = state.pointLots(customer.getCustomerID());
+        if (lots != nullptr && lots->getTotal() > 0) {
+            const PointLots::Lot& next = lots->getLots().front();
+            std::time_t expiresAt = static_cast<std::time_t>(next.expiresAt);
+            std::cout << "Expiring Points: " << lots->getTotal() << " in " << lots->getLots().size()
+                      << " lots (next " << next.points << " on "
+                      << std::put_time(std::localtime(&expiresAt), "%Y-%m-%d %H:%M:%S") << ")\n";
         }
         else {
             // do nothing
         }
+        const CustomerTotals* totals = state.customerTotals(customer.getCustomerID());
+        if (totals != nullptr && totals->getOrderCount() > 0) {
+            std::time_t lastPurchase = static_cast<std::time_t>(totals->getLastPurchase());
+            std::cout << "Lifetime Spend: $" << std::fixed << std::setprecision(2)
+                      << static_cast<double>(totals->getSpendCents()) / 100.0 << std::defaultfloat << " over "
+                      << totals->getOrderCount() << " orders";
+            if (lastPurchase != 0) {
+                std::cout << " (last on " << std::put_time(std::localtime(&lastPurchase), "%Y-%m-%d %H:%M:%S") << ")";
+            }
+            else {
+                // do nothing
+            }
+            std::cout << "\n";
+        }
+        else {
+            // do nothing
+        }
+        const RewardConfig::LoyaltyTier* tier =
+            config.loyaltyTierFor(totals == nullptr ? 0 : totals->getSpendCents());
+        if (tier != nullptr) {
+            std::cout << "Loyalty Tier: " << tier->name << " (+" << tier->bonusPercent << "% points)\n";
+        }
+        else {
+            // do nothing
+        }
+        found = true;
+
+        // Answered from the log's per-customer index, a seek per purchase rather than a scan of the log
+        std::vector<std::vector<std::string>> purchases =
+            TransactionLog::get().history(customer.getCustomerID(), TransactionLog::Kind::Purchase, 20);
+        std::cout << "\n--- Last " << purchases.size() << " Purchases (newest first) ---\n";
+        for (const std::vector<std::string>& record : purchases) {
+            std::string sequence, items, total, points;
+            for (const std::string& line : record) {
+                if (line.compare(0, 10, "Sequence: ") == 0) {
+                    sequence = "#" + line.substr(10) + " ";
+                }
+                else if (line.compare(0, 16, "  - Product ID: ") == 0) {
+                    std::size_t comma = line.find(", Quantity: ");
+                    items += (items.empty() ? "" : ", ") + line.substr(16, comma - 16) + " x" +
+                             (comma == std::string::npos ? "?" : line.substr(comma + 12));
+                }
+                else if (line.compare(0, 12, "Total Cost: ") == 0) {
+                    total = line.substr(12);
+                }
+                else if (line.compare(0, 22, "Reward Points Earned: ") == 0) {
+                    points = line.substr(22);
+                }
+                else {
+                    // do nothing
+                }
+            }
+            std::cout << sequence << items << " | " << total << " | +" << points << " points\n";
+        }
+    }
+    else {
+        // do nothing
     }
 
     if (!found) {
@@ -230,6 +393,140 @@ void viewCustomerByID(const std::vector<Customer>& customers) {
 }
 
 
+/**
+ * @brief Finds customers by name, age range or reward points range and shows them a page at a time.
+ * 
+ * @param store The data store; the customer indexes are built on first use.
+ */
+void searchCustomers(DataStore& store) {
+    constexpr std::size_t PAGE_SIZE = 10;
+    int kind;
+    std::cout << "Search by 1. Name, 2. Age range, 3. Reward points range: ";
+    std::cin >> kind;
+    if (std::cin.fail() || kind < 1 || kind > 3) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid choice.\n";
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    std::string lastName, firstName;
+    int low = 0, high = 0;
+    if (kind == 1) {
+        std::cout << "Enter the start of the last name ('*' for any): ";
+        std::cin >> lastName;
+        std::cout << "Enter the start of the first name ('*' for any; otherwise the last name must match exactly): ";
+        std::cin >> firstName;
+        lastName = lastName == "*" ? "" : lastName;
+        firstName = firstName == "*" ? "" : firstName;
+    }
+    else {
+        std::cout << "Enter the lowest and highest value: ";
+        std::cin >> low >> high;
+        if (std::cin.fail()) {
+            std::cin.clear();
+            std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+            std::cout << "Invalid range.\n";
+            return;
+        }
+        else {
+            // do nothing
+        }
+    }
+
+    try {
+        // Building the indexes needs the write guard, but only once; pages are then answered beside other readers
+        store.write().customerIndex();
+        std::string cursor;
+        std::size_t shown = 0;
+        while (true) {
+            // Each page is a fresh query from the cursor, so the store is not held while the user reads it
+            CustomerIndex::Page page;
+            {
+                auto state = store.read();
+                const CustomerIndex& index = *state.customerIndex();
+                page = kind == 1   ? index.byName(lastName, firstName, PAGE_SIZE, cursor)
+                       : kind == 2 ? index.byAge(low, high, PAGE_SIZE, cursor)
+                                   : index.byPoints(low, high, PAGE_SIZE, cursor);
+            }
+            for (const CustomerIndex::Row& row : page.rows) {
+                std::cout << "  " << row.customerID << "  " << row.lastName << ", " << row.firstName << "  age "
+                          << row.age << "  " << row.rewardPoints << " points\n";
+            }
+            shown += page.rows.size();
+
+            std::string more;
+            if (page.next.empty()) {
+                std::cout << shown << (shown == 1 ? " customer" : " customers") << " found.\n";
+                break;
+            }
+            else {
+                std::cout << "Show the next page? (y/n): ";
+                std::cin >> more;
+            }
+            if (more != "y" && more != "Y") {
+                break;
+            }
+            else {
+                cursor = page.next;
+            }
+        }
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
+
+/**
+ * @brief Lists the products with the least stock.
+ * 
+ * @param store The data store whose stock monitor is read.
+ */
+void lowStockReport(const DataStore& store) {
+    std::size_t count;
+    std::cout << "How many products to list: ";
+    std::cin >> count;
+    if (std::cin.fail()) {
+        std::cin.clear();
+        std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        std::cout << "Invalid number.\n";
+        return;
+    }
+    else {
+        // do nothing
+    }
+
+    auto state = store.read();
+    const StockMonitor& monitor = state.stockMonitor();
+    std::vector<StockMonitor::Level> levels = monitor.lowest(count);
+    std::cout << "\n--- Lowest Stock (threshold " << monitor.getThreshold() << ") ---\n";
+    for (const StockMonitor::Level& level : levels) {
+        std::cout << (level.inventory <= monitor.getThreshold() ? "* " : "  ") << level.productID << "  "
+                  << level.productName << "  " << level.inventory << " in stock\n";
+    }
+    if (levels.empty()) {
+        std::cout << "No products.\n";
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Prints the products that fell to the low-stock threshold since the last call.
+ * 
+ * @param store The data store whose stock monitor holds the alerts.
+ */
+void reportStockAlerts(DataStore& store) {
+    std::vector<StockMonitor::Alert> alerts = store.write().stockMonitor().takeAlerts();
+    for (const StockMonitor::Alert& alert : alerts) {
+        std::cout << "Low stock: " << alert.productID << " (" << alert.productName << ") is down to "
+                  << alert.inventory << (alert.inventory == 1 ? " unit.\n" : " units.\n");
+    }
+}
+
 /**
  * @brief Sets the number of reward points awarded per dollar spent.
  * 
@@ -245,11 +542,12 @@ void setPointsPerDollar(int& pointsPerDollar) {
 /**
  * @brief Adds a new gift to the list of available gifts for redemption.
  * 
- * @param gifts A reference to the vector of Gift objects where the new gift will be added.
+ * @param store The data store; the new gift is added to its gift list.
  */
-void addGift(std::vector<Gift>& gifts) {
+void addGift(DataStore& store) {
     std::string giftName;
     int requiredPoints;
+    int stock;
 
     std::cout << "Enter gift name: ";
     std::cin.ignore(); // Clear the input buffer
@@ -258,7 +556,12 @@ void addGift(std::vector<Gift>& gifts) {
     std::cout << "Enter points required to redeem this gift: ";
     std::cin >> requiredPoints;
 
-    gifts.emplace_back(giftName, requiredPoints);
+    std::cout << "Enter units available (-1 for unlimited): ";
+    std::cin >> stock;
+
+    auto state = store.write();
+    state.gifts().emplace_back(giftName, requiredPoints, stock);
+    state.appendLog(FileManager::formatChanges({Recovery::giftAdded(state.nextSequence(), state.readGifts().back())}));
     std::cout << "Gift added: " << giftName << " (requires " << requiredPoints << " points).\n";
 }
 
@@ -266,20 +569,30 @@ void addGift(std::vector<Gift>& gifts) {
 /**
  * @brief Allows a customer to redeem a reward using their reward points.
  * 
- * @param customers A reference to the vector of Customer objects.
- * @param gifts A reference to the vector of Gift objects available for redemption.
+ * Prompts under the store's shared lock only; the exclusive lock is taken for the redemption itself, which
+ * checks the customer, the stock and the points again.
+ * 
+ * @param store The data store holding the customers and the gifts available for redemption.
+ * @param config The reward configuration, whose gifts are offered after the ones in the store.
  */
-void redeemReward(std::vector<Customer>& customers, std::vector<Gift>& gifts) {
+void redeemReward(DataStore& store, const RewardConfig& config) {
     std::string customerID;
     std::cout << "Enter Customer ID: ";
     std::cin >> customerID;
 
-    // Find the customer
-    auto it = std::find_if(customers.begin(), customers.end(), [&](const Customer& c) {
-        return c.getCustomerID() == customerID;
-    });
+    // Find the customer, and what the gifts look like now
+    std::optional<Customer> found;
+    std::vector<Gift> gifts;
+    try {
+        auto snapshot = store.read();
+        found = snapshot.findCustomer(customerID);
+        gifts = snapshot.readGifts();
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+    gifts.insert(gifts.end(), config.getGifts().begin(), config.getGifts().end());
 
-    if (it == customers.end()) {
+    if (!found.has_value()) {
         std::cout << "Customer ID not found.\n";
         return;
     }
@@ -287,8 +600,6 @@ void redeemReward(std::vector<Customer>& customers, std::vector<Gift>& gifts) {
         // do nothing
     }
 
-    Customer& customer = *it;
-
     // Display available gifts
     if (gifts.empty()) {
         std::cout << "No gifts available for redemption.\n";
@@ -301,11 +612,21 @@ void redeemReward(std::vector<Customer>& customers, std::vector<Gift>& gifts) {
     std::cout << "\n--- Available Gifts ---\n";
     for (size_t i = 0; i < gifts.size(); ++i) {
         std::cout << i + 1 << ". " << gifts[i].getGiftName()
-                  << " (requires " << gifts[i].getRequiredPoints() << " points)\n";
+                  << " (requires " << gifts[i].getRequiredPoints() << " points";
+        if (!gifts[i].isInStock()) {
+            std::cout << ", sold out";
+        }
+        else if (gifts[i].isLimited()) {
+            std::cout << ", " << gifts[i].getStock() << " left";
+        }
+        else {
+            // do nothing
+        }
+        std::cout << ")\n";
     }
 
     // Display customer's points
-    std::cout << "\nYou have " << customer.getRewardPoints() << " reward points.\n";
+    std::cout << "\nYou have " << found->getRewardPoints() << " reward points.\n";
 
     // Select a gift
     int choice;
@@ -320,40 +641,86 @@ void redeemReward(std::vector<Customer>& customers, std::vector<Gift>& gifts) {
         // do nothing
     }
 
-    if (choice < 1 || choice > static_cast<int>(gifts.size())) {
-        std::cout << "Invalid choice.\n";
+    try {
+        auto state = store.write();
+        Customer* customer = state.findCustomer(customerID);
+        if (customer == nullptr) {
+            throw std::invalid_argument("Customer ID not found.");   // removed while choosing
+        }
+        else {
+            // do nothing
+        }
+        Gift redeemed = state.redeemGift(*customer, choice, config.getGifts(), config.getVelocityLimits());
+        state.appendLog(FileManager::formatRedemption(state.nextSequence(), customerID, redeemed));
+        std::cout << "Successfully redeemed: " << redeemed.getGiftName() << "\n";
+        std::cout << "Remaining points: " << customer->getRewardPoints() << "\n";
+    } catch (const std::invalid_argument& e) {
+        std::cout << e.what() << "\n";
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+}
+
+/**
+ * @brief Lists the products whose name matches what the customer typed instead of a Product ID.
+ * 
+ * @param store The data store, read for the price and stock of each match.
+ * @param productIndex The product name index.
+ * @param query Part of a product name.
+ */
+void listProductMatches(const DataStore& store, const ProductSearchIndex& productIndex, const std::string& query) {
+    TRACE_SPAN("shopping.searchProducts");
+    std::vector<std::string> matches = productIndex.search(query, 10);
+    if (matches.empty()) {
+        std::cout << "No products match \"" << query << "\".\n";
         return;
     }
     else {
         // do nothing
     }
 
-    const Gift& selectedGift = gifts[choice - 1];
-    if (customer.getRewardPoints() >= selectedGift.getRequiredPoints()) {
-        customer.addRewardPoints(-selectedGift.getRequiredPoints());
-        std::cout << "Successfully redeemed: " << selectedGift.getGiftName() << "\n";
-        std::cout << "Remaining points: " << customer.getRewardPoints() << "\n";
-    } else {
-        std::cout << "Insufficient reward points to redeem this gift.\n";
+    auto state = store.read();
+    const std::vector<Product>& products = state.readProducts();
+    for (const std::string& productID : matches) {
+        auto productIt = find_if(products.begin(), products.end(),
+                                 [&productID](const Product& p) { return p.getProductID() == productID; });
+        if (productIt != products.end()) {
+            std::cout << "  " << productID << "  " << productIt->getProductName() << "  $"
+                      << productIt->getProductPrice() << "  (" << productIt->getProductInventory() << " in stock)\n";
+        }
+        else {
+            // do nothing
+        }
     }
-}    
+}
 
 /**
  * "Shopping functionality in menu system"
  * 
- * @param customers References registered customers.
- * @param products References available products.
- * @param pointsPerDollar The number of reward points earned per dollar spent.
- * @throws std::runtime_error if file operations fail.
+ * Prompts for the cart, then hands it to the checkout pipeline, which reserves the stock, prices the cart,
+ * accrues the points and logs the transaction. Anything typed that is not a Product ID is looked up as part
+ * of a product name.
+ * 
+ * @param store The data store, read while prompting to check the customer, product IDs and stock.
+ * @param service The reward service whose checkout pipeline applies the cart.
+ * @param productIndex The product name index used to search by name.
  */
-void shopping(std::vector<Customer>& customers, std::vector<Product>& products, double pointsPerDollar) {
+void shopping(const DataStore& store, RewardService& service, const ProductSearchIndex& productIndex) {
     std::string customerID;
     std::cout << "Enter Customer ID: ";
     std::cin >> customerID;
 
-    auto customerIt = find_if(customers.begin(), customers.end(),
-                              [&customerID](const Customer& c) { return c.getCustomerID() == customerID; });
-    if (customerIt == customers.end()) {
+    TRACE_SPAN("shopping");
+    bool customerFound = false;
+    {
+        TRACE_SPAN("shopping.findCustomer");
+        try {
+            customerFound = store.read().findCustomer(customerID).has_value();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+        }
+    }
+    if (!customerFound) {
         std::cout << "Customer not found.\n";
         return;
     }
@@ -361,22 +728,32 @@ void shopping(std::vector<Customer>& customers, std::vector<Product>& products,
         // do nothing
     }
 
-    std::vector<std::pair<std::string, int>> cart;
-    double totalCost = 0.0;
+    Cart cart;
 
     while (true) {
-        std::cout << "Enter Product ID (or 'done' to finish): ";
+        std::cout << "Enter Product ID, part of a product name to search for, or 'done' to finish: ";
         std::string productID;
         std::cin >> productID;
         if (productID == "done") break;
+        else if (!Product::isProductIDValid(productID)) {
+            listProductMatches(store, productIndex, productID);
+            continue;
+        }
         else {
             // do nothing
         }
 
-        auto productIt = find_if(products.begin(), products.end(),
-                                 [&productID](const Product& p) { return p.getProductID() == productID; });
+        int available = -1;
+        {
+            TRACE_SPAN("shopping.findProduct");
+            auto state = store.read();
+            const std::vector<Product>& products = state.readProducts();
+            auto productIt = find_if(products.begin(), products.end(),
+                                     [&productID](const Product& p) { return p.getProductID() == productID; });
+            available = productIt == products.end() ? -1 : productIt->getProductInventory();
+        }
 
-        if (productIt == products.end()) {
+        if (available < 0) {
             std::cout << "Invalid Product ID.\n";
             continue;
         }
@@ -388,7 +765,11 @@ void shopping(std::vector<Customer>& customers, std::vector<Product>& products,
         std::cout << "Enter Quantity: ";
         std::cin >> quantity;
 
-        if (quantity <= 0 || quantity > productIt->getProductInventory()) {
+        // Stock is only reserved at checkout, so count what this cart already holds
+        for (const auto& line : cart) {
+            available -= line.first == productID ? line.second : 0;
+        }
+        if (quantity <= 0 || quantity > available) {
             std::cout << "Invalid quantity.\n";
             continue;
         }
@@ -396,16 +777,15 @@ void shopping(std::vector<Customer>& customers, std::vector<Product>& products,
             // do nothing
         }
 
-        productIt->updateInventory(-quantity);
-        totalCost += productIt->getProductPrice() * quantity;
         cart.emplace_back(productID, quantity);
     }
 
-    int rewardPoints = static_cast<int>(totalCost * pointsPerDollar);
-    customerIt->addRewardPoints(rewardPoints);
-    FileManager::logTransaction(customerID, cart, totalCost, rewardPoints);
-
-    std::cout << "Total: $" << totalCost << ", Reward Points Earned: " << rewardPoints << "\n";
+    try {
+        Receipt receipt = service.checkout(customerID, cart);
+        std::cout << "Total: $" << receipt.totalCost << ", Reward Points Earned: " << receipt.rewardPoints << "\n";
+    } catch (const std::invalid_argument& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
 }
 
 
@@ -420,61 +800,750 @@ void addDummyData(std::vector<Customer>& customers, std::vector<Product>& produc
     products.push_back(Product("Prod00002", "Phone", 499.99, 25));
 }
 
-int main() {
+/**
+ * @brief Command-line options.
+ */
+struct Options {
+    int snapshotInterval = 30;      ///< Seconds between background snapshots (--snapshot-interval N, 0 disables).
+    bool lazyCustomers = false;     ///< --lazy: index customers.txt at startup and decode customers on first use.
+    std::string serveAddress;       ///< --serve ADDRESS: serve requests on a socket instead of showing the menu.
+    unsigned workers = 0;           ///< --workers N: socket service worker threads (0 = one per hardware thread).
+    std::string loadTarget;         ///< --loadgen TARGET: drive "inproc" or a --serve address with simulated clients.
+    LoadConfig load;                ///< --clients N, --duration SECONDS, --rate PER_SECOND, --mix L,C,R,G.
+    std::string cartFile;           ///< --checkout-batch FILE: check out the carts in FILE, then exit.
+    bool perCart = false;           ///< --per-cart: check the batch out one cart at a time, for comparison.
+    /// --bench-<name> N: run the benchmarks named (see Benchmarks) in the order given, then exit.
+    std::vector<std::pair<const Benchmarks::Entry*, long long>> benchmarks;
+    bool selfCheck = false;         ///< --self-check: run every benchmark at a small size; exit 1 if a check fails.
+    int lowStockThreshold = 5;      ///< --low-stock N: alert when a product's inventory falls to N or fewer.
+    std::string dataDirectory;      ///< --data-dir DIR: load and save the data files in DIR, e.g. one shard's.
+    std::string reshardRoot;        ///< --reshard ROOT N: split ROOT's data into N shards, then exit.
+    unsigned reshardCount = 0;
+    std::string routeAddress;       ///< --route ADDRESS: forward requests to the shards' servers, then exit.
+    std::string shardsRoot;         ///< --shards ROOT: the sharded root directory --route reads shards.txt from.
+    std::string replicateAddress;   ///< --replicate ADDRESS: ship the transaction log to followers connecting here.
+    std::string followAddress;      ///< --follow ADDRESS: apply the log shipped from ADDRESS and serve reads only.
+    std::uint64_t logSegmentKB = 64 * 1024;   ///< --log-segment-kb N: start a new log segment after N KiB.
+    bool rebuildTotals = false;     ///< --rebuild-totals: rebuild the customers' lifetime totals from the whole log.
+};
+
+/**
+ * @brief Parses the command-line options.
+ * 
+ * @param argc The argument count passed to main.
+ * @param argv The arguments passed to main.
+ * @param options Receives the parsed options.
+ * @return bool True if the options were valid, false otherwise.
+ */
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        try {
+            if (option == "--snapshot-interval" && i + 1 < argc) {
+                options.snapshotInterval = std::stoi(argv[++i]);
+            }
+            else if (option == "--lazy") {
+                options.lazyCustomers = true;
+            }
+            else if (option == "--serve" && i + 1 < argc) {
+                options.serveAddress = argv[++i];
+            }
+            else if (option == "--workers" && i + 1 < argc) {
+                options.workers = static_cast<unsigned>(std::stoul(argv[++i]));
+            }
+            else if (option == "--loadgen" && i + 1 < argc) {
+                options.loadTarget = argv[++i];
+            }
+            else if (option == "--clients" && i + 1 < argc) {
+                options.load.clients = static_cast<unsigned>(std::stoul(argv[++i]));
+            }
+            else if (option == "--duration" && i + 1 < argc) {
+                options.load.seconds = std::stod(argv[++i]);
+            }
+            else if (option == "--rate" && i + 1 < argc) {
+                options.load.targetRate = std::stod(argv[++i]);
+            }
+            else if (option == "--mix" && i + 1 < argc) {
+                // Weights for lookups, checkouts, redemptions and registrations, e.g. 70,20,5,5
+                std::string mix = argv[++i];
+                std::size_t start = 0;
+                for (std::size_t op = 0; op < LOAD_OPERATION_COUNT; ++op) {
+                    std::size_t comma = mix.find(',', start);
+                    options.load.mix[op] = std::stod(mix.substr(start, comma - start));
+                    start = comma == std::string::npos ? mix.size() : comma + 1;
+                }
+            }
+            else if (option == "--checkout-batch" && i + 1 < argc) {
+                options.cartFile = argv[++i];
+            }
+            else if (option == "--per-cart") {
+                options.perCart = true;
+            }
+            else if (option.rfind("--bench-", 0) == 0 && Benchmarks::find(option.substr(8)) != nullptr &&
+                     i + 1 < argc) {
+                long long size = std::stoll(argv[++i]);
+                if (size <= 0) {
+                    return false;
+                }
+                else {
+                    options.benchmarks.emplace_back(Benchmarks::find(option.substr(8)), size);
+                }
+            }
+            else if (option == "--self-check") {
+                options.selfCheck = true;
+            }
+            else if (option == "--low-stock" && i + 1 < argc) {
+                options.lowStockThreshold = std::stoi(argv[++i]);
+            }
+            else if (option == "--data-dir" && i + 1 < argc) {
+                options.dataDirectory = argv[++i];
+            }
+            else if (option == "--reshard" && i + 2 < argc) {
+                options.reshardRoot = argv[++i];
+                options.reshardCount = static_cast<unsigned>(std::stoul(argv[++i]));
+            }
+            else if (option == "--route" && i + 1 < argc) {
+                options.routeAddress = argv[++i];
+            }
+            else if (option == "--shards" && i + 1 < argc) {
+                options.shardsRoot = argv[++i];
+            }
+            else if (option == "--replicate" && i + 1 < argc) {
+                options.replicateAddress = argv[++i];
+            }
+            else if (option == "--follow" && i + 1 < argc) {
+                options.followAddress = argv[++i];
+            }
+            else if (option == "--rebuild-totals") {
+                options.rebuildTotals = true;
+            }
+            else if (option == "--log-segment-kb" && i + 1 < argc) {
+                options.logSegmentKB = std::stoull(argv[++i]);
+            }
+            else {
+                std::cerr << "Unknown option: " << option << "\n";
+                return false;
+            }
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+    return options.snapshotInterval >= 0 && options.logSegmentKB > 0 && (options.reshardRoot.empty() || options.reshardCount > 0) &&
+           options.routeAddress.empty() == options.shardsRoot.empty() &&
+           (options.followAddress.empty() || !options.serveAddress.empty());
+}
+
+/**
+ * @brief Writes the final snapshot and prints the persistence statistics.
+ * 
+ * @param store The data store to save.
+ * @param snapshotter The background snapshotter, stopped first so the two writers never overlap.
+ */
+void saveAndExit(DataStore& store, Snapshotter& snapshotter) {
+    std::cout << "Saving files and exiting program.\n";
+    snapshotter.stop();
+    try {
+        Snapshotter::writeSnapshot(store.snapshot());
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+    }
+
+    Snapshotter::Stats snapshotStats = snapshotter.getStats();
+    DataStore::Stats storeStats = store.getStats();
+    std::cout << "Background snapshots written: " << snapshotStats.snapshotsWritten
+              << " (last took " << snapshotStats.lastWriteSeconds * 1000 << " ms).\n";
+    std::cout << "Copy-on-write copies: " << storeStats.copies << " in " << storeStats.writeOperations
+              << " operations, " << storeStats.copySeconds * 1000 << " ms total, "
+              << storeStats.maxCopySeconds * 1000 << " ms worst.\n";
+    TRACE_WRITE("trace.json");
+}
+
+/**
+ * @brief Drives the system with simulated clients and prints throughput and latency percentiles.
+ * 
+ * @param store The data store; its customers, products and gifts supply the IDs used in requests.
+ * @param service The reward service, for the in-process target.
+ * @param options The parsed options, for the target and load settings.
+ * @return int The process exit status.
+ */
+int generateLoad(DataStore& store, RewardService& service, const Options& options) {
+    LoadCatalog catalog;
+    DataStore::Snapshot snapshot = store.snapshot();
+    for (const Customer& customer : *snapshot.customers) {
+        catalog.customerIDs.push_back(customer.getCustomerID());
+    }
+    if (snapshot.baseCustomers != nullptr) {
+        for (std::size_t i = 0; i < snapshot.baseCustomers->size(); ++i) {
+            catalog.customerIDs.push_back(snapshot.baseCustomers->customerIDAt(i));
+        }
+    }
+    else {
+        // do nothing
+    }
+    for (const Product& product : *snapshot.products) {
+        catalog.productIDs.push_back(product.getProductID());
+    }
+    catalog.giftCount = static_cast<int>(snapshot.gifts->size() + service.getConfig()->getGifts().size());
+
+    std::function<std::unique_ptr<LoadTarget>()> connect;
+    if (options.loadTarget == "inproc") {
+        connect = [&service]() { return std::unique_ptr<LoadTarget>(new InProcessTarget(service)); };
+    }
+    else {
+        connect = [&options]() { return std::unique_ptr<LoadTarget>(new SocketTarget(options.loadTarget)); };
+    }
+
+    try {
+        std::cout << "Running " << options.load.clients << " clients against " << options.loadTarget << " for "
+                  << options.load.seconds << " s";
+        if (options.load.targetRate > 0.0) {
+            std::cout << " at " << options.load.targetRate << " requests/s";
+        }
+        else {
+            std::cout << ", closed loop";
+        }
+        std::cout << ".\n";
+        LoadReport report = LoadGenerator::run(options.load, catalog, connect);
+
+        std::cout << "\n--- Load Report ---\n";
+        std::cout << "Throughput: " << static_cast<long long>(report.throughput()) << " requests/s\n";
+        std::cout << "operation      count     errors   p50 us   p99 us  p999 us   max us\n";
+        auto printRow = [](const char* name, const LatencySummary& s) {
+            std::cout << std::left << std::setw(10) << name << std::right << std::setw(10) << s.count
+                      << std::setw(11) << s.errors << std::fixed << std::setprecision(1) << std::setw(9) << s.p50
+                      << std::setw(9) << s.p99 << std::setw(9) << s.p999 << std::setw(9) << s.max << "\n";
+            std::cout.unsetf(std::ios::fixed);
+        };
+        for (std::size_t op = 0; op < LOAD_OPERATION_COUNT; ++op) {
+            printRow(LoadGenerator::operationName(static_cast<LoadOperation>(op)), report.operations[op]);
+        }
+        printRow("all", report.overall);
+        LogWriter::Stats logStats = service.getPipeline().getLogStats();
+        if (logStats.batches > 0) {
+            std::cout << "Checkout log: " << logStats.records << " records in " << logStats.batches << " writes.\n";
+        }
+        else {
+            // do nothing
+        }
+        return 0;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+/**
+ * @brief Checks out every cart in a file, as one batch or one cart at a time, and prints the throughput.
+ * 
+ * @param service The reward service that applies the carts.
+ * @param options The parsed options, for the cart file and --per-cart.
+ * @return int The process exit status.
+ */
+int checkoutCarts(RewardService& service, const Options& options) {
+    std::vector<CartOrder> orders;
+    try {
+        orders = FileManager::loadCartOrders(options.cartFile);
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
+    std::size_t cartCount = orders.size();
+    std::size_t applied = 0;
+    double totalCost = 0.0;
+    std::string firstError;
+    auto start = std::chrono::steady_clock::now();
+    if (options.perCart) {
+        for (const CartOrder& order : orders) {
+            try {
+                totalCost += service.checkout(order.customerID, order.cart).totalCost;
+                applied++;
+            } catch (const std::invalid_argument& e) {
+                if (firstError.empty()) firstError = e.what();
+            }
+        }
+    }
+    else {
+        std::vector<BatchOutcome> outcomes = service.checkoutBatch(std::move(orders));
+        for (const BatchOutcome& outcome : outcomes) {
+            if (outcome.receipt) {
+                totalCost += outcome.receipt->totalCost;
+                applied++;
+            }
+            else if (firstError.empty()) {
+                firstError = outcome.error;
+            }
+            else {
+                // do nothing
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << (options.perCart ? "Per-cart" : "Batch") << " checkout: applied " << applied << " of "
+              << cartCount << " carts ($" << std::fixed << std::setprecision(2) << totalCost << ") in "
+              << seconds * 1000 << " ms, " << static_cast<long long>(cartCount / seconds) << " carts/s.\n";
+    std::cout.unsetf(std::ios::fixed);
+    if (!firstError.empty()) {
+        std::cout << cartCount - applied << " carts rejected, first: " << firstError << "\n";
+    }
+    else {
+        // do nothing
+    }
+    LogWriter::Stats logStats = service.getPipeline().getLogStats();
+    std::cout << "Checkout log: " << logStats.records << " records in " << logStats.batches << " writes.\n";
+    return 0;
+}
+
+// The running socket service, for the SIGINT/SIGTERM handler
+SocketServer* activeServer = nullptr;
+
+/**
+ * @brief Stops the socket service so main can save and exit normally.
+ * 
+ * @param signal The signal received.
+ */
+void stopServer(int) {
+    if (activeServer != nullptr) {
+        activeServer->stop();
+    }
+    else {
+        // do nothing
+    }
+}
+
+/**
+ * @brief Serves socket requests until SIGINT or SIGTERM.
+ * 
+ * @param service The reward service that executes the requests.
+ * @param options The parsed options, for the address and worker count.
+ * @return int The process exit status.
+ */
+int serve(RewardService& service, const Options& options) {
+    try {
+        SocketServer server(service, options.serveAddress, options.workers);
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cout << "Serving on " << options.serveAddress << ". Press Ctrl+C to stop.\n";
+        server.run();
+        activeServer = nullptr;
+
+        SocketServer::Stats stats = server.getStats();
+        std::cout << "Served " << stats.requestsServed << " requests (" << stats.errorResponses << " errors) on "
+                  << stats.connectionsAccepted << " connections.\n";
+        return 0;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+/**
+ * @brief Splits a data directory, or an existing set of shards, into a new number of shards and prints where
+ *        everything went.
+ * 
+ * @param options The parsed options, for the root directory and shard count.
+ * @return int The process exit status.
+ */
+int reshardData(const Options& options) {
+    try {
+        ReshardReport report = Resharder::reshard(options.reshardRoot, options.reshardCount);
+        std::size_t totalCustomers = 0;
+        std::cout << "Resharded " << report.sourceShards << " shard(s) into " << options.reshardCount << " in "
+                  << report.seconds * 1000 << " ms; sequence numbers continue after " << report.lastSequence << ".\n";
+        for (unsigned shard = 0; shard < options.reshardCount; ++shard) {
+            std::cout << "  " << ShardMap::directory(options.reshardRoot, shard) << ": "
+                      << report.customersPerShard[shard] << " customers, " << report.recordsPerShard[shard]
+                      << " log records carried.\n";
+            totalCustomers += report.customersPerShard[shard];
+        }
+        std::cout << totalCustomers << " customers in total; " << report.recordsDropped
+                  << " catalog log records left behind. Old files moved to " << report.retiredDirectory << ".\n";
+        return 0;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+/**
+ * @brief Forwards socket requests to the shard servers until SIGINT or SIGTERM.
+ * 
+ * @param options The parsed options, for the router's address, the sharded root and the worker count.
+ * @return int The process exit status.
+ */
+int routeRequests(const Options& options) {
+    try {
+        ShardRouter router(options.shardsRoot);
+        SocketServer server([&router](const std::string& request) { return router.route(request); },
+                            options.routeAddress, options.workers);
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cout << "Routing " << options.routeAddress << " to " << router.getShardCount()
+                  << " shards. Press Ctrl+C to stop.\n";
+        server.run();
+        activeServer = nullptr;
+
+        SocketServer::Stats stats = server.getStats();
+        std::vector<std::uint64_t> counts = router.getRequestCounts();
+        std::cout << "Routed " << stats.requestsServed << " requests (" << stats.errorResponses << " errors) on "
+                  << stats.connectionsAccepted << " connections; per shard:";
+        for (std::uint64_t count : counts) {
+            std::cout << " " << count;
+        }
+        std::cout << ".\n";
+        return 0;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+/**
+ * @brief Serves read-only socket requests from a follower until SIGINT or SIGTERM, applying the primary's log
+ *        in the background.
+ * 
+ * Lookups and stock reports are answered from this process's copy of the data; anything that would change
+ * it is refused. LAG reports how far behind the primary the copy is:
+ * "OK <applied> <primary> <recordsBehind> <delayMs> <heartbeatAgeMs> connected|disconnected".
+ * 
+ * @param store The data store, loaded from the primary's data files.
+ * @param service The reward service, for the read-only requests.
+ * @param options The parsed options, for the addresses and worker count.
+ * @param lastSequence The last log record already applied to the store.
+ * @param logOffset An offset in the log at or before the first record not yet applied.
+ * @return int The process exit status.
+ */
+int serveFollower(DataStore& store, RewardService& service, const Options& options, std::uint64_t lastSequence,
+                  std::uint64_t logOffset) {
+    try {
+        LogFollower follower(store, options.followAddress, lastSequence, logOffset);
+        auto handler = [&service, &follower](const std::string& request) -> std::string {
+            std::string command = request.substr(0, request.find(' '));
+            if (command == "PING" || command == "LOOKUP" || command == "LOWSTOCK") {
+                return SocketServer::respond(service, request);
+            }
+            else if (command == "LAG") {
+                LogFollower::Status status = follower.getStatus();
+                std::ostringstream out;
+                out << "OK " << status.appliedSequence << " " << status.primarySequence << " "
+                    << status.recordsBehind() << " " << status.lastDelayMs << " "
+                    << static_cast<long long>(status.heartbeatAgeMs) << " "
+                    << (status.connected ? "connected" : "disconnected");
+                return out.str();
+            }
+            else {
+                return "ERR " + command + " is not served by a read-only follower; send it to the primary.";
+            }
+        };
+        SocketServer server(handler, options.serveAddress, options.workers);
+        activeServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cout << "Following " << options.followAddress << "; serving reads on " << options.serveAddress
+                  << ". Press Ctrl+C to stop.\n";
+        server.run();
+        activeServer = nullptr;
+
+        SocketServer::Stats stats = server.getStats();
+        LogFollower::Status status = follower.getStatus();
+        std::cout << "Served " << stats.requestsServed << " reads (" << stats.errorResponses << " errors). Applied "
+                  << status.recordsApplied << " shipped records (" << status.recordsSkipped
+                  << " skipped) up to sequence " << status.appliedSequence << "; the primary was at "
+                  << status.primarySequence << ".\n";
+        return 0;
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
+
+int main(int argc, char* argv[]) {
     int choice;
     std::vector<Customer> customers;  // Create vector to store all customers
     std::vector<Product> products;    // Create vector to store all products
-    std::vector<Transaction> transactions;
+    Checkpoint customerCheckpoint, productCheckpoint, giftCheckpoint;
+    std::vector<PointLots> pointLots;
+    std::vector<CustomerTotals> customerTotals;
 
 
     int pointsPerDollar = 10; // Default points per dollar
     std::vector<Gift> gifts; // Empty vector of gifts
+    Options options;
+    std::shared_ptr<LazyCustomerFile> baseCustomers;
+    std::vector<std::string> removedBaseCustomerIDs;
 
     std::set<std::string> usedIDs; 
 
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: " << argv[0] << " [--snapshot-interval SECONDS] [--lazy] [--low-stock UNITS]"
+                  << " [--serve unix:PATH|tcp:PORT [--workers N]]"
+                  << " [--loadgen inproc|unix:PATH|tcp:PORT [--clients N] [--duration SECONDS] [--rate PER_SECOND]"
+                  << " [--mix LOOKUP,CHECKOUT,REDEEM,REGISTER]] [--checkout-batch FILE [--per-cart]]"
+                  << Benchmarks::usage() << " [--self-check]"
+                  << " [--data-dir DIR] [--reshard ROOT SHARDS]"
+                  << " [--route unix:PATH|tcp:PORT --shards ROOT] [--replicate unix:PATH|tcp:PORT]"
+                  << " [--follow unix:PATH|tcp:PORT --serve unix:PATH|tcp:PORT] [--log-segment-kb KIB]"
+                  << " [--rebuild-totals]\n";
+        return 1;
+    }
+    else {
+        // do nothing
+    }
+    TransactionLog::setSegmentBytes(options.logSegmentKB * 1024);
+
+    // The offline and routing tools never touch the data files of the current directory
+    if (!options.reshardRoot.empty()) {
+        return reshardData(options);
+    }
+    else if (!options.routeAddress.empty()) {
+        return routeRequests(options);
+    }
+    else {
+        // do nothing
+    }
+
+    // Every data file is opened relative to the working directory, so a shard runs inside its own directory
+    ShardMap shardMap;
+    try {
+        if (!options.dataDirectory.empty()) {
+            std::filesystem::current_path(options.dataDirectory);
+        }
+        else {
+            // do nothing
+        }
+        shardMap = ShardMap::loadIdentity(".");
+        if (shardMap.getShardCount() > 1) {
+            std::cout << "Serving shard " << shardMap.getShardIndex() << " of " << shardMap.getShardCount() << ".\n";
+        }
+        else {
+            // do nothing
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+
     // Load saved data with error handling
     try {
-        customers = FileManager::loadCustomers();
-        std::cout << "Successfully loaded " << customers.size() << " customers.\n";
-        
-        // Populate usedIDs set from loaded customers
-        for (const auto& customer : customers) {
-            usedIDs.insert(customer.getCustomerID());
+        if (options.lazyCustomers) {
+            auto indexStart = std::chrono::steady_clock::now();
+            baseCustomers = LazyCustomerFile::open("customers.txt", &customerCheckpoint);
+            std::cout << "Successfully indexed " << baseCustomers->size() << " customers in "
+                      << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - indexStart).count()
+                      << " ms.\n";
+        }
+        else {
+            customers = FileManager::loadCustomers("customers.txt", &customerCheckpoint);
+            std::cout << "Successfully loaded " << customers.size() << " customers.\n";
         }
     } catch (const std::runtime_error& e) {
         std::cout << "Note: " << e.what() << " Starting with empty customer list.\n";
     }
 
     try {
-        products = FileManager::loadProducts();
+        products = FileManager::loadProducts("products.txt", &productCheckpoint);
         std::cout << "Successfully loaded " << products.size() << " products.\n";
     } catch (const std::runtime_error& e) {
         std::cout << "Note: " << e.what() << " Starting with empty product list.\n";
     }
 
+    try {
+        gifts = FileManager::loadGifts("gifts.txt", &giftCheckpoint);
+        std::cout << "Successfully loaded " << gifts.size() << " gifts.\n";
+    } catch (const std::runtime_error& e) {
+        std::cout << "Note: " << e.what() << " Starting with empty gift list.\n";
+    }
+
+    // Without point_lots.txt no points expire but those logged since the customers were saved
+    Checkpoint lotCheckpoint = customerCheckpoint;
+    try {
+        pointLots = FileManager::loadPointLots("point_lots.txt", &lotCheckpoint);
+        std::cout << "Successfully loaded the point lots of " << pointLots.size() << " customers.\n";
+    } catch (const std::runtime_error&) {
+        // do nothing
+    }
+
+    // Lifetime totals missing or in doubt are rebuilt from every segment of the log, in parallel
+    Checkpoint totalsCheckpoint;
+    bool totalsLoaded = false;
+    if (!options.rebuildTotals) {
+        try {
+            customerTotals = FileManager::loadCustomerTotals("customer_totals.txt", &totalsCheckpoint);
+            std::cout << "Successfully loaded the lifetime totals of " << customerTotals.size() << " customers.\n";
+            totalsLoaded = true;
+        } catch (const std::runtime_error& e) {
+            std::cout << "Note: " << e.what() << " Rebuilding them from the transaction log.\n";
+        }
+    }
+    else {
+        // do nothing
+    }
+    if (!totalsLoaded) {
+        RecoveryReport rebuilt;
+        customerTotals = Recovery::rebuildTotals(totalsCheckpoint, "transactions.txt", &rebuilt);
+        std::cout << "Rebuilt the lifetime totals of " << customerTotals.size() << " customers from "
+                  << rebuilt.recordsRead << " logged changes on " << rebuilt.threads << " threads in "
+                  << rebuilt.seconds * 1000 << " ms.\n";
+    }
+
+    // Bring the checkpoints up to date with whatever was logged after them
+    RecoveryReport recovery = Recovery::replay(customers, customerCheckpoint, products, productCheckpoint,
+                                               gifts, giftCheckpoint, pointLots, lotCheckpoint, customerTotals,
+                                               totalsCheckpoint, "transactions.txt", baseCustomers.get(),
+                                               &removedBaseCustomerIDs);
+    if (recovery.recordsRead > 0) {
+        std::cout << "Replayed " << recovery.recordsApplied << " of " << recovery.recordsRead
+                  << " logged changes since the last checkpoint in " << recovery.seconds * 1000 << " ms";
+        if (recovery.recordsSkipped > 0) {
+            std::cout << " (" << recovery.recordsSkipped << " could not be applied)";
+        }
+        else {
+            // do nothing
+        }
+        std::cout << ".\n";
+    }
+    else {
+        // do nothing
+    }
+
+    // Populate usedIDs set from loaded customers (lazy mode checks the base file's index instead)
+    for (const auto& customer : customers) {
+        usedIDs.insert(customer.getCustomerID());
+    }
+
+    // From here on the lists live in the store so the snapshotter can persist them in the background
+    DataStore store(std::move(customers), std::move(products), std::move(gifts), recovery.lastSequence,
+                    baseCustomers, std::move(removedBaseCustomerIDs), std::move(pointLots),
+                    std::move(customerTotals));
+    // A follower only reads: the data files and the log belong to its primary
+    Snapshotter snapshotter(store, std::chrono::seconds(options.followAddress.empty() ? options.snapshotInterval : 0));
+    store.write().stockMonitor().setThreshold(options.lowStockThreshold);
+    store.write().shardMap() = shardMap;
+
+    // The reward configuration is optional; without it every dollar earns pointsPerDollar points
+    RewardConfig config(pointsPerDollar);
+    try {
+        config = RewardConfig::load("reward_rules.txt");
+        std::cout << "Successfully loaded " << config.getRules().getRuleCount() << " reward rules and "
+                  << config.getGifts().size() << " configured gifts.\n";
+    } catch (const std::runtime_error& e) {
+        std::cout << "Note: " << e.what() << " Using " << pointsPerDollar << " points per dollar.\n";
+    }
+    pointsPerDollar = config.getRules().getPointsPerDollar();
+    RewardService service(store, config);
+
+    if (!options.benchmarks.empty() || options.selfCheck) {
+        Benchmarks::Context context{store, service};
+        bool passed = options.selfCheck ? Benchmarks::selfCheck(context) : true;
+        for (const auto& [benchmark, size] : options.benchmarks) {
+            passed = Benchmarks::run(*benchmark, context, size) && passed;
+        }
+        snapshotter.stop();   // nothing was changed
+        return passed ? 0 : 1;
+    }
+    else {
+        // do nothing
+    }
+
+    // Reload the configuration whenever reward_rules.txt is saved; a bad file keeps the previous configuration
+    std::unique_ptr<ConfigWatcher> configWatcher;
+    try {
+        configWatcher = std::make_unique<ConfigWatcher>("reward_rules.txt", [&service](auto noticed) {
+            try {
+                service.setConfig(RewardConfig::load("reward_rules.txt"));
+                std::cout << "\nReloaded reward_rules.txt in "
+                          << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - noticed).count()
+                          << " ms (" << service.getPointsPerDollar() << " points per dollar).\n";
+            } catch (const std::runtime_error& e) {
+                std::cerr << "\nError: " << e.what() << " Keeping the previous reward configuration.\n";
+            }
+        });
+    } catch (const std::runtime_error& e) {
+        std::cout << "Note: " << e.what() << " Reward configuration changes need a restart.\n";
+    }
+
+    if (!options.followAddress.empty()) {
+        int status = serveFollower(store, service, options, recovery.lastSequence,
+                                   std::min({customerCheckpoint.logOffset, productCheckpoint.logOffset,
+                                             giftCheckpoint.logOffset, lotCheckpoint.logOffset,
+                                             totalsCheckpoint.logOffset}));
+        snapshotter.stop();   // a follower never saves
+        return status;
+    }
+    else {
+        // do nothing
+    }
+
+    // Points expire every second; a follower is sent its leader's expiries instead
+    PointExpirer expirer(store, std::chrono::seconds(1));
+
+    // Followers are sent the log as it is written, whichever way this process runs
+    std::unique_ptr<LogShipper> shipper;
+    if (!options.replicateAddress.empty()) {
+        try {
+            shipper = std::make_unique<LogShipper>(options.replicateAddress);
+            std::cout << "Shipping the transaction log to followers on " << options.replicateAddress << ".\n";
+        } catch (const std::runtime_error& e) {
+            std::cerr << "Error: " << e.what() << "\n";
+            snapshotter.stop();
+            return 1;
+        }
+    }
+    else {
+        // do nothing
+    }
+
+    if (!options.loadTarget.empty()) {
+        int status = generateLoad(store, service, options);
+        if (options.loadTarget == "inproc") {
+            saveAndExit(store, snapshotter);   // the load changed this process's data
+        }
+        else {
+            snapshotter.stop();   // the server owns the data files; leave them alone
+        }
+        return status;
+    }
+    else if (!options.cartFile.empty()) {
+        int status = checkoutCarts(service, options);
+        saveAndExit(store, snapshotter);
+        return status;
+    }
+    else if (!options.serveAddress.empty()) {
+        int status = serve(service, options);
+        saveAndExit(store, snapshotter);
+        return status;
+    }
+    else {
+        // do nothing
+    }
+
+    // Product names are searched while shopping; the menu keeps the index in step with the product list
+    ProductSearchIndex productIndex(store.read().readProducts());
 
     do {
         choice = displayMenu();
 
         switch (choice) {
             case 1:
-                registerCustomer(customers, usedIDs);
+                registerCustomer(store, usedIDs);
                 break;
             case 2:
-                removeCustomer(customers);
+                removeCustomer(store);
                 break;
             case 3:
-                addProduct(products);  // Call the function to add a product
+                addProduct(store, productIndex);
                 break;
             case 4:
-                removeProduct(products);  // Pass the products vector to remove a product
+                removeProduct(store, productIndex);
                 break;
             case 5:
-                shopping(customers, products, pointsPerDollar); 
+                shopping(store, service, productIndex);
                 break;
-                shopping(customers, products, pointsPerDollar);
             case 6:
-                viewCustomerByID(customers);
+                viewCustomerByID(store, *service.getConfig());
                 break;
             case 7: {
                 int subChoice;
@@ -489,12 +1558,18 @@ int main() {
                 switch (subChoice) {
                     case 1:
                         setPointsPerDollar(pointsPerDollar);
+                        service.setPointsPerDollar(pointsPerDollar);
+                        try {
+                            RewardConfig::savePointsPerDollar("reward_rules.txt", pointsPerDollar);
+                        } catch (const std::runtime_error& e) {
+                            std::cerr << "Error: " << e.what() << "\n";
+                        }
                         break;
                     case 2:
-                        addGift(gifts);
+                        addGift(store);
                         break;
                     case 3:
-                        redeemReward(customers, gifts);
+                        redeemReward(store, *service.getConfig());
                         break;
                     case 0:
                         break;
@@ -503,16 +1578,28 @@ int main() {
                 }
                 break;
             }
+            case 8:
+                importCustomers(store, usedIDs);
+                break;
+            case 9:
+                searchCustomers(store);
+                break;
+            case 10:
+                lowStockReport(store);
+                break;
             case 0:
-                std::cout << "Saving files and exiting program.\n";
-                FileManager::saveTransactions(transactions);
-                FileManager::saveCustomers(customers); 
-                FileManager::saveProducts(products); 
+                saveAndExit(store, snapshotter);
                 break;
             default:
                 std::cout << "Invalid option. Please try again.\n";
                 break;
         }
+        if (choice != 0) {
+            reportStockAlerts(store);
+        }
+        else {
+            // do nothing
+        }
     } while (choice != 0);
 
     return 0;